@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <stdio.h>
 #include "esp_err.h"
 #include "mbc_master.h"         // for master interface define
 #include "mbc_slave.h"          // for slave interface define
@@ -88,4 +89,121 @@ esp_err_t mbc_get_handler_count(void *ctx, uint16_t *count)
         ret = mbs_get_handler_count(mb_controller->mb_base, count);
     }
     return  MB_ERR_TO_ESP_ERR(ret);
-}
\ No newline at end of file
+}
+
+/**
+ * Read the records of transaction stages from the trace ring of the object
+ */
+esp_err_t mbc_get_trace(void *ctx, mb_trace_record_t *records, uint16_t *count, uint32_t *lost)
+{
+    MB_RETURN_ON_FALSE((ctx && records && count), ESP_ERR_INVALID_ARG, TAG,
+                            "Incorrect arguments.");
+    mb_controller_common_t *mb_controller = (mb_controller_common_t *)(ctx);
+    mb_base_t *mb_obj = (mb_base_t *)mb_controller->mb_base;
+    MB_RETURN_ON_FALSE((mb_obj && mb_obj->port_obj), ESP_ERR_INVALID_STATE, TAG,
+                            "Controller interface is not correctly initialized.");
+    mb_err_enum_t ret = mb_port_trace_read(mb_obj->port_obj, records, count, lost);
+    return  MB_ERR_TO_ESP_ERR(ret);
+}
+
+esp_err_t mbc_get_stats(void *ctx, mb_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((ctx && stats), ESP_ERR_INVALID_ARG, TAG,
+                            "Incorrect arguments.");
+    mb_controller_common_t *mb_controller = (mb_controller_common_t *)(ctx);
+    mb_base_t *mb_obj = (mb_base_t *)mb_controller->mb_base;
+    MB_RETURN_ON_FALSE((mb_obj && mb_obj->port_obj), ESP_ERR_INVALID_STATE, TAG,
+                            "Controller interface is not correctly initialized.");
+    mb_err_enum_t ret = mb_port_stats_get(mb_obj->port_obj, stats);
+    return  MB_ERR_TO_ESP_ERR(ret);
+}
+
+esp_err_t mbc_flush_trace_log(uint16_t max_count)
+{
+    return (mb_trace_log_flush(max_count) >= 0) ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+// Appends the formatted text to the buffer, the length keeps growing when the buffer is too small
+#define MB_STATS_PRINT(buf, size, len, ...) do {                                                   \
+        int ret = snprintf(((len) < (size)) ? ((buf) + (len)) : NULL,                               \
+                            ((len) < (size)) ? ((size) - (len)) : 0, __VA_ARGS__);                  \
+        (len) += (ret > 0) ? (size_t)ret : 0;                                                       \
+} while(0)
+
+static size_t mbc_stats_print_counter(char *buf, size_t size, size_t len, const char *name,
+                                        const char *instance, uint64_t value)
+{
+    MB_STATS_PRINT(buf, size, len, "# TYPE modbus_%s counter\n", name);
+    MB_STATS_PRINT(buf, size, len, "modbus_%s{instance=\"%s\"} %" PRIu64 "\n", name, instance, value);
+    return len;
+}
+
+// The func label is omitted for the summary which is not related to function code (func = 0)
+static size_t mbc_stats_print_summary(char *buf, size_t size, size_t len, const char *name,
+                                        const char *instance, uint8_t func, const mb_stats_time_t *time)
+{
+    static const char *quantiles[] = {"0.5", "0.9", "0.99"};
+    const uint32_t values[] = {time->p50_us, time->p90_us, time->p99_us};
+    char func_label[16] = "";
+    if (func) {
+        snprintf(func_label, sizeof(func_label), ",func=\"%u\"", (unsigned)func);
+    }
+    for (int i = 0; i < 3; i++) {
+        MB_STATS_PRINT(buf, size, len, "modbus_%s_seconds{instance=\"%s\"%s,quantile=\"%s\"} %" PRIu32 "e-6\n",
+                        name, instance, func_label, quantiles[i], values[i]);
+    }
+    MB_STATS_PRINT(buf, size, len, "modbus_%s_seconds_sum{instance=\"%s\"%s} %" PRIu64 "e-6\n",
+                    name, instance, func_label, time->sum_us);
+    MB_STATS_PRINT(buf, size, len, "modbus_%s_seconds_count{instance=\"%s\"%s} %" PRIu32 "\n",
+                    name, instance, func_label, time->count);
+    return len;
+}
+
+esp_err_t mbc_stats_to_prometheus(const mb_stats_t *stats, const char *instance, char *buf, size_t *size)
+{
+    MB_RETURN_ON_FALSE((stats && instance && buf && size && *size), ESP_ERR_INVALID_ARG, TAG,
+                            "Incorrect arguments.");
+    size_t len = 0;
+    len = mbc_stats_print_counter(buf, *size, len, "rx_bytes_total", instance, stats->rx_bytes);
+    len = mbc_stats_print_counter(buf, *size, len, "tx_bytes_total", instance, stats->tx_bytes);
+    len = mbc_stats_print_counter(buf, *size, len, "rx_frames_total", instance, stats->rx_frames);
+    len = mbc_stats_print_counter(buf, *size, len, "tx_frames_total", instance, stats->tx_frames);
+    len = mbc_stats_print_counter(buf, *size, len, "timeout_errors_total", instance, stats->err_timeout);
+    len = mbc_stats_print_counter(buf, *size, len, "receive_errors_total", instance, stats->err_receive);
+    len = mbc_stats_print_counter(buf, *size, len, "execute_errors_total", instance, stats->err_execute);
+    len = mbc_stats_print_counter(buf, *size, len, "dropped_frames_total", instance, stats->drops);
+    len = mbc_stats_print_counter(buf, *size, len, "untracked_requests_total", instance, stats->untracked);
+    len = mbc_stats_print_counter(buf, *size, len, "connect_errors_total", instance, stats->err_connect);
+    MB_STATS_PRINT(buf, *size, len, "# TYPE modbus_event_queue_high_water gauge\n");
+    MB_STATS_PRINT(buf, *size, len, "modbus_event_queue_high_water{instance=\"%s\"} %" PRIu32 "\n",
+                    instance, stats->queue_hwm);
+    MB_STATS_PRINT(buf, *size, len, "# TYPE modbus_request_errors_total counter\n");
+    for (int i = 0; i < MB_STATS_FUNC_MAX; i++) {
+        if (stats->funcs[i].func) {
+            MB_STATS_PRINT(buf, *size, len, "modbus_request_errors_total{instance=\"%s\",func=\"%u\"} %" PRIu32 "\n",
+                            instance, (unsigned)stats->funcs[i].func, stats->funcs[i].errors);
+        }
+    }
+    MB_STATS_PRINT(buf, *size, len, "# TYPE modbus_request_latency_seconds summary\n");
+    for (int i = 0; i < MB_STATS_FUNC_MAX; i++) {
+        if (stats->funcs[i].func) {
+            len = mbc_stats_print_summary(buf, *size, len, "request_latency", instance,
+                                            stats->funcs[i].func, &stats->funcs[i].latency);
+        }
+    }
+    MB_STATS_PRINT(buf, *size, len, "# TYPE modbus_handler_time_seconds summary\n");
+    for (int i = 0; i < MB_STATS_FUNC_MAX; i++) {
+        if (stats->funcs[i].func) {
+            len = mbc_stats_print_summary(buf, *size, len, "handler_time", instance,
+                                            stats->funcs[i].func, &stats->funcs[i].handler);
+        }
+    }
+    if (stats->connect.count) {
+        MB_STATS_PRINT(buf, *size, len, "# TYPE modbus_connect_time_seconds summary\n");
+        len = mbc_stats_print_summary(buf, *size, len, "connect_time", instance, 0, &stats->connect);
+    }
+    MB_RETURN_ON_FALSE((len < *size), ESP_ERR_INVALID_SIZE, TAG,
+                            "The buffer is too small, required %u bytes.", (unsigned)(len + 1));
+    *size = len;
+    return ESP_OK;
+}
@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <sys/param.h>         // for MIN()
 #include "esp_err.h"           // for esp_err_t
 #include "mbc_master.h"        // for master interface define
 #include "esp_modbus_master.h" // for public interface defines
@@ -77,6 +78,66 @@ esp_err_t mbc_master_get_cid_info(void *ctx, uint16_t cid, const mb_parameter_de
     return error;
 }
 
+/**
+ * Get information about characteristic selected by name
+ */
+esp_err_t mbc_master_get_cid_info_by_key(void *ctx, const char *param_key, const mb_parameter_descriptor_t **param_info)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    MB_RETURN_ON_FALSE((param_key && param_info), ESP_ERR_INVALID_ARG, TAG,
+                       "mb incorrect parameter key or data buffer pointer.");
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
+    MB_RETURN_ON_FALSE((mbm_opts->param_descriptor_table), ESP_ERR_INVALID_ARG, TAG,
+                       "mb incorrect descriptor table or not set.");
+    int index = mbc_master_find_key_index(mbm_opts, param_key);
+    MB_RETURN_ON_FALSE((index >= 0), ESP_ERR_NOT_FOUND, TAG,
+                       "mb characteristic (%s) is not found.", param_key);
+    *param_info = &mbm_opts->param_descriptor_table[index];
+    return ESP_OK;
+}
+
+/**
+ * Get round trip time statistics of the slave
+ */
+esp_err_t mbc_master_get_slave_rtt_stats(void *ctx, uint8_t slave_addr, mb_slave_rtt_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    MB_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "mb incorrect stats pointer.");
+    mbm_controller_iface_t *mbm_controller = MB_MASTER_GET_IFACE(ctx);
+    MB_RETURN_ON_FALSE((mbm_controller->mb_base && mbm_controller->mb_base->port_obj),
+                       ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    mb_port_rtt_stats_t port_stats = {0};
+    mb_err_enum_t mb_err = mb_port_timer_get_rtt_stats(mbm_controller->mb_base->port_obj, slave_addr, &port_stats);
+    MB_RETURN_ON_FALSE((mb_err == MB_ENOERR), MB_ERR_TO_ESP_ERR(mb_err), TAG,
+                       "Master get rtt stats failure, error=(0x%x).", (int)mb_err);
+    stats->srtt_us = port_stats.srtt_us;
+    stats->rttvar_us = port_stats.rttvar_us;
+    stats->last_rtt_us = port_stats.last_rtt_us;
+    stats->rto_ms = port_stats.rto_ms;
+    stats->samples = port_stats.samples;
+    stats->timeouts = port_stats.timeouts;
+    return ESP_OK;
+}
+
+/**
+ * Get health state of the slave
+ */
+esp_err_t mbc_master_get_slave_health(void *ctx, uint8_t slave_addr, mb_slave_health_state_t *state)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    MB_RETURN_ON_FALSE((state && (slave_addr != MB_ADDRESS_BROADCAST) && (slave_addr <= MB_ADDRESS_MAX)),
+                       ESP_ERR_INVALID_ARG, TAG, "mb incorrect state pointer or slave address.");
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
+    MB_RETURN_ON_FALSE(mbm_opts->slave_health, ESP_ERR_NOT_SUPPORTED, TAG,
+                       "Master slave health tracking is disabled.");
+    *state = (mb_slave_health_state_t)mbm_opts->slave_health[slave_addr].state;
+    return ESP_OK;
+}
+
 /**
  * Set parameter value for characteristic selected by name and cid
  */
@@ -456,282 +517,387 @@ mb_err_enum_t mbc_reg_discrete_master_cb(mb_base_t *inst, uint8_t *reg_buffer, u
     return status;
 }
 
-// Helper function to set parameter buffer according to its type
-esp_err_t mbc_master_set_param_data(void* dest, void* src, mb_descr_type_t param_type, size_t param_size)
-{
-    esp_err_t err = ESP_OK;
-    MB_RETURN_ON_FALSE((src), ESP_ERR_INVALID_STATE, TAG,"incorrect data pointer.");
-    MB_RETURN_ON_FALSE((dest), ESP_ERR_INVALID_STATE, TAG,"incorrect data pointer.");
-    void *dest_ptr = dest;
-    void *src_ptr = src;
+#define INLINE inline __attribute__((always_inline))
 
-    // Transfer parameter data into value of characteristic
-    switch(param_type)
-    {
-        case PARAM_TYPE_U8:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U8) {
-                *((uint8_t *)dest_ptr) = *((uint8_t*)src_ptr);
-            }
-            break;
+// Transfers the elements which have the same byte order in parameter and register buffer
+static void mb_conv_copy(const mb_param_conv_plan_t *plan, uint8_t *dest, const uint8_t *src)
+{
+    memcpy(dest, src, (size_t)plan->count * plan->stride);
+    ESP_LOGV(TAG, "Copy %u elements of %u bytes.", (unsigned)plan->count, (unsigned)plan->stride);
+}
 
-        case PARAM_TYPE_U16:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U16) {
-                *((uint16_t *)dest_ptr) = *((uint16_t*)src_ptr);
-            }
-            break;
+// Generic permutation kernel, the stride is constant to let compiler unroll the element loop
+static INLINE void mb_conv_permute_generic(const uint8_t *perm, uint8_t *dest, const uint8_t *src,
+                                            uint16_t count, const uint16_t stride)
+{
+    for (uint16_t i = 0; i < count; i++, dest += stride, src += stride) {
+        for (uint16_t k = 0; k < stride; k++) {
+            dest[k] = (perm[k] == MB_CONV_PERM_ZERO) ? 0 : src[perm[k]];
+        }
+    }
+    ESP_LOGV(TAG, "Permute %u elements of %u bytes.", (unsigned)count, (unsigned)stride);
+}
 
-        case PARAM_TYPE_U32:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U32) {
-                *((uint32_t *)dest_ptr) = *((uint32_t*)src_ptr);
-            }
-            break;
+static void mb_conv_permute16(const mb_param_conv_plan_t *plan, uint8_t *dest, const uint8_t *src)
+{
+    mb_conv_permute_generic(plan->perm, dest, src, plan->count, 2);
+}
 
-        case PARAM_TYPE_FLOAT:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_FLOAT) {
-                *((float *)dest_ptr) = *(float*)src_ptr;
-            }
-            break;
+static void mb_conv_permute32(const mb_param_conv_plan_t *plan, uint8_t *dest, const uint8_t *src)
+{
+    mb_conv_permute_generic(plan->perm, dest, src, plan->count, 4);
+}
 
-        case PARAM_TYPE_ASCII:
-        case PARAM_TYPE_BIN:
-            memcpy(dest, src, param_size);
-            break;
+static void mb_conv_permute64(const mb_param_conv_plan_t *plan, uint8_t *dest, const uint8_t *src)
+{
+    mb_conv_permute_generic(plan->perm, dest, src, plan->count, 8);
+}
 
+#define MB_CONV_Z MB_CONV_PERM_ZERO
+
+#define MB_CONV_COPY(size) { .convert = mb_conv_copy, .stride = (size), .count = 0, .perm = {0} }
+#define MB_CONV_PERM16(...) { .convert = mb_conv_permute16, .stride = 2, .count = 0, .perm = {__VA_ARGS__} }
+#define MB_CONV_PERM32(...) { .convert = mb_conv_permute32, .stride = 4, .count = 0, .perm = {__VA_ARGS__} }
+#define MB_CONV_PERM64(...) { .convert = mb_conv_permute64, .stride = 8, .count = 0, .perm = {__VA_ARGS__} }
+
+// The conversion plan templates indexed by parameter type.
+// The permutation for each type is the same as for appropriate mb_set_xxx() function from mb_endianness_utils.
+static const mb_param_conv_plan_t mb_conv_templates[] = {
+    [PARAM_TYPE_U8] = MB_CONV_COPY(PARAM_SIZE_U8),
+    [PARAM_TYPE_U16] = MB_CONV_COPY(PARAM_SIZE_U16),
+    [PARAM_TYPE_U32] = MB_CONV_COPY(PARAM_SIZE_U32),
+    [PARAM_TYPE_FLOAT] = MB_CONV_COPY(PARAM_SIZE_FLOAT),
+    [PARAM_TYPE_ASCII] = MB_CONV_COPY(PARAM_SIZE_U8),
+    [PARAM_TYPE_BIN] = MB_CONV_COPY(PARAM_SIZE_U8),
 #if CONFIG_FMB_EXT_TYPE_SUPPORT
+    [PARAM_TYPE_I8_A] = MB_CONV_PERM16(0, MB_CONV_Z),
+    [PARAM_TYPE_I8_B] = MB_CONV_PERM16(MB_CONV_Z, 1),
+    [PARAM_TYPE_U8_A] = MB_CONV_PERM16(0, MB_CONV_Z),
+    [PARAM_TYPE_U8_B] = MB_CONV_PERM16(MB_CONV_Z, 1),
+    [PARAM_TYPE_I16_AB] = MB_CONV_COPY(PARAM_SIZE_I16),
+    [PARAM_TYPE_I16_BA] = MB_CONV_PERM16(1, 0),
+    [PARAM_TYPE_U16_AB] = MB_CONV_COPY(PARAM_SIZE_U16),
+    [PARAM_TYPE_U16_BA] = MB_CONV_PERM16(1, 0),
+    [PARAM_TYPE_I32_ABCD] = MB_CONV_COPY(PARAM_SIZE_I32),
+    [PARAM_TYPE_I32_CDAB] = MB_CONV_PERM32(2, 3, 0, 1),
+    [PARAM_TYPE_I32_BADC] = MB_CONV_PERM32(1, 0, 3, 2),
+    [PARAM_TYPE_I32_DCBA] = MB_CONV_PERM32(3, 2, 1, 0),
+    [PARAM_TYPE_U32_ABCD] = MB_CONV_COPY(PARAM_SIZE_U32),
+    [PARAM_TYPE_U32_CDAB] = MB_CONV_PERM32(2, 3, 0, 1),
+    [PARAM_TYPE_U32_BADC] = MB_CONV_PERM32(1, 0, 3, 2),
+    [PARAM_TYPE_U32_DCBA] = MB_CONV_PERM32(3, 2, 1, 0),
+    [PARAM_TYPE_FLOAT_ABCD] = MB_CONV_COPY(PARAM_SIZE_FLOAT),
+    [PARAM_TYPE_FLOAT_CDAB] = MB_CONV_PERM32(2, 3, 0, 1),
+    [PARAM_TYPE_FLOAT_BADC] = MB_CONV_PERM32(1, 0, 3, 2),
+    [PARAM_TYPE_FLOAT_DCBA] = MB_CONV_PERM32(3, 2, 1, 0),
+    [PARAM_TYPE_I64_ABCDEFGH] = MB_CONV_COPY(PARAM_SIZE_I64),
+    [PARAM_TYPE_I64_HGFEDCBA] = MB_CONV_PERM64(7, 6, 5, 4, 3, 2, 1, 0),
+    [PARAM_TYPE_I64_GHEFCDAB] = MB_CONV_PERM64(6, 7, 4, 5, 2, 3, 0, 1),
+    [PARAM_TYPE_I64_BADCFEHG] = MB_CONV_PERM64(1, 0, 3, 2, 5, 4, 7, 6),
+    [PARAM_TYPE_U64_ABCDEFGH] = MB_CONV_COPY(PARAM_SIZE_U64),
+    [PARAM_TYPE_U64_HGFEDCBA] = MB_CONV_PERM64(7, 6, 5, 4, 3, 2, 1, 0),
+    [PARAM_TYPE_U64_GHEFCDAB] = MB_CONV_PERM64(6, 7, 4, 5, 2, 3, 0, 1),
+    [PARAM_TYPE_U64_BADCFEHG] = MB_CONV_PERM64(1, 0, 3, 2, 5, 4, 7, 6),
+    [PARAM_TYPE_DOUBLE_ABCDEFGH] = MB_CONV_COPY(PARAM_SIZE_DOUBLE),
+    [PARAM_TYPE_DOUBLE_HGFEDCBA] = MB_CONV_PERM64(7, 6, 5, 4, 3, 2, 1, 0),
+    [PARAM_TYPE_DOUBLE_GHEFCDAB] = MB_CONV_PERM64(6, 7, 4, 5, 2, 3, 0, 1),
+    [PARAM_TYPE_DOUBLE_BADCFEHG] = MB_CONV_PERM64(1, 0, 3, 2, 5, 4, 7, 6),
+#endif
+};
 
-        case PARAM_TYPE_I8_A:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U8_REG) {
-                mb_set_int8_a((val_16_arr *)dest_ptr, (*(int8_t*)src_ptr));
-                ESP_LOGV(TAG, "Convert uint8 B[%d] 0x%04" PRIx16 " = 0x%04" PRIx16, i, *(uint16_t *)src_ptr, *(uint16_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_I8_B:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U8_REG) {
-                mb_set_int8_b((val_16_arr *)dest_ptr, (int8_t)((*(uint16_t*)src_ptr) >> 8));
-                ESP_LOGV(TAG, "Convert int8 A[%d] 0x%02" PRIx16 " = 0x%02" PRIx16, i, *(uint16_t *)src_ptr, *(uint16_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_U8_A:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U8_REG) {
-                mb_set_uint8_a((val_16_arr *)dest_ptr, (*(uint8_t*)src_ptr));
-                ESP_LOGV(TAG, "Convert uint8 A[%d] 0x%02" PRIx16 " = %02" PRIx16, i, *(uint16_t *)src_ptr, *(uint16_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_U8_B:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U8_REG) {
-                uint8_t data = (uint8_t)((*(uint16_t*)src_ptr) >> 8);
-                mb_set_uint8_b((val_16_arr *)dest_ptr, data);
-                ESP_LOGV(TAG, "Convert uint8 B[%d] 0x%02" PRIx16 " = 0x%02" PRIx16, i, *(uint16_t *)src_ptr, *(uint16_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_I16_AB:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I16) {
-                mb_set_int16_ab((val_16_arr *)dest_ptr, *(int16_t*)src_ptr);
-                ESP_LOGV(TAG, "Convert int16 AB[%d] 0x%04" PRIx16 " = 0x%04" PRIx16, i, *(uint16_t *)src_ptr, *(uint16_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_I16_BA:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I16) {
-                mb_set_int16_ba((val_16_arr *)dest_ptr, *(int16_t*)src_ptr);
-                ESP_LOGV(TAG, "Convert int16 BA[%d] 0x%04" PRIx16 " = 0x%04" PRIx16, i, *(uint16_t *)src_ptr, *(uint16_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_U16_AB:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U16) {
-                mb_set_uint16_ab((val_16_arr *)dest_ptr, *(uint16_t*)src_ptr);
-                ESP_LOGV(TAG, "Convert uint16 AB[%d] 0x%02" PRIx16 " = 0x%02" PRIx16, i, *(uint16_t *)src_ptr, *(uint16_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_U16_BA:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U16) {
-                mb_set_uint16_ba((val_16_arr *)dest_ptr, *(uint16_t*)src_ptr);
-                ESP_LOGV(TAG, "Convert uint16 BA[%d] 0x%02" PRIx16 " = 0x%02" PRIx16, i, *(uint16_t *)src_ptr, *(uint16_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_I32_ABCD:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I32) {
-                mb_set_int32_abcd((val_32_arr *)dest_ptr, *(int32_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert int32 ABCD[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_U32_ABCD:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U32) {
-                mb_set_uint32_abcd((val_32_arr *)dest_ptr, *(uint32_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert uint32 ABCD[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
-
-        case PARAM_TYPE_FLOAT_ABCD:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_FLOAT) {
-                mb_set_float_abcd((val_32_arr *)dest_ptr, *(float *)src_ptr);
-                ESP_LOGV(TAG, "Convert float ABCD[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+#define MB_CONV_TEMPLATES_CNT (sizeof(mb_conv_templates) / sizeof(mb_conv_templates[0]))
 
-        case PARAM_TYPE_I32_CDAB:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I32) {
-                mb_set_int32_cdab((val_32_arr *)dest_ptr, *(int32_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert int32 CDAB[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+// Helper function to compile conversion plan for the parameter type
+esp_err_t mbc_master_get_conv_plan(mb_param_conv_plan_t *plan, mb_descr_type_t param_type, size_t param_size)
+{
+    MB_RETURN_ON_FALSE((plan), ESP_ERR_INVALID_ARG, TAG, "incorrect plan pointer.");
+    if (((unsigned)param_type >= MB_CONV_TEMPLATES_CNT) || !mb_conv_templates[param_type].convert) {
+        memset(plan, 0, sizeof(mb_param_conv_plan_t));
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    *plan = mb_conv_templates[param_type];
+    // The remainder of the parameter which is less than element size is not transferred
+    plan->count = (uint16_t)(param_size / plan->stride);
+    return ESP_OK;
+}
 
-        case PARAM_TYPE_U32_CDAB:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U32) {
-                mb_set_uint32_cdab((val_32_arr *)dest_ptr, *(uint32_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert uint32 CDAB[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+// Helper function to set parameter buffer using the compiled conversion plan
+esp_err_t mbc_master_apply_conv_plan(const mb_param_conv_plan_t *plan, void *dest, const void *src)
+{
+    MB_RETURN_ON_FALSE((src), ESP_ERR_INVALID_STATE, TAG, "incorrect data pointer.");
+    MB_RETURN_ON_FALSE((dest), ESP_ERR_INVALID_STATE, TAG, "incorrect data pointer.");
+    MB_RETURN_ON_FALSE((plan && plan->convert), ESP_ERR_NOT_SUPPORTED, TAG, "incorrect conversion plan.");
+    plan->convert(plan, (uint8_t *)dest, (const uint8_t *)src);
+    return ESP_OK;
+}
 
-        case PARAM_TYPE_FLOAT_CDAB:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_FLOAT) {
-                mb_set_float_cdab((val_32_arr *)dest_ptr, *(float *)src_ptr);
-                ESP_LOGV(TAG, "Convert float CDAB[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+// Helper function to set parameter buffer according to its type
+esp_err_t mbc_master_set_param_data(void* dest, void* src, mb_descr_type_t param_type, size_t param_size)
+{
+    MB_RETURN_ON_FALSE((src), ESP_ERR_INVALID_STATE, TAG,"incorrect data pointer.");
+    MB_RETURN_ON_FALSE((dest), ESP_ERR_INVALID_STATE, TAG,"incorrect data pointer.");
+    mb_param_conv_plan_t plan;
+    if (mbc_master_get_conv_plan(&plan, param_type, param_size) != ESP_OK) {
+        ESP_LOGE(TAG, "%s: Incorrect param type (%u).",
+                    __FUNCTION__, (unsigned)param_type);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return mbc_master_apply_conv_plan(&plan, dest, src);
+}
 
-        case PARAM_TYPE_I32_BADC:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I32) {
-                mb_set_int32_badc((val_32_arr *)dest_ptr, *(int32_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert int32 BADC[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+// Compiles the conversion plans for all parameters of the description table.
+// The parameters of unsupported type get the empty plan and fail on access as before.
+esp_err_t mbc_master_compile_conv_plans(mb_param_conv_plan_t **plans_out, const mb_parameter_descriptor_t *descriptor,
+                                        uint16_t num_elements)
+{
+    MB_RETURN_ON_FALSE((plans_out && descriptor && num_elements), ESP_ERR_INVALID_ARG, TAG, "incorrect descriptor table.");
+    mb_param_conv_plan_t *plans = calloc(num_elements, sizeof(mb_param_conv_plan_t));
+    MB_RETURN_ON_FALSE((plans), ESP_ERR_NO_MEM, TAG, "conversion plans allocation fail.");
+    for (uint16_t idx = 0; idx < num_elements; idx++) {
+        if (mbc_master_get_conv_plan(&plans[idx], descriptor[idx].param_type, descriptor[idx].param_size) != ESP_OK) {
+            ESP_LOGW(TAG, "cid #%u, the param type (%u) is not supported.",
+                        (unsigned)descriptor[idx].cid, (unsigned)descriptor[idx].param_type);
+        }
+    }
+    *plans_out = plans;
+    return ESP_OK;
+}
 
-        case PARAM_TYPE_U32_BADC:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U32) {
-                mb_set_uint32_badc((val_32_arr *)dest_ptr, *(uint32_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert uint32 BADC[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+// The FNV-1a hash of the parameter name
+static uint32_t mbc_master_key_hash(const char *key)
+{
+    uint32_t hash = 2166136261UL;
+    while (*key) {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
 
-        case PARAM_TYPE_FLOAT_BADC:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_FLOAT) {
-                mb_set_float_badc((val_32_arr *)dest_ptr, *(float *)src_ptr);
-                ESP_LOGV(TAG, "Convert float BADC[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+// Multiplicative hash to spread the sequential cids over the slots
+static inline uint32_t mbc_master_cid_hash(uint16_t cid)
+{
+    uint32_t hash = (uint32_t)cid * 2654435761UL;
+    return hash ^ (hash >> 16);
+}
 
-        case PARAM_TYPE_I32_DCBA:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I32) {
-                mb_set_int32_dcba((val_32_arr *)dest_ptr, *(int32_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert int32 DCBA[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+void mbc_master_free_param_index(mb_param_index_t *index)
+{
+    if (index) {
+        free(index->cid_slots);
+        memset(index, 0, sizeof(mb_param_index_t));
+    }
+}
 
-        case PARAM_TYPE_U32_DCBA:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U32) {
-                mb_set_uint32_dcba((val_32_arr *)dest_ptr, *(uint32_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert uint32 DCBA[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+// Builds the hash tables with linear probing, the table size is a power of two
+// not less than twice the number of parameters to keep the probe sequences short.
+esp_err_t mbc_master_build_param_index(mb_param_index_t *index, const mb_parameter_descriptor_t *descriptor,
+                                        uint16_t num_elements)
+{
+    MB_RETURN_ON_FALSE((index && descriptor && num_elements), ESP_ERR_INVALID_ARG, TAG, "incorrect descriptor table.");
+    uint32_t slots_num = 4;
+    while (slots_num < ((uint32_t)num_elements << 1)) {
+        slots_num <<= 1;
+    }
+    uint32_t mask = slots_num - 1;
+    // The tables are kept in one block: cid slots, key slots, key hashes (aligned as slots_num >= 4)
+    uint16_t *cid_slots = calloc(1, (slots_num * sizeof(uint16_t) * 2) + (num_elements * sizeof(uint32_t)));
+    MB_RETURN_ON_FALSE((cid_slots), ESP_ERR_NO_MEM, TAG, "parameter index allocation fail.");
+    uint16_t *key_slots = &cid_slots[slots_num];
+    uint32_t *key_hashes = (uint32_t *)&key_slots[slots_num];
+    for (uint16_t idx = 0; idx < num_elements; idx++) {
+        uint32_t slot = mbc_master_cid_hash(descriptor[idx].cid) & mask;
+        while (cid_slots[slot] != MB_PARAM_INDEX_EMPTY) {
+            if (descriptor[cid_slots[slot] - 1].cid == descriptor[idx].cid) {
+                ESP_LOGE(TAG, "mb descriptor cid #%u is duplicated.", (unsigned)descriptor[idx].cid);
+                free(cid_slots);
+                return ESP_ERR_INVALID_ARG;
+            }
+            slot = (slot + 1) & mask;
+        }
+        cid_slots[slot] = idx + 1;
+        key_hashes[idx] = mbc_master_key_hash(descriptor[idx].param_key);
+        slot = key_hashes[idx] & mask;
+        while (key_slots[slot] != MB_PARAM_INDEX_EMPTY) {
+            uint16_t other = key_slots[slot] - 1;
+            if ((key_hashes[other] == key_hashes[idx])
+                    && !strcmp(descriptor[other].param_key, descriptor[idx].param_key)) {
+                // The first characteristic with the same name is found by the key
+                ESP_LOGW(TAG, "mb descriptor key (%s) of cid #%u is duplicated.",
+                            descriptor[idx].param_key, (unsigned)descriptor[idx].cid);
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        if (key_slots[slot] == MB_PARAM_INDEX_EMPTY) {
+            key_slots[slot] = idx + 1;
+        }
+    }
+    index->cid_slots = cid_slots;
+    index->key_slots = key_slots;
+    index->key_hashes = key_hashes;
+    index->mask = mask;
+    return ESP_OK;
+}
 
-        case PARAM_TYPE_FLOAT_DCBA:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_FLOAT) {
-                mb_set_float_dcba((val_32_arr *)dest_ptr, *(float *)src_ptr);
-                ESP_LOGV(TAG, "Convert float DCBA[%d] 0x%04" PRIx32 " = 0x%04" PRIx32, i, *(uint32_t *)src_ptr, *(uint32_t *)dest_ptr);
-            }
-            break;
+// Builds the index and plans aside and replaces the current table only when both are ready
+esp_err_t mbc_master_set_param_table(mb_master_options_t *opts, const mb_parameter_descriptor_t *descriptor,
+                                        uint16_t num_elements)
+{
+    MB_RETURN_ON_FALSE((opts), ESP_ERR_INVALID_ARG, TAG, "incorrect master options.");
+    mb_param_index_t index = {0};
+    mb_param_conv_plan_t *plans = NULL;
+    esp_err_t err = mbc_master_build_param_index(&index, descriptor, num_elements);
+    MB_RETURN_ON_FALSE((err == ESP_OK), err, TAG, "mb descriptor index build fail.");
+    err = mbc_master_compile_conv_plans(&plans, descriptor, num_elements);
+    if (err != ESP_OK) {
+        mbc_master_free_param_index(&index);
+        ESP_LOGE(TAG, "mb conversion plans compile fail.");
+        return err;
+    }
+    mbc_master_free_param_index(&opts->param_index);
+    free(opts->param_conv_plans);
+    opts->param_index = index;
+    opts->param_conv_plans = plans;
+    opts->param_descriptor_table = descriptor;
+    opts->mbm_param_descriptor_size = num_elements;
+    return ESP_OK;
+}
 
-        case PARAM_TYPE_I64_ABCDEFGH:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I64) {
-                mb_set_int64_abcdefgh((val_64_arr *)dest_ptr, *(int64_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert int64 ABCDEFGH[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
-            }
-            break;
+int mbc_master_find_cid_index(const mb_master_options_t *opts, uint16_t cid)
+{
+    const mb_param_index_t *index = &opts->param_index;
+    // Fast path for the tables with dense cids starting from zero
+    if ((cid < opts->mbm_param_descriptor_size) && (opts->param_descriptor_table[cid].cid == cid)) {
+        return cid;
+    }
+    if (!index->cid_slots) {
+        return -1;
+    }
+    for (uint32_t slot = mbc_master_cid_hash(cid) & index->mask;
+            index->cid_slots[slot] != MB_PARAM_INDEX_EMPTY; slot = (slot + 1) & index->mask) {
+        uint16_t idx = index->cid_slots[slot] - 1;
+        if (opts->param_descriptor_table[idx].cid == cid) {
+            return idx;
+        }
+    }
+    return -1;
+}
 
-        case PARAM_TYPE_U64_ABCDEFGH:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U64) {
-                mb_set_uint64_abcdefgh((val_64_arr *)dest_ptr, *(uint64_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert double ABCDEFGH[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
-            }
-            break;
+int mbc_master_find_key_index(const mb_master_options_t *opts, const char *param_key)
+{
+    const mb_param_index_t *index = &opts->param_index;
+    if (!index->key_slots || !param_key) {
+        return -1;
+    }
+    uint32_t hash = mbc_master_key_hash(param_key);
+    for (uint32_t slot = hash & index->mask;
+            index->key_slots[slot] != MB_PARAM_INDEX_EMPTY; slot = (slot + 1) & index->mask) {
+        uint16_t idx = index->key_slots[slot] - 1;
+        if ((index->key_hashes[idx] == hash) && !strcmp(opts->param_descriptor_table[idx].param_key, param_key)) {
+            return idx;
+        }
+    }
+    return -1;
+}
 
-        case PARAM_TYPE_DOUBLE_ABCDEFGH:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_DOUBLE) {
-                mb_set_double_abcdefgh((val_64_arr *)dest_ptr, *(double *)src_ptr);
-                ESP_LOGV(TAG, "Convert double ABCDEFGH[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
-            }
-            break;
+#if MB_MASTER_SLAVE_HEALTH_ENABLED
 
-        case PARAM_TYPE_I64_HGFEDCBA:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I64) {
-                mb_set_int64_hgfedcba((val_64_arr *)dest_ptr, *(int64_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert int64 HGFEDCBA[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
-            }
-            break;
+// The tick time wraps around, so the times are compared using the signed difference
+static inline uint32_t mbc_master_health_time_ms(void)
+{
+    return (uint32_t)pdTICKS_TO_MS(xTaskGetTickCount());
+}
 
-        case PARAM_TYPE_U64_HGFEDCBA:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U64) {
-                mb_set_uint64_hgfedcba((val_64_arr *)dest_ptr, *(uint64_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert double HGFEDCBA[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
-            }
-            break;
+// The probe interval is doubled after each failed probe and limited by the maximum
+static uint32_t mbc_master_health_probe_ms(uint8_t backoff)
+{
+    uint32_t probe_ms = MB_MASTER_SLAVE_PROBE_MS;
+    while (backoff-- && (probe_ms < MB_MASTER_SLAVE_PROBE_MAX_MS)) {
+        probe_ms <<= 1;
+    }
+    return MIN(probe_ms, MB_MASTER_SLAVE_PROBE_MAX_MS);
+}
 
-        case PARAM_TYPE_DOUBLE_HGFEDCBA:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_DOUBLE) {
-                mb_set_double_hgfedcba((val_64_arr *)dest_ptr, *(double *)src_ptr);
-                ESP_LOGV(TAG, "Convert double HGFEDCBA[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
-            }
-            break;
+#endif
 
-        case PARAM_TYPE_I64_GHEFCDAB:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I64) {
-                mb_set_int64_ghefcdab((val_64_arr *)dest_ptr, *(int64_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert int64 GHEFCDAB[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
-            }
-            break;
+esp_err_t mbc_master_slave_health_create(mb_master_options_t *opts)
+{
+    MB_RETURN_ON_FALSE(opts, ESP_ERR_INVALID_ARG, TAG, "incorrect options pointer.");
+    opts->slave_health = NULL;
+#if MB_MASTER_SLAVE_HEALTH_ENABLED
+    opts->slave_health = calloc(MB_ADDRESS_MAX + 1, sizeof(mb_slave_health_t));
+    MB_RETURN_ON_FALSE(opts->slave_health, ESP_ERR_NO_MEM, TAG, "slave health table allocation fail.");
+#endif
+    return ESP_OK;
+}
 
-        case PARAM_TYPE_U64_GHEFCDAB:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U64) {
-                mb_set_uint64_ghefcdab((val_64_arr *)dest_ptr, *(uint64_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert uint64 GHEFCDAB[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
-            }
-            break;
+void mbc_master_slave_health_delete(mb_master_options_t *opts)
+{
+    if (opts) {
+        free(opts->slave_health);
+        opts->slave_health = NULL;
+    }
+}
 
-        case PARAM_TYPE_DOUBLE_GHEFCDAB:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_DOUBLE) {
-                mb_set_double_ghefcdab((val_64_arr *)dest_ptr, *(double *)src_ptr);
-                ESP_LOGV(TAG, "Convert double GHEFCDAB[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
-            }
-            break;
+bool mbc_master_slave_is_available(mb_master_options_t *opts, uint8_t slave_addr)
+{
+#if MB_MASTER_SLAVE_HEALTH_ENABLED
+    if (!opts->slave_health || (slave_addr == MB_ADDRESS_BROADCAST) || (slave_addr > MB_ADDRESS_MAX)) {
+        return true;
+    }
+    mb_slave_health_t *health = &opts->slave_health[slave_addr];
+    // The down slave gets one probe request when its probe time is expired
+    return (health->state != MB_SLAVE_HEALTH_DOWN)
+            || ((int32_t)(mbc_master_health_time_ms() - health->probe_time_ms) >= 0);
+#else
+    return true;
+#endif
+}
 
-        case PARAM_TYPE_I64_BADCFEHG:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_I64) {
-                mb_set_int64_badcfehg((val_64_arr *)dest_ptr, *(int64_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert int64 BADCFEHG[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
+void mbc_master_slave_update_health(mb_master_options_t *opts, uint8_t slave_addr, mb_err_enum_t mb_error)
+{
+#if MB_MASTER_SLAVE_HEALTH_ENABLED
+    if (!opts->slave_health || (slave_addr == MB_ADDRESS_BROADCAST) || (slave_addr > MB_ADDRESS_MAX)) {
+        return;
+    }
+    mb_slave_health_t *health = &opts->slave_health[slave_addr];
+    switch (mb_error) {
+        case MB_ETIMEDOUT:
+        case MB_ENOCONN:
+            if (health->state == MB_SLAVE_HEALTH_DOWN) {
+                // The probe is failed, increase the probe interval
+                if (health->backoff < UINT8_MAX) {
+                    health->backoff++;
+                }
+            } else if (++health->fail_count >= MB_MASTER_SLAVE_FAIL_THRESHOLD) {
+                health->state = MB_SLAVE_HEALTH_DOWN;
+                health->backoff = 0;
+                ESP_LOGW(TAG, "slave #%u is down after %u timeouts.",
+                            (unsigned)slave_addr, (unsigned)health->fail_count);
+            } else {
+                health->state = MB_SLAVE_HEALTH_SUSPECT;
             }
-            break;
-
-        case PARAM_TYPE_U64_BADCFEHG:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_U64) {
-                mb_set_uint64_badcfehg((val_64_arr *)dest_ptr, *(uint64_t *)src_ptr);
-                ESP_LOGV(TAG, "Convert uint64 BADCFEHG[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
+            if (health->state == MB_SLAVE_HEALTH_DOWN) {
+                health->probe_time_ms = mbc_master_health_time_ms() + mbc_master_health_probe_ms(health->backoff);
             }
             break;
-
-        case PARAM_TYPE_DOUBLE_BADCFEHG:
-            for MB_EACH_ELEM(src_ptr, dest_ptr, param_size, PARAM_SIZE_DOUBLE) {
-                mb_set_double_badcfehg((val_64_arr *)dest_ptr, *(double *)src_ptr);
-                ESP_LOGV(TAG, "Convert double BADCFEHG[%d] 0x%" PRIx64 " = 0x%" PRIx64, i, *(uint64_t *)src_ptr, *(uint64_t *)dest_ptr);
+        case MB_ENOERR:
+        case MB_ERECVDATA:
+        case MB_EILLFUNC:
+            // Any response of the slave recovers it
+            if (health->state == MB_SLAVE_HEALTH_DOWN) {
+                ESP_LOGI(TAG, "slave #%u is up.", (unsigned)slave_addr);
             }
+            health->state = MB_SLAVE_HEALTH_UP;
+            health->fail_count = 0;
+            health->backoff = 0;
             break;
-
-#endif
         default:
-            ESP_LOGE(TAG, "%s: Incorrect param type (%u).",
-                        __FUNCTION__, (unsigned)param_type);
-            err = ESP_ERR_NOT_SUPPORTED;
+            // The request is not sent to the slave
             break;
     }
-    return err;
+#endif
 }
 
 // Helper function to get configured Modbus command for each type of Modbus register area.
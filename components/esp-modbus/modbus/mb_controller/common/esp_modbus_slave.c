@@ -342,6 +342,7 @@ static esp_err_t mbc_slave_send_param_access_notification(void *ctx, mb_event_gr
 // Callback function for reading of MB Input Registers
 mb_err_enum_t mbc_reg_input_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uint16_t address, uint16_t n_regs)
 {
+    MB_STAGE_TRACE(inst->port_obj, MB_TRACE_STAGE_REG_CB, 0, address, (((uint32_t)MB_PARAM_INPUT << 16) | n_regs));
     void *ctx = (void *)MB_SLAVE_GET_IFACE_FROM_BASE(inst);
     MB_RETURN_ON_FALSE(reg_buffer, MB_EINVAL, TAG, "Slave stack call failed.");
     mb_err_enum_t status = MB_ENOERR;
@@ -379,6 +380,7 @@ mb_err_enum_t mbc_reg_input_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uint1
 // Executed by stack when request to read/write holding registers is received
 mb_err_enum_t mbc_reg_holding_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uint16_t address, uint16_t n_regs, mb_reg_mode_enum_t mode)
 {
+    MB_STAGE_TRACE(inst->port_obj, MB_TRACE_STAGE_REG_CB, 0, address, (((uint32_t)MB_PARAM_HOLDING << 16) | n_regs));
     void *ctx = (void *)MB_SLAVE_GET_IFACE_FROM_BASE(inst);
     MB_RETURN_ON_FALSE(reg_buffer, MB_EINVAL, TAG, "Slave stack call failed.");
     mb_err_enum_t status = MB_ENOERR;
@@ -441,6 +443,7 @@ mb_err_enum_t mbc_reg_holding_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uin
 // Callback function for reading of MB Coils Registers
 mb_err_enum_t mbc_reg_coils_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uint16_t address, uint16_t n_coils, mb_reg_mode_enum_t mode)
 {
+    MB_STAGE_TRACE(inst->port_obj, MB_TRACE_STAGE_REG_CB, 0, address, (((uint32_t)MB_PARAM_COIL << 16) | n_coils));
     void *ctx =(void *)MB_SLAVE_GET_IFACE_FROM_BASE(inst);
     MB_RETURN_ON_FALSE(ctx, MB_EILLSTATE, TAG, "Slave stack uninitialized.");
     MB_RETURN_ON_FALSE(reg_buffer, MB_EINVAL, TAG, "Slave stack call failed.");
@@ -505,6 +508,7 @@ mb_err_enum_t mbc_reg_coils_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uint1
 // Callback function for reading of MB Discrete Input Registers
 mb_err_enum_t mbc_reg_discrete_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uint16_t address, uint16_t n_discrete)
 {
+    MB_STAGE_TRACE(inst->port_obj, MB_TRACE_STAGE_REG_CB, 0, address, (((uint32_t)MB_PARAM_DISCRETE << 16) | n_discrete));
     void *ctx = (void *)MB_SLAVE_GET_IFACE_FROM_BASE(inst);
     MB_RETURN_ON_FALSE(reg_buffer, MB_EINVAL, TAG, "Slave stack call failed.");
     mb_err_enum_t status = MB_ENOERR;
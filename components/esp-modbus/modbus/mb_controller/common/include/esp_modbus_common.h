@@ -266,6 +266,65 @@ esp_err_t mbc_delete_handler(void *ctx, uint8_t func_code);
 */
 esp_err_t mbc_get_handler_count(void *ctx, uint16_t *count);
 
+/**
+ * @brief The function reads the records of transaction stages from the trace ring of the controller object.
+ *        The records are removed from the ring, the oldest records are overwritten if the ring is not read in time.
+ *
+ * @param[in] ctx context pointer to the controller object (master or slave)
+ * @param[out] records the buffer to store the trace records
+ * @param[in,out] count the size of buffer in records on input, the number of read records on output
+ * @param[out] lost the number of records overwritten before they are read, can be NULL
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the records are returned
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the controller object is not correctly initialized
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the trace is disabled in the configuration (CONFIG_FMB_STAGE_TRACE_EN)
+*/
+esp_err_t mbc_get_trace(void *ctx, mb_trace_record_t *records, uint16_t *count, uint32_t *lost);
+
+/**
+ * @brief The function gets the snapshot of latency histograms and throughput counters of the controller object.
+ *
+ * @param[in] ctx context pointer to the controller object (master or slave)
+ * @param[out] stats the pointer to the statistics structure
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the statistics are returned
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the controller object is not correctly initialized
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the statistics are disabled in the configuration (CONFIG_FMB_STATS_EN)
+*/
+esp_err_t mbc_get_stats(void *ctx, mb_stats_t *stats);
+
+/**
+ * @brief The function formats the statistics in the Prometheus text exposition format.
+ *        The counters are exported as counter metrics, the latencies as summary metrics with quantiles.
+ *
+ * @param[in] stats the statistics returned by mbc_get_stats()
+ * @param[in] instance the value of the instance label of the metrics
+ * @param[out] buf the buffer for the text
+ * @param[in,out] size the size of buffer on input, the length of the text on output
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the text is formatted
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
+ *     - esp_err_t ESP_ERR_INVALID_SIZE - the buffer is too small for the text
+*/
+esp_err_t mbc_stats_to_prometheus(const mb_stats_t *stats, const char *instance, char *buf, size_t *size);
+
+/**
+ * @brief The function formats and prints the hot path messages stored in the deferred log ring.
+ *        The ring is shared by all controller objects and is expected to be flushed from one task only.
+ *
+ * @param[in] max_count the maximum number of messages to print, zero means all stored messages
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the messages are printed
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the deferred log is disabled in the configuration (CONFIG_FMB_TRACE_DEFERRED_EN)
+*/
+esp_err_t mbc_flush_trace_log(uint16_t max_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,7 +8,11 @@
 
 #include <stdint.h>                 // for standard int types definition
 #include <stddef.h>                 // for NULL and std defines
+#if __has_include("soc/soc.h")
 #include "soc/soc.h"                // for BITN definitions
+#else
+#include "esp_bit_defs.h"           // for BITN definitions (linux target)
+#endif
 #include "esp_modbus_common.h"      // for common types
 
 #ifdef __cplusplus
@@ -175,6 +179,56 @@ typedef struct {
     mb_param_perms_t    access;             /*!< Access permissions based on mode */
 } mb_parameter_descriptor_t;
 
+/*!
+ * \brief The maximum number of bytes in the element of parameter handled by conversion plan.
+ */
+#define MB_CONV_PERM_MAX        (8)
+
+/*!
+ * \brief The byte permutation index used to zero the destination byte.
+ */
+#define MB_CONV_PERM_ZERO       (0xFF)
+
+typedef struct mb_param_conv_plan_s mb_param_conv_plan_t;
+
+/*!
+ * \brief The conversion kernel used to transfer the parameter data according to its plan.
+ */
+typedef void (*mb_param_conv_fp)(const mb_param_conv_plan_t *plan, uint8_t *dest, const uint8_t *src);
+
+/**
+ * @brief The conversion plan of the characteristic.
+ * The plan is compiled once from the parameter type and size when the descriptor table is set
+ * and then applied to the whole array of elements in one kernel call.
+ */
+struct mb_param_conv_plan_s {
+    mb_param_conv_fp    convert;                    /*!< Conversion kernel, NULL if the type is not supported */
+    uint16_t            stride;                     /*!< Size of one element in bytes */
+    uint16_t            count;                      /*!< Number of elements in the parameter */
+    uint8_t             perm[MB_CONV_PERM_MAX];     /*!< Source byte index for each destination byte of element */
+};
+
+/**
+ * @brief Round trip time statistics of the slave measured by master
+ */
+typedef struct {
+    uint32_t srtt_us;           /*!< Smoothed round trip time of the slave in microseconds */
+    uint32_t rttvar_us;         /*!< Round trip time variance in microseconds */
+    uint32_t last_rtt_us;       /*!< Last measured round trip time in microseconds */
+    uint32_t rto_ms;            /*!< Respond timeout of the next request to the slave in milliseconds */
+    uint32_t samples;           /*!< Number of measured responses of the slave */
+    uint32_t timeouts;          /*!< Number of respond timeouts of the slave */
+} mb_slave_rtt_stats_t;
+
+/**
+ * @brief Health state of the slave tracked by master
+ */
+typedef enum {
+    MB_SLAVE_HEALTH_UP = 0,     /*!< The slave responds to requests */
+    MB_SLAVE_HEALTH_SUSPECT,    /*!< The slave did not respond to last requests but the fail threshold is not reached */
+    MB_SLAVE_HEALTH_DOWN        /*!< The slave is down, the requests fail immediately except the periodic probes */
+} mb_slave_health_state_t;
+
 /**
  * @brief Modbus register request type structure
  */
@@ -319,6 +373,56 @@ esp_err_t mbc_master_send_request(void *ctx, mb_param_request_t *request, void *
 */
 esp_err_t mbc_master_get_cid_info(void *ctx, uint16_t cid, const mb_parameter_descriptor_t** param_info);
 
+/**
+ * @brief Get information about supported characteristic defined by its name (param_key). Uses the index
+ *        of parameter description table built by mbc_master_set_descriptor() with precomputed hashes of names,
+ *        so the lookup does not depend on the size of table.
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] param_key the name of characteristic
+ * @param param_info pointer to pointer of characteristic data.
+ *
+ * @return
+ *     - esp_err_t ESP_OK - request was successful and param_info points to the characteristic description
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function or the table is not set
+ *     - esp_err_t ESP_ERR_NOT_FOUND - the characteristic with param_key is not found
+*/
+esp_err_t mbc_master_get_cid_info_by_key(void *ctx, const char *param_key, const mb_parameter_descriptor_t** param_info);
+
+/**
+ * @brief Get the round trip time statistics of the slave. The master calculates the respond timeout
+ *        of each request from the smoothed round trip time and its variance measured for the slave.
+ *        The timeout is limited by the response_tout_ms option of the master (see CONFIG_FMB_MASTER_ADAPTIVE_TIMEOUT_EN).
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] slave_addr the short address (UID) of the slave
+ * @param[out] stats pointer to the statistics structure to fill
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the statistics is returned in stats
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function or incorrect slave address
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the master interface is not initialized
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the round trip time is not measured (option is disabled)
+*/
+esp_err_t mbc_master_get_slave_rtt_stats(void *ctx, uint8_t slave_addr, mb_slave_rtt_stats_t *stats);
+
+/**
+ * @brief Get the health state of the slave. The requests to the slave in the down state
+ *        fail immediately with ESP_ERR_TIMEOUT until the next probe request is allowed
+ *        (see CONFIG_FMB_MASTER_SLAVE_HEALTH_EN).
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] slave_addr the short address (UID) of the slave
+ * @param[out] state pointer to the health state of the slave
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the state of the slave is returned
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function or incorrect slave address
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the master interface is not initialized
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the health of slaves is not tracked (option is disabled)
+*/
+esp_err_t mbc_master_get_slave_health(void *ctx, uint8_t slave_addr, mb_slave_health_state_t *state);
+
 /**
  * @brief Read parameter from modbus slave device whose name is defined by name and has cid.
  *        The additional data for request is taken from parameter description (lookup) table.
@@ -483,6 +587,34 @@ mb_err_enum_t mbc_reg_coils_master_cb(mb_base_t *inst, uint8_t *reg_buffer, uint
 */
 esp_err_t mbc_master_set_param_data(void* dest, void* src, mb_descr_type_t param_type, size_t param_size);
 
+/**
+ * @brief The helper function to compile the conversion plan of the parameter according to its type
+ *
+ * @param[out] plan the pointer to the conversion plan to be initialized
+ * @param[in] param_type type of parameter from data dictionary
+ * @param[in] param_size the storage size of the characteristic (in bytes).
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the plan is compiled
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the parameter type is not supported
+*/
+esp_err_t mbc_master_get_conv_plan(mb_param_conv_plan_t *plan, mb_descr_type_t param_type, size_t param_size);
+
+/**
+ * @brief The helper function to set data of parameter using its compiled conversion plan
+ *
+ * @param[in] plan the pointer to the compiled conversion plan of the parameter
+ * @param[in] dest the destination address of the parameter
+ * @param[in] src the source address of the parameter
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the data is converted
+ *     - esp_err_t ESP_ERR_INVALID_STATE - invalid data pointer
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the plan is not compiled for supported type
+*/
+esp_err_t mbc_master_apply_conv_plan(const mb_param_conv_plan_t *plan, void *dest, const void *src);
+
 
 /**
  * @brief The helper function to get supported modbus function code (command) according to parameter type
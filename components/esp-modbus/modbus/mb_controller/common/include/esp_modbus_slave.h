@@ -9,7 +9,11 @@
 // Public interface header for slave
 #include <stdint.h>                 // for standard int types definition
 #include <stddef.h>                 // for NULL and std defines
+#if __has_include("soc/soc.h")
 #include "soc/soc.h"                // for BITN definitions
+#else
+#include "esp_bit_defs.h"           // for BITN definitions (linux target)
+#endif
 #include "freertos/FreeRTOS.h"      // for task creation and queues access
 #include "freertos/event_groups.h"  // for event groups
 #include "esp_modbus_common.h"      // for common types
@@ -32,6 +32,35 @@ extern "C" {
 // will be dependent on response time set by timer + convertion time if the command is received
 #define MB_MAX_RESP_DELAY_MS (3000)
 
+// Get the compiled conversion plan of the parameter with index in the description table
+#define MB_MASTER_GET_CONV_PLAN(pctx, index) (&(MB_MASTER_GET_OPTS(pctx)->param_conv_plans[(index)]))
+
+// The value of empty slot in the parameter index tables (the slots keep the descriptor index + 1)
+#define MB_PARAM_INDEX_EMPTY (0)
+
+/**
+ * @brief Index of the parameter description table built on set_descriptor
+ *
+ * The open addressing hash tables map the cid and the hash of param_key to the index of
+ * the parameter in the description table. This allows sparse cids and O(1) lookup by name.
+ */
+typedef struct {
+    uint16_t *cid_slots;                                /*!< Table of descriptor indexes hashed by cid */
+    uint16_t *key_slots;                                /*!< Table of descriptor indexes hashed by param_key */
+    uint32_t *key_hashes;                               /*!< Precomputed hash of param_key for each descriptor */
+    uint32_t mask;                                      /*!< Mask of the slot tables (size - 1) */
+} mb_param_index_t;
+
+/**
+ * @brief Health of the slave tracked by master to fail fast the requests to the down slave
+ */
+typedef struct {
+    uint8_t state;                                      /*!< The health state of the slave (mb_slave_health_state_t) */
+    uint8_t fail_count;                                 /*!< Number of consecutive timeouts of the slave */
+    uint8_t backoff;                                    /*!< Number of failed probes, the probe interval is doubled on each */
+    uint32_t probe_time_ms;                             /*!< The time of next probe request to the down slave */
+} mb_slave_health_t;
+
 /**
  * @brief Modbus controller handler structure
  */
@@ -45,6 +74,9 @@ typedef struct {
     SemaphoreHandle_t mbm_sema;                         /*!< Modbus controller semaphore */
     const mb_parameter_descriptor_t *param_descriptor_table; /*!< Modbus controller parameter description table */
     size_t mbm_param_descriptor_size;                   /*!< Modbus controller parameter description table size */
+    mb_param_conv_plan_t *param_conv_plans;             /*!< Compiled conversion plans of the description table parameters */
+    mb_param_index_t param_index;                       /*!< Index of the description table by cid and param_key */
+    mb_slave_health_t *slave_health;                    /*!< Health table of slaves indexed by slave address (NULL if disabled) */
 } mb_master_options_t;
 
 typedef esp_err_t (*iface_get_cid_info_fp)(void *, uint16_t, const mb_parameter_descriptor_t **);           /*!< Interface get_cid_info method */
@@ -78,6 +110,123 @@ typedef struct {
     iface_set_parameter_with_fp set_parameter_with; /*!< Interface set_parameter_with method */
 } mbm_controller_iface_t;
 
+/**
+ * @brief Compile the conversion plans for each parameter of description table
+ *
+ * @param[out] plans the pointer to receive the allocated plans, released by caller with free()
+ * @param[in] descriptor pointer to parameter description table
+ * @param num_elements number of elements in the table
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the plans are compiled
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument in function call
+ *     - esp_err_t ESP_ERR_NO_MEM - the plans allocation failure
+ */
+esp_err_t mbc_master_compile_conv_plans(mb_param_conv_plan_t **plans, const mb_parameter_descriptor_t *descriptor,
+                                        uint16_t num_elements);
+
+/**
+ * @brief Build the index of description table by cid and param_key
+ *
+ * @param[out] index the index to build, released by caller with mbc_master_free_param_index()
+ * @param[in] descriptor pointer to parameter description table
+ * @param num_elements number of elements in the table
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the index is built
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument or the cid is duplicated in the table
+ *     - esp_err_t ESP_ERR_NO_MEM - the index allocation failure
+ */
+esp_err_t mbc_master_build_param_index(mb_param_index_t *index, const mb_parameter_descriptor_t *descriptor,
+                                        uint16_t num_elements);
+
+/**
+ * @brief Free the index of description table
+ *
+ * @param[in] index the index to free
+ */
+void mbc_master_free_param_index(mb_param_index_t *index);
+
+/**
+ * @brief Set the description table with its index and conversion plans
+ *
+ * The index and plans are built first and the options are updated only when both succeed,
+ * so the previous table stays in use on failure.
+ *
+ * @param[in] opts the master options to keep the table
+ * @param[in] descriptor pointer to parameter description table
+ * @param num_elements number of elements in the table
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the table is set
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument or the cid is duplicated in the table
+ *     - esp_err_t ESP_ERR_NO_MEM - the allocation failure
+ */
+esp_err_t mbc_master_set_param_table(mb_master_options_t *opts, const mb_parameter_descriptor_t *descriptor,
+                                        uint16_t num_elements);
+
+/**
+ * @brief Find the index of characteristic in the description table by its cid
+ *
+ * @param[in] opts the master options keeping the description table and its index
+ * @param cid the characteristic id
+ *
+ * @return
+ *     - the index of the characteristic in the description table or -1 if not found
+ */
+int mbc_master_find_cid_index(const mb_master_options_t *opts, uint16_t cid);
+
+/**
+ * @brief Find the index of characteristic in the description table by its param_key
+ *
+ * @param[in] opts the master options keeping the description table and its index
+ * @param[in] param_key the name of characteristic
+ *
+ * @return
+ *     - the index of the characteristic in the description table or -1 if not found
+ */
+int mbc_master_find_key_index(const mb_master_options_t *opts, const char *param_key);
+
+/**
+ * @brief Allocate the health table of slaves if the health tracking is enabled
+ *
+ * @param[in] opts the master options to keep the table
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the table is allocated or the health tracking is disabled
+ *     - esp_err_t ESP_ERR_NO_MEM - the table allocation failure
+ */
+esp_err_t mbc_master_slave_health_create(mb_master_options_t *opts);
+
+/**
+ * @brief Free the health table of slaves
+ *
+ * @param[in] opts the master options keeping the table
+ */
+void mbc_master_slave_health_delete(mb_master_options_t *opts);
+
+/**
+ * @brief Check if the request can be sent to the slave
+ *
+ * The down slave is available only when its probe time is expired.
+ *
+ * @param[in] opts the master options keeping the health table
+ * @param slave_addr the address of the slave
+ *
+ * @return
+ *     - true if the request to the slave can be sent, false if it should fail immediately
+ */
+bool mbc_master_slave_is_available(mb_master_options_t *opts, uint8_t slave_addr);
+
+/**
+ * @brief Update the health of the slave with the result of request
+ *
+ * @param[in] opts the master options keeping the health table
+ * @param slave_addr the address of the slave
+ * @param mb_error the result of the request to the slave
+ */
+void mbc_master_slave_update_health(mb_master_options_t *opts, uint8_t slave_addr, mb_err_enum_t mb_error);
+
 #ifdef __cplusplus
 }
 #endif
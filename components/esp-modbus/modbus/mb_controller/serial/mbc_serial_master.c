@@ -121,6 +121,10 @@ static esp_err_t mbc_serial_master_delete(void *ctx)
     mbm_opts->event_group_handle = NULL;
     vSemaphoreDelete(mbm_opts->mbm_sema);
     mbm_opts->mbm_sema = NULL;
+    free(mbm_opts->param_conv_plans);
+    mbm_opts->param_conv_plans = NULL;
+    mbc_master_free_param_index(&mbm_opts->param_index);
+    mbc_master_slave_health_delete(mbm_opts);
     // delete mb_base instance and all its allocations
     mb_error = mbm_iface->mb_base->delete(mbm_iface->mb_base);
     MB_RETURN_ON_FALSE((mb_error == MB_ENOERR), ESP_ERR_INVALID_STATE, TAG,
@@ -141,16 +145,12 @@ static esp_err_t mbc_serial_master_set_descriptor(void *ctx, const mb_parameter_
     for (uint16_t counter = 0; counter < (num_elements); counter++, reg_ptr++)
     {
         // Below is the code to check consistency of the table format and required fields.
-        MB_RETURN_ON_FALSE((reg_ptr->cid == counter),
-                           ESP_ERR_INVALID_ARG, TAG, "mb descriptor cid field is incorrect.");
         MB_RETURN_ON_FALSE((reg_ptr->param_key),
                            ESP_ERR_INVALID_ARG, TAG, "mb descriptor param key is incorrect.");
         MB_RETURN_ON_FALSE((reg_ptr->mb_size > 0),
                            ESP_ERR_INVALID_ARG, TAG, "mb descriptor param size is incorrect.");
     }
-    mbm_opts->param_descriptor_table = descriptor;
-    mbm_opts->mbm_param_descriptor_size = num_elements;
-    return ESP_OK;
+    return mbc_master_set_param_table(mbm_opts, descriptor, num_elements);
 }
 
 // Send custom Modbus request defined as mb_param_request_t structure
@@ -173,6 +173,13 @@ static esp_err_t mbc_serial_master_send_request(void *ctx, mb_param_request_t *r
         mbm_opts->reg_buffer_ptr = (uint8_t *)data_ptr;
         mbm_opts->reg_buffer_size = mb_size;
 
+        // Fail fast the request to the down slave until its probe time is expired
+        if (!mbc_master_slave_is_available(mbm_opts, mb_slave_addr)) {
+            (void)xSemaphoreGive(mbm_opts->mbm_sema);
+            ESP_LOGD(TAG, "%s: slave #%u is down, skip request.", __func__, (unsigned)mb_slave_addr);
+            return ESP_ERR_TIMEOUT;
+        }
+
         // Calls appropriate request function to send request and waits response
         switch (mb_command)
         {
@@ -262,6 +269,7 @@ static esp_err_t mbc_serial_master_send_request(void *ctx, mb_param_request_t *r
             }
             break;
         }
+        mbc_master_slave_update_health(mbm_opts, mb_slave_addr, mb_error);
     } else {
         ESP_LOGD(TAG, "%s:MBC semaphore take fail.", __func__);
     }
@@ -279,11 +287,11 @@ static esp_err_t mbc_serial_master_get_cid_info(void *ctx, uint16_t cid, const m
                        ESP_ERR_INVALID_ARG, TAG, "mb incorrect data buffer pointer.");
     MB_RETURN_ON_FALSE((mbm_opts->param_descriptor_table),
                        ESP_ERR_INVALID_ARG, TAG, "mb incorrect descriptor table or not set.");
-    MB_RETURN_ON_FALSE((cid < mbm_opts->mbm_param_descriptor_size),
+    int index = mbc_master_find_cid_index(mbm_opts, cid);
+    MB_RETURN_ON_FALSE((index >= 0),
                        ESP_ERR_NOT_FOUND, TAG, "mb incorrect cid of characteristic.");
 
-    // It is assumed that characteristics cid increased in the table
-    const mb_parameter_descriptor_t *reg_info = &mbm_opts->param_descriptor_table[cid];
+    const mb_parameter_descriptor_t *reg_info = &mbm_opts->param_descriptor_table[index];
 
     MB_RETURN_ON_FALSE((reg_info->param_key),
                        ESP_ERR_INVALID_ARG, TAG, "mb incorrect characteristic key.");
@@ -295,16 +303,16 @@ static esp_err_t mbc_serial_master_get_cid_info(void *ctx, uint16_t cid, const m
 // and fills Modbus request fields accordingly
 static esp_err_t mbc_serial_master_set_request(void *ctx, uint16_t cid, mb_param_mode_t mode,
                                                mb_param_request_t *request,
-                                               mb_parameter_descriptor_t *reg_data)
+                                               mb_parameter_descriptor_t *reg_data, int *index)
 {
     mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
     esp_err_t error = ESP_ERR_NOT_FOUND;
     MB_RETURN_ON_FALSE((request), ESP_ERR_INVALID_ARG, TAG, "mb incorrect request parameter.");
     MB_RETURN_ON_FALSE((mode <= MB_PARAM_WRITE), ESP_ERR_INVALID_ARG, TAG, "mb incorrect mode.");
-    MB_RETURN_ON_FALSE((cid < mbm_opts->mbm_param_descriptor_size), ESP_ERR_INVALID_ARG, TAG, "mb incorrect cid parameter.");
     MB_RETURN_ON_FALSE((mbm_opts->param_descriptor_table), ESP_ERR_INVALID_ARG, TAG, "mb data dictionary is incorrect.");
-    const mb_parameter_descriptor_t *reg_ptr = mbm_opts->param_descriptor_table;
-    reg_ptr += cid;
+    int reg_index = mbc_master_find_cid_index(mbm_opts, cid);
+    MB_RETURN_ON_FALSE((reg_index >= 0), ESP_ERR_INVALID_ARG, TAG, "mb incorrect cid parameter.");
+    const mb_parameter_descriptor_t *reg_ptr = &mbm_opts->param_descriptor_table[reg_index];
     if (reg_ptr->cid == cid)
     {
         request->slave_addr = reg_ptr->mb_slave_addr;
@@ -316,6 +324,9 @@ static esp_err_t mbc_serial_master_set_request(void *ctx, uint16_t cid, mb_param
         {
             *reg_data = *reg_ptr; // Set the cid registered parameter data
         }
+        if (index) {
+            *index = reg_index; // The index of parameter in the table
+        }
         error = ESP_OK;
     }
     return error;
@@ -329,9 +340,10 @@ static esp_err_t mbc_serial_master_get_parameter(void *ctx, uint16_t cid, uint8_
     esp_err_t error = ESP_ERR_INVALID_RESPONSE;
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
+    int index = -1;
     uint8_t *data_ptr = NULL;
 
-    error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info);
+    error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info, &index);
     if ((error == ESP_OK) && (cid == reg_info.cid) && (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)) {
         MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
         // alloc buffer to store parameter data
@@ -343,8 +355,8 @@ static esp_err_t mbc_serial_master_get_parameter(void *ctx, uint16_t cid, uint8_
         if (error == ESP_OK) {
             // If data pointer is NULL then we don't need to set value (it is still in the cache of cid)
             if (value) {
-                error = mbc_master_set_param_data((void *)value, (void *)data_ptr,
-                                                    reg_info.param_type, reg_info.param_size);
+                error = mbc_master_apply_conv_plan(MB_MASTER_GET_CONV_PLAN(ctx, index),
+                                                    (void *)value, (void *)data_ptr);
                 if (error != ESP_OK) {
                     ESP_LOGE(TAG, "fail to set parameter data.");
                     error = ESP_ERR_INVALID_STATE;
@@ -376,9 +388,10 @@ static esp_err_t mbc_serial_master_get_parameter_with(void *ctx, uint16_t cid, u
     esp_err_t error = ESP_ERR_INVALID_RESPONSE;
     mb_param_request_t request;
     mb_parameter_descriptor_t reg_info = {0};
+    int index = -1;
     uint8_t *data_ptr = NULL;
 
-    error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info);
+    error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info, &index);
     if ((error == ESP_OK) && (cid == reg_info.cid))
     {
         if (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)
@@ -399,8 +412,8 @@ static esp_err_t mbc_serial_master_get_parameter_with(void *ctx, uint16_t cid, u
         {
             // If data pointer is NULL then we don't need to set value (it is still in the cache of cid)
             if (value_ptr) {
-                error = mbc_master_set_param_data((void *)value_ptr, (void *)data_ptr,
-                                                    reg_info.param_type, reg_info.param_size);
+                error = mbc_master_apply_conv_plan(MB_MASTER_GET_CONV_PLAN(ctx, index),
+                                                    (void *)value_ptr, (void *)data_ptr);
                 if (error != ESP_OK) {
                     ESP_LOGE(TAG, "fail to set parameter data.");
                     error = ESP_ERR_INVALID_STATE;
@@ -436,9 +449,10 @@ static esp_err_t mbc_serial_master_set_parameter(void *ctx, uint16_t cid, uint8_
     esp_err_t error = ESP_ERR_INVALID_RESPONSE;
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
+    int index = -1;
     uint8_t *data_ptr = NULL;
 
-    error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info);
+    error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info, &index);
     if ((error == ESP_OK) && (cid == reg_info.cid) && (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)) {
         MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
         data_ptr = calloc(1, (reg_info.mb_size << 1)); // alloc parameter buffer
@@ -446,8 +460,8 @@ static esp_err_t mbc_serial_master_set_parameter(void *ctx, uint16_t cid, uint8_
             return ESP_ERR_INVALID_STATE;
         }
         // Transfer value of characteristic into parameter buffer
-        error = mbc_master_set_param_data((void *)data_ptr, (void *)value,
-                                              reg_info.param_type, reg_info.param_size);
+        error = mbc_master_apply_conv_plan(MB_MASTER_GET_CONV_PLAN(ctx, index),
+                                                    (void *)data_ptr, (void *)value);
         if (error != ESP_OK) {
             ESP_LOGE(TAG, "fail to set parameter data.");
             free(data_ptr);
@@ -482,8 +496,9 @@ static esp_err_t mbc_serial_master_set_parameter_with(void *ctx, uint16_t cid, u
     esp_err_t error = ESP_ERR_INVALID_RESPONSE;
     mb_param_request_t request;
     mb_parameter_descriptor_t reg_info = {0};
+    int index = -1;
     uint8_t *data_ptr = NULL;
-    error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info);
+    error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info, &index);
     if ((error == ESP_OK) && (cid == reg_info.cid))
     {
         if (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)
@@ -498,8 +513,8 @@ static esp_err_t mbc_serial_master_set_parameter_with(void *ctx, uint16_t cid, u
             return ESP_ERR_INVALID_STATE;
         }
         // Transfer value of characteristic into parameter buffer
-        error = mbc_master_set_param_data((void *)data_ptr, (void *)value_ptr,
-                                              reg_info.param_type, reg_info.param_size);
+        error = mbc_master_apply_conv_plan(MB_MASTER_GET_CONV_PLAN(ctx, index),
+                                                    (void *)data_ptr, (void *)value_ptr);
         if (error != ESP_OK) {
             ESP_LOGE(TAG, "fail to set parameter data.");
             free(data_ptr);
@@ -545,6 +560,7 @@ static void mbc_serial_master_iface_free(void *ctx)
             vEventGroupDelete(mbm_iface->opts.event_group_handle);
             mbm_iface->opts.event_group_handle = NULL;
         }
+        mbc_master_slave_health_delete(&mbm_iface->opts);
         free(mbm_iface); // free the memory allocated for interface
     }   
 }
@@ -565,6 +581,9 @@ static esp_err_t mbc_serial_master_controller_create(void **ctx)
     // Initialize interface properties
     mb_master_options_t *mbm_opts = &mbm_controller_iface->opts;
     mbm_opts->task_handle = NULL;
+    mbm_opts->param_conv_plans = NULL;
+    memset(&mbm_opts->param_index, 0, sizeof(mb_param_index_t));
+    mbm_opts->slave_health = NULL;
 
     // Initialization of active context of the modbus controller
     mbm_opts->event_group_handle = xEventGroupCreate();
@@ -572,6 +591,8 @@ static esp_err_t mbc_serial_master_controller_create(void **ctx)
     mbm_opts->mbm_sema = xSemaphoreCreateBinary();
     MB_GOTO_ON_FALSE((mbm_opts->mbm_sema != NULL), ESP_ERR_NO_MEM, error, TAG, "%s: mbm resource create error.", __func__);
     (void)xSemaphoreGive(mbm_opts->mbm_sema);
+    ret = mbc_master_slave_health_create(mbm_opts);
+    MB_GOTO_ON_FALSE((ret == ESP_OK), ESP_ERR_NO_MEM, error, TAG, "%s: mb slave health create error.", __func__);
 
     // Create modbus controller task
     status = xTaskCreatePinnedToCore((void *)&mbc_ser_master_task,
@@ -10,7 +10,11 @@
 
 #include <stdint.h>                 // for standard int types definition
 #include <stddef.h>                 // for NULL and std defines
+#if __has_include("soc/soc.h")
 #include "soc/soc.h"                // for BITN definitions
+#else
+#include "esp_bit_defs.h"           // for BITN definitions (linux target)
+#endif
 #include "esp_err.h"                // for esp_err_t
 #include "esp_modbus_common.h"      // for common defines
 #include "sdkconfig.h"
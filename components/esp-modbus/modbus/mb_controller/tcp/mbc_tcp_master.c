@@ -138,7 +138,6 @@ static esp_err_t mbc_tcp_master_set_descriptor(void *ctx, const mb_parameter_des
     // Go through all items in the table to check all Modbus registers
     for (int idx = 0; idx < (num_elements); idx++, reg_ptr++) {
         // Check consistency of the table format and required fields.
-        MB_RETURN_ON_FALSE((reg_ptr->cid == idx), ESP_ERR_INVALID_ARG, TAG, "mb descriptor cid field is incorrect.");
         MB_RETURN_ON_FALSE((reg_ptr->param_key), ESP_ERR_INVALID_ARG, TAG, "mb descriptor param key is incorrect.");
         MB_RETURN_ON_FALSE((reg_ptr->mb_size > 0), ESP_ERR_INVALID_ARG, TAG, "mb descriptor param size is incorrect.");
         
@@ -152,9 +151,7 @@ static esp_err_t mbc_tcp_master_set_descriptor(void *ctx, const mb_parameter_des
                             "mb missing IP address configuration for cid #%u, uid=%d.", (unsigned)reg_ptr->cid, (int)reg_ptr->mb_slave_addr);
         ESP_LOGI(TAG, "mb found config for cid #%d, uid=%d.", (int)reg_ptr->cid, (int)reg_ptr->mb_slave_addr);
     }
-    mbm_opts->param_descriptor_table = descriptor;
-    mbm_opts->mbm_param_descriptor_size = num_elements;
-    return ESP_OK;
+    return mbc_master_set_param_table(mbm_opts, descriptor, num_elements);
 }
 
 // Send custom Modbus request defined as mb_param_request_t structure
@@ -177,6 +174,13 @@ static esp_err_t mbc_tcp_master_send_request(void *ctx, mb_param_request_t *requ
         mbm_opts->reg_buffer_ptr = (uint8_t *)data_ptr;
         mbm_opts->reg_buffer_size = mb_size;
 
+        // Fail fast the request to the down slave until its probe time is expired
+        if (!mbc_master_slave_is_available(mbm_opts, mb_slave_addr)) {
+            (void)xSemaphoreGive(mbm_opts->mbm_sema);
+            ESP_LOGD(TAG, "%s: slave #%u is down, skip request.", __func__, (unsigned)mb_slave_addr);
+            return ESP_ERR_TIMEOUT;
+        }
+
         // Calls appropriate request function to send request and waits response
         switch(mb_command) {
 #if MB_FUNC_READ_COILS_ENABLED
@@ -260,6 +264,7 @@ static esp_err_t mbc_tcp_master_send_request(void *ctx, mb_param_request_t *requ
                 }
                 break;
         }
+        mbc_master_slave_update_health(mbm_opts, mb_slave_addr, mb_error);
     } else {
         ESP_LOGD(TAG, "%s:MBC semaphore take fail.", __func__);
     }
@@ -277,11 +282,11 @@ static esp_err_t mbc_tcp_master_get_cid_info(void *ctx, uint16_t cid, const mb_p
                         ESP_ERR_INVALID_ARG, TAG, "mb incorrect data buffer pointer.");
     MB_RETURN_ON_FALSE((mbm_opts->param_descriptor_table),
                         ESP_ERR_INVALID_ARG, TAG, "mb incorrect descriptor table or not set.");
-    MB_RETURN_ON_FALSE((cid < mbm_opts->mbm_param_descriptor_size),
-                        ESP_ERR_NOT_FOUND, TAG, "mb incorrect cid of characteristic.");
+    int index = mbc_master_find_cid_index(mbm_opts, cid);
+    MB_RETURN_ON_FALSE((index >= 0),
+                       ESP_ERR_NOT_FOUND, TAG, "mb incorrect cid of characteristic.");
 
-    // It is assumed that characteristics cid increased in the table
-    const mb_parameter_descriptor_t *reg_info = &mbm_opts->param_descriptor_table[cid];
+    const mb_parameter_descriptor_t *reg_info = &mbm_opts->param_descriptor_table[index];
 
     MB_RETURN_ON_FALSE((reg_info->param_key),
                         ESP_ERR_INVALID_ARG, TAG, "mb incorrect characteristic key.");
@@ -291,16 +296,16 @@ static esp_err_t mbc_tcp_master_get_cid_info(void *ctx, uint16_t cid, const mb_p
 
 // Helper to search parameter in the parameter description table and fills Modbus request fields accordingly
 static esp_err_t mbc_tcp_master_set_request(void *ctx, uint16_t cid, mb_param_mode_t mode, mb_param_request_t *request,
-                                                mb_parameter_descriptor_t *reg_data)
+                                                mb_parameter_descriptor_t *reg_data, int *index)
 {
     mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
     esp_err_t error = ESP_ERR_NOT_FOUND;
     MB_RETURN_ON_FALSE((request), ESP_ERR_INVALID_ARG, TAG, "mb incorrect request parameter.");
     MB_RETURN_ON_FALSE((mode <= MB_PARAM_WRITE), ESP_ERR_INVALID_ARG, TAG, "mb incorrect mode.");
-    MB_RETURN_ON_FALSE((cid < mbm_opts->mbm_param_descriptor_size), ESP_ERR_INVALID_ARG, TAG, "mb incorrect cid parameter.");
     MB_RETURN_ON_FALSE((mbm_opts->param_descriptor_table), ESP_ERR_INVALID_ARG, TAG, "mb data dictionary is incorrect.");
-    const mb_parameter_descriptor_t *reg_ptr = mbm_opts->param_descriptor_table;
-    reg_ptr += cid;
+    int reg_index = mbc_master_find_cid_index(mbm_opts, cid);
+    MB_RETURN_ON_FALSE((reg_index >= 0), ESP_ERR_INVALID_ARG, TAG, "mb incorrect cid parameter.");
+    const mb_parameter_descriptor_t *reg_ptr = &mbm_opts->param_descriptor_table[reg_index];
     if (reg_ptr->cid == cid) {
         request->slave_addr = reg_ptr->mb_slave_addr;
         request->reg_start = reg_ptr->mb_reg_start;
@@ -310,6 +315,9 @@ static esp_err_t mbc_tcp_master_set_request(void *ctx, uint16_t cid, mb_param_mo
         if (reg_data) {
             *reg_data = *reg_ptr; // Set the cid registered parameter data
         }
+        if (index) {
+            *index = reg_index; // The index of parameter in the table
+        }
         error = ESP_OK;
     }
     return error;
@@ -324,9 +332,10 @@ static esp_err_t mbc_tcp_master_get_parameter(void *ctx, uint16_t cid, uint8_t *
     esp_err_t error = ESP_ERR_INVALID_RESPONSE;
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
+    int index = -1;
     uint8_t *data_ptr = NULL;
 
-    error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info);
+    error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info, &index);
     if ((error == ESP_OK) && (cid == reg_info.cid) && (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)) {
         mb_uid_info_t *addr_info = mbm_port_tcp_get_slave_info(mbm_controller_iface->mb_base->port_obj,
                                                                         request.slave_addr, MB_SOCK_STATE_CONNECTED);
@@ -344,8 +353,8 @@ static esp_err_t mbc_tcp_master_get_parameter(void *ctx, uint16_t cid, uint8_t *
         if (error == ESP_OK) {
             // If data pointer is NULL then we don't need to set value (it is still in the cache of cid)
             if (value) {
-                error = mbc_master_set_param_data((void *)value, (void *)data_ptr,
-                                                    reg_info.param_type, reg_info.param_size);
+                error = mbc_master_apply_conv_plan(MB_MASTER_GET_CONV_PLAN(ctx, index),
+                                                    (void *)value, (void *)data_ptr);
                 if (error != ESP_OK) {
                     ESP_LOGE(TAG, "fail to set parameter data.");
                     error = ESP_ERR_INVALID_STATE;
@@ -378,9 +387,10 @@ static esp_err_t mbc_tcp_master_get_parameter_with(void *ctx, uint16_t cid, uint
     esp_err_t error = ESP_ERR_INVALID_RESPONSE;
     mb_param_request_t request;
     mb_parameter_descriptor_t reg_info = { 0 };
+    int index = -1;
     uint8_t *data_ptr = NULL;
 
-    error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info);
+    error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info, &index);
     if ((error == ESP_OK) && (cid == reg_info.cid)) {
         // check that the requested uid is connected (call to port iface)
         mb_uid_info_t *addr_info = mbm_port_tcp_get_slave_info(mbm_controller_iface->mb_base->port_obj, 
@@ -404,8 +414,8 @@ static esp_err_t mbc_tcp_master_get_parameter_with(void *ctx, uint16_t cid, uint
         if (error == ESP_OK) {
             // If data pointer is NULL then we don't need to set value (it is still in the cache of cid)
             if (value) {
-                error = mbc_master_set_param_data((void *)value, (void *)data_ptr,
-                                                    reg_info.param_type, reg_info.param_size);
+                error = mbc_master_apply_conv_plan(MB_MASTER_GET_CONV_PLAN(ctx, index),
+                                                    (void *)value, (void *)data_ptr);
                 if (error != ESP_OK) {
                     ESP_LOGE(TAG, "fail to set parameter data.");
                     error = ESP_ERR_INVALID_STATE;
@@ -438,9 +448,10 @@ static esp_err_t mbc_tcp_master_set_parameter(void *ctx, uint16_t cid, uint8_t *
     esp_err_t error = ESP_ERR_INVALID_RESPONSE;
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
+    int index = -1;
     uint8_t *data_ptr = NULL;
 
-    error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info);
+    error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info, &index);
     if ((error == ESP_OK) && (cid == reg_info.cid) && (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)) {
         mb_uid_info_t *addr_info = mbm_port_tcp_get_slave_info(mbm_controller_iface->mb_base->port_obj,
                                                                         request.slave_addr, MB_SOCK_STATE_CONNECTED);
@@ -454,8 +465,8 @@ static esp_err_t mbc_tcp_master_set_parameter(void *ctx, uint16_t cid, uint8_t *
             return ESP_ERR_INVALID_STATE;
         }
         // Transfer value of characteristic into parameter buffer
-        error = mbc_master_set_param_data((void *)data_ptr, (void *)value,
-                                              reg_info.param_type, reg_info.param_size);
+        error = mbc_master_apply_conv_plan(MB_MASTER_GET_CONV_PLAN(ctx, index),
+                                                    (void *)data_ptr, (void *)value);
         if (error != ESP_OK) {
             ESP_LOGE(TAG, "fail to set parameter data.");
             free(data_ptr);
@@ -490,9 +501,10 @@ static esp_err_t mbc_tcp_master_set_parameter_with(void *ctx, uint16_t cid, uint
     esp_err_t error = ESP_ERR_INVALID_RESPONSE;
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
+    int index = -1;
     uint8_t *data_ptr = NULL;
 
-    error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info);
+    error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info, &index);
     if ((error == ESP_OK) && (cid == reg_info.cid)) {
         // check that the requested uid is connected (call to port iface)
         mb_uid_info_t *addr_info = mbm_port_tcp_get_slave_info(mbm_controller_iface->mb_base->port_obj, 
@@ -513,8 +525,8 @@ static esp_err_t mbc_tcp_master_set_parameter_with(void *ctx, uint16_t cid, uint
             return ESP_ERR_INVALID_STATE;
         }
         // Transfer value of characteristic into parameter buffer
-        error = mbc_master_set_param_data((void *)data_ptr, (void *)value,
-                                              reg_info.param_type, reg_info.param_size);
+        error = mbc_master_apply_conv_plan(MB_MASTER_GET_CONV_PLAN(ctx, index),
+                                                    (void *)data_ptr, (void *)value);
         if (error != ESP_OK) {
             ESP_LOGE(TAG, "fail to set parameter data.");
             free(data_ptr);
@@ -565,6 +577,10 @@ static esp_err_t mbc_tcp_master_delete(void *ctx)
     mbm_opts->event_group_handle = NULL;
     vSemaphoreDelete(mbm_opts->mbm_sema);
     mbm_opts->mbm_sema = NULL;
+    free(mbm_opts->param_conv_plans);
+    mbm_opts->param_conv_plans = NULL;
+    mbc_master_free_param_index(&mbm_opts->param_index);
+    mbc_master_slave_health_delete(mbm_opts);
     mb_error = mbm_iface->mb_base->delete(mbm_iface->mb_base);
     MB_RETURN_ON_FALSE((mb_error == MB_ENOERR), ESP_ERR_INVALID_STATE, TAG,
                         "mb stack delete failure, returned (0x%x).", (unsigned)mb_error);
@@ -587,6 +603,9 @@ esp_err_t mbc_tcp_master_controller_create(void ** ctx)
     // Initialize interface properties
     mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(mbm_controller_iface);
     mbm_opts->task_handle = NULL;
+    mbm_opts->param_conv_plans = NULL;
+    memset(&mbm_opts->param_index, 0, sizeof(mb_param_index_t));
+    mbm_opts->slave_health = NULL;
 
     // Initialization of active context of the modbus controller
     BaseType_t status = 0;
@@ -596,6 +615,8 @@ esp_err_t mbc_tcp_master_controller_create(void ** ctx)
     mbm_opts->mbm_sema = xSemaphoreCreateBinary();
     MB_GOTO_ON_FALSE((mbm_opts->mbm_sema != NULL), ESP_ERR_NO_MEM, error, TAG, "%s: mbm resource create error.", __func__);
     (void)xSemaphoreGive(mbm_opts->mbm_sema);
+    ret = mbc_master_slave_health_create(mbm_opts);
+    MB_GOTO_ON_FALSE((ret == ESP_OK), ESP_ERR_NO_MEM, error, TAG, "%s: mb slave health create error.", __func__);
 
     // Create modbus controller task
     status = xTaskCreatePinnedToCore((void *)&modbus_tcp_master_task,
@@ -635,6 +656,7 @@ error:
             vEventGroupDelete(mbm_controller_iface->opts.event_group_handle);
             mbm_controller_iface->opts.event_group_handle = NULL;
         }
+        mbc_master_slave_health_delete(&mbm_controller_iface->opts);
     }
     free(mbm_controller_iface); // free the memory allocated
     ctx = NULL;
@@ -652,7 +674,7 @@ esp_err_t mbc_tcp_master_create(mb_communication_info_t *config, void **ctx)
     // Check communication options
     mb_tcp_opts_t tcp_opts = (mb_tcp_opts_t)config->tcp_opts;
     MB_RETURN_ON_FALSE((tcp_opts.ip_addr_table), ESP_ERR_INVALID_ARG, TAG, "mb ip table address is incorrect.");
-    MB_RETURN_ON_FALSE((tcp_opts.mode == MB_TCP),
+    MB_RETURN_ON_FALSE(((tcp_opts.mode == MB_TCP) || (tcp_opts.mode == MB_UDP)),
                         ESP_ERR_INVALID_ARG, TAG, "mb transport protocol is incorrect.");
     MB_RETURN_ON_FALSE(((tcp_opts.addr_type == MB_IPV6) || (tcp_opts.addr_type == MB_IPV4)),
                         ESP_ERR_INVALID_ARG, TAG, "mb ip address type is incorrect.");
@@ -667,7 +689,6 @@ esp_err_t mbc_tcp_master_create(mb_communication_info_t *config, void **ctx)
     mbm_opts->comm_opts = *config;
 
     mbm_opts->port_type = MB_PORT_TCP_MASTER;
-    tcp_opts.mode = MB_TCP; // Override mode, UDP mode is not supported
     mbm_opts->comm_opts.tcp_opts = tcp_opts;
 
     // Keep the response time setting
@@ -679,7 +700,7 @@ esp_err_t mbc_tcp_master_create(mb_communication_info_t *config, void **ctx)
     void *inst = (void *)mbm_controller_iface; // set as descr.parent object
 
     // Initialize Modbus stack using mbcontroller parameters
-    if (tcp_opts.mode == MB_TCP) {
+    if ((tcp_opts.mode == MB_TCP) || (tcp_opts.mode == MB_UDP)) {
         err = mbm_tcp_create(&tcp_opts, &inst);
     }
     MB_GOTO_ON_FALSE((err == MB_ENOERR), ESP_ERR_INVALID_STATE, error, TAG, 
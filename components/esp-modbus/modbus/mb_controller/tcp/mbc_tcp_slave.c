@@ -232,7 +232,6 @@ esp_err_t mbc_tcp_slave_create(mb_communication_info_t *config, void **ctx)
     mbs_opts->comm_opts = *config;
 
     mbs_opts->port_type = MB_PORT_TCP_SLAVE;
-    tcp_opts.mode = MB_TCP; // Override mode, UDP mode is not supported
     // Keep the response time setting
     if (!tcp_opts.response_tout_ms) {
         tcp_opts.response_tout_ms = CONFIG_FMB_MASTER_TIMEOUT_MS_RESPOND;
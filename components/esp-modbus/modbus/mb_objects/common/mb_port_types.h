@@ -37,7 +37,41 @@ typedef enum mb_comm_mode_enum mb_mode_type_t;
 
 #if (CONFIG_FMB_COMM_MODE_ASCII_EN || CONFIG_FMB_COMM_MODE_RTU_EN)
 
+#if CONFIG_IDF_TARGET_LINUX
+
+// The serial port is emulated over the pseudo terminal on the linux target,
+// the options keep the types and values of the UART driver to be source compatible
+typedef int uart_port_t;
+
+#define UART_NUM_0      (0)
+#define UART_NUM_1      (1)
+#define UART_NUM_2      (2)
+#define UART_NUM_MAX    (8)
+
+typedef enum {
+    UART_DATA_5_BITS = 0x0,
+    UART_DATA_6_BITS = 0x1,
+    UART_DATA_7_BITS = 0x2,
+    UART_DATA_8_BITS = 0x3,
+    UART_DATA_BITS_MAX = 0x4,
+} uart_word_length_t;
+
+typedef enum {
+    UART_STOP_BITS_1 = 0x1,
+    UART_STOP_BITS_1_5 = 0x2,
+    UART_STOP_BITS_2 = 0x3,
+    UART_STOP_BITS_MAX = 0x4,
+} uart_stop_bits_t;
+
+typedef enum {
+    UART_PARITY_DISABLE = 0x0,
+    UART_PARITY_EVEN = 0x2,
+    UART_PARITY_ODD = 0x3
+} uart_parity_t;
+
+#else
 #include "driver/uart.h"
+#endif
 
 struct port_serial_opts_s {
     mb_mode_type_t mode;            /*!< Modbus communication mode */
@@ -80,6 +114,7 @@ struct port_tcp_opts_s {
     void *ip_netif_ptr;             /*!< Modbus network interface */
     char *dns_name;                 /*!< Modbus node DNS name */
     bool start_disconnected;        /*!< (Master only option) do not wait for connection to all nodes before polling */
+    bool rtu_framing;               /*!< Encapsulate raw RTU frames (address, PDU and CRC) instead of MBAP frames */
 } __attribute__((__packed__));
 
 typedef struct port_tcp_opts_s mb_tcp_opts_t;
@@ -93,6 +93,7 @@ typedef enum mb_exception_enum
     MB_EX_SLAVE_DEVICE_FAILURE = 0x04,
     MB_EX_ACKNOWLEDGE = 0x05,
     MB_EX_SLAVE_BUSY = 0x06,
+    MB_EX_NEGATIVE_ACKNOWLEDGE = 0x07,
     MB_EX_MEMORY_PARITY_ERROR = 0x08,
     MB_EX_GATEWAY_PATH_FAILED = 0x0A,
     MB_EX_GATEWAY_TGT_FAILED = 0x0B,
@@ -148,7 +149,8 @@ typedef enum
 {
     MB_TMODE_T35,                   /*!< Master receive frame T3.5 timeout. */
     MB_TMODE_RESPOND_TIMEOUT,       /*!< Master wait respond for slave. */
-    MB_TMODE_CONVERT_DELAY          /*!< Master sent broadcast , then delay sometime.*/
+    MB_TMODE_CONVERT_DELAY,         /*!< Master sent broadcast , then delay sometime.*/
+    MB_TMODE_SEND_DELAY             /*!< The frame is deferred until the bus is free. */
 } mb_timer_mode_enum_t;
 
 #ifdef __cplusplus
@@ -27,3 +27,121 @@
  *
  * File: $Id: mbfuncdiag.c, v 1.3 2006/12/07 22:10:34 wolti Exp $
  */
+#include "mb_common.h"
+#include "mb_proto.h"
+#include "mb_slave.h"
+
+#define MB_PDU_DIAG_SUB_OFF             (MB_PDU_DATA_OFF)
+#define MB_PDU_DIAG_DATA_OFF            (MB_PDU_DATA_OFF + 2)
+#define MB_PDU_DIAG_SIZE_MIN            (3)
+#define MB_PDU_DIAG_SIZE                (5)
+#define MB_PDU_EVENT_REQ_SIZE           (1)
+#define MB_PDU_EVENT_CNT_SIZE           (5)
+#define MB_PDU_EVENT_LOG_BYTECNT_OFF    (MB_PDU_DATA_OFF)
+#define MB_PDU_EVENT_LOG_EVENTS_OFF     (MB_PDU_DATA_OFF + 7)
+#define MB_EVENT_LOG_HEADER_SIZE        (6)
+#define MB_DIAG_RESTART_CLEAR_LOG       (0xFF00)
+#define MB_DIAG_STATUS_READY            (0x0000)
+
+/* ----------------------- Start implementation -----------------------------*/
+#if MB_FUNC_DIAG_ENABLED
+
+static inline uint16_t mb_diag_get_word(const uint8_t *buf)
+{
+    return (uint16_t)((buf[0] << 8) | buf[1]);
+}
+
+static inline void mb_diag_set_word(uint8_t *buf, uint16_t value)
+{
+    buf[0] = (uint8_t)(value >> 8);
+    buf[1] = (uint8_t)(value & 0xFF);
+}
+
+mb_exception_t mbs_fn_diag_diagnostic(mb_base_t *inst, uint8_t *frame_ptr, uint16_t *len_buf)
+{
+    if (!inst || !inst->port_obj || !frame_ptr || !len_buf) {
+        return MB_EX_SLAVE_DEVICE_FAILURE;
+    }
+    if (*len_buf < MB_PDU_DIAG_SIZE_MIN) {
+        return MB_EX_ILLEGAL_DATA_VALUE;
+    }
+    mb_port_base_t *port_obj = inst->port_obj;
+    uint16_t sub_func = mb_diag_get_word(&frame_ptr[MB_PDU_DIAG_SUB_OFF]);
+    if (sub_func == MB_DIAG_SUB_RETURN_QUERY_DATA) {
+        // The request is echoed as is
+        return MB_EX_NONE;
+    }
+    if (*len_buf != MB_PDU_DIAG_SIZE) {
+        return MB_EX_ILLEGAL_DATA_VALUE;
+    }
+    uint16_t data = mb_diag_get_word(&frame_ptr[MB_PDU_DIAG_DATA_OFF]);
+    if ((sub_func == MB_DIAG_SUB_RESTART_COMM) ? ((data != 0) && (data != MB_DIAG_RESTART_CLEAR_LOG)) : (data != 0)) {
+        return MB_EX_ILLEGAL_DATA_VALUE;
+    }
+    switch (sub_func) {
+        case MB_DIAG_SUB_RESTART_COMM:
+            mb_port_diag_restart(port_obj, (data == MB_DIAG_RESTART_CLEAR_LOG));
+            break;
+        case MB_DIAG_SUB_RETURN_DIAG_REG:
+            // The diagnostic register does not have device specific bits
+            mb_diag_set_word(&frame_ptr[MB_PDU_DIAG_DATA_OFF], 0);
+            break;
+        case MB_DIAG_SUB_FORCE_LISTEN_ONLY:
+            // The response is not sent in the listen only mode
+            mb_port_diag_set_listen_only(port_obj);
+            break;
+        case MB_DIAG_SUB_CLEAR_COUNTERS:
+            mb_port_diag_clear(port_obj, false);
+            break;
+        case MB_DIAG_SUB_BUS_MSG_CNT:
+        case MB_DIAG_SUB_BUS_COMM_ERR_CNT:
+        case MB_DIAG_SUB_BUS_EXCEPTION_CNT:
+        case MB_DIAG_SUB_SLAVE_MSG_CNT:
+        case MB_DIAG_SUB_SLAVE_NO_RESP_CNT:
+        case MB_DIAG_SUB_SLAVE_NAK_CNT:
+        case MB_DIAG_SUB_SLAVE_BUSY_CNT:
+        case MB_DIAG_SUB_BUS_CHAR_OVERRUN_CNT:
+            mb_diag_set_word(&frame_ptr[MB_PDU_DIAG_DATA_OFF],
+                                mb_port_diag_get_counter(port_obj, (mb_diag_cnt_t)(sub_func - MB_DIAG_SUB_BUS_MSG_CNT)));
+            break;
+        case MB_DIAG_SUB_CLEAR_OVERRUN:
+            mb_port_diag_clear_overrun(port_obj);
+            break;
+        default:
+            return MB_EX_ILLEGAL_FUNCTION;
+    }
+    return MB_EX_NONE;
+}
+
+mb_exception_t mbs_fn_diag_get_comm_event_cnt(mb_base_t *inst, uint8_t *frame_ptr, uint16_t *len_buf)
+{
+    if (!inst || !inst->port_obj || !frame_ptr || !len_buf) {
+        return MB_EX_SLAVE_DEVICE_FAILURE;
+    }
+    if (*len_buf != MB_PDU_EVENT_REQ_SIZE) {
+        return MB_EX_ILLEGAL_DATA_VALUE;
+    }
+    mb_diag_set_word(&frame_ptr[MB_PDU_DATA_OFF], MB_DIAG_STATUS_READY);
+    mb_diag_set_word(&frame_ptr[MB_PDU_DATA_OFF + 2], mb_port_diag_get_counter(inst->port_obj, MB_DIAG_COMM_EVENT_CNT));
+    *len_buf = MB_PDU_EVENT_CNT_SIZE;
+    return MB_EX_NONE;
+}
+
+mb_exception_t mbs_fn_diag_get_comm_event_log(mb_base_t *inst, uint8_t *frame_ptr, uint16_t *len_buf)
+{
+    if (!inst || !inst->port_obj || !frame_ptr || !len_buf) {
+        return MB_EX_SLAVE_DEVICE_FAILURE;
+    }
+    if (*len_buf != MB_PDU_EVENT_REQ_SIZE) {
+        return MB_EX_ILLEGAL_DATA_VALUE;
+    }
+    uint8_t count = mb_port_diag_get_log(inst->port_obj, &frame_ptr[MB_PDU_EVENT_LOG_EVENTS_OFF], MB_DIAG_EVENT_LOG_SIZE);
+    frame_ptr[MB_PDU_EVENT_LOG_BYTECNT_OFF] = (uint8_t)(MB_EVENT_LOG_HEADER_SIZE + count);
+    mb_diag_set_word(&frame_ptr[MB_PDU_EVENT_LOG_BYTECNT_OFF + 1], MB_DIAG_STATUS_READY);
+    mb_diag_set_word(&frame_ptr[MB_PDU_EVENT_LOG_BYTECNT_OFF + 3], mb_port_diag_get_counter(inst->port_obj, MB_DIAG_COMM_EVENT_CNT));
+    mb_diag_set_word(&frame_ptr[MB_PDU_EVENT_LOG_BYTECNT_OFF + 5], mb_port_diag_get_counter(inst->port_obj, MB_DIAG_BUS_MSG_CNT));
+    *len_buf = (uint16_t)(MB_PDU_EVENT_LOG_EVENTS_OFF + count);
+    return MB_EX_NONE;
+}
+
+#endif
@@ -63,6 +63,34 @@ extern "C" {
 #define MB_PORT_SERIAL_ISR_FLAG                 (ESP_INTR_FLAG_LOWMED)
 #endif
 
+/*! \brief The number of frame bytes processed per step of the CRC16 calculation.
+ */
+#if CONFIG_FMB_CRC16_SLICE_NUM
+#define MB_CRC16_SLICE_NUM                      (CONFIG_FMB_CRC16_SLICE_NUM)
+#else
+#define MB_CRC16_SLICE_NUM                      (1)
+#endif
+
+/*! \brief If the fixed T1.5 and T3.5 values are used for baud rates above 19200.
+ */
+#if CONFIG_FMB_SERIAL_FIXED_FRAME_TIMING_EN
+#define MB_SERIAL_FIXED_FRAME_TIMING_ENABLED    (1)
+#else
+#define MB_SERIAL_FIXED_FRAME_TIMING_ENABLED    (0)
+#endif
+
+/*! \brief The UART receive timeout in symbol times used to detect the end of frame.
+ */
+#if CONFIG_FMB_SERIAL_RX_TOUT_SYMB
+#define MB_SERIAL_RX_TOUT_SYMB                  (CONFIG_FMB_SERIAL_RX_TOUT_SYMB)
+#else
+#define MB_SERIAL_RX_TOUT_SYMB                  (3)
+#endif
+
+/*! \brief If the serial slave port drops the frames addressed to other slaves.
+ */
+#define MB_SLAVE_EARLY_ADDR_FILTER_ENABLED      (CONFIG_FMB_SLAVE_EARLY_ADDR_FILTER_EN)
+
 /*! \brief The option represents the serial buffer size for RTU and ASCI.
  */
 #define MB_BUFFER_SIZE                          (CONFIG_FMB_BUFFER_SIZE)
@@ -130,6 +158,10 @@ extern "C" {
 /*! \brief If the <em>Report Slave ID</em> function should be enabled. */
 #define MB_FUNC_OTHER_REP_SLAVEID_ENABLED       (CONFIG_FMB_CONTROLLER_SLAVE_ID_SUPPORT)
 
+/*! \brief If the <em>Diagnostics</em>, <em>Get Comm Event Counter</em> and
+ * <em>Get Comm Event Log</em> functions should be enabled. */
+#define MB_FUNC_DIAG_ENABLED                    (CONFIG_FMB_CONTROLLER_SLAVE_DIAG_SUPPORT)
+
 /*! \brief If the <em>Read Input Registers</em> function should be enabled. */
 #define MB_FUNC_READ_INPUT_ENABLED              (1)
 
@@ -159,6 +191,42 @@ extern "C" {
 
 /*! @} */
 
+/* ----------------------- Diagnostics of master and slave ------------------*/
+
+/*! \brief If the stages of transactions are recorded into the trace ring of the instance. */
+#if CONFIG_FMB_STAGE_TRACE_EN
+#define MB_STAGE_TRACE_ENABLED                  (1)
+/*! \brief The number of records in the trace ring (rounded up to the power of two). */
+#define MB_STAGE_TRACE_RING_SIZE                (CONFIG_FMB_STAGE_TRACE_RING_SIZE)
+#else
+#define MB_STAGE_TRACE_ENABLED                  (0)
+#endif
+
+/*! \brief If the latency histograms and throughput counters of the instance are collected. */
+#if CONFIG_FMB_STATS_EN
+#define MB_STATS_ENABLED                        (1)
+#else
+#define MB_STATS_ENABLED                        (0)
+#endif
+
+/*! \brief The maximum level of the hot path messages compiled in (see MB_TRACE). */
+#if CONFIG_FMB_TRACE_LEVEL
+#define MB_TRACE_LEVEL                          (CONFIG_FMB_TRACE_LEVEL)
+#else
+#define MB_TRACE_LEVEL                          (0)
+#endif
+
+/*! \brief If the hot path messages are stored into the ring and formatted later. */
+#if CONFIG_FMB_TRACE_DEFERRED_EN
+#define MB_TRACE_DEFERRED_ENABLED               (1)
+/*! \brief The number of messages in the deferred log ring rounded up to the power of two
+ * (the bits below the highest one are set, the option is limited to 4096 by the configuration). */
+#define MB_TRACE_POW2_FILL_(val, shift)         ((val) | ((val) >> (shift)))
+#define MB_TRACE_DEFERRED_RING_SIZE             (MB_TRACE_POW2_FILL_(MB_TRACE_POW2_FILL_(MB_TRACE_POW2_FILL_(  \
+                                                    MB_TRACE_POW2_FILL_((CONFIG_FMB_TRACE_DEFERRED_RING_SIZE - 1), 1), 2), 4), 8) + 1)
+#else
+#define MB_TRACE_DEFERRED_ENABLED               (0)
+#endif
 
 #if MB_MASTER_RTU_ENABLED || MB_MASTER_ASCII_ENABLED || MB_MASTER_TCP_ENABLED
 /*! \brief If master send a broadcast frame, the master will wait time of convert to delay,
@@ -172,6 +240,18 @@ extern "C" {
  * \note : The slave ID must be continuous from 1.*/
 #define MB_MASTER_TOTAL_SLAVE_NUM               (247)
 #define MB_MASTER_MIN_TIMEOUT_MS_RESPOND        (50)
+/*! \brief If the respond timeout is calculated for each slave from its measured round trip time. */
+#define MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED      (CONFIG_FMB_MASTER_ADAPTIVE_TIMEOUT_EN)
+/*! \brief If the broadcast requests of RTU master are batched and the conversion delay
+ * is applied only before the next unicast request. */
+#define MB_MASTER_BCAST_BATCH_ENABLED           (CONFIG_FMB_MASTER_BCAST_BATCH_EN)
+/*! \brief If the master tracks health of slaves and fails fast the requests to down slaves. */
+#define MB_MASTER_SLAVE_HEALTH_ENABLED          (CONFIG_FMB_MASTER_SLAVE_HEALTH_EN)
+#if MB_MASTER_SLAVE_HEALTH_ENABLED
+#define MB_MASTER_SLAVE_FAIL_THRESHOLD          (CONFIG_FMB_MASTER_SLAVE_FAIL_THRESHOLD)
+#define MB_MASTER_SLAVE_PROBE_MS                (CONFIG_FMB_MASTER_SLAVE_PROBE_MS)
+#define MB_MASTER_SLAVE_PROBE_MAX_MS            (CONFIG_FMB_MASTER_SLAVE_PROBE_MAX_MS)
+#endif
 
 #endif
 
@@ -22,6 +22,12 @@ mb_exception_t mbs_fn_report_slave_id(mb_base_t *inst, uint8_t *frame, uint16_t
 mb_exception_t mbm_fn_report_slave_id(mb_base_t *inst, uint8_t *frame, uint16_t *len);
 #endif
 
+#if MB_FUNC_DIAG_ENABLED
+mb_exception_t mbs_fn_diag_diagnostic(mb_base_t *inst, uint8_t *frame_ptr, uint16_t *len_buf);
+mb_exception_t mbs_fn_diag_get_comm_event_cnt(mb_base_t *inst, uint8_t *frame_ptr, uint16_t *len_buf);
+mb_exception_t mbs_fn_diag_get_comm_event_log(mb_base_t *inst, uint8_t *frame_ptr, uint16_t *len_buf);
+#endif
+
 #if MB_FUNC_READ_INPUT_ENABLED
 mb_exception_t mbs_fn_read_input_reg(mb_base_t *inst, uint8_t *frame_ptr,uint16_t *len_buf);
 mb_exception_t mbm_fn_read_inp_reg(mb_base_t *inst, uint8_t *frame_ptr,uint16_t *len_buf);
@@ -34,9 +34,32 @@ typedef enum mb_commands_enum
     MB_FUNC_DIAG_GET_COM_EVENT_CNT      = ( 11 ),
     MB_FUNC_DIAG_GET_COM_EVENT_LOG      = ( 12 ),
     MB_FUNC_OTHER_REPORT_SLAVEID        = ( 17 ),
+    MB_FUNC_READ_FILE_RECORD            = ( 20 ),
+    MB_FUNC_WRITE_FILE_RECORD           = ( 21 ),
+    MB_FUNC_MASK_WRITE_REGISTER         = ( 22 ),
+    MB_FUNC_READ_FIFO_QUEUE             = ( 24 ),
     MB_FUNC_ERROR                       = ( 0x80 )
 } mb_commands_t;
 
+/*! \brief The sub-functions of the <em>Diagnostics</em> (0x08) function. */
+typedef enum mb_diag_sub_func_enum
+{
+    MB_DIAG_SUB_RETURN_QUERY_DATA       = ( 0x00 ),
+    MB_DIAG_SUB_RESTART_COMM            = ( 0x01 ),
+    MB_DIAG_SUB_RETURN_DIAG_REG         = ( 0x02 ),
+    MB_DIAG_SUB_FORCE_LISTEN_ONLY       = ( 0x04 ),
+    MB_DIAG_SUB_CLEAR_COUNTERS          = ( 0x0A ),
+    MB_DIAG_SUB_BUS_MSG_CNT             = ( 0x0B ),
+    MB_DIAG_SUB_BUS_COMM_ERR_CNT        = ( 0x0C ),
+    MB_DIAG_SUB_BUS_EXCEPTION_CNT       = ( 0x0D ),
+    MB_DIAG_SUB_SLAVE_MSG_CNT           = ( 0x0E ),
+    MB_DIAG_SUB_SLAVE_NO_RESP_CNT       = ( 0x0F ),
+    MB_DIAG_SUB_SLAVE_NAK_CNT           = ( 0x10 ),
+    MB_DIAG_SUB_SLAVE_BUSY_CNT          = ( 0x11 ),
+    MB_DIAG_SUB_BUS_CHAR_OVERRUN_CNT    = ( 0x12 ),
+    MB_DIAG_SUB_CLEAR_OVERRUN           = ( 0x14 )
+} mb_diag_sub_func_t;
+
 /* ----------------------- Type definitions ---------------------------------*/
 
 typedef struct
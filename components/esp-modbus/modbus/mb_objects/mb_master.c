@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include "esp_timer.h"
 #include "mb_config.h"
 #include "mb_common.h"
 #include "mb_proto.h"
@@ -319,7 +320,8 @@ error:
 mb_err_enum_t mbm_tcp_create(mb_tcp_opts_t *tcp_opts, void **in_out_obj)
 {
     MB_RETURN_ON_FALSE((tcp_opts && in_out_obj), MB_EINVAL, TAG, "invalid options for the instance.");
-    MB_RETURN_ON_FALSE((tcp_opts->mode == MB_TCP), MB_EILLSTATE, TAG, "incorrect option mode != TCP.");
+    MB_RETURN_ON_FALSE(((tcp_opts->mode == MB_TCP) || (tcp_opts->mode == MB_UDP)),
+                        MB_EILLSTATE, TAG, "incorrect option mode != TCP, UDP.");
     mb_err_enum_t ret = MB_ENOERR;
     mbm_object_t *mbm_obj = NULL;
     mb_trans_base_t *transp_obj = NULL;
@@ -549,11 +551,15 @@ mb_err_enum_t mbm_poll(mb_base_t *inst)
                                 mbm_obj->snd_frame, mbm_obj->pdu_snd_len, ESP_LOG_DEBUG);
                 status = MB_OBJ(inst->transp_obj)->frm_send(inst->transp_obj, mbm_obj->master_dst_addr, 
                                                                 mbm_obj->snd_frame, mbm_obj->pdu_snd_len);
-                if (status != MB_ENOERR) {
+                if (status == MB_EBUSY) {
+                    // The bus is not free, the transport posts EV_FRAME_TRANSMIT again
+                    ESP_LOGD(TAG, MB_OBJ_FMT", frame send is deferred.", MB_OBJ_PARENT(inst));
+                } else if (status != MB_ENOERR) {
                     mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_RESPOND_TIMEOUT);
                     (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_ERROR_PROCESS));
                     ESP_LOGE(TAG, MB_OBJ_FMT", frame send error. %d", MB_OBJ_PARENT(inst), (int)status);
                 } else {
+                    MB_STATS_FRAME(inst->port_obj, true, mbm_obj->pdu_snd_len);
                     (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_FRAME_SENT));
                 }
                 // Initialize modbus transaction
@@ -572,9 +578,14 @@ mb_err_enum_t mbm_poll(mb_base_t *inst)
                 MB_RETURN_ON_FALSE(mbm_obj->snd_frame, MB_EILLSTATE, TAG, "Send buffer initialization fail.");
                 if (event.trans_id == mbm_obj->curr_trans_id) {
                     mb_port_timer_disable(MB_OBJ(inst->port_obj));
+                    if (status == MB_ENOERR) {
+                        MB_STATS_FRAME(inst->port_obj, false, mbm_obj->pdu_rcv_len);
+                    }
                     // Check if the frame is for us. If not ,send an error process event.
                     if ((status == MB_ENOERR) && ((mbm_obj->rcv_addr == mbm_obj->master_dst_addr)
                             || (mbm_obj->rcv_addr == MB_TCP_PSEUDO_ADDRESS))) {
+                        // Take the round trip time sample of the slave if it is not measured by port or transport
+                        mb_port_timer_rtt_stop(MB_OBJ(inst->port_obj), mbm_obj->master_dst_addr);
                         if ((mbm_obj->rcv_frame[MB_PDU_FUNC_OFF] & ~MB_FUNC_ERROR) == (mbm_obj->snd_frame[MB_PDU_FUNC_OFF])) {
                             ESP_LOGD(TAG, MB_OBJ_FMT", frame data received successfully, (%d).", MB_OBJ_PARENT(inst), (int)status);
                             MB_PRT_BUF(inst->descr.parent_name, ":MB_RECV",
@@ -584,6 +595,7 @@ mb_err_enum_t mbm_poll(mb_base_t *inst)
                             ESP_LOGE(TAG, MB_OBJ_FMT", drop incorrect frame, receive_func(%u) != send_func(%u)",
                                         MB_OBJ_PARENT(inst), (mbm_obj->rcv_frame[MB_PDU_FUNC_OFF] & ~MB_FUNC_ERROR), 
                                         mbm_obj->snd_frame[MB_PDU_FUNC_OFF]);
+                            MB_STATS_DROP(inst->port_obj, 1);
                             mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_RECEIVE_DATA);
                             (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_ERROR_PROCESS));
                         }
@@ -597,6 +609,7 @@ mb_err_enum_t mbm_poll(mb_base_t *inst)
                     // Ignore the `EV_FRAME_RECEIVED` event because the respond timeout occurred
                     // and this is likely respond to previous transaction.
                     ESP_LOGE(TAG, MB_OBJ_FMT", drop data received outside of transaction.", MB_OBJ_PARENT(inst));
+                    MB_STATS_DROP(inst->port_obj, 1);
                 }
                 break;
 
@@ -611,6 +624,9 @@ mb_err_enum_t mbm_poll(mb_base_t *inst)
                     ESP_LOGD(TAG, MB_OBJ_FMT":EV_EXECUTE", MB_OBJ_PARENT(inst));
                     mbm_obj->func_code = mbm_obj->rcv_frame[MB_PDU_FUNC_OFF];
                     exception = MB_EX_ILLEGAL_FUNCTION;
+#if MB_STATS_ENABLED
+                    int64_t handler_ts = esp_timer_get_time();
+#endif
                     /* If master request is broadcast,
                      * the master needs to execute function for all slaves.
                      */
@@ -624,6 +640,9 @@ mb_err_enum_t mbm_poll(mb_base_t *inst)
                         ESP_LOGD(TAG, MB_OBJ_FMT": function (0x%x), invoke handler.", MB_OBJ_PARENT(inst), (int)mbm_obj->func_code);
                         exception = mbm_check_invoke_handler(inst, mbm_obj->func_code, mbm_obj->rcv_frame, &mbm_obj->pdu_rcv_len);
                     }
+#if MB_STATS_ENABLED
+                    mb_port_stats_handler(inst->port_obj, mbm_obj->func_code, (uint32_t)(esp_timer_get_time() - handler_ts));
+#endif
                     /* If master has exception, will send error process event. Otherwise the master is idle.*/
                     if (exception != MB_EX_NONE) {
                         mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_EXECUTE_FUNCTION);
@@ -673,6 +692,10 @@ mb_err_enum_t mbm_poll(mb_base_t *inst)
                 }
                 mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_INIT);
                 uint64_t time_div_us = mbm_obj->curr_trans_id ? (event.get_ts - mbm_obj->curr_trans_id) : 0;
+#if MB_STATS_ENABLED
+                mb_port_stats_request(inst->port_obj, mbm_obj->snd_frame ? (mbm_obj->snd_frame[MB_PDU_FUNC_OFF] & ~MB_FUNC_ERROR) : 0,
+                                        (uint32_t)time_div_us, error_type);
+#endif
                 mbm_obj->curr_trans_id = 0;
                 ESP_LOGD(TAG, MB_OBJ_FMT", transaction processing time(us) = %" PRId64, MB_OBJ_PARENT(inst), time_div_us);
                 mb_port_event_res_release(MB_OBJ(inst->port_obj));
@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include "esp_timer.h"
 #include "mb_config.h"
 #include "mb_common.h"
 #include "mb_proto.h"
@@ -89,6 +90,39 @@ mb_err_enum_t mbs_get_handler_count(mb_base_t *inst, uint16_t *count)
     return MB_ENOERR;
 }
 
+#if MB_FUNC_DIAG_ENABLED
+
+// Returns the sub-function of the diagnostics request or -1 for the other requests
+static int mbs_diag_get_sub_func(const uint8_t *frame, uint16_t length)
+{
+    if ((length < 3) || (frame[MB_PDU_FUNC_OFF] != MB_FUNC_DIAG_DIAGNOSTIC)) {
+        return -1;
+    }
+    return (int)((frame[MB_PDU_DATA_OFF] << 8) | frame[MB_PDU_DATA_OFF + 1]);
+}
+
+// Update the diagnostic counters and the event log when the request is processed
+static void mbs_diag_request_done(mb_base_t *inst, uint8_t func_code, mb_exception_t exception, bool is_responded)
+{
+    if (!is_responded) {
+        MB_DIAG_INC(inst->port_obj, MB_DIAG_SLAVE_NO_RESP_CNT);
+    } else if (exception != MB_EX_NONE) {
+        MB_DIAG_INC(inst->port_obj, MB_DIAG_BUS_EXCEPTION_CNT);
+        if (exception == MB_EX_SLAVE_BUSY) {
+            MB_DIAG_INC(inst->port_obj, MB_DIAG_SLAVE_BUSY_CNT);
+        } else if (exception == MB_EX_NEGATIVE_ACKNOWLEDGE) {
+            MB_DIAG_INC(inst->port_obj, MB_DIAG_SLAVE_NAK_CNT);
+        }
+    }
+    if ((exception == MB_EX_NONE) && (func_code != MB_FUNC_DIAG_GET_COM_EVENT_CNT)
+            && (func_code != MB_FUNC_DIAG_GET_COM_EVENT_LOG)) {
+        MB_DIAG_INC(inst->port_obj, MB_DIAG_COMM_EVENT_CNT);
+    }
+    mb_port_diag_send_event(inst->port_obj, exception);
+}
+
+#endif
+
 static mb_exception_t mbs_check_invoke_handler(mb_base_t *inst, uint8_t func_code, uint8_t *buf, uint16_t *len)
 {
     mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
@@ -96,12 +130,19 @@ static mb_exception_t mbs_check_invoke_handler(mb_base_t *inst, uint8_t func_cod
     if (!func_code || (func_code & MB_FUNC_ERROR)) {
         return MB_EX_ILLEGAL_FUNCTION;
     }
+#if MB_FUNC_DIAG_ENABLED
+    // The TCP transaction always waits for the response, the listen only mode is supported on serial line only
+    if (((mbs_obj->cur_mode == MB_TCP) || (mbs_obj->cur_mode == MB_UDP))
+            && (mbs_diag_get_sub_func(buf, *len) == MB_DIAG_SUB_FORCE_LISTEN_ONLY)) {
+        return MB_EX_ILLEGAL_FUNCTION;
+    }
+#endif
     SEMA_SECTION(mbs_obj->handler_descriptor.sema, MB_HANDLER_UNLOCK_TICKS) {
         mb_fn_handler_fp handler = NULL;
         mb_err_enum_t status = mb_get_handler(&mbs_obj->handler_descriptor, func_code, &handler);
         if ((status == MB_ENOERR) && handler) {
             exception = handler(inst, buf, len);
-            ESP_LOGD(TAG, MB_OBJ_FMT": function (0x%x), invoke handler %p.", MB_OBJ_PARENT(inst), (int)func_code, handler);
+            MB_TRACED(TAG, MB_OBJ_FMT": function (0x%x), invoke handler %p.", MB_OBJ_PARENT(inst), (int)func_code, handler);
         }
     }
     return exception;
@@ -119,6 +160,14 @@ static mb_err_enum_t mbs_register_default_handlers(mb_base_t *inst)
         err = mbs_set_handler(inst, MB_FUNC_OTHER_REPORT_SLAVEID, (void *)mbs_fn_report_slave_id);
         MB_RETURN_ON_FALSE((err == MB_ENOERR), err, TAG, "handler registration error = (0x%x).", (int)err);
 #endif
+#if MB_FUNC_DIAG_ENABLED
+        err = mbs_set_handler(inst, MB_FUNC_DIAG_DIAGNOSTIC, (void *)mbs_fn_diag_diagnostic);
+        MB_RETURN_ON_FALSE((err == MB_ENOERR), err, TAG, "handler registration error = (0x%x).", (int)err);
+        err = mbs_set_handler(inst, MB_FUNC_DIAG_GET_COM_EVENT_CNT, (void *)mbs_fn_diag_get_comm_event_cnt);
+        MB_RETURN_ON_FALSE((err == MB_ENOERR), err, TAG, "handler registration error = (0x%x).", (int)err);
+        err = mbs_set_handler(inst, MB_FUNC_DIAG_GET_COM_EVENT_LOG, (void *)mbs_fn_diag_get_comm_event_log);
+        MB_RETURN_ON_FALSE((err == MB_ENOERR), err, TAG, "handler registration error = (0x%x).", (int)err);
+#endif
 #if MB_FUNC_READ_INPUT_ENABLED
         err =  mbs_set_handler(inst, MB_FUNC_READ_INPUT_REGISTER, (void *)mbs_fn_read_input_reg);
         MB_RETURN_ON_FALSE((err == MB_ENOERR), err, TAG, "handler registration error = (0x%x).", (int)err);
@@ -295,7 +344,8 @@ mb_err_enum_t mbs_tcp_create(mb_tcp_opts_t *tcp_opts, void **in_out_obj)
 {
     mb_err_enum_t ret = MB_ENOERR;
     MB_RETURN_ON_FALSE(tcp_opts, MB_EINVAL, TAG, "invalid options for the instance.");
-    MB_RETURN_ON_FALSE((tcp_opts->mode == MB_TCP), MB_EILLSTATE, TAG, "incorrect mode != TCP.");
+    MB_RETURN_ON_FALSE(((tcp_opts->mode == MB_TCP) || (tcp_opts->mode == MB_UDP)),
+                        MB_EILLSTATE, TAG, "incorrect mode != TCP, UDP.");
     mbs_object_t *mbs_obj = NULL;
     mb_trans_base_t *transp_obj = NULL;
     mbs_obj = (mbs_object_t*)calloc(1, sizeof(mbs_object_t));
@@ -426,25 +476,43 @@ mb_err_enum_t mbs_disable(mb_base_t *inst)
 void mbs_error_cb_respond_timeout(mb_base_t *inst, uint8_t dest_addr, const uint8_t *pdu_data, uint16_t pdu_length)
 {
     mb_port_event_set_resp_flag(MB_BASE2PORT(inst), EV_ERROR_RESPOND_TIMEOUT);
-    ESP_LOG_BUFFER_HEX_LEVEL(__func__, (void *)pdu_data, pdu_length, ESP_LOG_DEBUG);
+    MB_TRACE_BUF(__func__, "", (void *)pdu_data, pdu_length, ESP_LOG_DEBUG);
 }
 
 void mbs_error_cb_receive_data(mb_base_t *inst, uint8_t dest_addr, const uint8_t *pdu_data, uint16_t pdu_length)
 {
     mb_port_event_set_resp_flag(MB_BASE2PORT(inst), EV_ERROR_RECEIVE_DATA);
-    ESP_LOG_BUFFER_HEX_LEVEL(__func__, (void *)pdu_data, pdu_length, ESP_LOG_DEBUG);
+    MB_TRACE_BUF(__func__, "", (void *)pdu_data, pdu_length, ESP_LOG_DEBUG);
 }
 
 void mbs_error_cb_execute_function(mb_base_t *inst, uint8_t dest_address, const uint8_t *pdu_data, uint16_t pdu_length)
 {
     mb_port_event_set_resp_flag(MB_BASE2PORT(inst), EV_ERROR_EXECUTE_FUNCTION);
-    ESP_LOG_BUFFER_HEX_LEVEL(__func__, (void *)pdu_data, pdu_length, ESP_LOG_DEBUG);
+    MB_TRACE_BUF(__func__, "", (void *)pdu_data, pdu_length, ESP_LOG_DEBUG);
 }
 
 void mbs_error_cb_request_success(mb_base_t *inst, uint8_t dest_address, const uint8_t *pdu_data, uint16_t pdu_length)
 {
     mb_port_event_set_resp_flag(MB_BASE2PORT(inst), EV_ERROR_OK);
-    ESP_LOG_BUFFER_HEX_LEVEL(__func__, (void *)pdu_data, pdu_length, ESP_LOG_DEBUG);
+    MB_TRACE_BUF(__func__, "", (void *)pdu_data, pdu_length, ESP_LOG_DEBUG);
+}
+
+// Send the response frame, the transport can defer it until the bus is free
+static void mbs_send_response(mb_base_t *inst)
+{
+    mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
+    mb_err_enum_t status = MB_OBJ(inst->transp_obj)->frm_send(inst->transp_obj, mbs_obj->rcv_addr, mbs_obj->frame, mbs_obj->length);
+    if (status == MB_EBUSY) {
+        // The transport posts EV_FRAME_TRANSMIT to send the response again
+        MB_TRACED(TAG, MB_OBJ_FMT": frame send is deferred.", MB_OBJ_PARENT(inst));
+    } else if (status != MB_ENOERR) {
+        ESP_LOGE(TAG, MB_OBJ_FMT": frame send error: %d.", MB_OBJ_PARENT(inst), (int)status);
+        mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_RESPOND_TIMEOUT);
+        (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_ERROR_PROCESS));
+    } else {
+        MB_STATS_FRAME(inst->port_obj, true, mbs_obj->length);
+        (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_FRAME_SENT));
+    }
 }
 
 mb_err_enum_t mbs_poll(mb_base_t *inst)
@@ -453,6 +521,7 @@ mb_err_enum_t mbs_poll(mb_base_t *inst)
 
     mb_exception_t exception;
     mb_err_enum_t status = MB_ENOERR;
+    bool is_responded = false;
     mb_event_t event;
     mb_err_event_t error_type = EV_ERROR_INIT;
     uint64_t time_div_us = 0;
@@ -466,26 +535,37 @@ mb_err_enum_t mbs_poll(mb_base_t *inst)
     if (mb_port_event_get(MB_OBJ(mbs_obj->base.port_obj), &event)) {
         switch(event.event) {
             case EV_READY:
-                ESP_LOGD(TAG, MB_OBJ_FMT":EV_READY", MB_OBJ_PARENT(inst));
+                MB_TRACED(TAG, MB_OBJ_FMT":EV_READY", MB_OBJ_PARENT(inst));
                 mb_port_event_res_release(MB_OBJ(inst->port_obj));
                 break;
                 
             case EV_FRAME_RECEIVED:
-                ESP_LOGD(TAG, MB_OBJ_FMT":EV_FRAME_RECEIVED", MB_OBJ_PARENT(inst));
+                MB_TRACED(TAG, MB_OBJ_FMT":EV_FRAME_RECEIVED", MB_OBJ_PARENT(inst));
                 mbs_obj->length = event.length;
                 status = MB_OBJ(inst->transp_obj)->frm_rcv(inst->transp_obj, &mbs_obj->rcv_addr, &mbs_obj->frame, &mbs_obj->length);
+                MB_DIAG_INC(inst->port_obj, MB_DIAG_BUS_MSG_CNT);
                 // Check if the frame is for us. If not ,send an error process event.
                 if (status == MB_ENOERR) {
+                    MB_STATS_FRAME(inst->port_obj, false, mbs_obj->length);
                     // Check if the frame is for us. If not ignore the frame.
                     if((mbs_obj->rcv_addr == mbs_obj->mb_address) || (mbs_obj->rcv_addr == MB_ADDRESS_BROADCAST)
                             || (mbs_obj->rcv_addr == MB_TCP_PSEUDO_ADDRESS)) {
+#if MB_FUNC_DIAG_ENABLED
+                        MB_DIAG_INC(inst->port_obj, MB_DIAG_SLAVE_MSG_CNT);
+                        mb_port_diag_rcv_event(inst->port_obj, (mbs_obj->rcv_addr == MB_ADDRESS_BROADCAST), false);
+#endif
                         mbs_obj->curr_trans_id = event.get_ts;
+                        MB_STAGE_TRACE(inst->port_obj, MB_TRACE_STAGE_FRAME_PARSED, mbs_obj->frame[MB_PDU_FUNC_OFF],
+                                        mbs_obj->length, mbs_obj->rcv_addr);
                         (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_EXECUTE | EV_TRANS_START));
-                        MB_PRT_BUF(inst->descr.parent_name, ":MB_RECV",
+                        MB_TRACE_BUF(inst->descr.parent_name, ":MB_RECV",
                                     &mbs_obj->frame[MB_PDU_FUNC_OFF], mbs_obj->length, ESP_LOG_DEBUG);
                     }
                 } else {
                     ESP_LOGE(TAG, MB_OBJ_FMT":frame receive error. %d", MB_OBJ_PARENT(inst), (int)status);
+#if MB_FUNC_DIAG_ENABLED
+                    mb_port_diag_rcv_event(inst->port_obj, false, true);
+#endif
                     // If the frame was not received correctly, post an error event.
                     mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_RECEIVE_DATA);
                     (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_ERROR_PROCESS));
@@ -495,11 +575,35 @@ mb_err_enum_t mbs_poll(mb_base_t *inst)
 
             case EV_EXECUTE:
                 MB_RETURN_ON_FALSE(mbs_obj->frame, MB_EILLSTATE, TAG, "receive buffer fail.");
-                ESP_LOGD(TAG, MB_OBJ_FMT":EV_EXECUTE", MB_OBJ_PARENT(inst));
+                MB_TRACED(TAG, MB_OBJ_FMT":EV_EXECUTE", MB_OBJ_PARENT(inst));
                 mbs_obj->func_code = mbs_obj->frame[MB_PDU_FUNC_OFF];
+                is_responded = (mbs_obj->rcv_addr != MB_ADDRESS_BROADCAST) || (mbs_obj->cur_mode == MB_TCP) || (mbs_obj->cur_mode == MB_UDP);
+#if MB_FUNC_DIAG_ENABLED
+                // The requests are monitored only in the listen only mode
+                if (mb_port_diag_is_listen_only(inst->port_obj)) {
+                    is_responded = false;
+                    if (mbs_diag_get_sub_func(mbs_obj->frame, mbs_obj->length) != MB_DIAG_SUB_RESTART_COMM) {
+                        MB_DIAG_INC(inst->port_obj, MB_DIAG_SLAVE_NO_RESP_CNT);
+                        break;
+                    }
+                }
+#endif
+                MB_STAGE_TRACE(inst->port_obj, MB_TRACE_STAGE_EXEC_START, mbs_obj->func_code, mbs_obj->length, mbs_obj->curr_trans_id);
+#if MB_STATS_ENABLED
+                int64_t handler_ts = esp_timer_get_time();
+#endif
                 exception = mbs_check_invoke_handler(inst, mbs_obj->func_code, mbs_obj->frame, &mbs_obj->length);
+#if MB_STATS_ENABLED
+                mb_port_stats_handler(inst->port_obj, mbs_obj->func_code, (uint32_t)(esp_timer_get_time() - handler_ts));
+#endif
+                MB_STAGE_TRACE(inst->port_obj, MB_TRACE_STAGE_EXEC_END, mbs_obj->func_code, mbs_obj->length, exception);
+#if MB_FUNC_DIAG_ENABLED
+                // The force listen only request is not responded
+                is_responded = is_responded && !mb_port_diag_is_listen_only(inst->port_obj);
+                mbs_diag_request_done(inst, mbs_obj->func_code, exception, is_responded);
+#endif
                 // If the request was not sent to the broadcast address, return a reply.
-                if ((mbs_obj->rcv_addr != MB_ADDRESS_BROADCAST) || (mbs_obj->cur_mode == MB_TCP)) {
+                if (is_responded) {
                     if (exception != MB_EX_NONE) {
                         // An exception occurred. Build an error frame.
                         mbs_obj->length = 0;
@@ -509,37 +613,33 @@ mb_err_enum_t mbs_poll(mb_base_t *inst)
                     if ((mbs_obj->cur_mode == MB_ASCII) && MB_ASCII_TIMEOUT_WAIT_BEFORE_SEND_MS) {
                         mb_port_timer_delay(MB_OBJ(inst->port_obj), MB_ASCII_TIMEOUT_WAIT_BEFORE_SEND_MS);
                     }
-                    MB_PRT_BUF(inst->descr.parent_name, ":MB_SEND", (void *)mbs_obj->frame,
+                    MB_TRACE_BUF(inst->descr.parent_name, ":MB_SEND", (void *)mbs_obj->frame,
                                                     (uint16_t)mbs_obj->length, ESP_LOG_DEBUG);
-                    status = MB_OBJ(inst->transp_obj)->frm_send(inst->transp_obj, mbs_obj->rcv_addr, mbs_obj->frame, mbs_obj->length);
-                    if (status != MB_ENOERR) {
-                        ESP_LOGE(TAG, MB_OBJ_FMT": frame send error: %d.", MB_OBJ_PARENT(inst), (int)status);
-                        mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_RESPOND_TIMEOUT);
-                        (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_ERROR_PROCESS));
-                    } else {
-                        (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_FRAME_SENT));
-                    }
+                    mbs_send_response(inst);
                 }
                 break;
 
             case EV_FRAME_TRANSMIT:
-                ESP_LOGD(TAG, MB_OBJ_FMT":EV_FRAME_TRANSMIT", MB_OBJ_PARENT(inst));
+                MB_TRACED(TAG, MB_OBJ_FMT":EV_FRAME_TRANSMIT", MB_OBJ_PARENT(inst));
+                // The response deferred by the transport is sent when the bus is free
+                mbs_send_response(inst);
                 break;
 
             case EV_FRAME_SENT:
-                ESP_LOGD(TAG, MB_OBJ_FMT":EV_MASTER_FRAME_SENT", MB_OBJ_PARENT(inst));
+                MB_TRACED(TAG, MB_OBJ_FMT":EV_MASTER_FRAME_SENT", MB_OBJ_PARENT(inst));
+                MB_STAGE_TRACE(inst->port_obj, MB_TRACE_STAGE_SEND_DONE, mbs_obj->func_code, mbs_obj->length, mbs_obj->curr_trans_id);
                 error_type = mb_port_event_get_err_type(MB_OBJ(inst->port_obj));
                 if (error_type == EV_ERROR_INIT) {
-                    ESP_LOGD(TAG, MB_OBJ_FMT", set event EV_ERROR_OK", MB_OBJ_PARENT(inst));
+                    MB_TRACED(TAG, MB_OBJ_FMT", set event EV_ERROR_OK", MB_OBJ_PARENT(inst));
                     mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_OK);
                     (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_ERROR_PROCESS));
                 } else {
-                    ESP_LOGD(TAG, MB_OBJ_FMT", incorrect initial error type.", MB_OBJ_PARENT(inst));
+                    MB_TRACED(TAG, MB_OBJ_FMT", incorrect initial error type.", MB_OBJ_PARENT(inst));
                 }
                 break;
 
             case EV_ERROR_PROCESS:
-                ESP_LOGD(TAG, MB_OBJ_FMT":EV_ERROR_PROCESS", MB_OBJ_PARENT(inst));
+                MB_TRACED(TAG, MB_OBJ_FMT":EV_ERROR_PROCESS", MB_OBJ_PARENT(inst));
                 // stop timer and execute specified error process callback function.
                 mb_port_timer_disable(MB_OBJ(inst->port_obj));
                 error_type = mb_port_event_get_err_type(MB_OBJ(inst->port_obj));
@@ -567,18 +667,23 @@ mb_err_enum_t mbs_poll(mb_base_t *inst)
                 }
                 mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_INIT);
                 time_div_us = mbs_obj->curr_trans_id ? (event.get_ts - mbs_obj->curr_trans_id) : 0;
+#if MB_STATS_ENABLED
+                // The function code is not known for the requests failed before parsing
+                mb_port_stats_request(inst->port_obj, mbs_obj->curr_trans_id ? mbs_obj->func_code : 0,
+                                        (uint32_t)time_div_us, error_type);
+#endif
                 mbs_obj->curr_trans_id = 0;
-                ESP_LOGD(TAG, MB_OBJ_FMT", transaction processing time(us) = %" PRId64, MB_OBJ_PARENT(inst), time_div_us);
+                MB_TRACED(TAG, MB_OBJ_FMT", transaction processing time(us) = %" PRIu32, MB_OBJ_PARENT(inst), (uint32_t)time_div_us);
                 mb_port_event_res_release(MB_OBJ(inst->port_obj));
                 break;
 
             default:
-                ESP_LOGD(TAG, MB_OBJ_FMT": Unexpected event 0x%02x or timeout.", MB_OBJ_PARENT(inst), (int)event.event);
+                MB_TRACED(TAG, MB_OBJ_FMT": Unexpected event 0x%02x or timeout.", MB_OBJ_PARENT(inst), (int)event.event);
                 break;
         }
     } else {
         // Something went wrong and task unblocked but there are no any correct events set
-        ESP_LOGD(TAG, MB_OBJ_FMT": Unexpected event 0x%02x or timeout?", MB_OBJ_PARENT(inst), (int)event.event);
+        MB_TRACED(TAG, MB_OBJ_FMT": Unexpected event 0x%02x or timeout?", MB_OBJ_PARENT(inst), (int)event.event);
         status = MB_EILLSTATE;
     }
     return status;
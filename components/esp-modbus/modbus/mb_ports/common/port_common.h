@@ -6,9 +6,16 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 /*----------------------- Platform includes --------------------------------*/
+#if __has_include("spinlock.h")
 #include "spinlock.h"
+#endif
+#if __has_include(<sys/lock.h>)
+#include <sys/lock.h>
+#endif
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -17,12 +24,32 @@
 #include "freertos/portmacro.h"
 
 #include "mb_port_types.h"
+#include "port_trace.h"
+#include "port_diag.h"
+#include "port_stats.h"
+#include "port_log.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define MB_SER_PDU_SIZE_MIN             (3)
+#define MB_SER_FIXED_TIMING_BAUD        (19200UL)                      // The fixed frame timing is used above this baud rate
+#define MB_SER_FIXED_T15_US             (750UL)
+#define MB_SER_FIXED_T35_US             (1750UL)
+
+// The time in microseconds of the given number of characters (x2 to allow 1.5 and 3.5)
+// for the character of the given number of bits (x2 to allow 1.5 stop bits), rounded up
+#define MB_SER_GET_CHARS_TIME_US(chars_x2, bits_x2, baudrate) \
+    ((uint32_t)((((uint64_t)(chars_x2) * (bits_x2) * 250000UL) + (baudrate) - 1) / (baudrate)))
+
+// T1.5 and T3.5 intervals in microseconds, the fixed values are applied if the option is enabled
+#define MB_SER_GET_T15_US(bits_x2, baudrate) \
+    ((MB_SERIAL_FIXED_FRAME_TIMING_ENABLED && ((baudrate) > MB_SER_FIXED_TIMING_BAUD)) \
+        ? MB_SER_FIXED_T15_US : MB_SER_GET_CHARS_TIME_US(3, (bits_x2), (baudrate)))
+#define MB_SER_GET_T35_US(bits_x2, baudrate) \
+    ((MB_SERIAL_FIXED_FRAME_TIMING_ENABLED && ((baudrate) > MB_SER_FIXED_TIMING_BAUD)) \
+        ? MB_SER_FIXED_T35_US : MB_SER_GET_CHARS_TIME_US(7, (bits_x2), (baudrate)))
 #define MB_TIMER_TICS_PER_MS            (20UL)                         // Define number of timer reloads per 1 mS
 #define MB_TIMER_TICK_TIME_US           (1000 / MB_TIMER_TICS_PER_MS) // 50uS = one discreet for timer
 #define MB_EVENT_QUEUE_TIMEOUT_MAX_MS   (3000)
@@ -30,6 +57,25 @@ extern "C" {
 #define MB_EVENT_QUEUE_TIMEOUT_MAX      (pdMS_TO_TICKS(MB_EVENT_QUEUE_TIMEOUT_MAX_MS))
 #define MB_MS_TO_TICKS(time_ms)         (pdMS_TO_TICKS(time_ms))
 
+#if !__has_include(<sys/lock.h>)
+
+// The host C library (linux target) does not provide the newlib locks,
+// they are implemented over the FreeRTOS mutexes the same way as in newlib port
+#define MB_PORT_LOCK_EMULATED           (1)
+
+typedef intptr_t _lock_t;
+
+void _lock_init(_lock_t *lock);
+void _lock_close(_lock_t *lock);
+void _lock_acquire(_lock_t *lock);
+void _lock_release(_lock_t *lock);
+
+#endif
+
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
+
 int lock_obj(_lock_t *lock_ptr);
 void unlock_obj(_lock_t *lock_ptr);
 
@@ -136,6 +182,17 @@ typedef struct
 
 typedef struct mb_port_event_t mb_port_event_t;
 typedef struct mb_port_timer_t mb_port_timer_t;
+
+// The round trip time statistics of the slave measured by master port
+typedef struct
+{
+    uint32_t srtt_us;     /*!< Smoothed round trip time */
+    uint32_t rttvar_us;   /*!< Round trip time variance */
+    uint32_t last_rtt_us; /*!< Last measured round trip time */
+    uint32_t rto_ms;      /*!< Respond timeout of the next request to the slave */
+    uint32_t samples;     /*!< Number of measured responses */
+    uint32_t timeouts;    /*!< Number of respond timeouts */
+} mb_port_rtt_stats_t;
 typedef struct obj_descr_s obj_descr_t;
 
 typedef struct frame_queue_entry_s
@@ -157,6 +214,15 @@ struct mb_port_base_t
 
     mb_port_event_t *event_obj;
     mb_port_timer_t *timer_obj;
+#if CONFIG_FMB_STAGE_TRACE_EN
+    mb_port_trace_t *trace_obj;
+#endif
+#if CONFIG_FMB_CONTROLLER_SLAVE_DIAG_SUPPORT
+    mb_port_diag_t diag;
+#endif
+#if CONFIG_FMB_STATS_EN
+    mb_port_stats_t *stats_obj;
+#endif
 };
 
 // Port event functions
@@ -169,6 +235,9 @@ void mb_port_event_set_resp_flag(mb_port_base_t *inst, mb_err_event_t event_mask
 void mb_port_event_set_err_type(mb_port_base_t *inst, mb_err_event_t event);
 mb_err_event_t mb_port_event_get_err_type(mb_port_base_t *inst);
 void mb_port_event_delete(mb_port_base_t *inst);
+#if CONFIG_FMB_STATS_EN
+uint32_t mb_port_event_get_queue_hwm(mb_port_base_t *inst);
+#endif
 mb_err_enum_t mb_port_event_wait_req_finish(mb_port_base_t *inst);
 uint64_t mb_port_get_trans_id(mb_port_base_t *inst);
 
@@ -178,12 +247,20 @@ void mb_port_timer_disable(mb_port_base_t *inst);
 void mb_port_timer_enable(mb_port_base_t *inst);
 void mb_port_timer_respond_timeout_enable(mb_port_base_t *inst);
 void mb_port_timer_convert_delay_enable(mb_port_base_t *inst);
+void mb_port_timer_convert_delay_t35_enable(mb_port_base_t *inst);
+void mb_port_timer_send_delay_enable(mb_port_base_t *inst, uint64_t delay_us);
 void mb_port_set_cur_timer_mode(mb_port_base_t *inst, mb_timer_mode_enum_t tmr_mode);
 mb_timer_mode_enum_t mb_port_get_cur_timer_mode(mb_port_base_t *inst);
 void mb_port_timer_set_response_time(mb_port_base_t *inst, uint32_t resp_time_ms);
 uint32_t mb_port_timer_get_response_time_ms(mb_port_base_t *inst);
 void mb_port_timer_delay(mb_port_base_t *inst, uint16_t timeout_ms);
 void mb_port_timer_delete(mb_port_base_t *inst);
+mb_err_enum_t mb_port_timer_rtt_create(mb_port_base_t *inst);
+void mb_port_timer_slave_respond_timeout_enable(mb_port_base_t *inst, uint8_t slave_addr);
+void mb_port_timer_rtt_sample(mb_port_base_t *inst, uint8_t slave_addr, uint64_t rtt_us);
+void mb_port_timer_rtt_stop(mb_port_base_t *inst, uint8_t slave_addr);
+void mb_port_timer_rtt_stop_at(mb_port_base_t *inst, uint8_t slave_addr, int64_t recv_time_us);
+mb_err_enum_t mb_port_timer_get_rtt_stats(mb_port_base_t *inst, uint8_t slave_addr, mb_port_rtt_stats_t *stats);
 
 // Common functions to track instance descriptors
 void mb_port_set_inst_counter(uint32_t inst_counter);
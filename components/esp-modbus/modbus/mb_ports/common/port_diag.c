@@ -0,0 +1,124 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include "sdkconfig.h"
+
+#include "port_common.h"
+#include "mb_common.h"
+
+#if MB_FUNC_DIAG_ENABLED
+
+static void mb_port_diag_add_event(mb_port_diag_t *diag, uint8_t event)
+{
+    diag->event_log[diag->event_head % MB_DIAG_EVENT_LOG_SIZE] = event;
+    diag->event_head++;
+}
+
+uint16_t mb_port_diag_get_counter(mb_port_base_t *inst, mb_diag_cnt_t cnt)
+{
+    if (!inst || (cnt >= MB_DIAG_CNT_MAX)) {
+        return 0;
+    }
+    // The counters of the protocol are 16 bit and roll over
+    return (uint16_t)atomic_load_explicit(&inst->diag.counters[cnt], memory_order_relaxed);
+}
+
+void mb_port_diag_clear(mb_port_base_t *inst, bool clear_log)
+{
+    for (int i = 0; i < MB_DIAG_CNT_MAX; i++) {
+        atomic_store_explicit(&inst->diag.counters[i], 0, memory_order_relaxed);
+    }
+    atomic_store(&inst->diag.overrun, false);
+    if (clear_log) {
+        inst->diag.event_head = 0;
+    }
+}
+
+void mb_port_diag_restart(mb_port_base_t *inst, bool clear_log)
+{
+    // The instance keeps running, the restart leaves the listen only mode and clears the counters
+    atomic_store(&inst->diag.listen_only, false);
+    mb_port_diag_clear(inst, clear_log);
+    mb_port_diag_add_event(&inst->diag, MB_DIAG_EV_RESTART);
+}
+
+void mb_port_diag_set_overrun(mb_port_base_t *inst)
+{
+    MB_DIAG_INC(inst, MB_DIAG_BUS_CHAR_OVERRUN_CNT);
+    atomic_store(&inst->diag.overrun, true);
+}
+
+void mb_port_diag_clear_overrun(mb_port_base_t *inst)
+{
+    atomic_store_explicit(&inst->diag.counters[MB_DIAG_BUS_CHAR_OVERRUN_CNT], 0, memory_order_relaxed);
+    atomic_store(&inst->diag.overrun, false);
+}
+
+void mb_port_diag_set_listen_only(mb_port_base_t *inst)
+{
+    atomic_store(&inst->diag.listen_only, true);
+    mb_port_diag_add_event(&inst->diag, MB_DIAG_EV_LISTEN_ONLY);
+}
+
+bool mb_port_diag_is_listen_only(mb_port_base_t *inst)
+{
+    return atomic_load_explicit(&inst->diag.listen_only, memory_order_relaxed);
+}
+
+void mb_port_diag_rcv_event(mb_port_base_t *inst, bool is_broadcast, bool is_comm_err)
+{
+    uint8_t event = MB_DIAG_EV_RCV;
+    event |= is_comm_err ? MB_DIAG_EV_RCV_COMM_ERR : 0;
+    event |= is_broadcast ? MB_DIAG_EV_RCV_BROADCAST : 0;
+    event |= atomic_load(&inst->diag.listen_only) ? MB_DIAG_EV_RCV_LISTEN_ONLY : 0;
+    // The overrun is reported once with the next received request
+    event |= atomic_exchange(&inst->diag.overrun, false) ? MB_DIAG_EV_RCV_OVERRUN : 0;
+    mb_port_diag_add_event(&inst->diag, event);
+}
+
+void mb_port_diag_send_event(mb_port_base_t *inst, uint8_t exception)
+{
+    uint8_t event = MB_DIAG_EV_SEND;
+    switch (exception) {
+        case MB_EX_NONE:
+            break;
+        case MB_EX_ILLEGAL_FUNCTION:
+        case MB_EX_ILLEGAL_DATA_ADDRESS:
+        case MB_EX_ILLEGAL_DATA_VALUE:
+            event |= MB_DIAG_EV_SEND_READ_EX;
+            break;
+        case MB_EX_SLAVE_DEVICE_FAILURE:
+            event |= MB_DIAG_EV_SEND_ABORT_EX;
+            break;
+        case MB_EX_ACKNOWLEDGE:
+        case MB_EX_SLAVE_BUSY:
+            event |= MB_DIAG_EV_SEND_BUSY_EX;
+            break;
+        case MB_EX_NEGATIVE_ACKNOWLEDGE:
+            event |= MB_DIAG_EV_SEND_NAK_EX;
+            break;
+        default:
+            event |= MB_DIAG_EV_SEND_ABORT_EX;
+            break;
+    }
+    event |= atomic_load(&inst->diag.listen_only) ? MB_DIAG_EV_SEND_LISTEN_ONLY : 0;
+    mb_port_diag_add_event(&inst->diag, event);
+}
+
+uint8_t mb_port_diag_get_log(mb_port_base_t *inst, uint8_t *events, uint8_t max_count)
+{
+    uint32_t head = inst->diag.event_head;
+    uint32_t count = (head < MB_DIAG_EVENT_LOG_SIZE) ? head : MB_DIAG_EVENT_LOG_SIZE;
+    count = (count < max_count) ? count : max_count;
+    for (uint32_t i = 0; i < count; i++) {
+        events[i] = inst->diag.event_log[(head - 1 - i) % MB_DIAG_EVENT_LOG_SIZE];
+    }
+    return (uint8_t)count;
+}
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The diagnostic counters of the instance, the order matches the
+ *        sub-functions 0x0B - 0x12 of the Diagnostics (0x08) function
+ */
+typedef enum {
+    MB_DIAG_BUS_MSG_CNT = 0,        /*!< The messages detected on the bus, including the messages for other slaves */
+    MB_DIAG_BUS_COMM_ERR_CNT,       /*!< The messages with CRC or LRC error */
+    MB_DIAG_BUS_EXCEPTION_CNT,      /*!< The exception responses returned by the slave */
+    MB_DIAG_SLAVE_MSG_CNT,          /*!< The messages addressed to the slave, including broadcast */
+    MB_DIAG_SLAVE_NO_RESP_CNT,      /*!< The messages addressed to the slave without response */
+    MB_DIAG_SLAVE_NAK_CNT,          /*!< The negative acknowledge exceptions returned by the slave */
+    MB_DIAG_SLAVE_BUSY_CNT,         /*!< The slave busy exceptions returned by the slave */
+    MB_DIAG_BUS_CHAR_OVERRUN_CNT,   /*!< The character overruns of the receiver */
+    MB_DIAG_COMM_EVENT_CNT,         /*!< The successfully completed requests (Get Comm Event Counter) */
+    MB_DIAG_CNT_MAX
+} mb_diag_cnt_t;
+
+#define MB_DIAG_EVENT_LOG_SIZE          (64)
+
+// The bits of the communication event log entries
+#define MB_DIAG_EV_RCV                  (0x80)  /*!< The request is received */
+#define MB_DIAG_EV_RCV_COMM_ERR         (0x02)
+#define MB_DIAG_EV_RCV_OVERRUN          (0x10)
+#define MB_DIAG_EV_RCV_LISTEN_ONLY      (0x20)
+#define MB_DIAG_EV_RCV_BROADCAST        (0x40)
+#define MB_DIAG_EV_SEND                 (0x40)  /*!< The request is processed */
+#define MB_DIAG_EV_SEND_READ_EX         (0x01)
+#define MB_DIAG_EV_SEND_ABORT_EX        (0x02)
+#define MB_DIAG_EV_SEND_BUSY_EX         (0x04)
+#define MB_DIAG_EV_SEND_NAK_EX          (0x08)
+#define MB_DIAG_EV_SEND_LISTEN_ONLY     (0x20)
+#define MB_DIAG_EV_LISTEN_ONLY          (0x04)  /*!< The slave entered the listen only mode */
+#define MB_DIAG_EV_RESTART              (0x00)  /*!< The communication is restarted */
+
+/**
+ * @brief The diagnostic state of the instance, the counters are updated from the port
+ *        task and from the FSM task, the event log is updated from the FSM task only.
+ */
+typedef struct {
+    _Atomic(uint32_t) counters[MB_DIAG_CNT_MAX];
+    _Atomic(bool) listen_only;
+    _Atomic(bool) overrun;
+    uint32_t event_head;
+    uint8_t event_log[MB_DIAG_EVENT_LOG_SIZE];
+} mb_port_diag_t;
+
+typedef struct mb_port_base_t mb_port_base_t;
+
+#if CONFIG_FMB_CONTROLLER_SLAVE_DIAG_SUPPORT
+
+static inline void mb_port_diag_inc(mb_port_diag_t *diag, mb_diag_cnt_t cnt)
+{
+    atomic_fetch_add_explicit(&diag->counters[cnt], 1, memory_order_relaxed);
+}
+
+#define MB_DIAG_INC(inst, cnt) mb_port_diag_inc(&((mb_port_base_t *)(inst))->diag, (cnt))
+
+uint16_t mb_port_diag_get_counter(mb_port_base_t *inst, mb_diag_cnt_t cnt);
+void mb_port_diag_clear(mb_port_base_t *inst, bool clear_log);
+void mb_port_diag_restart(mb_port_base_t *inst, bool clear_log);
+void mb_port_diag_set_overrun(mb_port_base_t *inst);
+void mb_port_diag_clear_overrun(mb_port_base_t *inst);
+void mb_port_diag_set_listen_only(mb_port_base_t *inst);
+bool mb_port_diag_is_listen_only(mb_port_base_t *inst);
+void mb_port_diag_rcv_event(mb_port_base_t *inst, bool is_broadcast, bool is_comm_err);
+void mb_port_diag_send_event(mb_port_base_t *inst, uint8_t exception);
+
+/**
+ * @brief Copy the communication event log, the most recent event is the first
+ *
+ * @param inst the port instance
+ * @param events the buffer for the events
+ * @param max_count the size of buffer
+ * @return the number of copied events
+ */
+uint8_t mb_port_diag_get_log(mb_port_base_t *inst, uint8_t *events, uint8_t max_count);
+
+#else
+
+#define MB_DIAG_INC(inst, cnt) ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
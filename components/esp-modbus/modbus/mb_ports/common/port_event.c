@@ -16,15 +16,193 @@
 
 static const char *TAG = "mb_port.event";
 
+// The task notification entry used to wake up the task waiting for the events, the entry 0 is used
+// by the port tasks, so the binary semaphore is used instead if the task has only one entry
+// (configTASK_NOTIFICATION_ARRAY_ENTRIES == 1). Both ways are the plain wake up, the events are read from the ring
+#if (configTASK_NOTIFICATION_ARRAY_ENTRIES > 1)
+#define MB_EVENT_USE_NOTIFY 1
+#define MB_EVENT_NOTIFY_INDEX (configTASK_NOTIFICATION_ARRAY_ENTRIES - 1)
+#else
+#define MB_EVENT_USE_NOTIFY 0
+#endif
+
+typedef struct
+{
+    _Atomic(uint32_t) seq;
+    mb_event_t event;
+} mb_event_cell_t;
+
+// Bounded lock free ring of the event payloads, it can be written from several tasks and ISRs
+typedef struct
+{
+    _Atomic(uint32_t) enq_pos;
+    _Atomic(uint32_t) deq_pos;
+    uint32_t mask;
+    mb_event_cell_t *cells;
+#if MB_STATS_ENABLED
+    _Atomic(uint32_t) max_depth;            // the high water mark of the ring
+#endif
+} mb_event_ring_t;
+
 struct mb_port_event_t
 {
     _Atomic(int) curr_err_type;
     SemaphoreHandle_t resource_hdl;
     EventGroupHandle_t event_group_hdl;
-    QueueHandle_t event_hdl;
+    mb_event_ring_t ring;
+    _Atomic(TaskHandle_t) wait_task_hdl;    // the task which gets the events
+#if !MB_EVENT_USE_NOTIFY
+    SemaphoreHandle_t wake_sema_hdl;        // wakes up the waiting task when the notification entry is not available
+#endif
+    SemaphoreHandle_t space_sema_hdl;       // wakes up the posting task waiting for the free cell of the ring
+    _Atomic(uint32_t) full_waiters;         // the number of tasks waiting for the free cell
+    bool chain_pending;                     // the event is posted by the waiting task itself
+    mb_event_t chain_event;
     _Atomic(uint64_t) curr_trans_id;
 };
 
+static bool mb_event_ring_init(mb_event_ring_t *ring, uint32_t size)
+{
+    uint32_t ring_size = 1;
+    while (ring_size < size) {
+        ring_size <<= 1;
+    }
+    ring->cells = (mb_event_cell_t *)calloc(ring_size, sizeof(mb_event_cell_t));
+    if (!ring->cells) {
+        return false;
+    }
+    for (uint32_t i = 0; i < ring_size; i++) {
+        atomic_init(&ring->cells[i].seq, i);
+    }
+    ring->mask = ring_size - 1;
+    atomic_init(&ring->enq_pos, 0);
+    atomic_init(&ring->deq_pos, 0);
+#if MB_STATS_ENABLED
+    atomic_init(&ring->max_depth, 0);
+#endif
+    return true;
+}
+
+static bool IRAM_ATTR mb_event_ring_push(mb_event_ring_t *ring, const mb_event_t *event)
+{
+    mb_event_cell_t *cell = NULL;
+    uint32_t pos = atomic_load_explicit(&ring->enq_pos, memory_order_relaxed);
+    while (1) {
+        cell = &ring->cells[pos & ring->mask];
+        int32_t diff = (int32_t)(atomic_load_explicit(&cell->seq, memory_order_acquire) - pos);
+        if (diff == 0) {
+            // The cell is free, try to take it
+            if (atomic_compare_exchange_weak_explicit(&ring->enq_pos, &pos, pos + 1,
+                                                        memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The ring is full
+            return false;
+        } else {
+            pos = atomic_load_explicit(&ring->enq_pos, memory_order_relaxed);
+        }
+    }
+    cell->event = *event;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+#if MB_STATS_ENABLED
+    uint32_t depth = pos + 1 - atomic_load_explicit(&ring->deq_pos, memory_order_relaxed);
+    uint32_t max_depth = atomic_load_explicit(&ring->max_depth, memory_order_relaxed);
+    while ((depth > max_depth)
+            && !atomic_compare_exchange_weak_explicit(&ring->max_depth, &max_depth, depth,
+                                                        memory_order_relaxed, memory_order_relaxed)) {
+    }
+#endif
+    return true;
+}
+
+static bool mb_event_ring_pop(mb_event_ring_t *ring, mb_event_t *event)
+{
+    mb_event_cell_t *cell = NULL;
+    uint32_t pos = atomic_load_explicit(&ring->deq_pos, memory_order_relaxed);
+    while (1) {
+        cell = &ring->cells[pos & ring->mask];
+        int32_t diff = (int32_t)(atomic_load_explicit(&cell->seq, memory_order_acquire) - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->deq_pos, &pos, pos + 1,
+                                                        memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The ring is empty or the event is not completely written yet,
+            // the writer notifies the task when it is done
+            return false;
+        } else {
+            pos = atomic_load_explicit(&ring->deq_pos, memory_order_relaxed);
+        }
+    }
+    *event = cell->event;
+    atomic_store_explicit(&cell->seq, pos + ring->mask + 1, memory_order_release);
+    return true;
+}
+
+static inline bool mb_event_ring_is_empty(mb_event_ring_t *ring)
+{
+    return (atomic_load(&ring->enq_pos) == atomic_load(&ring->deq_pos));
+}
+
+// Wake up the task waiting for the events, returns true if the higher priority task is woken from ISR
+static bool IRAM_ATTR mb_event_wake(mb_port_event_t *event_obj, TaskHandle_t task_hdl)
+{
+    BaseType_t high_prio_task_woken = pdFALSE;
+#if MB_EVENT_USE_NOTIFY
+    if (xPortInIsrContext()) {
+        vTaskNotifyGiveIndexedFromISR(task_hdl, MB_EVENT_NOTIFY_INDEX, &high_prio_task_woken);
+    } else {
+        (void)xTaskNotifyGiveIndexed(task_hdl, MB_EVENT_NOTIFY_INDEX);
+    }
+#else
+    (void)task_hdl;
+    if (xPortInIsrContext()) {
+        (void)xSemaphoreGiveFromISR(event_obj->wake_sema_hdl, &high_prio_task_woken);
+    } else {
+        (void)xSemaphoreGive(event_obj->wake_sema_hdl);
+    }
+#endif
+    return (high_prio_task_woken == pdTRUE);
+}
+
+// Wait for the wake up after the ring is found empty, the posts since the last wait are not lost
+static void mb_event_wait(mb_port_event_t *event_obj, TickType_t ticks)
+{
+#if MB_EVENT_USE_NOTIFY
+    (void)ulTaskNotifyTakeIndexed(MB_EVENT_NOTIFY_INDEX, pdTRUE, ticks);
+#else
+    (void)xSemaphoreTake(event_obj->wake_sema_hdl, ticks);
+#endif
+}
+
+// Wait for the free cell when the ring is full and push the event, the waiting task can not wait for itself
+static bool mb_event_wait_space(mb_port_event_t *event_obj, TaskHandle_t task_hdl, const mb_event_t *event)
+{
+    bool is_pushed = false;
+    if (task_hdl == xTaskGetCurrentTaskHandle()) {
+        return false;
+    }
+    TickType_t start_ticks = xTaskGetTickCount();
+    TickType_t wait_ticks = MB_EVENT_QUEUE_TIMEOUT_MAX;
+    atomic_fetch_add(&event_obj->full_waiters, 1);
+    while (1) {
+        // The counter is set before the retry, so the cell released after the failed push is not missed
+        if (mb_event_ring_push(&event_obj->ring, event)) {
+            is_pushed = true;
+            break;
+        }
+        TickType_t elapsed_ticks = xTaskGetTickCount() - start_ticks;
+        if (elapsed_ticks >= wait_ticks) {
+            break;
+        }
+        (void)xSemaphoreTake(event_obj->space_sema_hdl, (wait_ticks - elapsed_ticks));
+    }
+    atomic_fetch_sub(&event_obj->full_waiters, 1);
+    return is_pushed;
+}
+
 mb_err_enum_t mb_port_event_create(mb_port_base_t *inst)
 {
     mb_port_event_t *event_obj = NULL;
@@ -39,18 +217,47 @@ mb_err_enum_t mb_port_event_create(mb_port_base_t *inst)
     event_obj->event_group_hdl = xEventGroupCreate();
     MB_GOTO_ON_FALSE((event_obj->event_group_hdl), MB_EILLSTATE, error, TAG,
                         "%s, event group create error.", inst->descr.parent_name);
-    event_obj->event_hdl = xQueueCreate(MB_EVENT_QUEUE_SIZE, sizeof(mb_event_t));
-    MB_GOTO_ON_FALSE((event_obj->event_hdl), MB_EILLSTATE, error,  TAG, "%s, event queue create error.", inst->descr.parent_name);
-    vQueueAddToRegistry(event_obj->event_hdl, TAG);
+    MB_GOTO_ON_FALSE(mb_event_ring_init(&event_obj->ring, MB_EVENT_QUEUE_SIZE), MB_EILLSTATE, error,
+                        TAG, "%s, event queue create error.", inst->descr.parent_name);
+#if !MB_EVENT_USE_NOTIFY
+    event_obj->wake_sema_hdl = xSemaphoreCreateBinary();
+    MB_GOTO_ON_FALSE((event_obj->wake_sema_hdl), MB_EILLSTATE, error, TAG,
+                            "%s, mb event wake semaphore create failure.", inst->descr.parent_name);
+#endif
+    event_obj->space_sema_hdl = xSemaphoreCreateBinary();
+    MB_GOTO_ON_FALSE((event_obj->space_sema_hdl), MB_EILLSTATE, error, TAG,
+                            "%s, mb event space semaphore create failure.", inst->descr.parent_name);
+    atomic_init(&event_obj->full_waiters, 0);
+#if MB_STAGE_TRACE_ENABLED
+    MB_GOTO_ON_FALSE((mb_port_trace_create(inst) == MB_ENOERR), MB_EILLSTATE, error,
+                        TAG, "%s, trace ring create error.", inst->descr.parent_name);
+#endif
+#if MB_STATS_ENABLED
+    MB_GOTO_ON_FALSE((mb_port_stats_create(inst) == MB_ENOERR), MB_EILLSTATE, error,
+                        TAG, "%s, stats create error.", inst->descr.parent_name);
+#endif
+    atomic_init(&event_obj->wait_task_hdl, NULL);
+    event_obj->chain_pending = false;
     inst->event_obj = event_obj;
     atomic_init(&event_obj->curr_err_type, EV_ERROR_INIT);
     ESP_LOGD(TAG, "initialized object @%p", event_obj);
     return MB_ENOERR;
 
 error:
-    if(event_obj->event_hdl) {
-        vQueueDelete(event_obj->event_hdl);
-        event_obj->event_hdl = NULL;
+#if MB_STAGE_TRACE_ENABLED
+    mb_port_trace_delete(inst);
+#endif
+    free(event_obj->ring.cells);
+    event_obj->ring.cells = NULL;
+#if !MB_EVENT_USE_NOTIFY
+    if (event_obj->wake_sema_hdl) {
+        vSemaphoreDelete(event_obj->wake_sema_hdl);
+        event_obj->wake_sema_hdl = NULL;
+    }
+#endif
+    if (event_obj->space_sema_hdl) {
+        vSemaphoreDelete(event_obj->space_sema_hdl);
+        event_obj->space_sema_hdl = NULL;
     }
     if (event_obj->event_group_hdl) {
         vEventGroupDelete(event_obj->event_group_hdl);
@@ -77,6 +284,16 @@ inline mb_err_event_t mb_port_event_get_err_type(mb_port_base_t *inst)
     return atomic_load(&inst->event_obj->curr_err_type);
 }
 
+#if MB_STATS_ENABLED
+
+uint32_t mb_port_event_get_queue_hwm(mb_port_base_t *inst)
+{
+    MB_RETURN_ON_FALSE((inst && inst->event_obj), 0, TAG, "incorrect object handle.");
+    return atomic_load_explicit(&inst->event_obj->ring.max_depth, memory_order_relaxed);
+}
+
+#endif
+
 uint64_t mb_port_get_trans_id(mb_port_base_t *inst)
 {
     MB_RETURN_ON_FALSE((inst && inst->event_obj), 0, TAG, "incorrect object handle.");
@@ -86,54 +303,86 @@ uint64_t mb_port_get_trans_id(mb_port_base_t *inst)
 bool mb_port_event_post(mb_port_base_t *inst, mb_event_t event)
 {
     MB_RETURN_ON_FALSE((inst), false, TAG, "incorrect object handle for transaction %" PRIu64, event.trans_id);
-    MB_RETURN_ON_FALSE((inst->event_obj && inst->event_obj->event_hdl), false, TAG, 
+    MB_RETURN_ON_FALSE((inst->event_obj && inst->event_obj->ring.cells), false, TAG, 
                             "Wrong event handle for transaction: %" PRIu64" %d, %p, %s.", 
                             event.trans_id, (int)(event.event), inst, inst->descr.parent_name);
-    BaseType_t result = pdFALSE;
+    mb_port_event_t *event_obj = inst->event_obj;
     mb_event_t temp_event;
     temp_event = event;
-    temp_event.post_ts = esp_timer_get_time();
 
+    // The time stamp is used as an unique identifier of the transaction
     if (event.event & EV_TRANS_START) {
-        atomic_store(&(inst->event_obj->curr_trans_id), temp_event.post_ts);
+        temp_event.post_ts = esp_timer_get_time();
+        atomic_store(&(event_obj->curr_trans_id), temp_event.post_ts);
     }
     temp_event.event = (event.event & ~EV_TRANS_START);
 
     if (xPortInIsrContext()) {
-        BaseType_t high_prio_task_woken = pdFALSE;
-        result = xQueueSendFromISR(inst->event_obj->event_hdl, 
-                                    (const void*)&temp_event, &high_prio_task_woken);
-        // Was the message posted successfully?
-        if (result != pdPASS) {
+        if (!mb_event_ring_push(&event_obj->ring, &temp_event)) {
             ESP_EARLY_LOGV(TAG, "%s, post message %x failure .", inst->descr.parent_name, temp_event.event);
             return false;
-        }    
-        // If high_prio_task_woken is now set to pdTRUE
-        // then a context switch should be requested.
-        if (high_prio_task_woken) {
+        }
+        TaskHandle_t task_hdl = atomic_load(&event_obj->wait_task_hdl);
+        // If the higher priority task is woken then a context switch should be requested
+        if (task_hdl && mb_event_wake(event_obj, task_hdl)) {
             portYIELD_FROM_ISR();
         }
         return true;
     }
-    result = xQueueSend(inst->event_obj->event_hdl, (const void*)&temp_event, MB_EVENT_QUEUE_TIMEOUT_MAX);
-    if (result != pdTRUE) {
-        xQueueReset(inst->event_obj->event_hdl);
+    TaskHandle_t task_hdl = atomic_load(&event_obj->wait_task_hdl);
+    if ((task_hdl == xTaskGetCurrentTaskHandle()) && !event_obj->chain_pending
+            && mb_event_ring_is_empty(&event_obj->ring)) {
+        // The next FSM step is posted by the waiting task itself, it is returned by the next get
+        // without the ring round trip, the order of events is kept as the ring is empty
+        event_obj->chain_event = temp_event;
+        event_obj->chain_pending = true;
+        return true;
+    }
+    if (!mb_event_ring_push(&event_obj->ring, &temp_event)
+            && !mb_event_wait_space(event_obj, task_hdl, &temp_event)) {
         ESP_LOGE(TAG, "%s, post message failure.", inst->descr.parent_name);
         return false;
     }
+    if (task_hdl) {
+        (void)mb_event_wake(event_obj, task_hdl);
+    }
     return true;
 }
 
 bool mb_port_event_get(mb_port_base_t *inst, mb_event_t *event)
 {
-    MB_RETURN_ON_FALSE((inst && event && inst->event_obj && inst->event_obj->event_hdl), false, TAG, 
+    MB_RETURN_ON_FALSE((inst && event && inst->event_obj && inst->event_obj->ring.cells), false, TAG, 
                             "incorrect object handle.");
+    mb_port_event_t *event_obj = inst->event_obj;
     bool event_happened = false;
+    TickType_t start_ticks = xTaskGetTickCount();
+    TickType_t wait_ticks = MB_EVENT_QUEUE_TIMEOUT_MAX;
 
-    if (xQueueReceive(inst->event_obj->event_hdl, event, MB_EVENT_QUEUE_TIMEOUT_MAX) == pdTRUE) {
-        event->trans_id = atomic_load(&inst->event_obj->curr_trans_id);
-        event->get_ts = esp_timer_get_time();
+    // The posting side needs to know the task to notify before the ring is checked
+    atomic_store(&event_obj->wait_task_hdl, xTaskGetCurrentTaskHandle());
+    if (event_obj->chain_pending) {
+        *event = event_obj->chain_event;
+        event_obj->chain_pending = false;
         event_happened = true;
+    }
+    while (!event_happened) {
+        if (mb_event_ring_pop(&event_obj->ring, event)) {
+            if (atomic_load(&event_obj->full_waiters)) {
+                (void)xSemaphoreGive(event_obj->space_sema_hdl);
+            }
+            event_happened = true;
+            break;
+        }
+        TickType_t elapsed_ticks = xTaskGetTickCount() - start_ticks;
+        if (elapsed_ticks >= wait_ticks) {
+            break;
+        }
+        // The notification count (or the semaphore) keeps the posts since the last wait
+        mb_event_wait(event_obj, (wait_ticks - elapsed_ticks));
+    }
+    if (event_happened) {
+        event->trans_id = atomic_load(&event_obj->curr_trans_id);
+        event->get_ts = esp_timer_get_time();
     } else {
         ESP_LOGD(TAG, "%s, get event timeout.", inst->descr.parent_name);
     }
@@ -229,10 +478,22 @@ void mb_port_event_delete(mb_port_base_t *inst)
     if (inst->event_obj->event_group_hdl) {
         vEventGroupDelete(inst->event_obj->event_group_hdl);
     }
-    if(inst->event_obj->event_hdl) {
-        vQueueDelete(inst->event_obj->event_hdl);
-        inst->event_obj->event_hdl = NULL;
+    free(inst->event_obj->ring.cells);
+    inst->event_obj->ring.cells = NULL;
+#if !MB_EVENT_USE_NOTIFY
+    if (inst->event_obj->wake_sema_hdl) {
+        vSemaphoreDelete(inst->event_obj->wake_sema_hdl);
+    }
+#endif
+    if (inst->event_obj->space_sema_hdl) {
+        vSemaphoreDelete(inst->event_obj->space_sema_hdl);
     }
+#if MB_STAGE_TRACE_ENABLED
+    mb_port_trace_delete(inst);
+#endif
+#if MB_STATS_ENABLED
+    mb_port_stats_delete(inst);
+#endif
     free(inst->event_obj);
     inst->event_obj = NULL;
 }
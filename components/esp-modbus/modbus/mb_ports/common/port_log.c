@@ -0,0 +1,219 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "port_common.h"
+#include "mb_common.h"
+
+#if MB_TRACE_DEFERRED_ENABLED
+
+_Static_assert(((MB_TRACE_DEFERRED_RING_SIZE & (MB_TRACE_DEFERRED_RING_SIZE - 1)) == 0),
+                "The size of deferred log ring must be the power of two.");
+
+#define MB_TRACE_LOG_MSG_SIZE   (160)
+#define MB_TRACE_BUF_FORMAT     "%s (%u bytes) %02x %02x %02x %02x %02x %02x %02x %02x"
+
+// The string arguments keep the offset in the strs buffer, the bit of str_mask is set for each of them
+typedef struct
+{
+    uint32_t time_us;
+    const char *tag;
+    const char *format;
+    uint8_t level;
+    uint8_t nargs;
+    uint8_t str_mask;
+    uintptr_t args[MB_TRACE_ARGS_MAX];
+    char strs[MB_TRACE_STR_SIZE];
+} mb_trace_log_record_t;
+
+// The slot keeps the sequence number of the message written into it, the zero value means
+// the message is being written (the sequence numbers start from one)
+typedef struct
+{
+    _Atomic(uint32_t) seq;
+    mb_trace_log_record_t record;
+} mb_trace_log_slot_t;
+
+static _Atomic(uint32_t) s_log_head = 1;
+static uint32_t s_log_tail = 1;
+static mb_trace_log_slot_t s_log_slots[MB_TRACE_DEFERRED_RING_SIZE];
+
+static inline mb_trace_log_record_t *mb_trace_log_begin(uint32_t *seq)
+{
+    *seq = atomic_fetch_add(&s_log_head, 1);
+    mb_trace_log_slot_t *slot = &s_log_slots[*seq & (MB_TRACE_DEFERRED_RING_SIZE - 1)];
+    // Invalidate the slot while it is overwritten to let the reader drop the torn message
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->record.time_us = (uint32_t)esp_timer_get_time();
+    return &slot->record;
+}
+
+static inline void mb_trace_log_end(uint32_t seq)
+{
+    atomic_store_explicit(&s_log_slots[seq & (MB_TRACE_DEFERRED_RING_SIZE - 1)].seq, seq, memory_order_release);
+}
+
+static inline bool IRAM_ATTR mb_trace_log_is_spec_char(char chr)
+{
+    return ((chr >= '0') && (chr <= '9')) || (chr == '-') || (chr == '+') || (chr == ' ') || (chr == '#')
+            || (chr == '.') || (chr == '*') || (chr == 'h') || (chr == 'l') || (chr == 'z') || (chr == 'j')
+            || (chr == 't') || (chr == 'L');
+}
+
+// Returns the mask of the arguments converted by %s, the strings may be freed before the message is flushed
+static uint8_t IRAM_ATTR mb_trace_log_get_str_mask(const char *format, uint8_t nargs)
+{
+    uint8_t mask = 0;
+    uint8_t arg = 0;
+    for (const char *ptr = format; *ptr && (arg < nargs); ptr++) {
+        if (*ptr != '%') {
+            continue;
+        }
+        if (*(++ptr) == '%') {
+            continue;
+        }
+        for (; *ptr && mb_trace_log_is_spec_char(*ptr); ptr++) {
+            arg += (*ptr == '*') ? 1 : 0;
+        }
+        if (!*ptr) {
+            break;
+        }
+        mask |= ((*ptr == 's') && (arg < nargs)) ? (uint8_t)(1 << arg) : 0;
+        arg++;
+    }
+    return mask;
+}
+
+// Copies the string truncated to the free space, returns the position after the terminating zero
+static size_t IRAM_ATTR mb_trace_log_copy_str(char *strs, size_t pos, const char *str)
+{
+    str = str ? str : "(null)";
+    while (*str && (pos < (MB_TRACE_STR_SIZE - 1))) {
+        strs[pos++] = *str++;
+    }
+    strs[pos] = '\0';
+    return (pos < (MB_TRACE_STR_SIZE - 1)) ? (pos + 1) : pos;
+}
+
+void IRAM_ATTR mb_trace_log_write(esp_log_level_t level, const char *tag, const char *format, uint8_t nargs, const uintptr_t *args)
+{
+    uint32_t seq = 0;
+    mb_trace_log_record_t *record = mb_trace_log_begin(&seq);
+    record->tag = tag;
+    record->format = format;
+    record->level = (uint8_t)level;
+    record->nargs = (nargs < MB_TRACE_ARGS_MAX) ? nargs : MB_TRACE_ARGS_MAX;
+    record->str_mask = mb_trace_log_get_str_mask(format, record->nargs);
+    size_t pos = 0;
+    for (int i = 0; i < record->nargs; i++) {
+        record->args[i] = args[i];
+        if (record->str_mask & (1 << i)) {
+            record->args[i] = pos;
+            pos = mb_trace_log_copy_str(record->strs, pos, (const char *)args[i]);
+        }
+    }
+    mb_trace_log_end(seq);
+}
+
+void IRAM_ATTR mb_trace_log_write_buf(esp_log_level_t level, const char *tag, const char *message,
+                                        const uint8_t *buffer, uint16_t length)
+{
+    uint32_t seq = 0;
+    mb_trace_log_record_t *record = mb_trace_log_begin(&seq);
+    // The prefix (the tag) and the message are copied, the prefix is usually the name of the object
+    record->tag = NULL;
+    record->format = NULL;
+    record->level = (uint8_t)level;
+    record->nargs = 0;
+    record->str_mask = 0;
+    record->args[0] = length;
+    record->args[MB_TRACE_ARGS_MAX - 1] = mb_trace_log_copy_str(record->strs, 0, tag);
+    (void)mb_trace_log_copy_str(record->strs, record->args[MB_TRACE_ARGS_MAX - 1], message);
+    // The first bytes of the buffer are packed into the arguments
+    uint8_t *bytes = (uint8_t *)&record->args[1];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (buffer && (i < length)) ? buffer[i] : 0;
+    }
+    mb_trace_log_end(seq);
+}
+
+static void mb_trace_log_print(const mb_trace_log_record_t *record)
+{
+    static const char letters[] = {'N', 'E', 'W', 'I', 'D', 'V'};
+    char msg[MB_TRACE_LOG_MSG_SIZE];
+    const char *tag = record->tag;
+    uintptr_t args[MB_TRACE_ARGS_MAX];
+    // The offsets of the copied strings are replaced by the pointers
+    for (int i = 0; i < MB_TRACE_ARGS_MAX; i++) {
+        args[i] = (record->str_mask & (1 << i)) ? (uintptr_t)&record->strs[record->args[i]] : record->args[i];
+    }
+    if (record->format) {
+        // The arguments are passed as the machine words, the unused ones are ignored by the format
+        (void)snprintf(msg, sizeof(msg), record->format,
+                        args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]);
+    } else {
+        const uint8_t *bytes = (const uint8_t *)&args[1];
+        tag = record->strs;
+        (void)snprintf(msg, sizeof(msg), MB_TRACE_BUF_FORMAT, &record->strs[args[MB_TRACE_ARGS_MAX - 1]], (unsigned)args[0],
+                        bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5], bytes[6], bytes[7]);
+    }
+    esp_log_level_t level = (esp_log_level_t)record->level;
+    esp_log_write(level, tag, "%c (%" PRIu32 ") %s: %s\n",
+                    letters[(level <= ESP_LOG_VERBOSE) ? level : ESP_LOG_VERBOSE],
+                    record->time_us / 1000, tag, msg);
+}
+
+int mb_trace_log_flush(uint16_t max_count)
+{
+    mb_trace_log_record_t record;
+    uint32_t lost = 0;
+    int count = 0;
+    uint32_t head = atomic_load(&s_log_head);
+    // The messages older than the ring size are overwritten already
+    if ((head - s_log_tail) > MB_TRACE_DEFERRED_RING_SIZE) {
+        lost += (head - s_log_tail) - MB_TRACE_DEFERRED_RING_SIZE;
+        s_log_tail = head - MB_TRACE_DEFERRED_RING_SIZE;
+    }
+    while ((s_log_tail != head) && (!max_count || (count < max_count))) {
+        mb_trace_log_slot_t *slot = &s_log_slots[s_log_tail & (MB_TRACE_DEFERRED_RING_SIZE - 1)];
+        uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq == 0) {
+            // The message is being written now, print it next time
+            break;
+        }
+        record = slot->record;
+        atomic_thread_fence(memory_order_acquire);
+        if ((seq != s_log_tail) || (atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq)) {
+            lost++;
+        } else {
+            mb_trace_log_print(&record);
+            count++;
+        }
+        s_log_tail++;
+    }
+    if (lost) {
+        ESP_LOGW("mb_trace", "%" PRIu32 " deferred messages are lost.", lost);
+    }
+    return count;
+}
+
+#else
+
+int mb_trace_log_flush(uint16_t max_count)
+{
+    (void)max_count;
+    return -1;
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MB_TRACE_ARGS_MAX           (8)     /*!< The maximum number of arguments of the deferred message */
+#define MB_TRACE_TAG_SIZE           (64)    /*!< The size of buffer for the tag of the hex dump */
+#define MB_TRACE_STR_SIZE           (48)    /*!< The size of buffer for the string arguments of the deferred message */
+
+/**
+ * @brief The hot path log macros of the stack
+ *
+ * The messages above CONFIG_FMB_TRACE_LEVEL are removed by the compiler, the arguments are not evaluated.
+ * The messages at or below the level are printed with ESP_LOG_LEVEL_LOCAL() or, if CONFIG_FMB_TRACE_DEFERRED_EN
+ * is set, the format string and raw arguments are stored into the ring and formatted later by mb_trace_log_flush().
+ * The deferred messages take up to MB_TRACE_ARGS_MAX integer or pointer arguments (the 64 bit values are not
+ * supported), the strings of the %s arguments are copied into the message and truncated to fit MB_TRACE_STR_SIZE
+ * bytes in total.
+ */
+#define MB_TRACE(level, tag, format, ...) do {                                                  \
+        if ((level) <= CONFIG_FMB_TRACE_LEVEL) {                                                \
+            MB_TRACE_OUT(level, tag, format __VA_OPT__(,) __VA_ARGS__);                         \
+        }                                                                                       \
+    } while(0)
+
+#define MB_TRACEE(tag, format, ...) MB_TRACE(ESP_LOG_ERROR, tag, format __VA_OPT__(,) __VA_ARGS__)
+#define MB_TRACEW(tag, format, ...) MB_TRACE(ESP_LOG_WARN, tag, format __VA_OPT__(,) __VA_ARGS__)
+#define MB_TRACEI(tag, format, ...) MB_TRACE(ESP_LOG_INFO, tag, format __VA_OPT__(,) __VA_ARGS__)
+#define MB_TRACED(tag, format, ...) MB_TRACE(ESP_LOG_DEBUG, tag, format __VA_OPT__(,) __VA_ARGS__)
+#define MB_TRACEV(tag, format, ...) MB_TRACE(ESP_LOG_VERBOSE, tag, format __VA_OPT__(,) __VA_ARGS__)
+
+/**
+ * @brief The hex dump of the buffer in the hot path tagged with the prefix and message (as MB_PRT_BUF),
+ *        the deferred message keeps the length and first 8 bytes of the buffer only
+ */
+#define MB_TRACE_BUF(pref, message, buffer, length, level) do {                                 \
+        if ((level) <= CONFIG_FMB_TRACE_LEVEL) {                                                \
+            MB_TRACE_BUF_OUT(pref, message, buffer, length, level);                             \
+        }                                                                                       \
+    } while(0)
+
+#if CONFIG_FMB_TRACE_DEFERRED_EN
+
+#define MB_TRACE_CAT_(a, b) a##b
+#define MB_TRACE_CAT(a, b) MB_TRACE_CAT_(a, b)
+#define MB_TRACE_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define MB_TRACE_NARGS(...) MB_TRACE_NARGS_(0 __VA_OPT__(,) __VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+// The argument is stored as is, the values wider than the pointer can not be stored
+// (the conditional operator converts the arrays to pointers)
+#define MB_TRACE_ARG(a) ((uintptr_t)(a) + 0 * sizeof(char[(sizeof(1 ? (a) : (a)) <= sizeof(uintptr_t)) ? 1 : -1]))
+#define MB_TRACE_MAP_0()
+#define MB_TRACE_MAP_1(a) , MB_TRACE_ARG(a)
+#define MB_TRACE_MAP_2(a, ...) , MB_TRACE_ARG(a) MB_TRACE_MAP_1(__VA_ARGS__)
+#define MB_TRACE_MAP_3(a, ...) , MB_TRACE_ARG(a) MB_TRACE_MAP_2(__VA_ARGS__)
+#define MB_TRACE_MAP_4(a, ...) , MB_TRACE_ARG(a) MB_TRACE_MAP_3(__VA_ARGS__)
+#define MB_TRACE_MAP_5(a, ...) , MB_TRACE_ARG(a) MB_TRACE_MAP_4(__VA_ARGS__)
+#define MB_TRACE_MAP_6(a, ...) , MB_TRACE_ARG(a) MB_TRACE_MAP_5(__VA_ARGS__)
+#define MB_TRACE_MAP_7(a, ...) , MB_TRACE_ARG(a) MB_TRACE_MAP_6(__VA_ARGS__)
+#define MB_TRACE_MAP_8(a, ...) , MB_TRACE_ARG(a) MB_TRACE_MAP_7(__VA_ARGS__)
+#define MB_TRACE_MAP(...) MB_TRACE_CAT(MB_TRACE_MAP_, MB_TRACE_NARGS(__VA_ARGS__))(__VA_ARGS__)
+
+#define MB_TRACE_OUT(level, tag, format, ...) do {                                              \
+        const uintptr_t mb_trace_args_[] = { 0 MB_TRACE_MAP(__VA_ARGS__) };                     \
+        mb_trace_log_write((level), (tag), (format),                                            \
+                            MB_TRACE_NARGS(__VA_ARGS__), &mb_trace_args_[1]);                   \
+    } while(0)
+
+#define MB_TRACE_BUF_OUT(pref, message, buffer, length, level)                                  \
+        mb_trace_log_write_buf((level), (pref), (message), (const uint8_t *)(buffer), (uint16_t)(length))
+
+/**
+ * @brief Store the message into the deferred log ring, the function does not format the message
+ *        and does not block, the oldest messages are overwritten
+ */
+void mb_trace_log_write(esp_log_level_t level, const char *tag, const char *format, uint8_t nargs, const uintptr_t *args);
+void mb_trace_log_write_buf(esp_log_level_t level, const char *tag, const char *message, const uint8_t *buffer, uint16_t length);
+
+#else
+
+#define MB_TRACE_OUT(level, tag, format, ...) ESP_LOG_LEVEL_LOCAL(level, tag, format __VA_OPT__(,) __VA_ARGS__)
+#define MB_TRACE_BUF_OUT(pref, message, buffer, length, level) do {                             \
+        char mb_trace_tag_[MB_TRACE_TAG_SIZE];                                                  \
+        (void)snprintf(mb_trace_tag_, sizeof(mb_trace_tag_), "%s%s", (pref), (message));        \
+        ESP_LOG_BUFFER_HEX_LEVEL(mb_trace_tag_, (buffer), (length), (level));                   \
+    } while(0)
+
+#endif
+
+/**
+ * @brief Format and print the messages stored in the deferred log ring,
+ *        the function is expected to be called from one task only
+ *
+ * @param max_count the maximum number of messages to print, zero means all stored messages
+ * @return the number of printed messages or -1 if the deferred log is disabled
+ */
+int mb_trace_log_flush(uint16_t max_count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,7 +6,7 @@
 #include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
-#include "sys/lock.h"
+#include "freertos/semphr.h"
 
 #include "port_common.h"
 
@@ -14,6 +14,46 @@
 static _Atomic(uint32_t) inst_counter = 0;
 
 /* ----------------------- Start implementation -----------------------------*/
+#if MB_PORT_LOCK_EMULATED
+
+void _lock_init(_lock_t *lock)
+{
+    *lock = (_lock_t)xSemaphoreCreateMutex();
+}
+
+void _lock_close(_lock_t *lock)
+{
+    if (*lock) {
+        vSemaphoreDelete((SemaphoreHandle_t)*lock);
+        *lock = 0;
+    }
+}
+
+void _lock_acquire(_lock_t *lock)
+{
+    if (!*lock) {
+        // The static locks are created on first use
+        SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+        vTaskSuspendAll();
+        if (!*lock) {
+            *lock = (_lock_t)mutex;
+            mutex = NULL;
+        }
+        (void)xTaskResumeAll();
+        if (mutex) {
+            vSemaphoreDelete(mutex);
+        }
+    }
+    (void)xSemaphoreTake((SemaphoreHandle_t)*lock, portMAX_DELAY);
+}
+
+void _lock_release(_lock_t *lock)
+{
+    (void)xSemaphoreGive((SemaphoreHandle_t)*lock);
+}
+
+#endif
+
 int lock_obj(_lock_t *lock_ptr)
 {
     _lock_acquire(lock_ptr);
@@ -0,0 +1,276 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "port_common.h"
+#include "mb_common.h"
+
+static const char *TAG = "mb_port.stats";
+
+#if MB_STATS_ENABLED
+
+// The histogram keeps four significant bits of the value: sixteen linear buckets for each power of two
+// (the percentile error is below 6.25%), the last bucket keeps the values above 2^25 us (about 33 seconds)
+#define MB_STATS_SUB_BITS       (4)
+#define MB_STATS_SUB_BUCKETS    (1 << MB_STATS_SUB_BITS)
+#define MB_STATS_HIST_BUCKETS   ((26 - MB_STATS_SUB_BITS) * MB_STATS_SUB_BUCKETS)
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[MB_STATS_HIST_BUCKETS];
+} mb_stats_hist_t;
+
+typedef struct
+{
+    uint8_t func;
+    uint32_t errors;
+    mb_stats_hist_t latency;
+    mb_stats_hist_t handler;
+} mb_stats_func_hist_t;
+
+// The histograms and frame counters are updated from the FSM task only,
+// the drops are counted by the port tasks, the connections by the TCP driver task.
+// The 64-bit values are not written atomically, so they and the histogram summaries
+// are updated and read under the spin lock, the buckets are read without it.
+struct mb_port_stats_t
+{
+    portMUX_TYPE lock;
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint32_t rx_frames;
+    uint32_t tx_frames;
+    uint32_t err_timeout;
+    uint32_t err_receive;
+    uint32_t err_execute;
+    uint32_t untracked;
+    _Atomic(uint32_t) drops;
+    uint32_t err_connect;
+    mb_stats_hist_t connect;
+    mb_stats_func_hist_t funcs[MB_STATS_FUNC_MAX];
+};
+
+static inline uint32_t mb_stats_bucket_index(uint32_t value)
+{
+    if (value < MB_STATS_SUB_BUCKETS) {
+        return value;
+    }
+    uint32_t msb = 31 - __builtin_clz(value);
+    uint32_t index = ((msb - MB_STATS_SUB_BITS + 1) << MB_STATS_SUB_BITS)
+                        + ((value >> (msb - MB_STATS_SUB_BITS)) & (MB_STATS_SUB_BUCKETS - 1));
+    return (index < MB_STATS_HIST_BUCKETS) ? index : (MB_STATS_HIST_BUCKETS - 1);
+}
+
+// Returns the highest value of the bucket
+static uint32_t mb_stats_bucket_value(uint32_t index)
+{
+    if (index < MB_STATS_SUB_BUCKETS) {
+        return index;
+    }
+    uint32_t shift = (index >> MB_STATS_SUB_BITS) - 1;
+    uint32_t base = (MB_STATS_SUB_BUCKETS + (index & (MB_STATS_SUB_BUCKETS - 1))) << shift;
+    return base + (1 << shift) - 1;
+}
+
+static inline void mb_stats_hist_add(mb_port_stats_t *stats_obj, mb_stats_hist_t *hist, uint32_t value)
+{
+    hist->buckets[mb_stats_bucket_index(value)]++;
+    portENTER_CRITICAL_SAFE(&stats_obj->lock);
+    hist->min_us = (!hist->count || (value < hist->min_us)) ? value : hist->min_us;
+    hist->max_us = (value > hist->max_us) ? value : hist->max_us;
+    hist->sum_us += value;
+    hist->count++;
+    portEXIT_CRITICAL_SAFE(&stats_obj->lock);
+}
+
+static uint32_t mb_stats_hist_percentile(const mb_stats_hist_t *hist, uint32_t count, uint32_t percent)
+{
+    uint32_t rank = (uint32_t)(((uint64_t)count * percent + 99) / 100);
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < MB_STATS_HIST_BUCKETS; i++) {
+        total += hist->buckets[i];
+        if (total >= rank) {
+            uint32_t value = mb_stats_bucket_value(i);
+            return (value < hist->max_us) ? value : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+static void mb_stats_hist_summary(mb_port_stats_t *stats_obj, const mb_stats_hist_t *hist, mb_stats_time_t *time)
+{
+    // The histogram is updated concurrently, the count of buckets is used for the percentiles
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < MB_STATS_HIST_BUCKETS; i++) {
+        count += hist->buckets[i];
+    }
+    portENTER_CRITICAL_SAFE(&stats_obj->lock);
+    time->count = hist->count;
+    time->min_us = hist->min_us;
+    time->max_us = hist->max_us;
+    time->sum_us = hist->sum_us;
+    portEXIT_CRITICAL_SAFE(&stats_obj->lock);
+    time->p50_us = count ? mb_stats_hist_percentile(hist, count, 50) : 0;
+    time->p90_us = count ? mb_stats_hist_percentile(hist, count, 90) : 0;
+    time->p99_us = count ? mb_stats_hist_percentile(hist, count, 99) : 0;
+}
+
+static inline mb_stats_func_hist_t *mb_stats_get_func(mb_port_stats_t *stats_obj, uint8_t func)
+{
+    for (int i = 0; i < MB_STATS_FUNC_MAX; i++) {
+        if (stats_obj->funcs[i].func == func) {
+            return &stats_obj->funcs[i];
+        }
+        if (!stats_obj->funcs[i].func) {
+            // The first free entry is taken for the new function code
+            stats_obj->funcs[i].func = func;
+            return &stats_obj->funcs[i];
+        }
+    }
+    stats_obj->untracked++;
+    return NULL;
+}
+
+mb_err_enum_t mb_port_stats_create(mb_port_base_t *inst)
+{
+    MB_RETURN_ON_FALSE((inst), MB_EINVAL, TAG, "incorrect object handle.");
+    mb_port_stats_t *stats_obj = (mb_port_stats_t *)calloc(1, sizeof(mb_port_stats_t));
+    MB_RETURN_ON_FALSE((stats_obj), MB_EILLSTATE, TAG, "%s, mb stats creation error.", inst->descr.parent_name);
+    atomic_init(&stats_obj->drops, 0);
+    portMUX_TYPE lock_init = portMUX_INITIALIZER_UNLOCKED;
+    stats_obj->lock = lock_init;
+    inst->stats_obj = stats_obj;
+    ESP_LOGD(TAG, "initialized object @%p, size: %u", stats_obj, (unsigned)sizeof(mb_port_stats_t));
+    return MB_ENOERR;
+}
+
+void mb_port_stats_delete(mb_port_base_t *inst)
+{
+    MB_RETURN_ON_FALSE((inst), ;, TAG, "incorrect object handle.");
+    free(inst->stats_obj);
+    inst->stats_obj = NULL;
+}
+
+void mb_port_stats_frame(mb_port_base_t *inst, bool is_tx, uint16_t length)
+{
+    mb_port_stats_t *stats_obj = inst->stats_obj;
+    if (!stats_obj) {
+        return;
+    }
+    portENTER_CRITICAL_SAFE(&stats_obj->lock);
+    if (is_tx) {
+        stats_obj->tx_frames++;
+        stats_obj->tx_bytes += length;
+    } else {
+        stats_obj->rx_frames++;
+        stats_obj->rx_bytes += length;
+    }
+    portEXIT_CRITICAL_SAFE(&stats_obj->lock);
+}
+
+void IRAM_ATTR mb_port_stats_drop(mb_port_base_t *inst, uint32_t count)
+{
+    if (inst->stats_obj) {
+        atomic_fetch_add_explicit(&inst->stats_obj->drops, count, memory_order_relaxed);
+    }
+}
+
+void mb_port_stats_handler(mb_port_base_t *inst, uint8_t func, uint32_t time_us)
+{
+    // The function code 0 is invalid and must not take one of the tracked slots
+    mb_stats_func_hist_t *func_stats = (inst->stats_obj && func) ? mb_stats_get_func(inst->stats_obj, func) : NULL;
+    if (func_stats) {
+        mb_stats_hist_add(inst->stats_obj, &func_stats->handler, time_us);
+    }
+}
+
+void mb_port_stats_request(mb_port_base_t *inst, uint8_t func, uint32_t latency_us, mb_err_event_t error)
+{
+    mb_port_stats_t *stats_obj = inst->stats_obj;
+    if (!stats_obj) {
+        return;
+    }
+    switch (error) {
+        case EV_ERROR_RESPOND_TIMEOUT:
+            stats_obj->err_timeout++;
+            break;
+        case EV_ERROR_RECEIVE_DATA:
+            stats_obj->err_receive++;
+            break;
+        case EV_ERROR_EXECUTE_FUNCTION:
+            stats_obj->err_execute++;
+            break;
+        default:
+            break;
+    }
+    // The function code is unknown when the request is not received correctly
+    mb_stats_func_hist_t *func_stats = func ? mb_stats_get_func(stats_obj, func) : NULL;
+    if (func_stats) {
+        func_stats->errors += (error != EV_ERROR_OK) ? 1 : 0;
+        mb_stats_hist_add(stats_obj, &func_stats->latency, latency_us);
+    }
+}
+
+void mb_port_stats_connect(mb_port_base_t *inst, uint32_t time_us, bool is_ok)
+{
+    mb_port_stats_t *stats_obj = inst->stats_obj;
+    if (!stats_obj) {
+        return;
+    }
+    if (is_ok) {
+        mb_stats_hist_add(stats_obj, &stats_obj->connect, time_us);
+    } else {
+        stats_obj->err_connect++;
+    }
+}
+
+mb_err_enum_t mb_port_stats_get(mb_port_base_t *inst, mb_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((inst && inst->stats_obj && stats), MB_EINVAL, TAG, "incorrect arguments.");
+    mb_port_stats_t *stats_obj = inst->stats_obj;
+    memset(stats, 0, sizeof(mb_stats_t));
+    portENTER_CRITICAL_SAFE(&stats_obj->lock);
+    stats->rx_bytes = stats_obj->rx_bytes;
+    stats->tx_bytes = stats_obj->tx_bytes;
+    stats->rx_frames = stats_obj->rx_frames;
+    stats->tx_frames = stats_obj->tx_frames;
+    portEXIT_CRITICAL_SAFE(&stats_obj->lock);
+    stats->err_timeout = stats_obj->err_timeout;
+    stats->err_receive = stats_obj->err_receive;
+    stats->err_execute = stats_obj->err_execute;
+    stats->untracked = stats_obj->untracked;
+    stats->drops = atomic_load_explicit(&stats_obj->drops, memory_order_relaxed);
+    stats->queue_hwm = mb_port_event_get_queue_hwm(inst);
+    stats->err_connect = stats_obj->err_connect;
+    mb_stats_hist_summary(stats_obj, &stats_obj->connect, &stats->connect);
+    for (int i = 0; i < MB_STATS_FUNC_MAX; i++) {
+        const mb_stats_func_hist_t *func_stats = &stats_obj->funcs[i];
+        stats->funcs[i].func = func_stats->func;
+        stats->funcs[i].errors = func_stats->errors;
+        mb_stats_hist_summary(stats_obj, &func_stats->latency, &stats->funcs[i].latency);
+        mb_stats_hist_summary(stats_obj, &func_stats->handler, &stats->funcs[i].handler);
+    }
+    return MB_ENOERR;
+}
+
+#else
+
+mb_err_enum_t mb_port_stats_get(mb_port_base_t *inst, mb_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((inst && stats), MB_EINVAL, TAG, "incorrect arguments.");
+    return MB_ENOREG;
+}
+
+#endif
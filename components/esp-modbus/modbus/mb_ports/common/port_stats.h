@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "mb_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MB_STATS_FUNC_MAX           (8)     /*!< The number of function codes tracked separately */
+
+/**
+ * @brief The summary of the time histogram, the percentiles are resolved to the histogram
+ *        bucket which keeps four significant bits of the value (the error is below 6.25%)
+ */
+typedef struct {
+    uint32_t count;             /*!< The number of samples */
+    uint32_t min_us;            /*!< The minimum value */
+    uint32_t max_us;            /*!< The maximum value */
+    uint64_t sum_us;            /*!< The sum of the values */
+    uint32_t p50_us;            /*!< The median */
+    uint32_t p90_us;            /*!< The 90th percentile */
+    uint32_t p99_us;            /*!< The 99th percentile */
+} mb_stats_time_t;
+
+/**
+ * @brief The statistics of the requests with the function code
+ */
+typedef struct {
+    uint8_t func;               /*!< The function code, the zero means the entry is not used */
+    uint32_t errors;            /*!< The requests completed with an error */
+    mb_stats_time_t latency;    /*!< The request latency, slave: request received - response sent,
+                                     master: request queued - response processed */
+    mb_stats_time_t handler;    /*!< The time of the function handler execution */
+} mb_stats_func_t;
+
+/**
+ * @brief The performance statistics of the instance
+ */
+typedef struct {
+    uint64_t rx_bytes;          /*!< The PDU bytes of the received frames */
+    uint64_t tx_bytes;          /*!< The PDU bytes of the sent frames */
+    uint32_t rx_frames;         /*!< The received frames */
+    uint32_t tx_frames;         /*!< The sent frames */
+    uint32_t err_timeout;       /*!< The requests failed because of the respond timeout or send failure */
+    uint32_t err_receive;       /*!< The requests failed because of the incorrect received data */
+    uint32_t err_execute;       /*!< The requests failed in the function handler */
+    uint32_t drops;             /*!< The frames dropped by the port (short, expired or unexpected) */
+    uint32_t untracked;         /*!< The requests with function codes above MB_STATS_FUNC_MAX distinct ones */
+    uint32_t queue_hwm;         /*!< The high water mark of the event queue */
+    uint32_t err_connect;       /*!< The connection attempts failed or expired (TCP master) */
+    mb_stats_time_t connect;    /*!< The time to connect to the slave (TCP master) */
+    mb_stats_func_t funcs[MB_STATS_FUNC_MAX]; /*!< The per function code statistics */
+} mb_stats_t;
+
+typedef struct mb_port_base_t mb_port_base_t;
+typedef struct mb_port_stats_t mb_port_stats_t;
+
+#if CONFIG_FMB_STATS_EN
+
+mb_err_enum_t mb_port_stats_create(mb_port_base_t *inst);
+void mb_port_stats_delete(mb_port_base_t *inst);
+void mb_port_stats_frame(mb_port_base_t *inst, bool is_tx, uint16_t length);
+void mb_port_stats_drop(mb_port_base_t *inst, uint32_t count);
+void mb_port_stats_handler(mb_port_base_t *inst, uint8_t func, uint32_t time_us);
+void mb_port_stats_request(mb_port_base_t *inst, uint8_t func, uint32_t latency_us, mb_err_event_t error);
+void mb_port_stats_connect(mb_port_base_t *inst, uint32_t time_us, bool is_ok);
+
+#define MB_STATS_FRAME(inst, is_tx, length) mb_port_stats_frame((mb_port_base_t *)(inst), (is_tx), (length))
+#define MB_STATS_DROP(inst, count) mb_port_stats_drop((mb_port_base_t *)(inst), (count))
+#define MB_STATS_CONNECT(inst, time_us, is_ok) mb_port_stats_connect((mb_port_base_t *)(inst), (time_us), (is_ok))
+
+#else
+
+#define MB_STATS_FRAME(inst, is_tx, length) ((void)0)
+#define MB_STATS_DROP(inst, count) ((void)0)
+#define MB_STATS_CONNECT(inst, time_us, is_ok) ((void)0)
+
+#endif
+
+/**
+ * @brief Get the performance statistics of the instance
+ *
+ * @param inst the port instance
+ * @param[out] stats the statistics
+ * @return
+ *     - MB_ENOERR on success
+ *     - MB_EINVAL if the arguments are incorrect
+ *     - MB_ENOREG if the statistics are disabled in the configuration
+ */
+mb_err_enum_t mb_port_stats_get(mb_port_base_t *inst, mb_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
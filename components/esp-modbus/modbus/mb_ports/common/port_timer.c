@@ -6,6 +6,7 @@
 
 /*----------------------- Platform includes --------------------------------*/
 #include <stdatomic.h>
+#include <sys/param.h>
 #include "esp_idf_version.h"
 #include "esp_attr.h"
 
@@ -13,19 +14,45 @@
 #include "esp_log.h"
 
 #include "port_common.h"
+#include "port_timer_wheel.h"
 #include "mb_types.h"
 #include "mb_config.h"
 #include "mb_common.h"
 
 /* ----------------------- Defines ----------------------------------------*/
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+
+#define MB_RTT_TABLE_SIZE       (MB_MASTER_TOTAL_SLAVE_NUM + 1)
+#define MB_RTT_ADDR_NONE        (0xFFFF)
+#define MB_RTT_GRANULARITY_US   (MB_TIMER_TICK_TIME_US)
+#define MB_RTT_BACKOFF_MAX      (8)
+
+// The round trip time estimation of the slave (see RFC6298)
+typedef struct
+{
+    uint32_t srtt_us;
+    uint32_t rttvar_us;
+    uint32_t last_rtt_us;
+    uint32_t samples;
+    uint16_t timeouts;
+    uint16_t backoff;
+} mb_port_rtt_t;
+
+#endif
+
 struct mb_port_timer_t
 {
-    //spinlock_t spin_lock;
-    esp_timer_handle_t timer_handle;
+    mb_timer_wheel_entry_t timer_entry; // the timer of the shared timer service
     uint16_t t35_ticks;
     _Atomic(uint32_t) response_time_ms;
     _Atomic(bool) timer_state;
     _Atomic(uint16_t) timer_mode;
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+    mb_port_rtt_t *rtt_table;
+    portMUX_TYPE rtt_lock; // the table is updated from the timer callback and read by the master task
+    _Atomic(uint16_t) rtt_addr;
+    int64_t rtt_start_us;
+#endif
 };
 
 /* ----------------------- Static variables ---------------------------------*/
@@ -34,9 +61,46 @@ static const char *TAG = "mb_port.timer";
 /* ----------------------- Start implementation -----------------------------*/
 mb_timer_mode_enum_t mb_port_get_cur_timer_mode(mb_port_base_t *inst);
 
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+
+// Backoff of the respond timeout for the slave which did not respond
+static void IRAM_ATTR mb_port_timer_rtt_expired(mb_port_timer_t *timer_obj)
+{
+    uint16_t addr = atomic_exchange(&(timer_obj->rtt_addr), MB_RTT_ADDR_NONE);
+    if (timer_obj->rtt_table && (addr < MB_RTT_TABLE_SIZE)) {
+        mb_port_rtt_t *rtt = &timer_obj->rtt_table[addr];
+        portENTER_CRITICAL_SAFE(&timer_obj->rtt_lock);
+        rtt->timeouts = (rtt->timeouts < UINT16_MAX) ? (rtt->timeouts + 1) : rtt->timeouts;
+        rtt->backoff = (rtt->backoff < MB_RTT_BACKOFF_MAX) ? (rtt->backoff + 1) : rtt->backoff;
+        portEXIT_CRITICAL_SAFE(&timer_obj->rtt_lock);
+    }
+}
+
+// RTO = SRTT + max(G, 4 * RTTVAR), doubled for each timeout in a row,
+// limited by the minimal and the configured respond timeout, called with rtt_lock held
+static uint32_t mb_port_timer_rtt_calc_rto_ms(mb_port_timer_t *timer_obj, mb_port_rtt_t *rtt)
+{
+    uint32_t max_ms = atomic_load(&(timer_obj->response_time_ms));
+    if (!rtt->samples) {
+        return max_ms;
+    }
+    uint64_t rto_us = (uint64_t)rtt->srtt_us + MAX(MB_RTT_GRANULARITY_US, ((uint64_t)rtt->rttvar_us << 2));
+    rto_us <<= rtt->backoff;
+    uint64_t rto_ms = (rto_us + 999) / 1000;
+    rto_ms = MAX(rto_ms, MB_MASTER_MIN_TIMEOUT_MS_RESPOND);
+    return (uint32_t)MIN(rto_ms, max_ms);
+}
+
+#endif
+
 static void IRAM_ATTR timer_alarm_cb(void *param)
 {
     mb_port_base_t *inst = (mb_port_base_t *)param;
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+    if (mb_port_get_cur_timer_mode(inst) == MB_TMODE_RESPOND_TIMEOUT) {
+        mb_port_timer_rtt_expired(inst->timer_obj);
+    }
+#endif
     if (inst->cb.tmr_expired && inst->arg) {
         inst->cb.tmr_expired(inst->arg); // Timer expired callback function
     }
@@ -53,34 +117,19 @@ mb_err_enum_t mb_port_timer_create(mb_port_base_t *inst, uint16_t t35_timer_tick
     mb_err_enum_t ret = MB_EILLSTATE;
     inst->timer_obj = (mb_port_timer_t *)calloc(1, sizeof(mb_port_timer_t));
     MB_GOTO_ON_FALSE((inst && inst->timer_obj), MB_EILLSTATE, error, TAG, "mb timer allocation error.");
-    inst->timer_obj->timer_handle = NULL;
     atomic_init(&(inst->timer_obj->timer_mode), MB_TMODE_T35);
     atomic_init(&(inst->timer_obj->timer_state), false);
     // Set default response time according to kconfig
     atomic_init(&(inst->timer_obj->response_time_ms), MB_MASTER_TIMEOUT_MS_RESPOND);
     // Save timer reload value for Modbus T35 period
     inst->timer_obj->t35_ticks = t35_timer_ticks;
-    esp_timer_create_args_t timer_conf = {
-        .callback = timer_alarm_cb,
-        .arg = inst,
-#if (MB_TIMER_SUPPORTS_ISR_DISPATCH_METHOD && MB_TIMER_USE_ISR_DISPATCH_METHOD)
-        .dispatch_method = ESP_TIMER_ISR,
-#else
-        .dispatch_method = ESP_TIMER_TASK,
-#endif
-        .name = "MB_T35timer"
-    };
-    // Create Modbus timer
-    esp_err_t err = esp_timer_create(&timer_conf, &(inst->timer_obj->timer_handle));
-    MB_GOTO_ON_FALSE((err == ESP_OK), MB_EILLSTATE, error, TAG, "mb timer creation error.");
+    // All instances share the single timer service
+    ret = mb_timer_wheel_attach(&(inst->timer_obj->timer_entry), timer_alarm_cb, inst);
+    MB_GOTO_ON_FALSE((ret == MB_ENOERR), MB_EILLSTATE, error, TAG, "mb timer creation error.");
     ESP_LOGD(TAG, "initialized %s object @%p", TAG, inst->timer_obj);
     return MB_ENOERR;
 
 error:
-    if (inst && inst->timer_obj && inst->timer_obj->timer_handle)
-    {
-        esp_timer_delete(inst->timer_obj->timer_handle);
-    }
     free(inst->timer_obj);
     inst->timer_obj = NULL;
     return ret;
@@ -91,11 +140,10 @@ void mb_port_timer_delete(mb_port_base_t *inst)
     // Delete active timer
     if (inst->timer_obj)
     {
-        if (inst->timer_obj->timer_handle)
-        {
-            esp_timer_stop(inst->timer_obj->timer_handle);
-            esp_timer_delete(inst->timer_obj->timer_handle);
-        }
+        mb_timer_wheel_detach(&(inst->timer_obj->timer_entry));
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+        free(inst->timer_obj->rtt_table);
+#endif
         free(inst->timer_obj);
         inst->timer_obj = NULL;
     }
@@ -103,11 +151,10 @@ void mb_port_timer_delete(mb_port_base_t *inst)
 
 void mb_port_timer_us(mb_port_base_t *inst, uint64_t timeout_us)
 {
-    MB_RETURN_ON_FALSE((inst && inst->timer_obj->timer_handle), ;, TAG, "timer is not initialized.");
+    MB_RETURN_ON_FALSE((inst && inst->timer_obj), ;, TAG, "timer is not initialized.");
     MB_RETURN_ON_FALSE((timeout_us > 0), ;, TAG,
                         "%s, incorrect tick value for timer = (%" PRId64 ").", inst->descr.parent_name, timeout_us);
-    esp_timer_stop(inst->timer_obj->timer_handle);
-    esp_timer_start_once(inst->timer_obj->timer_handle, timeout_us);
+    mb_timer_wheel_arm(&(inst->timer_obj->timer_entry), timeout_us);
     atomic_store(&(inst->timer_obj->timer_state), false);
 }
 
@@ -143,6 +190,24 @@ void mb_port_timer_convert_delay_enable(mb_port_base_t *inst)
     mb_port_timer_us(inst, tout_us);
 }
 
+void mb_port_timer_convert_delay_t35_enable(mb_port_base_t *inst)
+{
+    uint64_t tout_us = (inst->timer_obj->t35_ticks * MB_TIMER_TICK_TIME_US);
+
+    // The broadcast is completed after T3.5, the conversion delay is applied by the transport
+    mb_port_set_cur_timer_mode(inst, MB_TMODE_CONVERT_DELAY);
+    ESP_LOGD(TAG, "%s, convert delay T3.5 enable.", inst->descr.parent_name);
+    mb_port_timer_us(inst, tout_us);
+}
+
+void mb_port_timer_send_delay_enable(mb_port_base_t *inst, uint64_t delay_us)
+{
+    // The transport posts EV_FRAME_TRANSMIT again when the delay expires
+    mb_port_set_cur_timer_mode(inst, MB_TMODE_SEND_DELAY);
+    ESP_LOGD(TAG, "%s, send delay enable (%" PRIu64 ").", inst->descr.parent_name, delay_us);
+    mb_port_timer_us(inst, delay_us);
+}
+
 void mb_port_timer_respond_timeout_enable(mb_port_base_t *inst)
 {
     uint64_t tout_us = (inst->timer_obj->response_time_ms * 1000);
@@ -162,14 +227,7 @@ void mb_port_timer_delay(mb_port_base_t *inst, uint16_t timeout_ms)
 void mb_port_timer_disable(mb_port_base_t *inst)
 {
     // Disable timer alarm
-    esp_err_t err = esp_timer_stop(inst->timer_obj->timer_handle);
-    if (err != ESP_OK)
-    {
-        if (!esp_timer_is_active(inst->timer_obj->timer_handle))
-        {
-            ESP_EARLY_LOGD(TAG, "%s, timer stop, returns %d.", inst->descr.parent_name, (int)err);
-        }
-    }
+    mb_timer_wheel_cancel(&(inst->timer_obj->timer_entry));
 }
 
 void mb_port_timer_set_response_time(mb_port_base_t *inst, uint32_t resp_time_ms)
@@ -181,3 +239,107 @@ uint32_t mb_port_timer_get_response_time_ms(mb_port_base_t *inst)
 {
     return atomic_load(&(inst->timer_obj->response_time_ms));
 }
+
+mb_err_enum_t mb_port_timer_rtt_create(mb_port_base_t *inst)
+{
+    MB_RETURN_ON_FALSE((inst && inst->timer_obj), MB_EILLSTATE, TAG, "timer is not initialized.");
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+    if (!inst->timer_obj->rtt_table) {
+        inst->timer_obj->rtt_table = (mb_port_rtt_t *)calloc(MB_RTT_TABLE_SIZE, sizeof(mb_port_rtt_t));
+        MB_RETURN_ON_FALSE((inst->timer_obj->rtt_table), MB_EILLSTATE, TAG, "mb rtt table allocation error.");
+        portMUX_TYPE lock_init = portMUX_INITIALIZER_UNLOCKED;
+        inst->timer_obj->rtt_lock = lock_init;
+    }
+    atomic_init(&(inst->timer_obj->rtt_addr), MB_RTT_ADDR_NONE);
+#endif
+    return MB_ENOERR;
+}
+
+void mb_port_timer_slave_respond_timeout_enable(mb_port_base_t *inst, uint8_t slave_addr)
+{
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+    mb_port_timer_t *timer_obj = inst->timer_obj;
+    if (timer_obj->rtt_table && (slave_addr < MB_RTT_TABLE_SIZE)) {
+        portENTER_CRITICAL_SAFE(&timer_obj->rtt_lock);
+        uint64_t tout_us = ((uint64_t)mb_port_timer_rtt_calc_rto_ms(timer_obj, &timer_obj->rtt_table[slave_addr]) * 1000);
+        portEXIT_CRITICAL_SAFE(&timer_obj->rtt_lock);
+        mb_port_set_cur_timer_mode(inst, MB_TMODE_RESPOND_TIMEOUT);
+        ESP_LOGD(TAG, "%s, respond enable timeout (%" PRIu64 ") for slave %u.",
+                    inst->descr.parent_name, tout_us / 1000, (unsigned)slave_addr);
+        timer_obj->rtt_start_us = esp_timer_get_time();
+        atomic_store(&(timer_obj->rtt_addr), slave_addr);
+        mb_port_timer_us(inst, tout_us);
+        return;
+    }
+#endif
+    mb_port_timer_respond_timeout_enable(inst);
+}
+
+// Update the estimation of slave round trip time with the measured sample
+void mb_port_timer_rtt_sample(mb_port_base_t *inst, uint8_t slave_addr, uint64_t rtt_us)
+{
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+    mb_port_timer_t *timer_obj = inst->timer_obj;
+    uint16_t addr = atomic_exchange(&(timer_obj->rtt_addr), MB_RTT_ADDR_NONE);
+    if (!timer_obj->rtt_table || (addr != slave_addr)) {
+        return; // the sample does not belong to the active request
+    }
+    mb_port_rtt_t *rtt = &timer_obj->rtt_table[slave_addr];
+    uint32_t sample_us = (uint32_t)MIN(rtt_us, UINT32_MAX);
+    portENTER_CRITICAL_SAFE(&timer_obj->rtt_lock);
+    if (!rtt->samples) {
+        rtt->srtt_us = sample_us;
+        rtt->rttvar_us = sample_us >> 1;
+    } else {
+        uint32_t delta_us = (rtt->srtt_us > sample_us) ? (rtt->srtt_us - sample_us) : (sample_us - rtt->srtt_us);
+        rtt->rttvar_us = rtt->rttvar_us - (rtt->rttvar_us >> 2) + (delta_us >> 2);
+        rtt->srtt_us = rtt->srtt_us - (rtt->srtt_us >> 3) + (sample_us >> 3);
+    }
+    rtt->last_rtt_us = sample_us;
+    rtt->samples = (rtt->samples < UINT32_MAX) ? (rtt->samples + 1) : rtt->samples;
+    rtt->backoff = 0;
+    uint32_t srtt_us = rtt->srtt_us;
+    uint32_t rttvar_us = rtt->rttvar_us;
+    portEXIT_CRITICAL_SAFE(&timer_obj->rtt_lock);
+    ESP_LOGD(TAG, "%s, slave %u, rtt: %" PRIu32 ", srtt: %" PRIu32 ", rttvar: %" PRIu32 " (us).",
+                inst->descr.parent_name, (unsigned)slave_addr, sample_us, srtt_us, rttvar_us);
+#endif
+}
+
+// Take the round trip time sample from the start of respond timeout until the response is received
+void mb_port_timer_rtt_stop_at(mb_port_base_t *inst, uint8_t slave_addr, int64_t recv_time_us)
+{
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+    if (atomic_load(&(inst->timer_obj->rtt_addr)) == slave_addr) {
+        int64_t rtt_us = recv_time_us - inst->timer_obj->rtt_start_us;
+        mb_port_timer_rtt_sample(inst, slave_addr, (rtt_us > 0) ? (uint64_t)rtt_us : 0);
+    }
+#endif
+}
+
+void mb_port_timer_rtt_stop(mb_port_base_t *inst, uint8_t slave_addr)
+{
+    mb_port_timer_rtt_stop_at(inst, slave_addr, esp_timer_get_time());
+}
+
+mb_err_enum_t mb_port_timer_get_rtt_stats(mb_port_base_t *inst, uint8_t slave_addr, mb_port_rtt_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((inst && inst->timer_obj && stats), MB_EINVAL, TAG, "incorrect arguments.");
+#if MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED
+    mb_port_timer_t *timer_obj = inst->timer_obj;
+    MB_RETURN_ON_FALSE((timer_obj->rtt_table), MB_ENOREG, TAG, "the rtt is not measured for the port.");
+    MB_RETURN_ON_FALSE((slave_addr < MB_RTT_TABLE_SIZE), MB_EINVAL, TAG, "incorrect slave address %u.", (unsigned)slave_addr);
+    mb_port_rtt_t *rtt = &timer_obj->rtt_table[slave_addr];
+    portENTER_CRITICAL_SAFE(&timer_obj->rtt_lock);
+    stats->srtt_us = rtt->srtt_us;
+    stats->rttvar_us = rtt->rttvar_us;
+    stats->last_rtt_us = rtt->last_rtt_us;
+    stats->rto_ms = mb_port_timer_rtt_calc_rto_ms(timer_obj, rtt);
+    stats->samples = rtt->samples;
+    stats->timeouts = rtt->timeouts;
+    portEXIT_CRITICAL_SAFE(&timer_obj->rtt_lock);
+    return MB_ENOERR;
+#else
+    return MB_ENOREG;
+#endif
+}
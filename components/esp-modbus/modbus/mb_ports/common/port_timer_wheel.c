@@ -0,0 +1,402 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*----------------------- Platform includes --------------------------------*/
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "port_common.h"
+#include "port_timer_wheel.h"
+#include "mb_config.h"
+#include "mb_common.h"
+
+/* ----------------------- Defines ----------------------------------------*/
+// The hierarchical wheel: the level 0 slot is one tick, each slot of the next level spans the whole previous level.
+// The timer is placed into the level of the highest 6-bit digit of its expire tick which differs from the
+// base tick of the wheel, so the nearest event is found by the lowest set bit of the slot masks.
+// The single esp_timer is started for the nearest event only, there is no periodic tick.
+#define MB_WHEEL_TICK_US        (MB_TIMER_TICK_TIME_US)
+#define MB_WHEEL_SLOT_BITS      (6)
+#define MB_WHEEL_SLOTS          (1 << MB_WHEEL_SLOT_BITS)
+#define MB_WHEEL_SLOT_MASK      (MB_WHEEL_SLOTS - 1)
+#define MB_WHEEL_LEVELS         (4)  // 64^4 ticks of 50 us is about 14 minutes
+#define MB_WHEEL_OVERFLOW_IDX   (MB_WHEEL_LEVELS * MB_WHEEL_SLOTS)
+#define MB_WHEEL_EXPIRED_IDX    (MB_WHEEL_OVERFLOW_IDX + 1)
+#define MB_WHEEL_LIST_COUNT     (MB_WHEEL_EXPIRED_IDX + 1)
+#define MB_WHEEL_IDX_NONE       (0xFFFF)
+#define MB_WHEEL_LEVEL_NONE     (-1)
+
+#define MB_WHEEL_LEVEL_SHIFT(level) (MB_WHEEL_SLOT_BITS * (level))
+
+typedef LIST_HEAD(mb_wheel_list_s, mb_timer_wheel_entry_s) mb_wheel_list_t;
+
+// The change of the esp_timer decided under the spin lock and done after it is released
+typedef struct
+{
+    esp_timer_handle_t timer_handle;
+    bool start;
+    uint64_t tick;
+    uint32_t seq;
+} mb_wheel_hw_req_t;
+
+typedef struct
+{
+    portMUX_TYPE spin_lock;
+    esp_timer_handle_t timer_handle;
+    uint32_t ref_count;
+    uint64_t base_tick;                     // all timers in the wheel expire at or after the base tick
+    uint64_t hw_tick;                       // the tick the esp_timer is started for
+    bool hw_active;
+    uint32_t hw_seq;                        // the sequence number of the last esp_timer change
+    mb_timer_wheel_entry_t *cb_entry;       // the entry which callback is executed now
+    TaskHandle_t cb_task;                   // the task executing the callback, NULL for ISR dispatch
+    uint64_t slot_mask[MB_WHEEL_LEVELS];    // the non-empty slots of each level
+    mb_wheel_list_t lists[MB_WHEEL_LIST_COUNT];
+    int64_t start_time_us;
+    mb_timer_wheel_stats_t stats;
+} mb_timer_wheel_t;
+
+/* ----------------------- Static variables ---------------------------------*/
+static const char *TAG = "mb_port.timer_wheel";
+
+static _lock_t wheel_lock;
+static mb_timer_wheel_t wheel_obj = {
+    .spin_lock = portMUX_INITIALIZER_UNLOCKED,
+    .timer_handle = NULL,
+};
+
+/* ----------------------- Start implementation -----------------------------*/
+static inline uint64_t mb_wheel_get_tick(void)
+{
+    return (uint64_t)esp_timer_get_time() / MB_WHEEL_TICK_US;
+}
+
+static void IRAM_ATTR mb_wheel_place(mb_timer_wheel_t *wheel, mb_timer_wheel_entry_t *entry)
+{
+    uint64_t diff = entry->expire_tick ^ wheel->base_tick;
+    uint16_t idx = MB_WHEEL_OVERFLOW_IDX;
+    for (int level = 0; level < MB_WHEEL_LEVELS; level++) {
+        if (diff < (1ULL << MB_WHEEL_LEVEL_SHIFT(level + 1))) {
+            uint32_t slot = (uint32_t)(entry->expire_tick >> MB_WHEEL_LEVEL_SHIFT(level)) & MB_WHEEL_SLOT_MASK;
+            wheel->slot_mask[level] |= (1ULL << slot);
+            idx = (level * MB_WHEEL_SLOTS) + slot;
+            break;
+        }
+    }
+    entry->list_idx = idx;
+    LIST_INSERT_HEAD(&wheel->lists[idx], entry, entries);
+}
+
+static void IRAM_ATTR mb_wheel_remove(mb_timer_wheel_t *wheel, mb_timer_wheel_entry_t *entry)
+{
+    uint16_t idx = entry->list_idx;
+    LIST_REMOVE(entry, entries);
+    entry->list_idx = MB_WHEEL_IDX_NONE;
+    if ((idx < MB_WHEEL_OVERFLOW_IDX) && LIST_EMPTY(&wheel->lists[idx])) {
+        wheel->slot_mask[idx / MB_WHEEL_SLOTS] &= ~(1ULL << (idx % MB_WHEEL_SLOTS));
+    }
+}
+
+// Get the tick of the nearest event: the expiration on level 0 or the cascade of the higher level slot
+static int IRAM_ATTR mb_wheel_get_next_tick(mb_timer_wheel_t *wheel, uint64_t *tick)
+{
+    for (int level = 0; level < MB_WHEEL_LEVELS; level++) {
+        if (wheel->slot_mask[level]) {
+            uint32_t shift = MB_WHEEL_LEVEL_SHIFT(level);
+            uint64_t slot = (uint64_t)__builtin_ctzll(wheel->slot_mask[level]);
+            uint64_t upper = (wheel->base_tick >> (shift + MB_WHEEL_SLOT_BITS)) << (shift + MB_WHEEL_SLOT_BITS);
+            *tick = upper | (slot << shift);
+            return level;
+        }
+    }
+    if (!LIST_EMPTY(&wheel->lists[MB_WHEEL_OVERFLOW_IDX])) {
+        uint32_t shift = MB_WHEEL_LEVEL_SHIFT(MB_WHEEL_LEVELS);
+        *tick = ((wheel->base_tick >> shift) + 1) << shift;
+        return MB_WHEEL_LEVELS;
+    }
+    return MB_WHEEL_LEVEL_NONE;
+}
+
+// Decide the esp_timer change under the spin lock: start it for the nearest event if it is earlier
+// than the started one or stop it if there are no events, returns false if the change is not needed.
+// The forced change is always returned.
+static bool IRAM_ATTR mb_wheel_program(mb_timer_wheel_t *wheel, mb_wheel_hw_req_t *req, bool force)
+{
+    uint64_t tick = 0;
+    if (mb_wheel_get_next_tick(wheel, &tick) == MB_WHEEL_LEVEL_NONE) {
+        if (!wheel->hw_active && !force) {
+            return false;
+        }
+        wheel->hw_active = false;
+        req->start = false;
+    } else {
+        if (wheel->hw_active && (wheel->hw_tick <= tick) && !force) {
+            return false;
+        }
+        wheel->hw_tick = tick;
+        wheel->hw_active = true;
+        req->start = true;
+        req->tick = tick;
+    }
+    req->timer_handle = wheel->timer_handle;
+    req->seq = ++wheel->hw_seq;
+    return true;
+}
+
+// Apply the decided change of the esp_timer out of the critical section. The change decided later by other
+// context can be applied earlier than this one, so the change is repeated for the current state of the wheel
+// until it is the last decided one.
+static void IRAM_ATTR mb_wheel_program_apply(mb_timer_wheel_t *wheel, mb_wheel_hw_req_t *req)
+{
+    bool is_last = false;
+    while (!is_last) {
+        if (req->timer_handle) {
+            (void)esp_timer_stop(req->timer_handle);
+            if (req->start) {
+                int64_t delay_us = (int64_t)(req->tick * MB_WHEEL_TICK_US) - esp_timer_get_time();
+                (void)esp_timer_start_once(req->timer_handle, (delay_us > 0) ? (uint64_t)delay_us : 1);
+            }
+        }
+        portENTER_CRITICAL_SAFE(&wheel->spin_lock);
+        is_last = (wheel->hw_seq == req->seq);
+        if (!is_last) {
+            (void)mb_wheel_program(wheel, req, true);
+        }
+        portEXIT_CRITICAL_SAFE(&wheel->spin_lock);
+    }
+}
+
+static void IRAM_ATTR mb_wheel_timer_cb(void *param)
+{
+    mb_timer_wheel_t *wheel = (mb_timer_wheel_t *)param;
+    int64_t start_us = esp_timer_get_time();
+    uint64_t now_tick = (uint64_t)start_us / MB_WHEEL_TICK_US;
+    mb_timer_wheel_entry_t *entry = NULL;
+    uint64_t tick = 0;
+    int level = MB_WHEEL_LEVEL_NONE;
+    mb_wheel_hw_req_t req;
+    bool is_changed = false;
+
+    portENTER_CRITICAL_SAFE(&wheel->spin_lock);
+    wheel->hw_active = false;
+    wheel->stats.wakeup_count++;
+    // Advance the wheel up to the current tick, move the expired timers to the expired list
+    // and the timers of the reached higher level slots to the lower levels
+    while (((level = mb_wheel_get_next_tick(wheel, &tick)) != MB_WHEEL_LEVEL_NONE) && (tick <= now_tick)) {
+        wheel->base_tick = tick;
+        uint16_t idx = (level < MB_WHEEL_LEVELS)
+                        ? ((level * MB_WHEEL_SLOTS) + ((tick >> MB_WHEEL_LEVEL_SHIFT(level)) & MB_WHEEL_SLOT_MASK))
+                        : MB_WHEEL_OVERFLOW_IDX;
+        if (level == MB_WHEEL_LEVELS) {
+            // The overflow entries can be placed back into the overflow list, so the list is taken
+            // out first and each entry is placed once for the new base tick
+            mb_wheel_list_t overflow = LIST_HEAD_INITIALIZER(overflow);
+            while ((entry = LIST_FIRST(&wheel->lists[idx]))) {
+                LIST_REMOVE(entry, entries);
+                LIST_INSERT_HEAD(&overflow, entry, entries);
+            }
+            while ((entry = LIST_FIRST(&overflow))) {
+                LIST_REMOVE(entry, entries);
+                mb_wheel_place(wheel, entry);
+                wheel->stats.cascade_count++;
+            }
+            continue;
+        }
+        while ((entry = LIST_FIRST(&wheel->lists[idx]))) {
+            mb_wheel_remove(wheel, entry);
+            if (level == 0) {
+                entry->list_idx = MB_WHEEL_EXPIRED_IDX;
+                LIST_INSERT_HEAD(&wheel->lists[MB_WHEEL_EXPIRED_IDX], entry, entries);
+            } else {
+                mb_wheel_place(wheel, entry);
+                wheel->stats.cascade_count++;
+            }
+        }
+    }
+    is_changed = mb_wheel_program(wheel, &req, false);
+    portEXIT_CRITICAL_SAFE(&wheel->spin_lock);
+    if (is_changed) {
+        mb_wheel_program_apply(wheel, &req);
+    }
+
+    // The callbacks are called out of the critical section, they can start or stop the timers.
+    // The entry is marked as executed, so it is not detached and released until its callback returns.
+    TaskHandle_t cb_task = xPortInIsrContext() ? NULL : xTaskGetCurrentTaskHandle();
+    while (1) {
+        mb_timer_wheel_cb_fp cb = NULL;
+        void *arg = NULL;
+        portENTER_CRITICAL_SAFE(&wheel->spin_lock);
+        wheel->cb_entry = NULL;
+        entry = LIST_FIRST(&wheel->lists[MB_WHEEL_EXPIRED_IDX]);
+        if (entry) {
+            mb_wheel_remove(wheel, entry);
+            wheel->stats.armed--;
+            wheel->stats.expired_count++;
+            cb = entry->cb;
+            arg = entry->arg;
+            wheel->cb_entry = entry;
+            wheel->cb_task = cb_task;
+        }
+        portEXIT_CRITICAL_SAFE(&wheel->spin_lock);
+        if (!entry) {
+            break;
+        }
+        cb(arg);
+    }
+
+    uint32_t busy_us = (uint32_t)(esp_timer_get_time() - start_us);
+    portENTER_CRITICAL_SAFE(&wheel->spin_lock);
+    wheel->stats.busy_time_us += busy_us;
+    wheel->stats.busy_time_max_us = (busy_us > wheel->stats.busy_time_max_us) ? busy_us : wheel->stats.busy_time_max_us;
+    portEXIT_CRITICAL_SAFE(&wheel->spin_lock);
+}
+
+mb_err_enum_t mb_timer_wheel_attach(mb_timer_wheel_entry_t *entry, mb_timer_wheel_cb_fp cb, void *arg)
+{
+    MB_RETURN_ON_FALSE((entry && cb), MB_EINVAL, TAG, "incorrect arguments.");
+    mb_err_enum_t ret = MB_ENOERR;
+    mb_timer_wheel_t *wheel = &wheel_obj;
+    CRITICAL_SECTION(wheel_lock) {
+        if (!wheel->timer_handle) {
+            esp_timer_create_args_t timer_conf = {
+                .callback = mb_wheel_timer_cb,
+                .arg = wheel,
+#if (MB_TIMER_SUPPORTS_ISR_DISPATCH_METHOD && MB_TIMER_USE_ISR_DISPATCH_METHOD)
+                .dispatch_method = ESP_TIMER_ISR,
+#else
+                .dispatch_method = ESP_TIMER_TASK,
+#endif
+                .name = "MB_timer_wheel"
+            };
+            esp_err_t err = esp_timer_create(&timer_conf, &wheel->timer_handle);
+            if (err == ESP_OK) {
+                // No timers are armed when the service starts, it is safe to reset the wheel
+                for (int idx = 0; idx < MB_WHEEL_LIST_COUNT; idx++) {
+                    LIST_INIT(&wheel->lists[idx]);
+                }
+                memset(wheel->slot_mask, 0, sizeof(wheel->slot_mask));
+                memset(&wheel->stats, 0, sizeof(wheel->stats));
+                wheel->base_tick = mb_wheel_get_tick();
+                wheel->hw_active = false;
+                wheel->start_time_us = esp_timer_get_time();
+                ESP_LOGD(TAG, "timer service is started.");
+            } else {
+                ESP_LOGE(TAG, "timer service creation error, err: 0x%x.", (int)err);
+                wheel->timer_handle = NULL;
+                ret = MB_EILLSTATE;
+            }
+        }
+        if (ret == MB_ENOERR) {
+            entry->list_idx = MB_WHEEL_IDX_NONE;
+            entry->expire_tick = 0;
+            entry->cb = cb;
+            entry->arg = arg;
+            wheel->ref_count++;
+            wheel->stats.timers = wheel->ref_count;
+        }
+    }
+    return ret;
+}
+
+void mb_timer_wheel_detach(mb_timer_wheel_entry_t *entry)
+{
+    MB_RETURN_ON_FALSE((entry && entry->cb), ;, TAG, "incorrect arguments.");
+    mb_timer_wheel_t *wheel = &wheel_obj;
+    mb_timer_wheel_cancel(entry);
+    // Wait for the callback of the entry taken from the expired list, the entry is released
+    // by the caller after return. The callback itself can detach its entry.
+    while (1) {
+        bool is_busy = false;
+        portENTER_CRITICAL_SAFE(&wheel->spin_lock);
+        is_busy = (wheel->cb_entry == entry) && (wheel->cb_task != xTaskGetCurrentTaskHandle());
+        portEXIT_CRITICAL_SAFE(&wheel->spin_lock);
+        if (!is_busy) {
+            break;
+        }
+        vTaskDelay(1);
+    }
+    // The callback could arm the entry again
+    mb_timer_wheel_cancel(entry);
+    CRITICAL_SECTION(wheel_lock) {
+        entry->cb = NULL;
+        if (wheel->ref_count && !(--wheel->ref_count) && wheel->timer_handle) {
+            (void)esp_timer_stop(wheel->timer_handle);
+            (void)esp_timer_delete(wheel->timer_handle);
+            wheel->timer_handle = NULL;
+            wheel->hw_active = false;
+            ESP_LOGD(TAG, "timer service is stopped.");
+        }
+        wheel->stats.timers = wheel->ref_count;
+    }
+}
+
+void IRAM_ATTR mb_timer_wheel_arm(mb_timer_wheel_entry_t *entry, uint64_t timeout_us)
+{
+    mb_timer_wheel_t *wheel = &wheel_obj;
+    uint64_t now_us = (uint64_t)esp_timer_get_time();
+    uint64_t now_tick = now_us / MB_WHEEL_TICK_US;
+    mb_wheel_hw_req_t req;
+    bool is_changed = false;
+    portENTER_CRITICAL_SAFE(&wheel->spin_lock);
+    if (entry->list_idx != MB_WHEEL_IDX_NONE) {
+        mb_wheel_remove(wheel, entry);
+    } else {
+        wheel->stats.armed++;
+    }
+    if (wheel->stats.armed == 1) {
+        // The wheel is empty, just move its base to the current tick
+        wheel->base_tick = now_tick;
+    }
+    // The timer never expires earlier than requested
+    entry->expire_tick = (now_us + timeout_us + MB_WHEEL_TICK_US - 1) / MB_WHEEL_TICK_US;
+    entry->expire_tick = (entry->expire_tick > wheel->base_tick) ? entry->expire_tick : wheel->base_tick;
+    mb_wheel_place(wheel, entry);
+    wheel->stats.arm_count++;
+    is_changed = mb_wheel_program(wheel, &req, false);
+    portEXIT_CRITICAL_SAFE(&wheel->spin_lock);
+    if (is_changed) {
+        mb_wheel_program_apply(wheel, &req);
+    }
+}
+
+void IRAM_ATTR mb_timer_wheel_cancel(mb_timer_wheel_entry_t *entry)
+{
+    mb_timer_wheel_t *wheel = &wheel_obj;
+    mb_wheel_hw_req_t req;
+    bool is_changed = false;
+    portENTER_CRITICAL_SAFE(&wheel->spin_lock);
+    if (entry->list_idx != MB_WHEEL_IDX_NONE) {
+        mb_wheel_remove(wheel, entry);
+        wheel->stats.armed--;
+        wheel->stats.cancel_count++;
+        // The esp_timer started for the earlier event just makes an empty wakeup,
+        // it is stopped only if there are no more timers
+        if (!wheel->stats.armed) {
+            is_changed = mb_wheel_program(wheel, &req, false);
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&wheel->spin_lock);
+    if (is_changed) {
+        mb_wheel_program_apply(wheel, &req);
+    }
+}
+
+bool IRAM_ATTR mb_timer_wheel_is_armed(mb_timer_wheel_entry_t *entry)
+{
+    return (entry->list_idx != MB_WHEEL_IDX_NONE);
+}
+
+mb_err_enum_t mb_timer_wheel_get_stats(mb_timer_wheel_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((stats), MB_EINVAL, TAG, "incorrect arguments.");
+    mb_timer_wheel_t *wheel = &wheel_obj;
+    portENTER_CRITICAL_SAFE(&wheel->spin_lock);
+    *stats = wheel->stats;
+    portEXIT_CRITICAL_SAFE(&wheel->spin_lock);
+    stats->run_time_us = wheel->timer_handle ? (uint64_t)(esp_timer_get_time() - wheel->start_time_us) : 0;
+    return MB_ENOERR;
+}
@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/queue.h>
+
+#include "mb_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The callback of expired timer, it is called from the context of the timer service
+ *        (the ISR or esp_timer task depending on the dispatch method)
+ */
+typedef void (*mb_timer_wheel_cb_fp)(void *arg);
+
+/**
+ * @brief The timer entry of the shared timer service, the entry is embedded into the owner object
+ */
+typedef struct mb_timer_wheel_entry_s
+{
+    LIST_ENTRY(mb_timer_wheel_entry_s) entries; /*!< The link of the entry in the wheel slot */
+    uint64_t expire_tick;                       /*!< The tick the timer expires at */
+    uint16_t list_idx;                          /*!< The index of the list the entry is linked into */
+    mb_timer_wheel_cb_fp cb;                    /*!< The expiration callback */
+    void *arg;                                  /*!< The argument of the expiration callback */
+} mb_timer_wheel_entry_t;
+
+/**
+ * @brief The statistic of the shared timer service
+ */
+typedef struct
+{
+    uint32_t timers;            /*!< Number of timers attached to the service */
+    uint32_t armed;             /*!< Number of currently armed timers */
+    uint32_t arm_count;         /*!< Number of timer start requests */
+    uint32_t cancel_count;      /*!< Number of timer stop requests for armed timers */
+    uint32_t expired_count;     /*!< Number of expired timers */
+    uint32_t cascade_count;     /*!< Number of timers moved to the lower level of the wheel */
+    uint32_t wakeup_count;      /*!< Number of wakeups of the service */
+    uint32_t busy_time_max_us;  /*!< Maximum time of one wakeup including the expiration callbacks, us */
+    uint64_t busy_time_us;      /*!< Total time of the wakeups including the expiration callbacks, us */
+    uint64_t run_time_us;       /*!< Time since the service is started, us */
+} mb_timer_wheel_stats_t;
+
+/**
+ * @brief Attach the timer entry to the shared timer service, the service is started by the first entry
+ *
+ * @param entry the timer entry to initialize
+ * @param cb the callback called when the timer expires
+ * @param arg the argument of the callback
+ * @return
+ *     - MB_ENOERR on success
+ *     - MB_EINVAL if the arguments are incorrect
+ *     - MB_EILLSTATE if the service can not be started
+ */
+mb_err_enum_t mb_timer_wheel_attach(mb_timer_wheel_entry_t *entry, mb_timer_wheel_cb_fp cb, void *arg);
+
+/**
+ * @brief Stop the timer and detach it from the service, the service is stopped with the last entry
+ *
+ * @param entry the timer entry
+ */
+void mb_timer_wheel_detach(mb_timer_wheel_entry_t *entry);
+
+/**
+ * @brief Start or restart the one shot timer, the timeout is rounded up to the tick of the wheel (50 us)
+ *
+ * @param entry the timer entry
+ * @param timeout_us the timeout in microseconds
+ */
+void mb_timer_wheel_arm(mb_timer_wheel_entry_t *entry, uint64_t timeout_us);
+
+/**
+ * @brief Stop the timer, the callback is not called after this function returns
+ *        unless it is already in progress
+ *
+ * @param entry the timer entry
+ */
+void mb_timer_wheel_cancel(mb_timer_wheel_entry_t *entry);
+
+/**
+ * @brief Check if the timer is started and not expired yet
+ *
+ * @param entry the timer entry
+ * @return true if the timer is armed
+ */
+bool mb_timer_wheel_is_armed(mb_timer_wheel_entry_t *entry);
+
+/**
+ * @brief Get the statistic of the shared timer service
+ *
+ * @param stats pointer to the statistic structure to fill
+ * @return
+ *     - MB_ENOERR on success
+ *     - MB_EINVAL if the argument is incorrect
+ */
+mb_err_enum_t mb_timer_wheel_get_stats(mb_timer_wheel_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
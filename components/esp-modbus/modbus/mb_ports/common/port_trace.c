@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "port_common.h"
+#include "mb_common.h"
+
+static const char *TAG = "mb_port.trace";
+
+#if MB_STAGE_TRACE_ENABLED
+
+// The slot keeps the sequence number of the record written into it, the zero value means
+// the record is being written (the sequence numbers start from one)
+typedef struct
+{
+    _Atomic(uint32_t) seq;
+    mb_trace_record_t record;
+} mb_trace_slot_t;
+
+struct mb_port_trace_t
+{
+    _Atomic(uint32_t) head;     // sequence number of the next record to write
+    uint32_t tail;              // sequence number of the next record to read (the reader side only)
+    uint32_t mask;
+    mb_trace_slot_t *slots;
+};
+
+mb_err_enum_t mb_port_trace_create(mb_port_base_t *inst)
+{
+    MB_RETURN_ON_FALSE((inst), MB_EINVAL, TAG, "incorrect object handle.");
+    uint32_t ring_size = 1;
+    while (ring_size < MB_STAGE_TRACE_RING_SIZE) {
+        ring_size <<= 1;
+    }
+    mb_port_trace_t *trace_obj = (mb_port_trace_t *)calloc(1, sizeof(mb_port_trace_t));
+    MB_RETURN_ON_FALSE((trace_obj), MB_EILLSTATE, TAG, "mb trace creation error.");
+    trace_obj->slots = (mb_trace_slot_t *)calloc(ring_size, sizeof(mb_trace_slot_t));
+    if (!trace_obj->slots) {
+        free(trace_obj);
+        ESP_LOGE(TAG, "%s, mb trace ring creation error.", inst->descr.parent_name);
+        return MB_EILLSTATE;
+    }
+    trace_obj->mask = ring_size - 1;
+    atomic_init(&trace_obj->head, 1);
+    trace_obj->tail = 1;
+    inst->trace_obj = trace_obj;
+    ESP_LOGD(TAG, "initialized object @%p, records: %" PRIu32, trace_obj, ring_size);
+    return MB_ENOERR;
+}
+
+void mb_port_trace_delete(mb_port_base_t *inst)
+{
+    MB_RETURN_ON_FALSE((inst), ;, TAG, "incorrect object handle.");
+    if (inst->trace_obj) {
+        free(inst->trace_obj->slots);
+        free(inst->trace_obj);
+        inst->trace_obj = NULL;
+    }
+}
+
+void IRAM_ATTR mb_port_trace_write(mb_port_base_t *inst, mb_trace_stage_t stage, uint8_t func, uint16_t arg, uint32_t value)
+{
+    if (!inst || !inst->trace_obj) {
+        return;
+    }
+    mb_port_trace_t *trace_obj = inst->trace_obj;
+    uint32_t seq = atomic_fetch_add(&trace_obj->head, 1);
+    mb_trace_slot_t *slot = &trace_obj->slots[seq & trace_obj->mask];
+    // Invalidate the slot while it is overwritten to let the reader drop the torn record
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->record.seq = seq;
+    slot->record.time_us = (uint32_t)esp_timer_get_time();
+    slot->record.stage = (uint8_t)stage;
+    slot->record.func = func;
+    slot->record.arg = arg;
+    slot->record.value = value;
+    atomic_store_explicit(&slot->seq, seq, memory_order_release);
+}
+
+mb_err_enum_t mb_port_trace_read(mb_port_base_t *inst, mb_trace_record_t *records, uint16_t *count, uint32_t *lost)
+{
+    MB_RETURN_ON_FALSE((inst && inst->trace_obj && records && count), MB_EINVAL, TAG, "incorrect arguments.");
+    mb_port_trace_t *trace_obj = inst->trace_obj;
+    uint32_t lost_cnt = 0;
+    uint16_t read_cnt = 0;
+    uint32_t head = atomic_load(&trace_obj->head);
+    // The records older than the ring size are overwritten already
+    if ((head - trace_obj->tail) > (trace_obj->mask + 1)) {
+        lost_cnt += (head - trace_obj->tail) - (trace_obj->mask + 1);
+        trace_obj->tail = head - (trace_obj->mask + 1);
+    }
+    while ((trace_obj->tail != head) && (read_cnt < *count)) {
+        mb_trace_slot_t *slot = &trace_obj->slots[trace_obj->tail & trace_obj->mask];
+        uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq == 0) {
+            // The record is being written now, read it next time
+            break;
+        }
+        records[read_cnt] = slot->record;
+        atomic_thread_fence(memory_order_acquire);
+        if ((seq != trace_obj->tail) || (atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq)) {
+            // The record is overwritten by the writer which is ahead of the reader
+            lost_cnt++;
+        } else {
+            read_cnt++;
+        }
+        trace_obj->tail++;
+    }
+    *count = read_cnt;
+    if (lost) {
+        *lost = lost_cnt;
+    }
+    return MB_ENOERR;
+}
+
+#else
+
+mb_err_enum_t mb_port_trace_read(mb_port_base_t *inst, mb_trace_record_t *records, uint16_t *count, uint32_t *lost)
+{
+    MB_RETURN_ON_FALSE((inst && records && count), MB_EINVAL, TAG, "incorrect arguments.");
+    *count = 0;
+    return MB_ENOREG;
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "mb_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The stages of the transaction recorded into the trace ring of the instance
+ */
+typedef enum {
+    MB_TRACE_STAGE_RX_READY = 0,    /*!< The socket is readable (TCP) or the frame is read from UART (serial) */
+    MB_TRACE_STAGE_FRAME_QUEUED,    /*!< The received frame is queued for the stack (TCP) */
+    MB_TRACE_STAGE_FRAME_PARSED,    /*!< The frame is checked and parsed by the transport */
+    MB_TRACE_STAGE_EXEC_START,      /*!< The FSM starts the function handler execution */
+    MB_TRACE_STAGE_REG_CB,          /*!< The register access callback is called by the function handler */
+    MB_TRACE_STAGE_EXEC_END,        /*!< The function handler is completed, the response is ready */
+    MB_TRACE_STAGE_SEND_DONE,       /*!< The response frame is sent */
+    MB_TRACE_STAGE_COUNT
+} mb_trace_stage_t;
+
+/**
+ * @brief The binary trace record, the records are kept in the ring of fixed size
+ */
+typedef struct {
+    uint32_t seq;       /*!< The sequence number of the record, the gaps mean the lost (overwritten) records */
+    uint32_t time_us;   /*!< The time stamp of the stage, lower 32 bits of esp_timer_get_time() */
+    uint8_t stage;      /*!< The stage of transaction (mb_trace_stage_t) */
+    uint8_t func;       /*!< The function code if known on this stage, otherwise zero */
+    uint16_t arg;       /*!< The stage argument (node index, frame length or register address) */
+    uint32_t value;     /*!< The stage value (transaction identifier, exception, register type and count) */
+} mb_trace_record_t;
+
+typedef struct mb_port_base_t mb_port_base_t;
+typedef struct mb_port_trace_t mb_port_trace_t;
+
+#if CONFIG_FMB_STAGE_TRACE_EN
+
+mb_err_enum_t mb_port_trace_create(mb_port_base_t *inst);
+void mb_port_trace_delete(mb_port_base_t *inst);
+
+/**
+ * @brief Record the stage of transaction into the trace ring of the instance, the function does not
+ *        block and can be called from several tasks and ISR, the oldest records are overwritten
+ */
+void mb_port_trace_write(mb_port_base_t *inst, mb_trace_stage_t stage, uint8_t func, uint16_t arg, uint32_t value);
+
+#define MB_STAGE_TRACE(inst, stage, func, arg, value) \
+    mb_port_trace_write((mb_port_base_t *)(inst), (stage), (uint8_t)(func), (uint16_t)(arg), (uint32_t)(value))
+
+#else
+
+#define MB_STAGE_TRACE(inst, stage, func, arg, value) ((void)0)
+
+#endif
+
+/**
+ * @brief Read the records from the trace ring of the instance, the records are removed from the ring.
+ *        The ring is expected to be read from one task only.
+ *
+ * @param inst the port instance
+ * @param records the buffer to store the records
+ * @param[in,out] count the size of buffer in records on input, the number of read records on output
+ * @param[out] lost the number of records overwritten before they are read, can be NULL
+ * @return
+ *     - MB_ENOERR on success
+ *     - MB_EINVAL if the arguments are incorrect
+ *     - MB_ENOREG if the trace is disabled in the configuration
+ */
+mb_err_enum_t mb_port_trace_read(mb_port_base_t *inst, mb_trace_record_t *records, uint16_t *count, uint32_t *lost);
+
+#ifdef __cplusplus
+}
+#endif
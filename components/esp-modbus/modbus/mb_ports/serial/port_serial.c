@@ -9,13 +9,15 @@
 #include "port_common.h"
 #include "mb_config.h"
 #include "port_serial_common.h"
+#include "mb_proto.h"
+#include "rtu/mbcrc.h"
 
 /* ----------------------- Defines ------------------------------------------*/
 #define MB_SERIAL_RX_SEMA_TOUT_MS   (1000)
 #define MB_SERIAL_RX_SEMA_TOUT      (pdMS_TO_TICKS(MB_SERIAL_RX_SEMA_TOUT_MS))
 #define MB_SERIAL_RX_FLUSH_RETRY    (2)
 #define MB_QUEUE_LENGTH             (20)
-#define MB_SERIAL_TOUT              (3)
+#define MB_SERIAL_TOUT              (MB_SERIAL_RX_TOUT_SYMB)
 #define MB_SERIAL_TX_TOUT_TICKS     (pdMS_TO_TICKS(400))
 #define MB_SERIAL_TASK_STACK_SIZE   (CONFIG_FMB_PORT_TASK_STACK_SIZE)
 #define MB_SERIAL_RX_TOUT_TICKS     (pdMS_TO_TICKS(100))
@@ -41,63 +43,33 @@ typedef struct
     QueueHandle_t uart_queue;           // A queue to handle UART event.
     TaskHandle_t  task_handle;          // UART task to handle UART event.
     SemaphoreHandle_t bus_sema_handle;   // Rx blocking semaphore handle
+    uint8_t *rx_buf_pool;               // Two frame buffers, one is lent to the transport
+    uint8_t *rx_buffer;                 // The frame accumulated while the bytes arrive
+    mb_port_ser_rx_stream_t rx_stream;  // The state of the frame accumulated in the rx_buffer
+    uint16_t rx_frame_crc;              // CRC16 of the last frame read from the port
+    bool rx_frame_crc_valid;            // The rx_frame_crc is calculated over the whole frame
+    _Atomic(bool) rx_frame_ready;       // The frame is complete and waits to be read
+    _Atomic(bool) rx_reset;             // Drop the accumulated data on next receive event
+    _Atomic(bool) rx_tout_pending;      // The timeout event arrived before the previous frame is read
+    mb_port_ser_stats_t stats;          // Receive statistic counters
+    uint32_t char_time_us;              // Time of one character on the line
+    uint32_t t35_us;                    // Minimal idle time between RTU frames (0 - not applied)
+    int64_t frame_end_time_us;          // Time stamp of the last frame end on the bus
+    int64_t rx_frame_end_us;            // Time stamp of the end of the frame waiting to be read
 } mb_ser_port_t;
 
 /* ----------------------- Static variables & functions ----------------------*/
 static const char *TAG = "mb_port.serial";
 
-static bool mb_port_ser_bus_sema_init(mb_port_base_t *inst)
-{
-    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
-    port_obj->bus_sema_handle = xSemaphoreCreateBinary();
-    MB_RETURN_ON_FALSE((port_obj->bus_sema_handle), false , TAG, 
-                        "%s: RX semaphore create failure.", inst->descr.parent_name);
-    return true;
-}
-
-static void mb_port_ser_bus_sema_close(mb_port_base_t *inst)
-{
-    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
-    if (port_obj->bus_sema_handle) {
-        vSemaphoreDelete(port_obj->bus_sema_handle);
-        port_obj->bus_sema_handle = NULL;
-    }
-}
-
-static bool mb_port_ser_bus_sema_take(mb_port_base_t *inst, uint32_t tm_ticks)
-{
-    BaseType_t status = pdTRUE;
-    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
-    status = xSemaphoreTake(port_obj->bus_sema_handle, tm_ticks );
-    MB_RETURN_ON_FALSE((status == pdTRUE), false , TAG, 
-                        "%s,  rx semaphore take failure.", inst->descr.parent_name);
-    ESP_LOGV(TAG, "%s: take RX semaphore (%" PRIu32" ticks).", inst->descr.parent_name, tm_ticks);
-    return true;
-}
-
-static void mb_port_ser_bus_sema_release(mb_port_base_t *inst)
-{
-    BaseType_t status = pdFALSE;
-    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
-    status = xSemaphoreGive(port_obj->bus_sema_handle);
-    if (status != pdTRUE) {
-        ESP_LOGD(TAG, "%s,  rx semaphore is free.", inst->descr.parent_name);
-    }
-}
-
-static bool mb_port_ser_bus_sema_is_busy(mb_port_base_t *inst)
-{
-    BaseType_t status = pdFALSE;
-    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
-    status = (uxSemaphoreGetCount(port_obj->bus_sema_handle) == 0) ? true : false;
-    return status;
-}
-
 static void mb_port_ser_rx_flush(mb_port_base_t *inst)
 {
     size_t size = 1;
     esp_err_t err = ESP_OK;
     mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    // The accumulated frame is dropped by the port task which owns the rx_buffer
+    atomic_store(&(port_obj->rx_reset), true);
+    atomic_store(&(port_obj->rx_frame_ready), false);
+    atomic_store(&(port_obj->rx_tout_pending), false);
     for (int cnt = 0; (cnt < MB_SERIAL_RX_FLUSH_RETRY) && size; cnt++) {
         err = uart_get_buffered_data_len(port_obj->ser_opts.port, &size);
         MB_RETURN_ON_FALSE((err == ESP_OK), ; , TAG, 
@@ -116,7 +88,7 @@ void mb_port_ser_enable(mb_port_base_t *inst)
     mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
     CRITICAL_SECTION (port_obj->base.lock) {
         atomic_store(&(port_obj->enabled), true);
-        mb_port_ser_bus_sema_release(inst);
+        mb_port_ser_bus_sema_release(inst, port_obj->bus_sema_handle);
         ESP_LOGD(TAG, "%s, resume port.", port_obj->base.descr.parent_name);
         // Resume receiver task from known position
         xTaskNotifyGive(port_obj->task_handle);
@@ -133,6 +105,74 @@ void mb_port_ser_disable(mb_port_base_t *inst)
     }
 }
 
+// Drop only the counted bytes, the start of the next frame can already follow them in the ring buffer
+static void mb_port_ser_rx_drain(mb_ser_port_t *port_obj, size_t size)
+{
+    while (size) {
+        size_t chunk = (size < MB_BUFFER_SIZE) ? size : MB_BUFFER_SIZE;
+        int count = uart_read_bytes(port_obj->ser_opts.port, port_obj->rx_buffer, chunk, 0);
+        if (count <= 0) {
+            break;
+        }
+        size -= count;
+    }
+}
+
+// Pull the received bytes from the UART ring buffer and advance the CRC of the frame
+static void mb_port_ser_rx_stream(mb_ser_port_t *port_obj)
+{
+    size_t size = 0;
+    // Keep the new data in the ring buffer until the completed frame is read,
+    // the reset request is checked after, as it is stored before the ready flag is cleared
+    if (atomic_load(&(port_obj->rx_frame_ready))) {
+        return;
+    }
+    if (atomic_exchange(&(port_obj->rx_reset), false)) {
+        mb_port_ser_rx_stream_reset(&port_obj->rx_stream);
+    }
+    if (uart_get_buffered_data_len(port_obj->ser_opts.port, &size) != ESP_OK) {
+        return;
+    }
+    if (port_obj->rx_stream.skip) {
+        // The rest of the frame addressed to other slave is dropped without the checksum calculation
+        mb_port_ser_rx_drain(port_obj, size);
+        return;
+    }
+    size = ((port_obj->rx_stream.count + size) < MB_BUFFER_SIZE) ? size : (MB_BUFFER_SIZE - port_obj->rx_stream.count);
+    if (size) {
+        uint16_t prev_count = port_obj->rx_stream.count;
+        int count = uart_read_bytes(port_obj->ser_opts.port, &port_obj->rx_buffer[prev_count], size, 0);
+        if (count <= 0) {
+            return;
+        }
+        port_obj->rx_stream.count += count;
+        port_obj->stats.copy_bytes += count;
+#if (MB_SLAVE_EARLY_ADDR_FILTER_ENABLED)
+        if (!port_obj->base.descr.is_master
+                && mb_port_ser_is_foreign_frame(port_obj->ser_opts.mode, port_obj->ser_opts.uid,
+                                                port_obj->rx_buffer, prev_count, port_obj->rx_stream.count)) {
+            // The rest of the frame is drained by the next receive events
+            port_obj->rx_stream.skip = true;
+            return;
+        }
+#endif
+        if (port_obj->ser_opts.mode == MB_RTU) {
+            port_obj->rx_stream.crc = mb_crc16_update(port_obj->rx_stream.crc, &port_obj->rx_buffer[prev_count], count);
+        }
+    }
+}
+
+// Post the deferred timeout event back to the port task to complete the frame left in the ringbuffer
+static void mb_port_ser_rx_tout_repeat(mb_ser_port_t *port_obj)
+{
+    if (atomic_exchange(&(port_obj->rx_tout_pending), false)) {
+        uart_event_t tout_event = {.type = UART_DATA, .size = 0, .timeout_flag = true};
+        if (xQueueSend(port_obj->uart_queue, &tout_event, 0) != pdTRUE) {
+            ESP_LOGD(TAG, "%s, repeat rx timeout event fail.", port_obj->base.descr.parent_name);
+        }
+    }
+}
+
 // UART receive event task
 static void mb_port_ser_task(void *p_args)
 {
@@ -151,22 +191,54 @@ static void mb_port_ser_task(void *p_args)
             switch(event.type) {
                 case UART_DATA:
                     ESP_LOGD(TAG, "%s, data event, len: %d.", port_obj->base.descr.parent_name, (int)event.size);
+                    if (port_obj->rx_buffer) {
+                        mb_port_ser_rx_stream(port_obj);
+                    }
                     // This flag set in the event means that no more
                     // data received during configured timeout and UART TOUT feature is triggered
                     if (event.timeout_flag) {
+                        // The last character is received the rx timeout before the event
+                        port_obj->frame_end_time_us = esp_timer_get_time()
+                                                        - (MB_SERIAL_TOUT * port_obj->char_time_us);
                         // If bus is busy or fragmented data is received, then flush buffer
-                        if (mb_port_ser_bus_sema_is_busy(&port_obj->base) && port_obj->base.descr.is_master) {
+                        if (mb_port_ser_bus_sema_is_busy(port_obj->bus_sema_handle) && port_obj->base.descr.is_master) {
                             mb_port_ser_rx_flush(&port_obj->base);
                             break;
                         }
-                        uart_get_buffered_data_len(port_obj->ser_opts.port, (unsigned int*)&event.size);
+                        if (port_obj->rx_stream.skip) {
+                            // Do not wake up the stack for the frame addressed to other slave
+                            port_obj->stats.filtered_count++;
+                            MB_DIAG_INC(&port_obj->base, MB_DIAG_BUS_MSG_CNT);
+                            ESP_LOGD(TAG, "%s, drop frame for other slave.", port_obj->base.descr.parent_name);
+                            mb_port_ser_rx_stream_reset(&port_obj->rx_stream);
+                            break;
+                        }
+                        if (!port_obj->rx_buffer) {
+                            uart_get_buffered_data_len(port_obj->ser_opts.port, (unsigned int*)&event.size);
+                        } else if (!atomic_load(&(port_obj->rx_frame_ready))) {
+                            event.size = port_obj->rx_stream.count;
+                        } else {
+                            // The previous frame is not read yet, the data of the next one stays in the ringbuffer
+                            // and the timeout is posted again when the frame is taken by the transport
+                            atomic_store(&(port_obj->rx_tout_pending), true);
+                            if (!atomic_load(&(port_obj->rx_frame_ready))) {
+                                // The frame has been taken meanwhile, repeat the timeout event now
+                                mb_port_ser_rx_tout_repeat(port_obj);
+                            }
+                            break;
+                        }
                         port_obj->recv_length = (event.size < MB_BUFFER_SIZE) ? event.size : MB_BUFFER_SIZE;
                         if (event.size <= MB_SER_PDU_SIZE_MIN) {
                             ESP_LOGD(TAG, "%s, drop short packet %d byte(s)", port_obj->base.descr.parent_name, (int)event.size);
+                            MB_STATS_DROP(&port_obj->base, 1);
                             (void)mb_port_ser_rx_flush(&port_obj->base);
                             break;
                         }
+                        port_obj->rx_frame_end_us = port_obj->frame_end_time_us;
                         // New frame is received, send an event to main FSM to read it into receiver buffer
+                        atomic_store(&(port_obj->rx_frame_ready), (port_obj->rx_buffer != NULL));
+                        port_obj->stats.frame_count++;
+                        MB_STAGE_TRACE(&port_obj->base, MB_TRACE_STAGE_RX_READY, 0, port_obj->recv_length, port_obj->rx_frame_end_us);
                         mb_port_event_post(&port_obj->base, EVENT(EV_FRAME_RECEIVED, port_obj->recv_length, NULL, 0));
                         ESP_LOGD(TAG, "%s, frame %d bytes is ready.", port_obj->base.descr.parent_name, (int)port_obj->recv_length);
                     }
@@ -174,11 +246,17 @@ static void mb_port_ser_task(void *p_args)
                 //Event of HW FIFO overflow detected
                 case UART_FIFO_OVF:
                     ESP_LOGD(TAG, "%s, hw fifo overflow.", port_obj->base.descr.parent_name);
+#if MB_FUNC_DIAG_ENABLED
+                    mb_port_diag_set_overrun(&port_obj->base);
+#endif
                     xQueueReset(port_obj->uart_queue);
                     break;
                 //Event of UART ring buffer full
                 case UART_BUFFER_FULL:
                     ESP_LOGD(TAG, "%s, ring buffer full.", port_obj->base.descr.parent_name);
+#if MB_FUNC_DIAG_ENABLED
+                    mb_port_diag_set_overrun(&port_obj->base);
+#endif
                     (void)mb_port_ser_rx_flush(&port_obj->base);
                     break;
                 //Event of UART RX break detected
@@ -245,10 +323,24 @@ mb_err_enum_t mb_port_ser_create(mb_serial_opts_t *ser_opts, mb_port_base_t **in
     err = uart_set_rx_timeout(ser_port->ser_opts.port, MB_SERIAL_TOUT);
     MB_GOTO_ON_FALSE((err == ESP_OK), MB_EILLSTATE, error, TAG,
                         "%s, mb serial set rx timeout failure, returned (0x%x).", ser_port->base.descr.parent_name, (int)err);
+    // Calculate the frame timing for the configured character format
+    uint32_t bits_x2 = mb_port_ser_get_char_bits_x2(&ser_port->ser_opts);
+    ser_port->char_time_us = MB_SER_GET_CHARS_TIME_US(2, bits_x2, ser_port->ser_opts.baudrate);
+    ser_port->t35_us = (ser_port->ser_opts.mode == MB_RTU) ? MB_SER_GET_T35_US(bits_x2, ser_port->ser_opts.baudrate) : 0;
+    ESP_LOGD(TAG, "%s, character time: %" PRIu32 " us, T1.5: %" PRIu32 " us, T3.5: %" PRIu32 " us.",
+                ser_port->base.descr.parent_name, ser_port->char_time_us,
+                (uint32_t)MB_SER_GET_T15_US(bits_x2, ser_port->ser_opts.baudrate), ser_port->t35_us);
     // Set always timeout flag to trigger timeout interrupt even after rx fifo full
     uart_set_always_rx_timeout(ser_port->ser_opts.port, true);
-    MB_GOTO_ON_FALSE((mb_port_ser_bus_sema_init(&ser_port->base)), MB_EILLSTATE, error, TAG,
+    MB_GOTO_ON_FALSE((mb_port_ser_bus_sema_init(&ser_port->base, &ser_port->bus_sema_handle)), MB_EILLSTATE, error, TAG,
                                 "%s, mb serial bus semaphore create fail.", ser_port->base.descr.parent_name);
+    // The frame is accumulated while received to check the address and CRC without additional pass,
+    // the completed frame buffer is lent to the transport and the next frame is received into other one
+    ser_port->rx_buf_pool = calloc(2, MB_BUFFER_SIZE);
+    MB_GOTO_ON_FALSE((ser_port->rx_buf_pool), MB_EILLSTATE, error, TAG,
+                            "%s, mb serial receive buffer allocation fail.", ser_port->base.descr.parent_name);
+    ser_port->rx_buffer = ser_port->rx_buf_pool;
+    mb_port_ser_rx_stream_reset(&ser_port->rx_stream);
     // Suspend task on start and then resume when initialization is completed
     atomic_store(&(ser_port->enabled), false);
     // Create a task to handle UART events
@@ -271,7 +363,8 @@ error:
         }
         uart_driver_delete(ser_port->ser_opts.port);
         CRITICAL_SECTION_CLOSE(ser_port->base.lock);
-        mb_port_ser_bus_sema_close(&ser_port->base);
+        mb_port_ser_bus_sema_close(&ser_port->bus_sema_handle);
+        free(ser_port->rx_buf_pool);
     }
     free(ser_port);
     return MB_EILLSTATE;
@@ -282,8 +375,9 @@ void mb_port_ser_delete(mb_port_base_t *inst)
     mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
     vTaskDelete(port_obj->task_handle);
     ESP_ERROR_CHECK(uart_driver_delete(port_obj->ser_opts.port));
-    mb_port_ser_bus_sema_close(inst);
+    mb_port_ser_bus_sema_close(&port_obj->bus_sema_handle);
     CRITICAL_SECTION_CLOSE(inst->lock);
+    free(port_obj->rx_buf_pool);
     free(port_obj);
 }
 
@@ -294,12 +388,40 @@ bool mb_port_ser_recv_data(mb_port_base_t *inst, uint8_t **ser_frame, uint16_t *
     uint16_t counter = *p_ser_length ? *p_ser_length : port_obj->recv_length;
     bool status = false;
 
-    status = mb_port_ser_bus_sema_take(inst, pdMS_TO_TICKS(mb_port_timer_get_response_time_ms(inst)));
+    status = mb_port_ser_bus_sema_take(inst, port_obj->bus_sema_handle, pdMS_TO_TICKS(mb_port_timer_get_response_time_ms(inst)));
+    port_obj->rx_frame_crc_valid = false;
     if (status && counter && *ser_frame && atomic_load(&(port_obj->enabled))) {
-        // Read frame data from the ringbuffer of receiver
-        counter = uart_read_bytes(port_obj->ser_opts.port, *ser_frame, counter, MB_SERIAL_RX_TOUT_TICKS);
+        if (port_obj->rx_buffer && atomic_load(&(port_obj->rx_frame_ready))) {
+            // The frame is already copied from the ringbuffer by the port task, lend its buffer
+            // to the transport as is. It stays valid until the next frame is read from the port.
+            counter = (counter < port_obj->rx_stream.count) ? counter : port_obj->rx_stream.count;
+            *ser_frame = port_obj->rx_buffer;
+            port_obj->rx_buffer = (port_obj->rx_buffer == port_obj->rx_buf_pool)
+                                    ? &port_obj->rx_buf_pool[MB_BUFFER_SIZE] : port_obj->rx_buf_pool;
+            port_obj->rx_frame_crc = port_obj->rx_stream.crc;
+            port_obj->rx_frame_crc_valid = (port_obj->ser_opts.mode == MB_RTU) && (counter == port_obj->rx_stream.count);
+            port_obj->stats.buf_lend_count++;
+            port_obj->stats.frame_copy_bytes = port_obj->rx_stream.count;
+            atomic_store(&(port_obj->rx_reset), true);
+            atomic_store(&(port_obj->rx_frame_ready), false);
+            mb_port_ser_rx_tout_repeat(port_obj);
+        } else {
+            // Read frame data from the ringbuffer of receiver
+            counter = uart_read_bytes(port_obj->ser_opts.port, *ser_frame, counter, MB_SERIAL_RX_TOUT_TICKS);
+            port_obj->stats.copy_count++;
+            port_obj->stats.copy_bytes += (counter > 0) ? counter : 0;
+            port_obj->stats.frame_copy_bytes = (counter > 0) ? counter : 0;
+            port_obj->rx_frame_end_us = 0;
+        }
         // Store the timestamp of received frame
         port_obj->recv_time_stamp = esp_timer_get_time();
+        if (port_obj->rx_frame_end_us && (port_obj->recv_time_stamp > port_obj->rx_frame_end_us)) {
+            // The time from the end of frame on the bus until it is passed to the transport
+            uint32_t latency = (uint32_t)(port_obj->recv_time_stamp - port_obj->rx_frame_end_us);
+            port_obj->stats.recv_latency_us = latency;
+            port_obj->stats.recv_latency_max_us = (latency > port_obj->stats.recv_latency_max_us)
+                                                    ? latency : port_obj->stats.recv_latency_max_us;
+        }
         ESP_LOGD(TAG, "%s, received data: %d bytes.", inst->descr.parent_name, (int)counter);
         MB_PRT_BUF(inst->descr.parent_name, ":PORT_RECV", *ser_frame, counter, ESP_LOG_DEBUG);
         int64_t time_delta = (port_obj->recv_time_stamp > port_obj->send_time_stamp) ? 
@@ -312,20 +434,53 @@ bool mb_port_ser_recv_data(mb_port_base_t *inst, uint8_t **ser_frame, uint16_t *
         ESP_LOGE(TAG, "%s: junk data (%d bytes) received. ", inst->descr.parent_name, (int)counter);
     }
     *p_ser_length = counter;
-    mb_port_ser_bus_sema_release(inst);
+    mb_port_ser_bus_sema_release(inst, port_obj->bus_sema_handle);
     return status;
 }
 
+bool mb_port_ser_get_recv_crc(mb_port_base_t *inst, uint16_t *crc)
+{
+    MB_RETURN_ON_FALSE((inst && crc), false, TAG, "mb serial get crc failure.");
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    if (port_obj->rx_frame_crc_valid) {
+        *crc = port_obj->rx_frame_crc;
+    }
+    return port_obj->rx_frame_crc_valid;
+}
+
+// The time stamp of the frame end on the bus if the frame is lent by the port task, otherwise the read time
+int64_t mb_port_ser_get_recv_time_us(mb_port_base_t *inst)
+{
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    return port_obj->rx_frame_end_us ? port_obj->rx_frame_end_us : port_obj->recv_time_stamp;
+}
+
+bool mb_port_ser_get_stats(mb_port_base_t *inst, mb_port_ser_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((inst && stats), false, TAG, "mb serial get stats failure.");
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    *stats = port_obj->stats;
+    return true;
+}
+
+// The rest of T3.5 idle interval, the transport defers the frame with the port timer
+uint32_t mb_port_ser_get_send_delay_us(mb_port_base_t *inst)
+{
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    return mb_port_ser_get_frame_gap_us(port_obj->frame_end_time_us, port_obj->t35_us);
+}
+
 bool mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *p_ser_frame, uint16_t ser_length)
 {
     bool res = false;
     int count = 0;
     mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
 
-    res = mb_port_ser_bus_sema_take(inst, pdMS_TO_TICKS(mb_port_timer_get_response_time_ms(inst)));
+    res = mb_port_ser_bus_sema_take(inst, port_obj->bus_sema_handle, pdMS_TO_TICKS(mb_port_timer_get_response_time_ms(inst)));
     if (res && p_ser_frame && ser_length && atomic_load(&(port_obj->enabled))) {
         // Flush buffer received from previous transaction
         mb_port_ser_rx_flush(inst);
+        mb_port_ser_wait_frame_gap(port_obj->frame_end_time_us, port_obj->t35_us);
         count = uart_write_bytes(port_obj->ser_opts.port, p_ser_frame, ser_length);
         // Waits while UART sending the packet
         esp_err_t status = uart_wait_tx_done(port_obj->ser_opts.port, MB_SERIAL_TX_TOUT_TICKS);
@@ -334,11 +489,12 @@ bool mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *p_ser_frame, uint16_t
                                 inst->descr.parent_name);
         MB_PRT_BUF(inst->descr.parent_name, ":PORT_SEND", p_ser_frame, ser_length, ESP_LOG_DEBUG);
         port_obj->send_time_stamp = esp_timer_get_time();
+        port_obj->frame_end_time_us = port_obj->send_time_stamp;
         res = true;
     } else {
         ESP_LOGE(TAG, "%s, send fail state:%d, %p, %u. ", inst->descr.parent_name, (int)port_obj->tx_state_en, p_ser_frame, (unsigned)ser_length);
     }
-    mb_port_ser_bus_sema_release(inst);
+    mb_port_ser_bus_sema_release(inst, port_obj->bus_sema_handle);
     return res;
 }
 
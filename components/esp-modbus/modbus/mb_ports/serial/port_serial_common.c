@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "esp_timer.h"
+#include "mb_common.h"
+#include "port_common.h"
+#include "mb_config.h"
+#include "port_serial_common.h"
+#include "mb_proto.h"
+#include "ascii/ascii_lrc.h"
+#include "rtu/mbcrc.h"
+
+#if (CONFIG_FMB_COMM_MODE_ASCII_EN || CONFIG_FMB_COMM_MODE_RTU_EN)
+
+// The helpers shared by the UART and pty serial ports
+static const char *TAG = "mb_port.serial";
+
+bool mb_port_ser_is_foreign_frame(mb_mode_type_t mode, uint8_t uid, const uint8_t *frame,
+                                    uint16_t prev_count, uint16_t count)
+{
+    uint8_t addr = 0;
+    if (mode == MB_RTU) {
+        // The address is checked once, when the first byte of the frame is received
+        if ((prev_count > MB_SER_PDU_ADDR_OFF) || (count <= MB_SER_PDU_ADDR_OFF)) {
+            return false;
+        }
+        addr = frame[MB_SER_PDU_ADDR_OFF];
+    } else {
+        // The ASCII frame starts with ':' followed by two characters of the address
+        if ((prev_count >= 3) || (count < 3) || (frame[0] != MB_ASCII_START)) {
+            return false;
+        }
+        uint8_t addr_hi = mb_char2bin(frame[1]);
+        uint8_t addr_lo = mb_char2bin(frame[2]);
+        if ((addr_hi > 0x0F) || (addr_lo > 0x0F)) {
+            return false;
+        }
+        addr = (uint8_t)(addr_hi << 4 | addr_lo);
+    }
+    return ((addr != uid) && (addr != MB_ADDRESS_BROADCAST) && (addr != MB_TCP_PSEUDO_ADDRESS));
+}
+
+bool mb_port_ser_bus_sema_init(mb_port_base_t *inst, SemaphoreHandle_t *sema_handle)
+{
+    *sema_handle = xSemaphoreCreateBinary();
+    MB_RETURN_ON_FALSE((*sema_handle), false , TAG,
+                        "%s: RX semaphore create failure.", inst->descr.parent_name);
+    return true;
+}
+
+void mb_port_ser_bus_sema_close(SemaphoreHandle_t *sema_handle)
+{
+    if (*sema_handle) {
+        vSemaphoreDelete(*sema_handle);
+        *sema_handle = NULL;
+    }
+}
+
+bool mb_port_ser_bus_sema_take(mb_port_base_t *inst, SemaphoreHandle_t sema_handle, uint32_t tm_ticks)
+{
+    BaseType_t status = pdTRUE;
+    status = xSemaphoreTake(sema_handle, tm_ticks );
+    MB_RETURN_ON_FALSE((status == pdTRUE), false , TAG,
+                        "%s,  rx semaphore take failure.", inst->descr.parent_name);
+    ESP_LOGV(TAG, "%s: take RX semaphore (%" PRIu32" ticks).", inst->descr.parent_name, tm_ticks);
+    return true;
+}
+
+void mb_port_ser_bus_sema_release(mb_port_base_t *inst, SemaphoreHandle_t sema_handle)
+{
+    BaseType_t status = pdFALSE;
+    status = xSemaphoreGive(sema_handle);
+    if (status != pdTRUE) {
+        ESP_LOGD(TAG, "%s,  rx semaphore is free.", inst->descr.parent_name);
+    }
+}
+
+bool mb_port_ser_bus_sema_is_busy(SemaphoreHandle_t sema_handle)
+{
+    return (uxSemaphoreGetCount(sema_handle) == 0);
+}
+
+void mb_port_ser_rx_stream_reset(mb_port_ser_rx_stream_t *rx_stream)
+{
+    rx_stream->count = 0;
+    rx_stream->crc = MB_CRC16_INIT;
+    rx_stream->skip = false;
+}
+
+uint32_t mb_port_ser_get_char_bits_x2(const mb_serial_opts_t *ser_opts)
+{
+    uint32_t bits_x2 = 2 * (1 + 5 + (uint32_t)ser_opts->data_bits);
+    bits_x2 += (ser_opts->parity != UART_PARITY_DISABLE) ? 2 : 0;
+    switch (ser_opts->stop_bits) {
+        case UART_STOP_BITS_1_5:
+            bits_x2 += 3;
+            break;
+        case UART_STOP_BITS_2:
+            bits_x2 += 4;
+            break;
+        default:
+            bits_x2 += 2;
+            break;
+    }
+    return bits_x2;
+}
+
+void mb_port_ser_wait_until(int64_t time_us)
+{
+    int64_t wait_us = time_us - esp_timer_get_time();
+    if (wait_us > 0) {
+        // The wait is rounded up to the tick, the task is never spinning
+        vTaskDelay((TickType_t)((wait_us + (portTICK_PERIOD_MS * 1000) - 1) / (portTICK_PERIOD_MS * 1000)));
+    }
+}
+
+uint32_t mb_port_ser_get_frame_gap_us(int64_t frame_end_time_us, uint32_t t35_us)
+{
+    int64_t wait_us = (frame_end_time_us + t35_us) - esp_timer_get_time();
+    return (t35_us && (wait_us > 0)) ? (uint32_t)wait_us : 0;
+}
+
+void mb_port_ser_wait_frame_gap(int64_t frame_end_time_us, uint32_t t35_us)
+{
+    if (mb_port_ser_get_frame_gap_us(frame_end_time_us, t35_us)) {
+        mb_port_ser_wait_until(frame_end_time_us + t35_us);
+    }
+}
+
+#endif
@@ -12,6 +12,8 @@
 #include "mb_types.h"
 #include "mb_frame.h"
 #include "mb_port_types.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,13 +25,105 @@ typedef struct mb_port_base_t mb_port_base_t;
 
 #if (CONFIG_FMB_COMM_MODE_ASCII_EN || CONFIG_FMB_COMM_MODE_RTU_EN)
 
+/**
+ * @brief The receive statistic counters of the serial port
+ */
+typedef struct {
+    uint32_t frame_count;           /*!< Number of frames passed to the stack */
+    uint32_t filtered_count;        /*!< Number of frames addressed to other slaves dropped by the port */
+    uint32_t buf_lend_count;        /*!< Number of frames read by the port task and lent to the transport in the port buffer */
+    uint32_t copy_count;            /*!< Number of frames read from the driver into the transport buffer on request */
+    uint32_t copy_bytes;            /*!< Number of bytes copied from the driver */
+    uint32_t frame_copy_bytes;      /*!< Number of bytes copied from the driver for the last frame passed to the transport */
+    uint32_t recv_latency_us;       /*!< Time from the end of the last frame on the bus until it is read, us */
+    uint32_t recv_latency_max_us;   /*!< Maximum time from the end of frame on the bus until it is read, us */
+} mb_port_ser_stats_t;
+
+/**
+ * @brief The state of the frame accumulated by the receive task of the serial port
+ */
+typedef struct {
+    uint16_t count;                 /*!< Number of bytes accumulated in the receive buffer */
+    uint16_t crc;                   /*!< CRC16 accumulated over the received bytes */
+    bool skip;                      /*!< The frame is addressed to other slave and is dropped */
+} mb_port_ser_rx_stream_t;
+
 mb_err_enum_t mb_port_ser_create(mb_serial_opts_t *ser_opts, mb_port_base_t **in_out_obj);
 bool mb_port_ser_recv_data(mb_port_base_t *inst, uint8_t **ser_frame, uint16_t *p_ser_length);
+bool mb_port_ser_get_recv_crc(mb_port_base_t *inst, uint16_t *crc);
+int64_t mb_port_ser_get_recv_time_us(mb_port_base_t *inst);
+bool mb_port_ser_get_stats(mb_port_base_t *inst, mb_port_ser_stats_t *stats);
 bool mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *p_ser_frame, uint16_t ser_length);
+uint32_t mb_port_ser_get_send_delay_us(mb_port_base_t *inst);
 void mb_port_ser_enable(mb_port_base_t *inst);
 void mb_port_ser_disable(mb_port_base_t *inst);
 void mb_port_ser_delete(mb_port_base_t *inst);
 
+/**
+ * @brief Check the address field of the serial frame as soon as it is received
+ *
+ * The address is checked only once, by the call which receives it: the first byte of
+ * the RTU frame or the ':' and two address characters of the ASCII frame.
+ *
+ * @param mode the serial communication mode (MB_RTU or MB_ASCII)
+ * @param uid the address of the slave
+ * @param frame the received part of the frame
+ * @param prev_count the number of bytes received before this call
+ * @param count the number of bytes received including this call
+ * @return true if the frame is addressed to other slave, false if it is addressed to
+ *         this slave, broadcast or the address is not complete yet
+ */
+bool mb_port_ser_is_foreign_frame(mb_mode_type_t mode, uint8_t uid, const uint8_t *frame,
+                                    uint16_t prev_count, uint16_t count);
+
+/**
+ * @brief The bus semaphore of the serial port, serializes the access of the transport to the port
+ *        (the semaphore is created free)
+ */
+bool mb_port_ser_bus_sema_init(mb_port_base_t *inst, SemaphoreHandle_t *sema_handle);
+void mb_port_ser_bus_sema_close(SemaphoreHandle_t *sema_handle);
+bool mb_port_ser_bus_sema_take(mb_port_base_t *inst, SemaphoreHandle_t sema_handle, uint32_t tm_ticks);
+void mb_port_ser_bus_sema_release(mb_port_base_t *inst, SemaphoreHandle_t sema_handle);
+bool mb_port_ser_bus_sema_is_busy(SemaphoreHandle_t sema_handle);
+
+/**
+ * @brief Drop the accumulated frame and start the new one
+ */
+void mb_port_ser_rx_stream_reset(mb_port_ser_rx_stream_t *rx_stream);
+
+/**
+ * @brief Get the number of bits of one character including start, parity and stop bits
+ *
+ * @param ser_opts the serial options of the port
+ * @return the doubled number of bits to allow 1.5 stop bits
+ */
+uint32_t mb_port_ser_get_char_bits_x2(const mb_serial_opts_t *ser_opts);
+
+/**
+ * @brief Wait until the time stamp of esp_timer in the ticks of scheduler
+ *
+ * The wait is rounded up to the tick, the transports which need the exact timing
+ * defer the transmission with the port timer instead (see mb_port_ser_get_send_delay_us).
+ */
+void mb_port_ser_wait_until(int64_t time_us);
+
+/**
+ * @brief Get the rest of T3.5 idle interval after the last frame on the bus
+ *
+ * @param frame_end_time_us the time stamp of the last frame end on the bus
+ * @param t35_us the minimal idle time between frames (0 - not applied)
+ * @return the time in microseconds to wait before the transmission, 0 - the frame can be sent now
+ */
+uint32_t mb_port_ser_get_frame_gap_us(int64_t frame_end_time_us, uint32_t t35_us);
+
+/**
+ * @brief Keep the T3.5 idle interval after the last frame on the bus before the transmission
+ *
+ * @param frame_end_time_us the time stamp of the last frame end on the bus
+ * @param t35_us the minimal idle time between frames (0 - not applied)
+ */
+void mb_port_ser_wait_frame_gap(int64_t frame_end_time_us, uint32_t t35_us);
+
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,554 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+// The pty functions (posix_openpt, ptsname, cfmakeraw) are the extensions of the host libc
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+#include "esp_timer.h"
+#include "mb_common.h"
+#include "port_common.h"
+#include "mb_config.h"
+#include "port_serial_common.h"
+#include "mb_proto.h"
+#include "rtu/mbcrc.h"
+
+// The serial port of the linux target. The frames are transferred over the pseudo terminal (pty),
+// the first instance opening the port number creates the pty and links its name to the port path,
+// the other instance of the stack or an external tool opens the link as the other end of the line.
+
+/* ----------------------- Defines ------------------------------------------*/
+#define MB_SERIAL_RX_SEMA_TOUT_MS   (1000)
+#define MB_SERIAL_RX_SEMA_TOUT      (pdMS_TO_TICKS(MB_SERIAL_RX_SEMA_TOUT_MS))
+#define MB_SERIAL_TOUT              (MB_SERIAL_RX_TOUT_SYMB)
+#define MB_SERIAL_TASK_STACK_SIZE   (CONFIG_FMB_PORT_TASK_STACK_SIZE)
+#define MB_SERIAL_RX_TOUT_US        (100000)
+#define MB_SERIAL_PATH_MAX_LEN      (64)
+
+#define MB_PTY_PATH_FMT             (CONFIG_FMB_PORT_PTY_PATH)
+#define MB_PTY_JITTER_US            (CONFIG_FMB_PORT_PTY_JITTER_US)
+
+#if (CONFIG_FMB_COMM_MODE_ASCII_EN || CONFIG_FMB_COMM_MODE_RTU_EN)
+
+typedef struct
+{
+    mb_port_base_t base;
+    // serial communication properties
+    mb_serial_opts_t ser_opts;
+    bool tx_state_en;
+    uint16_t recv_length;
+    uint64_t send_time_stamp;
+    uint64_t recv_time_stamp;
+    _Atomic(bool) enabled;
+    int fd;                             // The end of the pty used by the port
+    int peer_fd;                        // The other end kept opened by the creator of the pty
+    bool is_owner;                      // The pty is created by this instance and is removed on delete
+    char path[MB_SERIAL_PATH_MAX_LEN];  // The link to the pty for the port number
+    uint32_t rand_state;                // The state of generator for the character jitter
+    TaskHandle_t  task_handle;          // Receive task of the port
+    SemaphoreHandle_t bus_sema_handle;  // Rx blocking semaphore handle
+    uint8_t *rx_buf_pool;               // Two frame buffers, one is lent to the transport
+    uint8_t *rx_buffer;                 // The frame accumulated while the bytes arrive
+    mb_port_ser_rx_stream_t rx_stream;  // The state of the frame accumulated in the rx_buffer
+    uint16_t rx_frame_crc;              // CRC16 of the last frame read from the port
+    bool rx_frame_crc_valid;            // The rx_frame_crc is calculated over the whole frame
+    _Atomic(bool) rx_frame_ready;       // The frame is complete and waits to be read
+    _Atomic(bool) rx_reset;             // Drop the accumulated data on next receive event
+    mb_port_ser_stats_t stats;          // Receive statistic counters
+    uint32_t char_time_us;              // Time of one character on the line
+    uint32_t t35_us;                    // Minimal idle time between RTU frames (0 - not applied)
+    uint32_t rx_tout_us;                // Idle time on the line which completes the received frame
+    int64_t frame_end_time_us;          // Time stamp of the last frame end on the bus
+    int64_t rx_frame_end_us;            // Time stamp of the end of the frame waiting to be read
+} mb_ser_port_t;
+
+/* ----------------------- Static variables & functions ----------------------*/
+static const char *TAG = "mb_port.serial";
+
+// Read and drop the data pending in the pty, the descriptor is non-blocking
+static void mb_port_ser_pty_drain(int fd)
+{
+    uint8_t scratch[64];
+    while (read(fd, scratch, sizeof(scratch)) > 0) {
+    }
+}
+
+static void mb_port_ser_rx_flush(mb_port_base_t *inst)
+{
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    // The accumulated frame is dropped by the port task which owns the rx_buffer
+    atomic_store(&(port_obj->rx_reset), true);
+    atomic_store(&(port_obj->rx_frame_ready), false);
+    mb_port_ser_pty_drain(port_obj->fd);
+}
+
+void mb_port_ser_enable(mb_port_base_t *inst)
+{
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    CRITICAL_SECTION (port_obj->base.lock) {
+        atomic_store(&(port_obj->enabled), true);
+        mb_port_ser_bus_sema_release(inst, port_obj->bus_sema_handle);
+        ESP_LOGD(TAG, "%s, resume port.", port_obj->base.descr.parent_name);
+        // Resume receiver task from known position
+        xTaskNotifyGive(port_obj->task_handle);
+    }
+}
+
+void mb_port_ser_disable(mb_port_base_t *inst)
+{
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    CRITICAL_SECTION (port_obj->base.lock) {
+        // Suspend port task by itself
+        atomic_store(&(port_obj->enabled), false);
+        ESP_LOGD(TAG, "%s, suspend port.", port_obj->base.descr.parent_name);
+    }
+}
+
+// Drop the accumulated data if the reset is requested and no completed frame waits to be read
+static void mb_port_ser_rx_check_reset(mb_ser_port_t *port_obj)
+{
+    if (!atomic_load(&(port_obj->rx_frame_ready)) && atomic_exchange(&(port_obj->rx_reset), false)) {
+        mb_port_ser_rx_stream_reset(&port_obj->rx_stream);
+    }
+}
+
+// Read the received bytes from the pty and advance the CRC of the frame
+static void mb_port_ser_rx_stream(mb_ser_port_t *port_obj)
+{
+    mb_port_ser_rx_check_reset(port_obj);
+    if (port_obj->rx_stream.skip) {
+        // The rest of the frame addressed to other slave is dropped without the checksum calculation,
+        // only the bytes available now are read as the next frame can follow them
+        (void)read(port_obj->fd, port_obj->rx_buffer, MB_BUFFER_SIZE);
+        return;
+    }
+    size_t size = MB_BUFFER_SIZE - port_obj->rx_stream.count;
+    if (!size) {
+        // The line delivers more data than the frame can hold
+        ESP_LOGD(TAG, "%s, receive buffer full.", port_obj->base.descr.parent_name);
+#if MB_FUNC_DIAG_ENABLED
+        mb_port_diag_set_overrun(&port_obj->base);
+#endif
+        (void)mb_port_ser_rx_flush(&port_obj->base);
+        return;
+    }
+    uint16_t prev_count = port_obj->rx_stream.count;
+    ssize_t count = read(port_obj->fd, &port_obj->rx_buffer[prev_count], size);
+    if (count <= 0) {
+        return;
+    }
+    port_obj->rx_stream.count += count;
+    port_obj->stats.copy_bytes += count;
+#if (MB_SLAVE_EARLY_ADDR_FILTER_ENABLED)
+    if (!port_obj->base.descr.is_master
+            && mb_port_ser_is_foreign_frame(port_obj->ser_opts.mode, port_obj->ser_opts.uid,
+                                            port_obj->rx_buffer, prev_count, port_obj->rx_stream.count)) {
+        // The rest of the frame is drained by the next reads
+        port_obj->rx_stream.skip = true;
+        return;
+    }
+#endif
+    if (port_obj->ser_opts.mode == MB_RTU) {
+        port_obj->rx_stream.crc = mb_crc16_update(port_obj->rx_stream.crc, &port_obj->rx_buffer[prev_count], count);
+    }
+}
+
+// Random gap before the character in range [0, CONFIG_FMB_PORT_PTY_JITTER_US] (xorshift32)
+static uint32_t mb_port_ser_get_jitter_us(mb_ser_port_t *port_obj)
+{
+#if (MB_PTY_JITTER_US > 0)
+    uint32_t x = port_obj->rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    port_obj->rand_state = x;
+    return x % (MB_PTY_JITTER_US + 1);
+#else
+    return 0;
+#endif
+}
+
+static bool mb_port_ser_write_all(int fd, const uint8_t *buf, size_t len)
+{
+    while (len) {
+        ssize_t count = write(fd, buf, len);
+        if (count < 0) {
+            if ((errno == EINTR) || (errno == EAGAIN)) {
+                continue;
+            }
+            return false;
+        }
+        buf += count;
+        len -= count;
+    }
+    return true;
+}
+
+// Write the frame with the timing of the configured line: each character is passed to the pty
+// when its transmission would be completed at the baud rate, plus the random inter-character gap
+static bool mb_port_ser_write_paced(mb_ser_port_t *port_obj, const uint8_t *frame, uint16_t length)
+{
+#if CONFIG_FMB_PORT_PTY_PACING_EN
+    int64_t line_time_us = esp_timer_get_time();
+    uint16_t sent = 0;
+    while (sent < length) {
+        uint16_t count = 0;
+        // The characters which are already due are written at once when the task is late
+        do {
+            line_time_us += port_obj->char_time_us + mb_port_ser_get_jitter_us(port_obj);
+            count++;
+        } while (((sent + count) < length) && (line_time_us <= esp_timer_get_time()));
+        int64_t wait_us = line_time_us - esp_timer_get_time();
+        if (wait_us > 0) {
+            // The pacing task sleeps, the character time is shorter than the tick
+            usleep((useconds_t)wait_us);
+        }
+        if (!mb_port_ser_write_all(port_obj->fd, &frame[sent], count)) {
+            return false;
+        }
+        sent += count;
+    }
+    return true;
+#else
+    return mb_port_ser_write_all(port_obj->fd, frame, length);
+#endif
+}
+
+// The receive task of the pty, the frame is completed by the idle line during the rx timeout
+static void mb_port_ser_task(void *p_args)
+{
+    mb_ser_port_t *port_obj = __containerof(p_args, mb_ser_port_t, base);
+    MB_RETURN_ON_FALSE(port_obj, ;, TAG, "%s, get serial instance fail.", port_obj->base.descr.parent_name);
+    (void)mb_port_ser_rx_flush(&port_obj->base);
+    while(1) {
+        // Workaround to suspend task from known place to avoid dead lock when resume
+        while (!atomic_load(&(port_obj->enabled))) {
+            ESP_LOGI(TAG, "%s, suspend port from task.", port_obj->base.descr.parent_name);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        mb_port_ser_rx_check_reset(port_obj);
+        // Keep the new data in the pty until the completed frame is read, the ready flag is polled
+        // with the short timeout as there is no event when the frame is taken by the transport
+        bool is_ready = atomic_load(&(port_obj->rx_frame_ready));
+        bool in_frame = !is_ready && (port_obj->rx_stream.count || port_obj->rx_stream.skip);
+        uint32_t tout_us = (in_frame || is_ready) ? port_obj->rx_tout_us : MB_SERIAL_RX_TOUT_US;
+        struct timeval tv = {.tv_sec = tout_us / 1000000, .tv_usec = tout_us % 1000000};
+        fd_set readset;
+        FD_ZERO(&readset);
+        if (!is_ready) {
+            FD_SET(port_obj->fd, &readset);
+        }
+        int ret = select(port_obj->fd + 1, &readset, NULL, NULL, &tv);
+        if (ret < 0) {
+            if (errno != EINTR) {
+                ESP_LOGE(TAG, "%s, pty select error = %d.", port_obj->base.descr.parent_name, errno);
+                vTaskDelay(1);
+            }
+            continue;
+        }
+        if (ret > 0) {
+            mb_port_ser_rx_stream(port_obj);
+            continue;
+        }
+        if (!in_frame) {
+            continue;
+        }
+        // No more data received during the rx timeout, the last character is received before it
+        port_obj->frame_end_time_us = esp_timer_get_time() - port_obj->rx_tout_us;
+        // If bus is busy or fragmented data is received, then flush buffer
+        if (mb_port_ser_bus_sema_is_busy(port_obj->bus_sema_handle) && port_obj->base.descr.is_master) {
+            mb_port_ser_rx_flush(&port_obj->base);
+            continue;
+        }
+        if (port_obj->rx_stream.skip) {
+            // Do not wake up the stack for the frame addressed to other slave
+            port_obj->stats.filtered_count++;
+            MB_DIAG_INC(&port_obj->base, MB_DIAG_BUS_MSG_CNT);
+            ESP_LOGD(TAG, "%s, drop frame for other slave.", port_obj->base.descr.parent_name);
+            mb_port_ser_rx_stream_reset(&port_obj->rx_stream);
+            continue;
+        }
+        port_obj->recv_length = port_obj->rx_stream.count;
+        if (port_obj->recv_length <= MB_SER_PDU_SIZE_MIN) {
+            ESP_LOGD(TAG, "%s, drop short packet %d byte(s)", port_obj->base.descr.parent_name, (int)port_obj->recv_length);
+            MB_STATS_DROP(&port_obj->base, 1);
+            (void)mb_port_ser_rx_flush(&port_obj->base);
+            continue;
+        }
+        port_obj->rx_frame_end_us = port_obj->frame_end_time_us;
+        // New frame is received, send an event to main FSM to read it into receiver buffer
+        atomic_store(&(port_obj->rx_frame_ready), true);
+        port_obj->stats.frame_count++;
+        MB_STAGE_TRACE(&port_obj->base, MB_TRACE_STAGE_RX_READY, 0, port_obj->recv_length, port_obj->rx_frame_end_us);
+        mb_port_event_post(&port_obj->base, EVENT(EV_FRAME_RECEIVED, port_obj->recv_length, NULL, 0));
+        ESP_LOGD(TAG, "%s, frame %d bytes is ready.", port_obj->base.descr.parent_name, (int)port_obj->recv_length);
+    }
+    vTaskDelete(NULL);
+}
+
+// Open the pty linked to the port path or create the new one when the link does not exist
+static bool mb_port_ser_pty_open(mb_ser_port_t *port_obj)
+{
+    snprintf(port_obj->path, sizeof(port_obj->path), MB_PTY_PATH_FMT, (int)port_obj->ser_opts.port);
+    port_obj->fd = open(port_obj->path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (port_obj->fd >= 0) {
+        ESP_LOGI(TAG, "%s, open pty %s.", port_obj->base.descr.parent_name, port_obj->path);
+        return true;
+    }
+    // The link is stale or absent, create the pty and publish the name of its other end
+    (void)unlink(port_obj->path);
+    port_obj->fd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    MB_RETURN_ON_FALSE((port_obj->fd >= 0), false, TAG,
+                        "%s, pty create failure, errno = %d.", port_obj->base.descr.parent_name, errno);
+    port_obj->is_owner = true;
+    const char *peer_name = NULL;
+    if (!grantpt(port_obj->fd) && !unlockpt(port_obj->fd)) {
+        peer_name = ptsname(port_obj->fd);
+    }
+    MB_RETURN_ON_FALSE(peer_name, false, TAG,
+                        "%s, pty unlock failure, errno = %d.", port_obj->base.descr.parent_name, errno);
+    // Keep the other end opened to avoid the hang up while the peer is not connected
+    port_obj->peer_fd = open(peer_name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    MB_RETURN_ON_FALSE((port_obj->peer_fd >= 0), false, TAG,
+                        "%s, pty open failure, errno = %d.", port_obj->base.descr.parent_name, errno);
+    // The line transfers the binary frames as is
+    struct termios tio;
+    MB_RETURN_ON_FALSE(!tcgetattr(port_obj->peer_fd, &tio), false, TAG,
+                        "%s, pty get attributes failure.", port_obj->base.descr.parent_name);
+    cfmakeraw(&tio);
+    MB_RETURN_ON_FALSE(!tcsetattr(port_obj->peer_fd, TCSANOW, &tio), false, TAG,
+                        "%s, pty set attributes failure.", port_obj->base.descr.parent_name);
+    int flags = fcntl(port_obj->fd, F_GETFL, 0);
+    MB_RETURN_ON_FALSE(((flags >= 0) && (fcntl(port_obj->fd, F_SETFL, flags | O_NONBLOCK) >= 0)), false, TAG,
+                        "%s, pty set non-blocking failure.", port_obj->base.descr.parent_name);
+    MB_RETURN_ON_FALSE(!symlink(peer_name, port_obj->path), false, TAG,
+                        "%s, pty link %s failure, errno = %d.", port_obj->base.descr.parent_name, port_obj->path, errno);
+    ESP_LOGI(TAG, "%s, create pty %s -> %s.", port_obj->base.descr.parent_name, port_obj->path, peer_name);
+    return true;
+}
+
+static void mb_port_ser_pty_close(mb_ser_port_t *port_obj)
+{
+    if (port_obj->is_owner) {
+        (void)unlink(port_obj->path);
+        port_obj->is_owner = false;
+    }
+    if (port_obj->peer_fd >= 0) {
+        close(port_obj->peer_fd);
+        port_obj->peer_fd = -1;
+    }
+    if (port_obj->fd >= 0) {
+        close(port_obj->fd);
+        port_obj->fd = -1;
+    }
+}
+
+mb_err_enum_t mb_port_ser_create(mb_serial_opts_t *ser_opts, mb_port_base_t **in_out_obj)
+{
+    mb_ser_port_t *ser_port = NULL;
+    __attribute__((unused)) mb_err_enum_t ret = MB_EILLSTATE;
+    ser_port = (mb_ser_port_t*)calloc(1, sizeof(mb_ser_port_t));
+    MB_GOTO_ON_FALSE((ser_port && in_out_obj), MB_EILLSTATE, error, TAG, "mb serial port creation error.");
+
+    CRITICAL_SECTION_INIT(ser_port->base.lock);
+    ser_port->base.descr = (*in_out_obj)->descr;
+    ser_port->fd = -1;
+    ser_port->peer_fd = -1;
+    ser_opts->data_bits = ((ser_opts->data_bits > UART_DATA_5_BITS)
+                                && (ser_opts->data_bits < UART_DATA_BITS_MAX))
+                                ? ser_opts->data_bits : UART_DATA_8_BITS;
+    // Keep the communication options, the pty does not apply them but they define the line timing
+    ser_port->ser_opts = *ser_opts;
+    MB_GOTO_ON_FALSE((ser_port->ser_opts.baudrate), MB_EILLSTATE, error, TAG,
+                        "%s, mb serial incorrect baudrate.", ser_port->base.descr.parent_name);
+    MB_GOTO_ON_FALSE((mb_port_ser_pty_open(ser_port)), MB_EILLSTATE, error, TAG,
+                        "%s, mb serial pty %s open failure.", ser_port->base.descr.parent_name, ser_port->path);
+    // Calculate the frame timing for the configured character format
+    uint32_t bits_x2 = mb_port_ser_get_char_bits_x2(&ser_port->ser_opts);
+    ser_port->char_time_us = MB_SER_GET_CHARS_TIME_US(2, bits_x2, ser_port->ser_opts.baudrate);
+    ser_port->t35_us = (ser_port->ser_opts.mode == MB_RTU) ? MB_SER_GET_T35_US(bits_x2, ser_port->ser_opts.baudrate) : 0;
+    // The frame is completed after the same number of idle characters as the UART rx timeout,
+    // the gap between characters written with the jitter must not complete the frame
+    ser_port->rx_tout_us = (MB_SERIAL_TOUT * ser_port->char_time_us) + MB_PTY_JITTER_US;
+    ser_port->rand_state = ((uint32_t)esp_timer_get_time() ^ ((uint32_t)ser_port->ser_opts.port << 16)) | 1;
+    ESP_LOGD(TAG, "%s, character time: %" PRIu32 " us, T1.5: %" PRIu32 " us, T3.5: %" PRIu32 " us.",
+                ser_port->base.descr.parent_name, ser_port->char_time_us,
+                (uint32_t)MB_SER_GET_T15_US(bits_x2, ser_port->ser_opts.baudrate), ser_port->t35_us);
+    MB_GOTO_ON_FALSE((mb_port_ser_bus_sema_init(&ser_port->base, &ser_port->bus_sema_handle)), MB_EILLSTATE, error, TAG,
+                                "%s, mb serial bus semaphore create fail.", ser_port->base.descr.parent_name);
+    // The frame is accumulated while received to check the address and CRC without additional pass,
+    // the completed frame buffer is lent to the transport and the next frame is received into other one
+    ser_port->rx_buf_pool = calloc(2, MB_BUFFER_SIZE);
+    MB_GOTO_ON_FALSE((ser_port->rx_buf_pool), MB_EILLSTATE, error, TAG,
+                            "%s, mb serial receive buffer allocation fail.", ser_port->base.descr.parent_name);
+    ser_port->rx_buffer = ser_port->rx_buf_pool;
+    mb_port_ser_rx_stream_reset(&ser_port->rx_stream);
+    // Suspend task on start and then resume when initialization is completed
+    atomic_store(&(ser_port->enabled), false);
+    // Create a task to receive the data from pty
+    BaseType_t status = xTaskCreatePinnedToCore(mb_port_ser_task, "port_serial_task",
+                                                    MB_SERIAL_TASK_STACK_SIZE,
+                                                    &ser_port->base, CONFIG_FMB_PORT_TASK_PRIO,
+                                                    &ser_port->task_handle, CONFIG_FMB_PORT_TASK_AFFINITY);
+    // Force exit from function with failure
+    MB_GOTO_ON_FALSE((status == pdPASS), MB_EILLSTATE, error, TAG,
+                                "%s, mb stack serial task creation error, returned (0x%x).",
+                                ser_port->base.descr.parent_name, (int)status);
+    *in_out_obj = &(ser_port->base);
+    ESP_LOGD(TAG, "created object @%p", ser_port);
+    return MB_ENOERR;
+
+error:
+    if (ser_port) {
+        if (ser_port->task_handle) {
+            vTaskDelete(ser_port->task_handle);
+        }
+        mb_port_ser_pty_close(ser_port);
+        CRITICAL_SECTION_CLOSE(ser_port->base.lock);
+        mb_port_ser_bus_sema_close(&ser_port->bus_sema_handle);
+        free(ser_port->rx_buf_pool);
+    }
+    free(ser_port);
+    return MB_EILLSTATE;
+}
+
+void mb_port_ser_delete(mb_port_base_t *inst)
+{
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    vTaskDelete(port_obj->task_handle);
+    mb_port_ser_pty_close(port_obj);
+    mb_port_ser_bus_sema_close(&port_obj->bus_sema_handle);
+    CRITICAL_SECTION_CLOSE(inst->lock);
+    free(port_obj->rx_buf_pool);
+    free(port_obj);
+}
+
+bool mb_port_ser_recv_data(mb_port_base_t *inst, uint8_t **ser_frame, uint16_t *p_ser_length)
+{
+    MB_RETURN_ON_FALSE((ser_frame && p_ser_length), false, TAG, "mb serial get buffer failure.");
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    uint16_t counter = *p_ser_length ? *p_ser_length : port_obj->recv_length;
+    bool status = false;
+
+    status = mb_port_ser_bus_sema_take(inst, port_obj->bus_sema_handle, pdMS_TO_TICKS(mb_port_timer_get_response_time_ms(inst)));
+    port_obj->rx_frame_crc_valid = false;
+    if (status && counter && *ser_frame && atomic_load(&(port_obj->enabled))) {
+        if (atomic_load(&(port_obj->rx_frame_ready))) {
+            // The frame is already read from the pty by the port task, lend its buffer
+            // to the transport as is. It stays valid until the next frame is read from the port.
+            counter = (counter < port_obj->rx_stream.count) ? counter : port_obj->rx_stream.count;
+            *ser_frame = port_obj->rx_buffer;
+            port_obj->rx_buffer = (port_obj->rx_buffer == port_obj->rx_buf_pool)
+                                    ? &port_obj->rx_buf_pool[MB_BUFFER_SIZE] : port_obj->rx_buf_pool;
+            port_obj->rx_frame_crc = port_obj->rx_stream.crc;
+            port_obj->rx_frame_crc_valid = (port_obj->ser_opts.mode == MB_RTU) && (counter == port_obj->rx_stream.count);
+            port_obj->stats.buf_lend_count++;
+            port_obj->stats.frame_copy_bytes = port_obj->rx_stream.count;
+            atomic_store(&(port_obj->rx_reset), true);
+            atomic_store(&(port_obj->rx_frame_ready), false);
+        } else {
+            // Read the frame data pending in the pty
+            ssize_t count = read(port_obj->fd, *ser_frame, counter);
+            counter = (count > 0) ? count : 0;
+            port_obj->stats.copy_count++;
+            port_obj->stats.copy_bytes += counter;
+            port_obj->stats.frame_copy_bytes = counter;
+            port_obj->rx_frame_end_us = 0;
+        }
+        // Store the timestamp of received frame
+        port_obj->recv_time_stamp = esp_timer_get_time();
+        if (port_obj->rx_frame_end_us && (port_obj->recv_time_stamp > port_obj->rx_frame_end_us)) {
+            // The time from the end of frame on the bus until it is passed to the transport
+            uint32_t latency = (uint32_t)(port_obj->recv_time_stamp - port_obj->rx_frame_end_us);
+            port_obj->stats.recv_latency_us = latency;
+            port_obj->stats.recv_latency_max_us = (latency > port_obj->stats.recv_latency_max_us)
+                                                    ? latency : port_obj->stats.recv_latency_max_us;
+        }
+        ESP_LOGD(TAG, "%s, received data: %d bytes.", inst->descr.parent_name, (int)counter);
+        MB_PRT_BUF(inst->descr.parent_name, ":PORT_RECV", *ser_frame, counter, ESP_LOG_DEBUG);
+        int64_t time_delta = (port_obj->recv_time_stamp > port_obj->send_time_stamp) ?
+                                (port_obj->recv_time_stamp - port_obj->send_time_stamp) :
+                                (port_obj->send_time_stamp - port_obj->recv_time_stamp);
+        ESP_LOGD(TAG, "%s, serial processing time[us] = %" PRId64, inst->descr.parent_name, time_delta);
+        status = true;
+        *p_ser_length = counter;
+    } else {
+        ESP_LOGE(TAG, "%s: junk data (%d bytes) received. ", inst->descr.parent_name, (int)counter);
+    }
+    *p_ser_length = counter;
+    mb_port_ser_bus_sema_release(inst, port_obj->bus_sema_handle);
+    return status;
+}
+
+bool mb_port_ser_get_recv_crc(mb_port_base_t *inst, uint16_t *crc)
+{
+    MB_RETURN_ON_FALSE((inst && crc), false, TAG, "mb serial get crc failure.");
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    if (port_obj->rx_frame_crc_valid) {
+        *crc = port_obj->rx_frame_crc;
+    }
+    return port_obj->rx_frame_crc_valid;
+}
+
+// The time stamp of the frame end on the bus if the frame is lent by the port task, otherwise the read time
+int64_t mb_port_ser_get_recv_time_us(mb_port_base_t *inst)
+{
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    return port_obj->rx_frame_end_us ? port_obj->rx_frame_end_us : port_obj->recv_time_stamp;
+}
+
+bool mb_port_ser_get_stats(mb_port_base_t *inst, mb_port_ser_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((inst && stats), false, TAG, "mb serial get stats failure.");
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    *stats = port_obj->stats;
+    return true;
+}
+
+// The rest of T3.5 idle interval, the transport defers the frame with the port timer
+uint32_t mb_port_ser_get_send_delay_us(mb_port_base_t *inst)
+{
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    return mb_port_ser_get_frame_gap_us(port_obj->frame_end_time_us, port_obj->t35_us);
+}
+
+bool mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *p_ser_frame, uint16_t ser_length)
+{
+    bool res = false;
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+
+    res = mb_port_ser_bus_sema_take(inst, port_obj->bus_sema_handle, pdMS_TO_TICKS(mb_port_timer_get_response_time_ms(inst)));
+    if (res && p_ser_frame && ser_length && atomic_load(&(port_obj->enabled))) {
+        // Flush buffer received from previous transaction
+        mb_port_ser_rx_flush(inst);
+        mb_port_ser_wait_frame_gap(port_obj->frame_end_time_us, port_obj->t35_us);
+        // The write returns when the last character would leave the line
+        res = mb_port_ser_write_paced(port_obj, p_ser_frame, ser_length);
+        ESP_LOGD(TAG, "%s, tx buffer sent: (%d) bytes.", inst->descr.parent_name, (int)ser_length);
+        if (res) {
+            MB_PRT_BUF(inst->descr.parent_name, ":PORT_SEND", p_ser_frame, ser_length, ESP_LOG_DEBUG);
+        } else {
+            ESP_LOGE(TAG, "%s, mb serial sent buffer failure, errno = %d.", inst->descr.parent_name, errno);
+        }
+        port_obj->send_time_stamp = esp_timer_get_time();
+        port_obj->frame_end_time_us = port_obj->send_time_stamp;
+    } else {
+        ESP_LOGE(TAG, "%s, send fail state:%d, %p, %u. ", inst->descr.parent_name, (int)port_obj->tx_state_en, p_ser_frame, (unsigned)ser_length);
+        res = false;
+    }
+    mb_port_ser_bus_sema_release(inst, port_obj->bus_sema_handle);
+    return res;
+}
+
+#endif
@@ -18,7 +18,9 @@
 #include "freertos/queue.h"
 
 #include "port_common.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "esp_vfs_eventfd.h"
+#endif
 #include "port_tcp_driver.h"
 #include "port_tcp_utils.h"
 
@@ -59,6 +61,7 @@ const char *driver_event_to_name_r(mb_driver_event_t event)
 static esp_err_t init_event_fd(void *ctx)
 {
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+#if !CONFIG_IDF_TARGET_LINUX
     if (!mb_drv_loop_inst_counter) {
         esp_vfs_eventfd_config_t config = MB_EVENTFD_CONFIG();
         esp_err_t err = esp_vfs_eventfd_register(&config);
@@ -66,7 +69,9 @@ static esp_err_t init_event_fd(void *ctx)
             ESP_LOGE(TAG, "eventfd registration fail.");
         }
     }
-    drv_obj->event_fd = eventfd(0, 0);
+#endif
+    // The eventfd is also written from the timer service which can work in ISR context
+    drv_obj->event_fd = eventfd(0, MB_EVENTFD_FLAGS);
     MB_RETURN_ON_FALSE((drv_obj->event_fd > 0), ESP_ERR_INVALID_STATE, TAG, "eventfd init error.");
     return (drv_obj->event_fd > 0) ? ESP_OK : ESP_ERR_INVALID_STATE;
 }
@@ -78,11 +83,27 @@ static esp_err_t close_event_fd(void *ctx)
         close(drv_obj->event_fd);
     } else {
         ESP_LOGD(TAG, "close eventfd (%d).", (int)drv_obj->event_fd);
+#if CONFIG_IDF_TARGET_LINUX
+        close(drv_obj->event_fd);
+#else
         return esp_vfs_eventfd_unregister();
+#endif
     }
     return ESP_OK;
 }
 
+static inline int write_event_fd(int event_fd, mb_event_info_t *event)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    // The host eventfd adds the written value to its counter, so the unit value is written
+    // to avoid the counter overflow, the event value is used for the trace only
+    uint64_t val = 1;
+    return (write(event_fd, (char *)&val, sizeof(val)) == sizeof(val)) ? sizeof(mb_event_info_t) : -1;
+#else
+    return write(event_fd, (char *)&event->val, sizeof(mb_event_info_t));
+#endif
+}
+
 int32_t write_event(void *ctx, mb_event_info_t *event)
 {
     MB_RETURN_ON_FALSE((event && ctx), -1, TAG, "wrong arguments.");
@@ -95,10 +116,39 @@ int32_t write_event(void *ctx, mb_event_info_t *event)
         return -1;
     }
     // send eventfd to just trigger select
-    int32_t ret = write(drv_obj->event_fd, (char *)&event->val, sizeof(mb_event_info_t));
+    int32_t ret = write_event_fd(drv_obj->event_fd, event);
     return (ret == sizeof(mb_event_info_t)) ? event->event_id : -1;
 }
 
+void mb_drv_wake_task(void *ctx)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    mb_event_info_t event = {
+        .event_id = MB_EVENT_TIMEOUT,
+        .opt_fd = UNDEF_FD
+    };
+    // just unblock the select, no event is posted to the event loop
+    (void)write_event_fd(drv_obj->event_fd, &event);
+}
+
+static void mb_drv_timer_cb(void *arg)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(arg);
+    // The event loop can not be posted from ISR, the timeout event is sent by the driver task
+    atomic_store(&drv_obj->timer_expired, true);
+    mb_drv_wake_task(arg);
+}
+
+void mb_drv_set_timeout(void *ctx, uint32_t timeout_ms)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    if (timeout_ms) {
+        mb_timer_wheel_arm(&drv_obj->timer_entry, (uint64_t)timeout_ms * 1000);
+    } else {
+        mb_timer_wheel_cancel(&drv_obj->timer_entry);
+    }
+}
+
 static int32_t read_event(void *ctx, mb_event_info_t *event)
 {
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
@@ -312,12 +362,15 @@ int mb_drv_open(void *ctx, mb_uid_info_t addr_info, int flags)
             node_ptr->addr_info = addr_info;
             //node_ptr->addr_info.ip_addr_str = NULL;
             node_ptr->addr_info.index = fd;
+            node_ptr->addr_info.proto = drv_obj->mb_proto;
             node_ptr->send_time = esp_timer_get_time();
             node_ptr->recv_time = esp_timer_get_time();
             node_ptr->tid_counter = 0;
             node_ptr->send_counter = 0;
             node_ptr->recv_counter = 0;
             node_ptr->is_blocking = ((flags & O_NONBLOCK) == 0);
+            node_ptr->rtu_framing = drv_obj->rtu_framing;
+            node_ptr->is_master = drv_obj->is_master;
             drv_obj->mb_nodes[fd] = node_ptr;
             // mark opened node in the open set
             FD_SET(fd, &drv_obj->open_set);
@@ -419,7 +472,10 @@ int mb_drv_close(void *ctx, int fd)
         // Do we need to close connection, if the close event is not run
         if ((node_ptr->sock_id > 0) && (FD_ISSET(node_ptr->sock_id, &drv_obj->conn_set)))
         {
-            FD_CLR(node_ptr->sock_id, &drv_obj->conn_set);
+            // The socket is shared by all nodes in UDP mode
+            if (node_ptr->addr_info.proto != MB_UDP) {
+                FD_CLR(node_ptr->sock_id, &drv_obj->conn_set);
+            }
             if (drv_obj->node_conn_count)
             {
                 drv_obj->node_conn_count--;
@@ -439,6 +495,7 @@ int mb_drv_close(void *ctx, int fd)
     free((void *)node_ptr->addr_info.node_name_str);
     node_ptr->addr_info.node_name_str = NULL;
     node_ptr->addr_info.ip_addr_str = NULL;
+    free(node_ptr->rtu_buf);
     free(node_ptr);
     drv_obj->mb_nodes[fd] = NULL;
     mb_drv_unlock(ctx);
@@ -466,6 +523,84 @@ mb_node_info_t *mb_drv_get_next_node_from_set(void *ctx, int *fd_ptr, fd_set *fd
     return NULL;
 }
 
+// Find the node by the peer address of datagram, the current node of master is preferred
+static mb_node_info_t *mb_drv_get_node_from_sock_addr(void *ctx, const struct sockaddr_storage *src_addr)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    mb_node_info_t *found_ptr = NULL;
+    for (int fd = 0; fd < MB_MAX_FDS; fd++) {
+        mb_node_info_t *node_ptr = drv_obj->mb_nodes[fd];
+        if (node_ptr && (node_ptr->sock_id > 0)
+                && (MB_GET_NODE_STATE(node_ptr) >= MB_SOCK_STATE_CONNECTED)
+                && port_is_same_sock_addr(&node_ptr->peer_addr, src_addr)) {
+            if (node_ptr == drv_obj->mb_node_curr) {
+                return node_ptr;
+            }
+            found_ptr = (found_ptr) ? found_ptr : node_ptr;
+        }
+    }
+    return found_ptr;
+}
+
+// Open the node for the new peer of slave, there is no connection phase in UDP
+static mb_node_info_t *mb_drv_open_datagram_node(void *ctx, const struct sockaddr_storage *src_addr, socklen_t addr_len)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    mb_uid_info_t node_info = {0};
+    if (drv_obj->mb_node_open_count >= MB_MAX_FDS) {
+        ESP_LOGE(TAG, "%p, unable to open node, maximum is %u nodes.", drv_obj, MB_MAX_FDS);
+        return NULL;
+    }
+    if ((port_get_sock_addr_info(src_addr, &node_info) < 0) || !node_info.ip_addr_str) {
+        return NULL;
+    }
+    node_info.fd = drv_obj->listen_sock_fd;
+    int fd = mb_drv_open(ctx, node_info, 0);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "%p, unable to open node: %s", drv_obj, node_info.ip_addr_str);
+        free((void *)node_info.ip_addr_str);
+        return NULL;
+    }
+    mb_node_info_t *node_ptr = mb_drv_get_node(ctx, fd);
+    node_ptr->peer_addr = *src_addr;
+    node_ptr->peer_addr_len = addr_len;
+    DRIVER_SEND_EVENT(ctx, MB_EVENT_CONNECT, fd);
+    return node_ptr;
+}
+
+// Read the datagram from the shared socket and dispatch it to the node of the peer
+static int mb_drv_read_datagram(void *ctx)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    uint8_t buf[MB_TCP_BUFF_MAX_SIZE];
+    struct sockaddr_storage src_addr;
+    socklen_t addr_len = sizeof(src_addr);
+
+    bzero(&src_addr, sizeof(src_addr));
+    int len = port_recv_datagram(drv_obj->listen_sock_fd, buf, sizeof(buf), &src_addr, &addr_len);
+    if (len <= 0) {
+        return UNDEF_FD;
+    }
+    mb_node_info_t *node_ptr = mb_drv_get_node_from_sock_addr(ctx, &src_addr);
+    if (!node_ptr && !drv_obj->is_master) {
+        node_ptr = mb_drv_open_datagram_node(ctx, &src_addr, addr_len);
+    }
+    if (!node_ptr) {
+        MB_TRACED(TAG, "%p, datagram from unknown peer, drop %d bytes.", ctx, len);
+        return UNDEF_FD;
+    }
+    int ret = port_put_datagram(node_ptr, buf, len);
+    if (ret <= 0) {
+        MB_TRACED(TAG, "%p, "MB_NODE_FMT(", incorrect datagram, drop %d bytes."), ctx, (int)node_ptr->fd,
+                    (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str, len);
+        return UNDEF_FD;
+    }
+    mb_drv_lock(ctx);
+    node_ptr->recv_time = esp_timer_get_time();
+    mb_drv_unlock(ctx);
+    return node_ptr->index;
+}
+
 mb_node_info_t *mb_drv_get_node_info_from_addr(void *ctx, uint8_t uid)
 {
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
@@ -500,27 +635,65 @@ static int mb_drv_register_fds(void *ctx, fd_set *fdset)
     return max_fd;
 }
 
+// The sockets with the connection in progress are checked for write in the same select
+static int mb_drv_register_connecting_fds(void *ctx, fd_set *fdset, int max_fd)
+{
+    mb_node_info_t *node_ptr = NULL;
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    FD_ZERO(fdset);
+    for (int i = 0; i < MB_MAX_FDS; i++) {
+        node_ptr = drv_obj->mb_nodes[i];
+        if (node_ptr && (node_ptr->sock_id > 0) && (MB_GET_NODE_STATE(node_ptr) == MB_SOCK_STATE_CONNECTING)
+                && FD_ISSET(node_ptr->sock_id, &drv_obj->connecting_set)) {
+            MB_ADD_FD(node_ptr->sock_id, max_fd, fdset);
+        }
+    }
+    return max_fd;
+}
+
+// Pass the nodes with the completed (or failed) connection to the connect handler once
+static void mb_drv_post_connecting_events(void *ctx, fd_set *fdset)
+{
+    mb_node_info_t *node_ptr = NULL;
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    for (int i = 0; i < MB_MAX_FDS; i++) {
+        node_ptr = drv_obj->mb_nodes[i];
+        if (node_ptr && (node_ptr->sock_id > 0) && (MB_GET_NODE_STATE(node_ptr) == MB_SOCK_STATE_CONNECTING)
+                && FD_ISSET(node_ptr->sock_id, fdset)) {
+            FD_CLR(node_ptr->sock_id, &drv_obj->connecting_set);
+            DRIVER_SEND_EVENT(ctx, MB_EVENT_CONNECT, node_ptr->index);
+        }
+    }
+}
+
 // Wait socket ready event during timeout
-static int mb_drv_wait_fd_events(void *ctx, fd_set *fdset, fd_set *perrset, int time_ms)
+static int mb_drv_wait_fd_events(void *ctx, fd_set *fdset, fd_set *pwrset, fd_set *perrset, int time_ms)
 {
     fd_set readset = *fdset;
     int ret = 0;
     struct timeval tv;
+    struct timeval *ptv = NULL; // wait infinitely if the time is negative
 
     if (!ctx || !fdset) {
         return -1;
     }
 
-    tv.tv_sec = time_ms / 1000;
-    tv.tv_usec = (time_ms - (tv.tv_sec * 1000)) * 1000;
+    if (time_ms >= 0) {
+        tv.tv_sec = time_ms / 1000;
+        tv.tv_usec = (time_ms - (tv.tv_sec * 1000)) * 1000;
+        ptv = &tv;
+    }
 
     // fill the readset according to the active fds
     int max_fd = mb_drv_register_fds(ctx, &readset);
     if (perrset) {
         *perrset = readset; // initialize error set if used
     }
+    if (pwrset) {
+        max_fd = mb_drv_register_connecting_fds(ctx, pwrset, max_fd);
+    }
 
-    ret = select(max_fd + 1, &readset, NULL, perrset, &tv);
+    ret = select(max_fd + 1, &readset, pwrset, perrset, ptv);
     if (ret == 0) {
         // No respond from node during timeout
         ret = ERR_TIMEOUT;
@@ -548,6 +721,7 @@ esp_err_t mb_drv_stop_task(void *ctx)
         drv_obj->close_done_sema = xSemaphoreCreateBinary();
     }
     (void)mb_drv_set_status_flag(ctx, MB_FLAG_SUSPEND);
+    mb_drv_wake_task(ctx);
     // Check if we can safely suspend the port task (workaround for issue with deadlock in suspend)
     if (!drv_obj->close_done_sema 
             || !(mb_drv_wait_status_flag(ctx, MB_FLAG_SUSPEND, 1) & MB_FLAG_SUSPEND) 
@@ -581,7 +755,13 @@ err_t mb_drv_check_node_state(void *ctx, int *fd_ptr, uint32_t timeout_ms)
             ESP_LOGD(TAG, "%p, node: %d, sock: %d, IP:%s, check connection state, time = %" PRId64 ", rcv_time: %" PRId64,
                         ctx, (int)pnode->index, (int)pnode->sock_id, pnode->addr_info.ip_addr_str,
                         (esp_timer_get_time() / 1000), pnode->recv_time / 1000);
-            err = port_check_alive(pnode, 1); // minimize blocking time
+            if (pnode->addr_info.proto == MB_UDP) {
+                // There is no connection to check, the slave drops the silent peer to free the node,
+                // it is opened again on the next datagram from the peer
+                err = drv_obj->is_master ? ERR_OK : ERR_CONN;
+            } else {
+                err = port_check_alive(pnode, 1); // minimize blocking time
+            }
             if ((err < 0) && (err != ERR_INPROGRESS)) {
                 ESP_LOGD(TAG, "Node #%d (%s), connection error, err=(%d).", pnode->index, pnode->addr_info.ip_addr_str, (int)err);
             } if (err == ERR_OK) {
@@ -598,47 +778,64 @@ void mb_drv_tcp_task(void *ctx)
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
     ESP_LOGD(TAG, "Start of driver task.");
     while (1) {
-        fd_set readset, errorset;
+        fd_set readset, writeset, errorset;
         FD_ZERO(&readset);
+        FD_ZERO(&writeset);
         FD_ZERO(&errorset);
-        // check all active socket and fd events
-        int ret = mb_drv_wait_fd_events(ctx, &readset, &errorset, MB_SELECT_WAIT_MS);
-        if (ret == ERR_TIMEOUT) {
-            // timeout occured waiting for the vfds
-            DRIVER_SEND_EVENT(ctx, MB_EVENT_TIMEOUT, UNDEF_FD);
-            mb_drv_check_suspend_shutdown(ctx);
-        } else if (ret == -1) {
+        // check all active socket and fd events, the timeouts are signaled through the eventfd,
+        // so the wait is not limited and select() never returns on timeout
+        int ret = mb_drv_wait_fd_events(ctx, &readset, &writeset, &errorset, -1);
+        if (ret == -1) {
             // error occured during waiting for vfds activation
             ESP_LOGD(TAG, "%p, task select error.", ctx);
             mb_drv_check_suspend_shutdown(ctx);
             ESP_LOGD(TAG, "%p, socket error, fdset: %" PRIx64, ctx, *(uint64_t *)&errorset);
         } else {
+            // The connection phase of the nodes is completed by the event handler without blocking the task
+            mb_drv_post_connecting_events(ctx, &writeset);
             // Is the fd event triggered, process the event
             if (drv_obj->event_fd && FD_ISSET(drv_obj->event_fd, &readset)) {
                 mb_event_info_t mb_event = {0};
                 int32_t event_id = read_event(ctx, &mb_event);
-                ESP_LOGD(TAG, "%p, fd event get: 0x%02x:%d, %s", 
+                MB_TRACED(TAG, "%p, fd event get: 0x%02x:%d, %s", 
                             ctx, (int)event_id, (int)mb_event.opt_fd, driver_event_to_name_r(event_id));
                 mb_drv_check_suspend_shutdown(ctx);
+                if (atomic_exchange(&drv_obj->timer_expired, false)) {
+                    // The driver timer is expired, the event is handled in the loop run below
+                    mb_event_info_t tout_event = {
+                        .event_id = MB_EVENT_TIMEOUT,
+                        .opt_fd = UNDEF_FD
+                    };
+                    (void)esp_event_post_to(mb_drv_loop_handle, MB_EVENT_BASE(ctx), MB_EVENT_TIMEOUT,
+                                            &tout_event, sizeof(mb_event_info_t), MB_EVENT_TOUT);
+                }
                 // Drive the event loop
                 esp_err_t err = esp_event_loop_run(mb_drv_loop_handle, pdMS_TO_TICKS(MB_TCP_EVENT_LOOP_TICK_MS));
                 if (err != ESP_OK) {
                     ESP_LOGE(TAG, "%p, event loop run, returns fail: %x", ctx, (int)err);
                 }
+            } else if ((drv_obj->mb_proto == MB_UDP) && (drv_obj->listen_sock_fd > 0)
+                            && FD_ISSET(drv_obj->listen_sock_fd, &readset)) {
+                // The datagram socket is shared by all nodes, the datagram is a complete frame
+                mb_drv_check_suspend_shutdown(ctx);
+                int fd = mb_drv_read_datagram(ctx);
+                if (fd >= 0) {
+                    DRIVER_SEND_EVENT(ctx, MB_EVENT_RECV_DATA, fd);
+                }
             } else if (drv_obj->listen_sock_fd && FD_ISSET(drv_obj->listen_sock_fd, &readset)) {
                 // If something happened on the listen socket, then it is an incoming connection.
-                ESP_LOGD(TAG, "%p, listen_sock is active.", ctx);
+                MB_TRACED(TAG, "%p, listen_sock is active.", ctx);
                 mb_uid_info_t node_info;
                 int sock_id = port_accept_connection(drv_obj->listen_sock_fd, &node_info);
                 if (sock_id) {
                     if (drv_obj->mb_node_open_count >= MB_MAX_FDS) {
                         ESP_LOGE(TAG, "%p, unable to accept node, maximum is %u connections.", drv_obj, MB_MAX_FDS);
-#if LWIP_SO_LINGER
+#if MB_TCP_SO_LINGER_ENABLED
                         struct linger sl;
                         sl.l_onoff = 1;  // non-zero value enables linger option in lwip
                         sl.l_linger = 0; // timeout interval in seconds
                         setsockopt(sock_id, SOL_SOCKET, SO_LINGER, &sl, sizeof(sl));
-#endif // LWIP_SO_LINGER
+#endif // MB_TCP_SO_LINGER_ENABLED
                         close(sock_id);
                     } else {
                         // Create new node info and open it
@@ -655,7 +852,7 @@ void mb_drv_tcp_task(void *ctx)
                 mb_drv_check_suspend_shutdown(ctx);
                 int curr_fd = 0;
                 mb_node_info_t *node_ptr = NULL;
-                ESP_LOGD(TAG, "%p, socket event active: %" PRIx64, ctx, *(uint64_t *)&readset);
+                MB_TRACED(TAG, "%p, socket event active, %d fds are ready.", ctx, ret);
                 while(((node_ptr = mb_drv_get_next_node_from_set(ctx, &curr_fd, &readset))
                            && (curr_fd < MB_MAX_FDS))) {
                     if (FD_ISSET(node_ptr->sock_id, &drv_obj->conn_set)) {
@@ -663,27 +860,29 @@ void mb_drv_tcp_task(void *ctx)
                         FD_CLR(node_ptr->sock_id, &readset);
                         int ret = port_read_packet(node_ptr);
                         if (ret > 0) {
-                            ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", frame received."), ctx, (int)node_ptr->fd,
+                            MB_TRACED(TAG, "%p, "MB_NODE_FMT(", frame received."), ctx, (int)node_ptr->fd,
                                         (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
                             mb_drv_lock(ctx);
                             node_ptr->recv_time = esp_timer_get_time();
                             mb_drv_unlock(ctx);
+                            // The parent port object starts from the port base
+                            MB_STAGE_TRACE(drv_obj->parent, MB_TRACE_STAGE_RX_READY, 0, node_ptr->index, ret);
                             DRIVER_SEND_EVENT(ctx, MB_EVENT_RECV_DATA, node_ptr->index);
                         } else if (ret == ERR_TIMEOUT) {
-                            ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", frame read timeout or closed connection."), ctx, (int)node_ptr->fd,
+                            MB_TRACED(TAG, "%p, "MB_NODE_FMT(", frame read timeout or closed connection."), ctx, (int)node_ptr->fd,
                                         (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
                         } else if (ret == ERR_BUF) {
                             // After retries a response with incorrect TID received, process failure.
                             drv_obj->event_cbs.mb_sync_event_cb(drv_obj->event_cbs.port_arg, MB_SYNC_EVENT_RECV_FAIL);
-                            ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", frame error."), ctx, (int)node_ptr->fd,
+                            MB_TRACED(TAG, "%p, "MB_NODE_FMT(", frame error."), ctx, (int)node_ptr->fd,
                                         (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
                         } else {
                             if (ret == ERR_CONN) {
-                                ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", connection lost."), ctx, (int)node_ptr->fd,
+                                MB_TRACED(TAG, "%p, "MB_NODE_FMT(", connection lost."), ctx, (int)node_ptr->fd,
                                             (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
                                 DRIVER_SEND_EVENT(ctx, MB_EVENT_ERROR, node_ptr->index);
                             } else {
-                                ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", critical read error=%d, errno=%u."), ctx, (int)node_ptr->fd,
+                                MB_TRACED(TAG, "%p, "MB_NODE_FMT(", critical read error=%d, errno=%u."), ctx, (int)node_ptr->fd,
                                         (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str, (int)ret, (unsigned)errno);
                                 DRIVER_SEND_EVENT(ctx, MB_EVENT_ERROR, node_ptr->index);
                             }
@@ -733,6 +932,10 @@ esp_err_t mb_drv_register(port_driver_t **ctx)
     MB_GOTO_ON_FALSE((pctx->status_flags_hdl), ESP_ERR_INVALID_STATE, error, 
                         TAG, "%p, mb event group error.", pctx);
 
+    // The node checks are scheduled with the timer shared with the port timers instead of polling
+    MB_GOTO_ON_FALSE((mb_timer_wheel_attach(&pctx->timer_entry, mb_drv_timer_cb, pctx) == MB_ENOERR),
+                        ESP_ERR_INVALID_STATE, error, TAG, "%p, driver timer init error.", pctx);
+
     mb_drv_loop_inst_counter++;
 
     // Create task for packet processing
@@ -751,6 +954,7 @@ esp_err_t mb_drv_register(port_driver_t **ctx)
     pctx->is_registered = true;
     FD_ZERO(&pctx->open_set);
     FD_ZERO(&pctx->conn_set);
+    FD_ZERO(&pctx->connecting_set);
     return ESP_OK;
 
 error:
@@ -758,6 +962,9 @@ error:
         if (pctx->mb_tcp_task_handle) {
             vTaskDelete(pctx->mb_tcp_task_handle);
         }
+        if (pctx->timer_entry.cb) {
+            mb_timer_wheel_detach(&pctx->timer_entry);
+        }
         if (mb_drv_loop_handle) {
             (void)esp_event_loop_delete(mb_drv_loop_handle);
             mb_drv_loop_handle = NULL;
@@ -766,7 +973,9 @@ error:
         }
         if (pctx->event_fd) {
             close(pctx->event_fd);
+#if !CONFIG_IDF_TARGET_LINUX
             (void)esp_vfs_eventfd_unregister();
+#endif
         }
         if (pctx->close_done_sema) {
             vSemaphoreDelete(pctx->close_done_sema);
@@ -784,6 +993,8 @@ esp_err_t mb_drv_unregister(void *ctx)
     ESP_LOGD(TAG, "%p, driver unregister.", drv_obj);
     (void)mb_drv_set_status_flag(ctx, MB_FLAG_SHUTDOWN);
     drv_obj->close_done_sema = xSemaphoreCreateBinary();
+    mb_timer_wheel_detach(&drv_obj->timer_entry);
+    mb_drv_wake_task(ctx);
 
     // if no semaphore (alloc issues) or couldn't acquire it, just delete the task
     if (!drv_obj->close_done_sema 
@@ -22,6 +22,7 @@
 #include "mb_config.h"
 
 #include "port_tcp_utils.h"
+#include "port_timer_wheel.h"
 #include "mb_port_types.h"
 
 #ifdef __cplusplus
@@ -51,7 +52,7 @@ typedef void (*mb_event_handler_fp)(void *ctx, esp_event_base_t base, int32_t id
 #define MB_DROP_TRANSACTION_TIME_US    (1000UL * (CONFIG_FMB_TCP_KEEP_ALIVE_TOUT_SEC * 2000UL)) // drop after twice keep alive timeout is reasonable
 
 #define MB_WAIT_DONE_MS             (5000)
-#define MB_SELECT_WAIT_MS           (200)
+#define MB_NODE_CHECK_MIN_MS        (200)   // minimal interval of the node state check
 #define MB_TCP_SEND_TIMEOUT_MS      (500)
 #define MB_TCP_EVENT_LOOP_TICK_MS   (50)
 
@@ -70,12 +71,17 @@ typedef void (*mb_event_handler_fp)(void *ctx, esp_event_base_t base, int32_t id
     .close_done_sema = NULL,                    \
     .node_conn_count = 0,                       \
     .event_fd = UNDEF_FD,                       \
+    .timer_expired = false,                     \
 }
 
+#if !CONFIG_IDF_TARGET_LINUX
 #define MB_EVENTFD_CONFIG() (esp_vfs_eventfd_config_t) {    \
       .max_fds = MB_TCP_PORT_MAX_CONN                       \
 };
 
+#define MB_EVENTFD_FLAGS            (EFD_SUPPORT_ISR)
+#endif
+
 typedef struct _port_driver port_driver_t;
 
 #define MB_CHECK_FD_RANGE(fd) ((fd < MB_TCP_PORT_MAX_CONN) && (fd >= 0))
@@ -189,10 +195,19 @@ typedef struct mb_node_info_s {
     QueueHandle_t tx_queue;             /*!< send request queue */
     int64_t send_time;                  /*!< send request time stamp */
     int64_t recv_time;                  /*!< receive response time stamp */
+    int64_t conn_start_time;            /*!< start time of the connection attempt */
+    int64_t conn_retry_time;            /*!< time of the next connection attempt after failure, zero if not scheduled */
     uint16_t tid_counter;               /*!< transaction identifier (TID) for slave */
     uint16_t send_counter;              /*!< number of packets sent to slave during one session */
     uint16_t recv_counter;              /*!< number of packets received from slave during one session */
     bool is_blocking;                   /*!< slave blocking bit state saved */
+    bool rtu_framing;                   /*!< the node sends and receives raw RTU frames instead of MBAP */
+    uint8_t *rtu_buf;                   /*!< the buffer to accumulate the RTU frame from the stream socket */
+    uint16_t rtu_count;                 /*!< number of bytes accumulated in the RTU frame buffer */
+    int64_t rtu_start_time;             /*!< time stamp of the first byte of the accumulated RTU frame */
+    bool is_master;                     /*!< the node belongs to master (receives the responses) */
+    struct sockaddr_storage peer_addr;  /*!< peer address of the node in UDP mode (the socket is shared) */
+    socklen_t peer_addr_len;            /*!< length of the peer address */
 } mb_node_info_t;
 
 typedef enum _mb_sync_event {
@@ -230,12 +245,13 @@ typedef struct _port_driver {
     portMUX_TYPE spin_lock;                     /*!< spin lock */
     _lock_t lock;                               /*!< semaphore mutex */
     bool is_registered;                         /*!< driver is active flag */
-    int listen_sock_fd;                         /*!< listen socket fd */
+    int listen_sock_fd;                         /*!< listen socket fd (the socket shared by all nodes in UDP mode) */
     int retry_cnt;                              /*!< retry counter for events */
     mb_comm_mode_t mb_proto;                    /*!< current node protocol type */
     uint16_t port;                              /*!< current node port number */
     uint8_t uid;                                /*!< unit identifier of the node */
     bool is_master;                             /*!< identify the type of instance (master, slave) */
+    bool rtu_framing;                           /*!< RTU over TCP framing of the nodes */
     void *network_iface_ptr;                    /*!< netif interface pointer */
     mb_node_info_t **mb_nodes;                  /*!< information structures for each associated node */
     uint16_t mb_node_open_count;                /*!< count of associated nodes */
@@ -244,7 +260,10 @@ typedef struct _port_driver {
     uint16_t curr_node_index;                   /*!< current processing slave index */
     fd_set open_set;                            /*!< file descriptor set for opened nodes */
     fd_set conn_set;                            /*!< file descriptor set for associated nodes */
+    fd_set connecting_set;                      /*!< file descriptor set for nodes with the connection in progress */
     int event_fd;                               /*!< eventfd descriptor for modbus event tracking */
+    mb_timer_wheel_entry_t timer_entry;         /*!< driver timer entry of the shared timer service */
+    _Atomic(bool) timer_expired;                /*!< the driver timer is expired, the timeout event is pending */
     SemaphoreHandle_t close_done_sema;          /*!< close and done semaphore */
     EventGroupHandle_t status_flags_hdl;        /*!< status bits to control nodes states */
     TaskHandle_t mb_tcp_task_handle;            /*!< TCP/UDP handling task handle */
@@ -346,6 +365,23 @@ mb_status_flags_t mb_drv_clear_status_flag(void *ctx, mb_status_flags_t mask);
 
 err_t mb_drv_check_node_state(void *ctx, int *fd, uint32_t timeout_ms);
 
+/**
+ * @brief Unblock the driver task waiting for the socket events, it is safe to call from ISR
+ *
+ * @param ctx - pointer to driver interface structure
+ */
+void mb_drv_wake_task(void *ctx);
+
+/**
+ * @brief Start the driver timer, the MB_EVENT_TIMEOUT event is sent to the driver when it expires
+ *
+ * The driver task does not poll the nodes periodically, the timer is used to schedule the checks instead.
+ *
+ * @param ctx - pointer to driver interface structure
+ * @param timeout_ms - the timeout in milliseconds, the zero value stops the timer
+ */
+void mb_drv_set_timeout(void *ctx, uint32_t timeout_ms);
+
 #endif
 
 #ifdef __cplusplus
@@ -5,6 +5,7 @@
  */ 
 #include <stdbool.h>
 #include <string.h>
+#include <stdatomic.h>
 
 #include "port_tcp_common.h"
 #include "port_tcp_driver.h"
@@ -20,6 +21,14 @@ typedef struct
     mb_tcp_opts_t tcp_opts;
     uint8_t ptemp_buf[MB_TCP_BUFF_MAX_SIZE];
     port_driver_t *drv_obj;
+    int64_t conn_start_time;        // start time of the connection phase, us
+    // UDP mode, the last request datagram is kept to resend it on response timeout,
+    // the flags are shared between the response timer callback (ISR) and the driver task
+    uint8_t retry_buf[MB_TCP_BUFF_MAX_SIZE];
+    uint16_t retry_len;
+    _Atomic(uint32_t) retry_cnt;    // the number of resent datagrams of current request
+    _Atomic(bool) retry_pending;    // the resend of the request is requested by response timer
+    _Atomic(bool) resp_pending;     // the response for the last request datagram is not received yet
 } mbm_tcp_port_t;
 
 /* ----------------------- Static variables & functions ----------------------*/
@@ -126,6 +135,7 @@ mb_err_enum_t mbm_port_tcp_create(mb_tcp_opts_t *tcp_opts, mb_port_base_t **port
     ptcp->drv_obj->port = tcp_opts->port;
     ptcp->drv_obj->uid = tcp_opts->uid;
     ptcp->drv_obj->is_master = true;
+    ptcp->drv_obj->rtu_framing = tcp_opts->rtu_framing;
     ptcp->drv_obj->dns_name = tcp_opts->dns_name;
     ptcp->drv_obj->event_cbs.mb_sync_event_cb = mbm_port_tcp_sync_event;
     ptcp->drv_obj->event_cbs.port_arg = (void *)ptcp;
@@ -206,6 +216,7 @@ void mbm_port_tcp_enable(mb_port_base_t *inst)
     mbm_tcp_port_t *port_obj = __containerof(inst, mbm_tcp_port_t, base);
     (void)mb_drv_start_task(port_obj->drv_obj);
     (void)mb_drv_clear_status_flag(port_obj->drv_obj, MB_FLAG_DISCONNECTED);
+    port_obj->conn_start_time = esp_timer_get_time();
     DRIVER_SEND_EVENT(port_obj->drv_obj, MB_EVENT_RESOLVE, UNDEF_FD);
 }
 
@@ -238,11 +249,18 @@ bool mbm_port_tcp_recv_data(mb_port_base_t *inst, uint8_t **frame, uint16_t *len
             time = port_get_timestamp() - info_ptr->send_time;
             ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", processing time[us] = %ju."), port_obj->drv_obj, info_ptr->index,
                         info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, time);
+            // The socket send and receive time stamps give the round trip time of the slave,
+            // the response to the resent datagram is ambiguous, so it is not sampled
+            if ((info_ptr->recv_time >= info_ptr->send_time) && !atomic_load(&port_obj->retry_cnt)) {
+                mb_port_timer_rtt_sample(inst, (uint8_t)info_ptr->addr_info.uid,
+                                            (uint64_t)(info_ptr->recv_time - info_ptr->send_time));
+            }
             status = true;
         } else {
             ESP_LOGE(TAG, "%p, "MB_NODE_FMT(", drop packet TID: 0x%04" PRIx16 ":0x%04" PRIx16 ", %p."),
                             port_obj->drv_obj, info_ptr->index, info_ptr->sock_id,
                             info_ptr->addr_info.ip_addr_str, (unsigned)tid_counter, (unsigned)info_ptr->tid_counter, *frame);
+            MB_STATS_DROP(inst, 1);
         }
     }
     return status;
@@ -304,14 +322,34 @@ bool mbm_port_timer_expired(void *inst)
         // It is now to check solution.
         mb_event.event_id = MB_EVENT_TIMEOUT;
         mb_event.opt_fd = port_obj->drv_obj->curr_node_index;
+#if CONFIG_ESP_EVENT_POST_FROM_ISR
         err = esp_event_isr_post_to(port_obj->drv_obj->event_loop_hdl, MB_EVENT_BASE(port_obj->drv_obj), 
                                     (int32_t)MB_EVENT_TIMEOUT, (void *)&mb_event, sizeof(mb_event_info_t*), &task_unblocked);
+#elif CONFIG_IDF_TARGET_LINUX
+        // The timer callback is dispatched from the task on the linux target, the event is posted without waiting
+        task_unblocked = pdFALSE;
+        err = esp_event_post_to(port_obj->drv_obj->event_loop_hdl, MB_EVENT_BASE(port_obj->drv_obj),
+                                    (int32_t)MB_EVENT_TIMEOUT, (void *)&mb_event, sizeof(mb_event_info_t*), 0);
+#else
+#error "The Modbus TCP master requires CONFIG_ESP_EVENT_POST_FROM_ISR to post the timeout event."
+#endif
         if (err != ESP_OK) {
             ESP_EARLY_LOGE(TAG, "Timeout event send error: %d", err);
         }
         need_poll = task_unblocked;
+        if ((port_obj->drv_obj->mb_proto == MB_UDP) && atomic_load(&port_obj->resp_pending)
+                && (atomic_load(&port_obj->retry_cnt) < MB_UDP_RETRY_CNT)) {
+            // The datagram might be lost, the request is resent by the timeout event handler
+            atomic_fetch_add(&port_obj->retry_cnt, 1);
+            atomic_store(&port_obj->retry_pending, true);
+            // The driver task does not poll, unblock it to handle the posted timeout event
+            mb_drv_wake_task(port_obj->drv_obj);
+            return need_poll;
+        }
+        atomic_store(&port_obj->resp_pending, false);
         mb_port_event_set_err_type(inst, EV_ERROR_RESPOND_TIMEOUT);
         need_poll = mb_port_event_post(inst, EVENT(EV_ERROR_PROCESS));
+        mb_drv_wake_task(port_obj->drv_obj);
     }
     return need_poll;
 }
@@ -389,8 +427,15 @@ MB_EVENT_HANDLER(mbm_on_resolve)
                 DRIVER_SEND_EVENT(ctx, MB_EVENT_CONNECT, pslave->index);
             } else {
 #ifdef MB_MDNS_IS_INCLUDED
-                int ret = port_resolve_mdns_host(pslave->addr_info.node_name_str, &pslave->addr_info.ip_addr_str);
+                char *addr_str = NULL;
+                int ret = port_resolve_mdns_host(pslave->addr_info.node_name_str, &addr_str);
                 if (ret > 0) {
+                    // Drop the address resolved before the connection was lost
+                    if (pslave->addr_info.ip_addr_str
+                            && (pslave->addr_info.ip_addr_str != pslave->addr_info.node_name_str)) {
+                        free((void *)pslave->addr_info.ip_addr_str);
+                    }
+                    pslave->addr_info.ip_addr_str = addr_str;
                     ESP_LOGI(TAG, "%p, slave: %d, resolved with IP:%s.", ctx, (int)fd, pslave->addr_info.ip_addr_str);
                     MB_SET_NODE_STATE(pslave, MB_SOCK_STATE_RESOLVED);
                     DRIVER_SEND_EVENT(ctx, MB_EVENT_CONNECT, pslave->index);
@@ -423,6 +468,112 @@ MB_EVENT_HANDLER(mbm_on_resolve)
     }
 }
 
+static void mbm_node_connected(void *ctx, mb_node_info_t *node_ptr)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    mbm_tcp_port_t *port_obj = (mbm_tcp_port_t *)drv_obj->parent;
+    FD_CLR(node_ptr->sock_id, &drv_obj->connecting_set);
+    FD_SET(node_ptr->sock_id, &drv_obj->conn_set);
+    mb_drv_lock(ctx);
+    drv_obj->node_conn_count++;
+    // Update time stamp for connected slaves
+    node_ptr->send_time = esp_timer_get_time();
+    node_ptr->recv_time = esp_timer_get_time();
+    mb_drv_unlock(ctx);
+    MB_STATS_CONNECT(&port_obj->base, (uint32_t)(node_ptr->recv_time - node_ptr->conn_start_time), true);
+    ESP_LOGI(TAG, "%p, slave: #%d, sock:%d, IP: %s, is connected in %u ms.",
+                ctx, (int)node_ptr->index, (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str,
+                (unsigned)((node_ptr->recv_time - node_ptr->conn_start_time) / 1000));
+    MB_SET_NODE_STATE(node_ptr, MB_SOCK_STATE_CONNECTED);
+    if (node_ptr->addr_info.proto != MB_UDP) {
+        (void)port_keep_alive_enable(node_ptr->sock_id, CONFIG_FMB_TCP_KEEP_ALIVE_TOUT_SEC);
+    }
+    ESP_LOGD(TAG, "Opened/connected: %u, %u.",
+                (unsigned)drv_obj->mb_node_open_count, (unsigned)drv_obj->node_conn_count);
+    if (drv_obj->mb_node_open_count == drv_obj->node_conn_count) {
+        if (drv_obj->event_cbs.on_conn_done_cb) {
+            drv_obj->event_cbs.on_conn_done_cb(drv_obj->event_cbs.arg);
+        }
+        ESP_LOGI(TAG, "%p, Connected: %u, %u, start polling, all nodes connected in %u ms.",
+                    ctx, (unsigned)drv_obj->mb_node_open_count, (unsigned)drv_obj->node_conn_count,
+                    (unsigned)((esp_timer_get_time() - port_obj->conn_start_time) / 1000));
+        mb_drv_set_status_flag(ctx, MB_FLAG_CONNECTED);
+    }
+}
+
+static void mbm_conn_timer_arm(void *ctx);
+
+// Close the node and schedule the next connection attempt, it is started by the connection timer
+static void mbm_node_connect_fail(void *ctx, mb_node_info_t *node_ptr, err_t err)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    mbm_tcp_port_t *port_obj = (mbm_tcp_port_t *)drv_obj->parent;
+    ESP_LOGE(TAG, "Modbus connection phase, slave: %d (%s), connection error (%d).",
+                (int)node_ptr->index, node_ptr->addr_info.ip_addr_str, (int)err);
+    MB_STATS_CONNECT(&port_obj->base, 0, false);
+#ifdef MB_MDNS_IS_INCLUDED
+    // The cached address may be stale, resolve the node again on next attempt
+    port_resolve_cache_invalidate(node_ptr->addr_info.node_name_str);
+#endif
+    if (node_ptr->sock_id > 0) {
+        FD_CLR(node_ptr->sock_id, &drv_obj->connecting_set);
+    }
+    port_close_connection(node_ptr);
+    node_ptr->conn_retry_time = esp_timer_get_time() + (MB_RECONNECT_DELAY_MS * 1000);
+    mbm_conn_timer_arm(ctx);
+}
+
+// Arm the driver timer for the nearest connect deadline or delayed connection attempt,
+// the driver sends the timeout event to check them instead of polling in the event loop
+static void mbm_conn_timer_arm(void *ctx)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    mb_node_info_t *node_ptr = NULL;
+    int64_t next_time = INT64_MAX;
+    for (int node = 0; (node < MB_TCP_PORT_MAX_CONN); node++) {
+        node_ptr = mb_drv_get_node(drv_obj, node);
+        if (node_ptr && (MB_GET_NODE_STATE(node_ptr) == MB_SOCK_STATE_CONNECTING)) {
+            int64_t deadline = node_ptr->conn_start_time + (int64_t)(MB_RECONNECT_TIME_MS * 1000);
+            next_time = (deadline < next_time) ? deadline : next_time;
+        } else if (node_ptr && (MB_GET_NODE_STATE(node_ptr) == MB_SOCK_STATE_OPENED) && node_ptr->conn_retry_time) {
+            next_time = (node_ptr->conn_retry_time < next_time) ? node_ptr->conn_retry_time : next_time;
+        }
+    }
+    if (next_time != INT64_MAX) {
+        int64_t wait_us = next_time - esp_timer_get_time();
+        // The timer never expires earlier, the zero timeout would cancel it
+        uint32_t wait_ms = (wait_us > 0) ? (uint32_t)((wait_us + 999) / 1000) : 1;
+        mb_drv_set_timeout(ctx, wait_ms);
+    }
+}
+
+// Check the connect deadlines and start the delayed connection attempts of all nodes
+static void mbm_check_pending_connections(void *ctx)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    mb_node_info_t *node_ptr = NULL;
+    int64_t time_now = esp_timer_get_time();
+    for (int node = 0; (node < MB_TCP_PORT_MAX_CONN); node++) {
+        node_ptr = mb_drv_get_node(drv_obj, node);
+        if (node_ptr && (MB_GET_NODE_STATE(node_ptr) == MB_SOCK_STATE_CONNECTING)) {
+            if ((time_now - node_ptr->conn_start_time) >= (int64_t)(MB_RECONNECT_TIME_MS * 1000)) {
+                // The slave does not answer, drop the attempt to not keep the node pending forever
+                mbm_node_connect_fail(ctx, node_ptr, ERR_TIMEOUT);
+            }
+        } else if (node_ptr && (MB_GET_NODE_STATE(node_ptr) == MB_SOCK_STATE_OPENED) && node_ptr->conn_retry_time) {
+            if (time_now >= node_ptr->conn_retry_time) {
+                node_ptr->conn_retry_time = 0;
+                DRIVER_SEND_EVENT(ctx, MB_EVENT_RESOLVE, node_ptr->index);
+            }
+        } else if (node_ptr && (MB_GET_NODE_STATE(node_ptr) == MB_SOCK_STATE_RESOLVED)
+                    && FD_ISSET(node, &drv_obj->open_set)) {
+            DRIVER_SEND_EVENT(ctx, MB_EVENT_CONNECT, node_ptr->index);
+        }
+        mb_drv_check_suspend_shutdown(ctx);
+    }
+    mbm_conn_timer_arm(ctx);
+}
+
 MB_EVENT_HANDLER(mbm_on_connect)
 {
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
@@ -432,63 +583,39 @@ MB_EVENT_HANDLER(mbm_on_connect)
     err_t err = ERR_CONN;
     if (MB_CHECK_FD_RANGE(event_info->opt_fd)) {
         node_ptr = mb_drv_get_node(drv_obj, event_info->opt_fd);
-        if (node_ptr &&
-            (MB_GET_NODE_STATE(node_ptr) < MB_SOCK_STATE_CONNECTED) &&
+        if (node_ptr && (MB_GET_NODE_STATE(node_ptr) == MB_SOCK_STATE_CONNECTING)) {
+            // The driver task found the socket writable, the connection is completed or failed
+            err = port_check_alive(node_ptr, 0);
+            if (err == ERR_OK) {
+                mbm_node_connected(ctx, node_ptr);
+            } else if (err == ERR_INPROGRESS) {
+                FD_SET(node_ptr->sock_id, &drv_obj->connecting_set);
+            } else {
+                mbm_node_connect_fail(ctx, node_ptr, err);
+            }
+        } else if (node_ptr &&
+            (MB_GET_NODE_STATE(node_ptr) < MB_SOCK_STATE_CONNECTING) &&
             (MB_GET_NODE_STATE(node_ptr) >= MB_SOCK_STATE_RESOLVED)) {
             ESP_LOGD(TAG, "%p, connection phase, slave: #%d(%d) [%s].",
                      ctx, (int)event_info->opt_fd, (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
+            node_ptr->conn_start_time = esp_timer_get_time();
+            node_ptr->conn_retry_time = 0;
             err = port_connect(ctx, node_ptr);
             switch (err) {
                 case ERR_OK:
-                    FD_SET(node_ptr->sock_id, &drv_obj->conn_set);
-                    mb_drv_lock(ctx);
-                    drv_obj->node_conn_count++;
-                    // Update time stamp for connected slaves
-                    node_ptr->send_time = esp_timer_get_time();
-                    node_ptr->recv_time = esp_timer_get_time();
-                    mb_drv_unlock(ctx);
-                    ESP_LOGI(TAG, "%p, slave: #%d, sock:%d, IP: %s, is connected.",
-                                ctx, (int)event_info->opt_fd, (int)node_ptr->sock_id, 
-                                node_ptr->addr_info.ip_addr_str);
-                    MB_SET_NODE_STATE(node_ptr, MB_SOCK_STATE_CONNECTED);
-                    (void)port_keep_alive_enable(node_ptr->sock_id, CONFIG_FMB_TCP_KEEP_ALIVE_TOUT_SEC);
-                    ESP_LOGD(TAG, "Opened/connected: %u, %u.",
-                                (unsigned)drv_obj->mb_node_open_count, (unsigned)drv_obj->node_conn_count);
-                    if (drv_obj->mb_node_open_count == drv_obj->node_conn_count) {
-                        if (drv_obj->event_cbs.on_conn_done_cb) {
-                            drv_obj->event_cbs.on_conn_done_cb(drv_obj->event_cbs.arg);
-                        }
-                        ESP_LOGI(TAG, "%p, Connected: %u, %u, start polling.", 
-                                    ctx, (unsigned)drv_obj->mb_node_open_count, (unsigned)drv_obj->node_conn_count);
-                        mb_drv_set_status_flag(ctx, MB_FLAG_CONNECTED);
-                    }
+                    mbm_node_connected(ctx, node_ptr);
                     break;
                 case ERR_INPROGRESS:
-                    if (FD_ISSET(node_ptr->sock_id, &drv_obj->conn_set)) {
-                        FD_CLR(node_ptr->sock_id, &drv_obj->conn_set);
-                        ESP_LOGD(TAG, "%p, slave: #%d, sock:%d, IP:%s, connect fail error = %d.",
-                                ctx, (int)event_info->opt_fd, (int)node_ptr->sock_id,
-                                node_ptr->addr_info.ip_addr_str, (int)err);
-                        mb_drv_lock(ctx);
-                        if (drv_obj->node_conn_count) {
-                            drv_obj->node_conn_count--;
-                        }
-                        mb_drv_unlock(ctx);
-                        DRIVER_SEND_EVENT(ctx, MB_EVENT_CLOSE, event_info->opt_fd);
-                        port_close_connection(node_ptr);
-                    } else {
-                        ESP_LOGD(TAG, "%p, slave: #%d, sock:%d, IP:%s, connection is in progress.",
-                                ctx, (int)event_info->opt_fd, (int)node_ptr->sock_id,
-                                node_ptr->addr_info.ip_addr_str);
-                        MB_SET_NODE_STATE(node_ptr, MB_SOCK_STATE_CONNECTING);
-                        vTaskDelay(MB_CONN_TICK_TIMEOUT);
-                        // try to connect to slave and check connection again if it is not connected
-                        DRIVER_SEND_EVENT(ctx, MB_EVENT_CONNECT, event_info->opt_fd);
-                    }
+                    // Do not block here, the driver task waits for the socket along with other sockets
+                    ESP_LOGD(TAG, "%p, slave: #%d, sock:%d, IP:%s, connection is in progress.",
+                            ctx, (int)event_info->opt_fd, (int)node_ptr->sock_id,
+                            node_ptr->addr_info.ip_addr_str);
+                    MB_SET_NODE_STATE(node_ptr, MB_SOCK_STATE_CONNECTING);
+                    FD_SET(node_ptr->sock_id, &drv_obj->connecting_set);
+                    mbm_conn_timer_arm(ctx);
                     break;
                 case ERR_CONN:
-                    ESP_LOGE(TAG, "Modbus connection phase, slave: %d (%s), connection error (%d).",
-                            (int)event_info->opt_fd, node_ptr->addr_info.ip_addr_str, (int)err);
+                    mbm_node_connect_fail(ctx, node_ptr, err);
                     break;
                 default:
                     ESP_LOGE(TAG, "Invalid error state, slave: %d (%s), error = %d.",
@@ -497,20 +624,9 @@ MB_EVENT_HANDLER(mbm_on_connect)
             }
         }
     } else {
-        // if the event fd is UNDEF_FD (an event for all slaves),
-        // then perform connection phase for all resolved slaves sending the connection event
-        for (int node = 0; (node < MB_TCP_PORT_MAX_CONN); node++) {
-            node_ptr = mb_drv_get_node(drv_obj, node);
-            if (node_ptr && 
-                (MB_GET_NODE_STATE(node_ptr) < MB_SOCK_STATE_CONNECTED) &&
-                (MB_GET_NODE_STATE(node_ptr) >= MB_SOCK_STATE_RESOLVED)) {
-                if (((node_ptr->sock_id < 0) || !FD_ISSET(node_ptr->sock_id, &drv_obj->conn_set))
-                            && FD_ISSET(node, &drv_obj->open_set)) {
-                    DRIVER_SEND_EVENT(ctx, MB_EVENT_CONNECT, node_ptr->index);
-                }
-            }
-            mb_drv_check_suspend_shutdown(ctx);
-        }
+        // if the event fd is UNDEF_FD (an event for all slaves), check the pending connections
+        // and perform connection phase for all resolved slaves sending the connection event
+        mbm_check_pending_connections(ctx);
     }
 }
 
@@ -533,7 +649,14 @@ MB_EVENT_HANDLER(mbm_on_error)
             ESP_LOGW(TAG, "%p, "MB_NODE_FMT(", error handling."), ctx, (int)node_ptr->fd,
                                             (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
             ESP_LOGE(TAG, "Node: %d, try to repair lost connection, err= %d", (int)event_info->opt_fd, ret);
-            FD_CLR(node_ptr->sock_id, &drv_obj->conn_set);
+            // The socket is shared by all nodes in UDP mode
+            if (node_ptr->addr_info.proto != MB_UDP) {
+                FD_CLR(node_ptr->sock_id, &drv_obj->conn_set);
+            }
+            if (drv_obj->mb_node_open_count == drv_obj->node_conn_count) {
+                // Measure the time to reconnect all nodes from this point
+                ((mbm_tcp_port_t *)drv_obj->parent)->conn_start_time = esp_timer_get_time();
+            }
             mb_drv_lock(ctx);
             if (drv_obj->node_conn_count) {
                 drv_obj->node_conn_count--;
@@ -586,6 +709,15 @@ MB_EVENT_HANDLER(mbm_on_send_data)
                         ctx, (int)info_ptr->index, (int)info_ptr->sock_id, 
                         info_ptr->addr_info.ip_addr_str, (unsigned)info_ptr->tid_counter, (int)ret, (unsigned)errno);
             info_ptr->error = 0;
+            if (info_ptr->addr_info.proto == MB_UDP) {
+                // Keep the datagram to resend it with the same TID if the response is lost
+                mbm_tcp_port_t *port_obj = (mbm_tcp_port_t *)drv_obj->parent;
+                memcpy(port_obj->retry_buf, tx_buffer, sz);
+                port_obj->retry_len = sz;
+                atomic_store(&port_obj->retry_cnt, 0);
+                atomic_store(&port_obj->retry_pending, false);
+                atomic_store(&port_obj->resp_pending, true);
+            }
             // Every successful write increase TID counter
             if (info_ptr->tid_counter < (USHRT_MAX - 1)) {
                 info_ptr->tid_counter++;
@@ -615,6 +747,7 @@ MB_EVENT_HANDLER(mbm_on_recv_data)
     // Get frame from queue, check for correctness, push back correct frame and generate receive condition.
     // Removes incorrect or expired frames from the queue, leave just correct one then sent sync event
     mb_node_info_t *node_ptr = mb_drv_get_node(drv_obj, event_info->opt_fd);
+    mbm_tcp_port_t *port_obj = (mbm_tcp_port_t *)drv_obj->parent;
     if (node_ptr) {
         ESP_LOGD(TAG, "%p, slave #%d(%d) [%s], receive data ready.", ctx, (int)event_info->opt_fd,
                     (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
@@ -623,7 +756,9 @@ MB_EVENT_HANDLER(mbm_on_recv_data)
             if ((sz > MB_TCP_FUNC) && (sz < sizeof(buf))) {
                 uint16_t tid = MB_TCP_MBAP_GET_FIELD(buf, MB_TCP_TID);
                 ESP_LOGD(TAG, "%p, packet TID: 0x%04" PRIx16 " received.", ctx, tid);
-                if (tid == (node_ptr->tid_counter - 1)) {
+                // The response to the resent datagram may come twice in UDP mode, take just the first one
+                if ((tid == (node_ptr->tid_counter - 1))
+                        && ((node_ptr->addr_info.proto != MB_UDP) || atomic_exchange(&port_obj->resp_pending, false))) {
                     queue_push(node_ptr->rx_queue, buf, sz, NULL);
                     mb_drv_lock(ctx);
                     node_ptr->recv_time = esp_timer_get_time();
@@ -675,8 +810,28 @@ MB_EVENT_HANDLER(mbm_on_close)
 MB_EVENT_HANDLER(mbm_on_timeout)
 {
     // Socket read/write timeout is triggered
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    mbm_tcp_port_t *port_obj = (mbm_tcp_port_t *)drv_obj->parent;
     mb_event_info_t *event_info = (mb_event_info_t *)data;
     ESP_LOGD(TAG, "%s  %s: fd: %d", (char *)base, __func__, (int)event_info->opt_fd);
+    if (event_info->opt_fd == UNDEF_FD) {
+        // The driver timer is expired, check the connect deadlines and delayed attempts
+        mbm_check_pending_connections(ctx);
+    } else if (MB_CHECK_FD_RANGE(event_info->opt_fd) && atomic_exchange(&port_obj->retry_pending, false)) {
+        mb_node_info_t *info_ptr = mb_drv_get_node(drv_obj, event_info->opt_fd);
+        // Resend the request datagram unless the response is received in between
+        if (info_ptr && atomic_load(&port_obj->resp_pending) && (MB_GET_NODE_STATE(info_ptr) >= MB_SOCK_STATE_CONNECTED)) {
+            int ret = port_write_poll(info_ptr, port_obj->retry_buf, port_obj->retry_len, MB_TCP_SEND_TIMEOUT_MS);
+            ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", resend request, retry: %u, ret: %d."),
+                        ctx, (int)info_ptr->index, (int)info_ptr->sock_id, info_ptr->addr_info.ip_addr_str,
+                        (unsigned)atomic_load(&port_obj->retry_cnt), ret);
+            mb_port_timer_respond_timeout_enable(&port_obj->base);
+        } else if (atomic_exchange(&port_obj->resp_pending, false)) {
+            // The request can not be resent, complete it with the timeout error
+            mb_port_event_set_err_type(&port_obj->base, EV_ERROR_RESPOND_TIMEOUT);
+            (void)mb_port_event_post(&port_obj->base, EVENT(EV_ERROR_PROCESS));
+        }
+    }
     // Todo: this event can be used to check network state (keep empty for now)
     mb_drv_check_suspend_shutdown(ctx);
     // Intentionally allow IDLE task to trigger if other tasks do not perform it properly.
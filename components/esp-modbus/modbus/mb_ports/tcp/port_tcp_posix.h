@@ -0,0 +1,73 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+// The TCP port on the linux target uses the host (POSIX) sockets and eventfd instead of lwIP and vfs,
+// this header keeps the lwIP specific definitions used by the port
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <net/if.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The error codes of lwIP returned by the port functions
+typedef int8_t err_t;
+
+typedef enum {
+    ERR_OK = 0,
+    ERR_MEM = -1,
+    ERR_BUF = -2,
+    ERR_TIMEOUT = -3,
+    ERR_RTE = -4,
+    ERR_INPROGRESS = -5,
+    ERR_VAL = -6,
+    ERR_WOULDBLOCK = -7,
+    ERR_USE = -8,
+    ERR_ALREADY = -9,
+    ERR_ISCONN = -10,
+    ERR_CONN = -11,
+    ERR_IF = -12,
+    ERR_ABRT = -13,
+    ERR_RST = -14,
+    ERR_CLSD = -15,
+    ERR_ARG = -16
+} err_enum_t;
+
+#define inet_ntoa_r(addr, buf, buflen)  ((char *)inet_ntop(AF_INET, &(addr), (buf), (buflen)))
+#define inet6_ntoa_r(addr, buf, buflen) ((char *)inet_ntop(AF_INET6, &(addr), (buf), (buflen)))
+
+#ifndef IPSTR
+#define IPSTR "%d.%d.%d.%d"
+#endif
+
+#ifndef IPV6STR
+#define IPV6STR "%04x:%04x:%04x:%04x:%04x:%04x:%04x:%04x"
+#endif
+
+#define MB_TCP_IPV6_ENABLED         (1)
+#define MB_TCP_SO_LINGER_ENABLED    (1)
+
+// The host raises SIGPIPE when the peer closes the connection, the error is returned instead
+#define MB_TCP_SEND_FLAGS           (MSG_NOSIGNAL)
+
+// The timer callbacks are dispatched from the task, the eventfd does not need the ISR support
+#define MB_EVENTFD_FLAGS            (EFD_NONBLOCK | EFD_CLOEXEC)
+
+#ifdef __cplusplus
+}
+#endif
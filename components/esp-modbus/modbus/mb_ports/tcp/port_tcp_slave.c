@@ -132,6 +132,7 @@ mb_err_enum_t mbs_port_tcp_create(mb_tcp_opts_t *tcp_opts, mb_port_base_t **port
     ptcp->drv_obj->mb_proto = tcp_opts->mode;
     ptcp->drv_obj->uid = tcp_opts->uid;
     ptcp->drv_obj->is_master = false;
+    ptcp->drv_obj->rtu_framing = tcp_opts->rtu_framing;
     ptcp->drv_obj->event_cbs.mb_sync_event_cb = mbs_port_tcp_sync_event;
     ptcp->drv_obj->event_cbs.port_arg = (void *)ptcp;
 
@@ -223,7 +224,7 @@ bool mbs_port_tcp_recv_data(mb_port_base_t *inst, uint8_t **frame, uint16_t *len
                 memcpy(*frame, buf, len);
                 *length = (uint16_t)len;
                 status = true;
-                ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", read packet, TID: 0x%04" PRIx16 ", %p."),
+                MB_TRACED(TAG, "%p, " MB_NODE_FMT(", read packet, TID: 0x%04" PRIx16 ", %p."),
                          port_obj, pnode->index, pnode->sock_id,
                          pnode->addr_info.ip_addr_str, (unsigned)pnode->tid_counter, *frame);
                 if (ESP_OK != transaction_item_set_state(item, CONFIRMED)) {
@@ -235,6 +236,7 @@ bool mbs_port_tcp_recv_data(mb_port_base_t *inst, uint8_t **frame, uint16_t *len
             int frame_cnt = transaction_delete_expired(port_obj->transaction, port_get_timestamp(), MB_DROP_TRANSACTION_TIME_US);
             if (frame_cnt) {
                 ESP_LOGE(TAG, "Deleted %d expired frames.", frame_cnt);
+                MB_STATS_DROP(inst, frame_cnt);
             }
         }
         mb_drv_unlock(drv_obj);
@@ -265,7 +267,7 @@ bool mbs_port_tcp_send_data(mb_port_base_t *inst, uint8_t *frame, uint16_t lengt
             int write_length = mb_drv_write(drv_obj, node_id, frame, length);
             if (pnode && write_length) {
                 frame_sent = true;
-                ESP_LOGD(TAG, "%p, node: #%d, socket(#%d)[%s], send packet TID: 0x%04" PRIx16 ":0x%04" PRIx16 ", %p, len: %d, ",
+                MB_TRACED(TAG, "%p, node: #%d, socket(#%d)[%s], send packet TID: 0x%04" PRIx16 ":0x%04" PRIx16 ", %p, len: %d, ",
                             drv_obj, pnode->index, pnode->sock_id,
                             pnode->addr_info.node_name_str, (unsigned)tid, (unsigned)msg_id, frame, length);
             } else {
@@ -283,12 +285,13 @@ bool mbs_port_tcp_send_data(mb_port_base_t *inst, uint8_t *frame, uint16_t lengt
             if (item && transaction_delete_item(port_obj->transaction, item) != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to remove queued TID:0x%04" PRIx16, tid);
             } else {
-                ESP_LOGD(TAG, "Remove the message TID:0x%04" PRIx16, tid);
+                MB_TRACED(TAG, "Remove the message TID:0x%04" PRIx16, tid);
             }
             (void)mb_drv_set_status_flag(drv_obj, MB_FLAG_TRANSACTION_READY);
         }
     } else {
         ESP_LOGE(TAG, "can not find the confirmed transaction TID: 0x%04" PRIx16 ", drop the frame", tid);
+        MB_STATS_DROP(inst, 1);
     }
     mb_drv_unlock(drv_obj);
 
@@ -365,7 +368,9 @@ MB_EVENT_HANDLER(mbs_on_ready)
         mb_drv_lock(ctx);
         drv_obj->listen_sock_fd = listen_sock;
         // so, all accepted sockets will inherit the keep-alive feature
-        (void)port_keep_alive_enable(drv_obj->listen_sock_fd, CONFIG_FMB_TCP_KEEP_ALIVE_TOUT_SEC);
+        if (drv_obj->mb_proto != MB_UDP) {
+            (void)port_keep_alive_enable(drv_obj->listen_sock_fd, CONFIG_FMB_TCP_KEEP_ALIVE_TOUT_SEC);
+        }
         (void)mb_drv_set_status_flag(drv_obj, MB_FLAG_TRANSACTION_READY);
         mb_drv_unlock(ctx);
         drv_obj->event_cbs.mb_sync_event_cb(drv_obj->event_cbs.port_arg, MB_SYNC_EVENT_READY);
@@ -389,7 +394,9 @@ MB_EVENT_HANDLER(mbs_on_connect)
         ESP_LOGD(TAG, "%s %s: fd: %d, is closed.", (char *)base, __func__, (int)event_info->opt_fd);
         return;
     }
-    (void)port_keep_alive_enable(pnode->sock_id, CONFIG_FMB_TCP_KEEP_ALIVE_TOUT_SEC);
+    if (pnode->addr_info.proto != MB_UDP) {
+        (void)port_keep_alive_enable(pnode->sock_id, CONFIG_FMB_TCP_KEEP_ALIVE_TOUT_SEC);
+    }
     mb_drv_lock(ctx);
     MB_SET_NODE_STATE(pnode, MB_SOCK_STATE_CONNECTED);
     FD_SET(pnode->sock_id, &drv_obj->conn_set);
@@ -397,6 +404,10 @@ MB_EVENT_HANDLER(mbs_on_connect)
         drv_obj->node_conn_count++;
     }
     mb_drv_unlock(ctx);
+    // Schedule the check of connection state if it is not scheduled yet
+    if (!mb_timer_wheel_is_armed(&drv_obj->timer_entry)) {
+        mb_drv_set_timeout(drv_obj, MB_TCP_KEEP_ALIVE_TOUT_MS);
+    }
 }
 
 MB_EVENT_HANDLER(mbs_on_recv_data)
@@ -404,18 +415,18 @@ MB_EVENT_HANDLER(mbs_on_recv_data)
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
     mb_event_info_t *event_info = (mb_event_info_t *)data;
     mbs_tcp_port_t *port_obj = (mbs_tcp_port_t *)drv_obj->parent;
-    ESP_LOGD(TAG, "%s  %s: fd: %d", (char *)base, __func__, (int)event_info->opt_fd);
+    MB_TRACED(TAG, "%s  %s: fd: %d", (char *)base, __func__, (int)event_info->opt_fd);
     mb_node_info_t *pnode = mb_drv_get_node(drv_obj, event_info->opt_fd);
     transaction_item_handle_t item = NULL;
     if (pnode) {
         if (!queue_is_empty(pnode->rx_queue)) {
-            ESP_LOGD(TAG, "%p, node #%d, socket(#%d) [%s], receive data ready.", ctx, (int)event_info->opt_fd,
+            MB_TRACED(TAG, "%p, node #%d, socket(#%d) [%s], receive data ready.", ctx, (int)event_info->opt_fd,
                      (int)pnode->sock_id, pnode->addr_info.ip_addr_str);
             frame_entry_t frame_entry;
             size_t sz = queue_pop(pnode->rx_queue, NULL, MB_BUFFER_SIZE, &frame_entry);
             if (sz > MB_TCP_FUNC) {
                 uint16_t tid_counter = MB_TCP_MBAP_GET_FIELD(frame_entry.buf, MB_TCP_TID);
-                ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", received packet TID: 0x%04" PRIx16 ", frame: %p, %u"),
+                MB_TRACED(TAG, "%p, " MB_NODE_FMT(", received packet TID: 0x%04" PRIx16 ", frame: %p, %u"),
                          drv_obj, pnode->index, pnode->sock_id,
                          pnode->addr_info.ip_addr_str, (unsigned)tid_counter, frame_entry.buf, frame_entry.len);
                 mb_drv_lock(drv_obj);
@@ -429,6 +440,8 @@ MB_EVENT_HANDLER(mbs_on_recv_data)
                 item = transaction_enqueue(port_obj->transaction, &msg, port_get_timestamp());
                 pnode->tid_counter = tid_counter; // assign the TID from frame to use it on send
                 mb_drv_unlock(drv_obj);
+                MB_STAGE_TRACE(&port_obj->base, MB_TRACE_STAGE_FRAME_QUEUED, frame_entry.buf[MB_TCP_FUNC],
+                                pnode->index, tid_counter);
             }
         }
         item = transaction_get_first(port_obj->transaction);
@@ -439,7 +452,7 @@ MB_EVENT_HANDLER(mbs_on_recv_data)
                     (void)mb_drv_clear_status_flag(drv_obj, MB_FLAG_TRANSACTION_READY);
                 } else {
                     if (port_get_timestamp() - transaction_item_get_tick(item) > MB_DROP_TRANSACTION_TIME_US) {
-                        ESP_LOGD(TAG, "Transaction TID:0x%04" PRIx16 " is expired.", transaction_item_get_id(item));
+                        MB_TRACED(TAG, "Transaction TID:0x%04" PRIx16 " is expired.", transaction_item_get_id(item));
                     } else {
                         // postpone the packet processing to next cycle
                         DRIVER_SEND_EVENT(ctx, MB_EVENT_RECV_DATA, pnode->index);
@@ -457,11 +470,11 @@ MB_EVENT_HANDLER(mbs_on_recv_data)
                 int node_id = 0;
                 (void)transaction_item_get_data(item, NULL, &msg_id, &node_id);
                 pnode = mb_drv_get_node(drv_obj, node_id);
-                ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", acknoledged packet TID: 0x%04" PRIx16 ", start transaction."),
+                MB_TRACED(TAG, "%p, " MB_NODE_FMT(", acknoledged packet TID: 0x%04" PRIx16 ", start transaction."),
                              drv_obj, pnode->index, pnode->sock_id,
                              pnode->addr_info.ip_addr_str, (unsigned)msg_id);
                 if (ESP_OK == transaction_item_set_state(item, ACKNOWLEDGED)) {
-                    ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", acknoledged packet TID: 0x%04" PRIx16 "."),
+                    MB_TRACED(TAG, "%p, " MB_NODE_FMT(", acknoledged packet TID: 0x%04" PRIx16 "."),
                              drv_obj, pnode->index, pnode->sock_id,
                              pnode->addr_info.ip_addr_str, (unsigned)msg_id);
                 }
@@ -475,7 +488,7 @@ MB_EVENT_HANDLER(mbs_on_recv_data)
                 }
             }
         } else {
-            ESP_LOGD(TAG, "%p, no queued items found", ctx);
+            MB_TRACED(TAG, "%p, no queued items found", ctx);
         }
     }
     mb_drv_check_suspend_shutdown(ctx);
@@ -489,7 +502,7 @@ MB_EVENT_HANDLER(mbs_on_send_data)
     transaction_item_handle_t item = NULL;
     esp_err_t err = ESP_ERR_INVALID_STATE;
     frame_entry_t frame_entry = {0};
-    ESP_LOGD(TAG, "%s  %s: fd: %d", (char *)base, __func__, (int)event_info->opt_fd);
+    MB_TRACED(TAG, "%s  %s: fd: %d", (char *)base, __func__, (int)event_info->opt_fd);
     mb_node_info_t *pnode = mb_drv_get_node(drv_obj, event_info->opt_fd);
     if (pnode && !queue_is_empty(pnode->tx_queue)) {
         // Pop the frame entry, keep the buffer
@@ -513,12 +526,12 @@ MB_EVENT_HANDLER(mbs_on_send_data)
                     if (err != ESP_OK) {
                         ESP_LOGE(TAG, "Failed to remove queued TID:0x%04" PRIx16, (int)tid);
                     } else {
-                        ESP_LOGD(TAG, "Remove the message TID:0x%04" PRIx16, (int)tid);
+                        MB_TRACED(TAG, "Remove the message TID:0x%04" PRIx16, (int)tid);
                     }
                     (void)mb_drv_set_status_flag(drv_obj, MB_FLAG_TRANSACTION_READY);
                     uint64_t tick = (transaction_tick_t)transaction_item_get_tick(item);
                     uint64_t time_div_us = (esp_timer_get_time() - tick);
-                    ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", frame TID:0x%04" PRIx16 "!=0x%04" PRIx16 ", slave is busy."),
+                    MB_TRACED(TAG, "%p, " MB_NODE_FMT(", frame TID:0x%04" PRIx16 "!=0x%04" PRIx16 ", slave is busy."),
                                 ctx, (int)pnode->index, (int)pnode->sock_id,
                                 pnode->addr_info.ip_addr_str, pnode->tid_counter, tid);
                     ESP_LOGW(TAG, "%p, " MB_NODE_FMT(", handling time [ms]: %" PRIu64 ", exceeds slave response time in master."),
@@ -537,12 +550,12 @@ MB_EVENT_HANDLER(mbs_on_send_data)
                         pnode->error = ret;
                     } else {
                         pnode->error = 0;
-                        ESP_LOG_BUFFER_HEX_LEVEL("SENT", frame_entry.buf, ret, ESP_LOG_DEBUG);
+                        MB_TRACE_BUF("SENT", "", frame_entry.buf, ret, ESP_LOG_DEBUG);
                     }
                     (void)mb_drv_set_status_flag(drv_obj, MB_FLAG_TRANSACTION_READY);
                     err = transaction_set_state(port_obj->transaction, tid, TRANSMITTED);
                     if (err == ESP_OK) {
-                        ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", sent packet TID: 0x%04" PRIx16 ", %p."),
+                        MB_TRACED(TAG, "%p, " MB_NODE_FMT(", sent packet TID: 0x%04" PRIx16 ", %p."),
                                     drv_obj, pnode->index, pnode->sock_id,
                                     pnode->addr_info.ip_addr_str, tid, frame_entry.buf);
                     } else {
@@ -553,7 +566,7 @@ MB_EVENT_HANDLER(mbs_on_send_data)
                     if (transaction_delete_item(port_obj->transaction, item) != ESP_OK) {
                         ESP_LOGE(TAG, "Failed to remove queued TID:0x%04" PRIx16, tid);
                     } else {
-                        ESP_LOGD(TAG, "Remove the message TID:0x%04" PRIx16, tid);
+                        MB_TRACED(TAG, "Remove the message TID:0x%04" PRIx16, tid);
                     }
                     pnode->send_time = port_get_timestamp();
                     pnode->send_counter = (pnode->send_counter < (USHRT_MAX - 1)) ? (pnode->send_counter + 1) : 0;
@@ -567,6 +580,7 @@ MB_EVENT_HANDLER(mbs_on_send_data)
                 ESP_LOGE(TAG, "%p, " MB_NODE_FMT(", transaction not found for TID: 0x%04" PRIx16 ", drop data %p."),
                             ctx, (int)pnode->index, (int)pnode->sock_id,
                             pnode->addr_info.ip_addr_str, tid, pnode);
+                MB_STATS_DROP(&port_obj->base, 1);
                 (void)mb_drv_set_status_flag(drv_obj, MB_FLAG_TRANSACTION_READY);
             }
         } else {
@@ -583,7 +597,7 @@ MB_EVENT_HANDLER(mbs_on_error)
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
     mb_event_info_t *event_info = (mb_event_info_t *)data;
     mbs_tcp_port_t *port_obj = __containerof(drv_obj->parent, mbs_tcp_port_t, base);
-    ESP_LOGD(TAG, "%s  %s: fd: %d", (char *)base, __func__, (int)event_info->opt_fd);
+    MB_TRACED(TAG, "%s  %s: fd: %d", (char *)base, __func__, (int)event_info->opt_fd);
     mb_node_info_t *pnode = mb_drv_get_node(drv_obj, event_info->opt_fd);
     if (!pnode) {
         ESP_LOGD(TAG, "%s %s: fd: %d, is closed.", (char *)base, __func__, (int)event_info->opt_fd);
@@ -642,28 +656,35 @@ MB_EVENT_HANDLER(mbs_on_close)
 
 MB_EVENT_HANDLER(mbs_on_timeout)
 {
-    // Slave timeout triggered
-    //mb_event_info_t *event_info = (mb_event_info_t *)data;
+    // Slave timeout triggered, check the state of all connected nodes
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
     mbs_tcp_port_t *port_obj = __containerof(drv_obj->parent, mbs_tcp_port_t, base);
-    static int curr_fd = 0;
-    mb_node_info_t *pnode = mb_drv_get_node(drv_obj, curr_fd);
-    ESP_LOGD(TAG, "%s %s: fd: %d, count: %d", (char *)base, __func__, (int)curr_fd, drv_obj->node_conn_count);
+    uint64_t next_check_us = 0;
+    ESP_LOGD(TAG, "%s %s: count: %d", (char *)base, __func__, drv_obj->node_conn_count);
     mb_drv_check_suspend_shutdown(ctx);
-    int ret = mb_drv_check_node_state(drv_obj, &curr_fd, MB_TCP_KEEP_ALIVE_TOUT_MS);
-    if ((ret != ERR_OK) && (ret != ERR_TIMEOUT)) {
-        ESP_LOGE(TAG, "%p, " MB_NODE_FMT(", connection lost, err=%d, drop connection."),
-                        port_obj, pnode->index, pnode->sock_id,
-                        pnode->addr_info.ip_addr_str, (int)ret);
-        mb_drv_lock(drv_obj);
-        (void)transaction_delete_by_node_id(port_obj->transaction, curr_fd);
-        mb_drv_unlock(drv_obj);
-        mb_drv_close(drv_obj, curr_fd);
+    for (int fd = 0; mb_drv_get_next_node_from_set(drv_obj, &fd, &drv_obj->conn_set); fd++) {
+        mb_node_info_t *pnode = mb_drv_get_node(drv_obj, fd);
+        int ret = mb_drv_check_node_state(drv_obj, &fd, MB_TCP_KEEP_ALIVE_TOUT_MS);
+        if ((ret != ERR_OK) && (ret != ERR_TIMEOUT)) {
+            ESP_LOGE(TAG, "%p, " MB_NODE_FMT(", connection lost, err=%d, drop connection."),
+                            port_obj, pnode->index, pnode->sock_id,
+                            pnode->addr_info.ip_addr_str, (int)ret);
+            mb_drv_lock(drv_obj);
+            (void)transaction_delete_by_node_id(port_obj->transaction, fd);
+            mb_drv_unlock(drv_obj);
+            mb_drv_close(drv_obj, fd);
+            continue;
+        }
+        // The node is checked again when its keep alive time is elapsed since the last activity
+        uint64_t idle_us = (uint64_t)(port_get_timestamp() - pnode->recv_time);
+        uint64_t remain_us = ((MB_TCP_KEEP_ALIVE_TOUT_MS * 1000) > idle_us) ? ((MB_TCP_KEEP_ALIVE_TOUT_MS * 1000) - idle_us) : 0;
+        if (!next_check_us || (remain_us < next_check_us)) {
+            next_check_us = (remain_us > (MB_NODE_CHECK_MIN_MS * 1000)) ? remain_us : (MB_NODE_CHECK_MIN_MS * 1000);
+        }
     }
-    if ((curr_fd + 1) >= (drv_obj->node_conn_count)) {
-        curr_fd = 0;
-    } else {
-        curr_fd++;
+    // The timer is started again on the next connection if there are no connected nodes
+    if (next_check_us) {
+        mb_drv_set_timeout(drv_obj, (uint32_t)(next_check_us / 1000));
     }
 }
 
@@ -10,6 +10,7 @@
 #include "port_tcp_master.h"
 #include "port_tcp_utils.h"
 #include "port_tcp_driver.h"
+#include "tcp/tcp_rtu_framing.h"
 #include "sdkconfig.h"
 
 #define TAG "port.utils"
@@ -21,12 +22,11 @@ extern "C" {
 #if (CONFIG_FMB_COMM_MODE_TCP_EN)
 
 // Check host name and/or fill the IP address structure
-bool port_check_host_addr(const char *host_str, ip_addr_t *host_addr)
+bool port_check_host_addr(const char *host_str, struct sockaddr_storage *host_addr)
 {
     MB_RETURN_ON_FALSE((host_str), false, TAG, "wrong host name or IP.");
     char cstr[HOST_STR_MAX_LEN];
     char *string_ptr = &cstr[0];
-    ip_addr_t target_addr;
     struct addrinfo hint;
     struct addrinfo *addr_list;
     memset(&hint, 0, sizeof(hint));
@@ -34,7 +34,6 @@ bool port_check_host_addr(const char *host_str, ip_addr_t *host_addr)
     hint.ai_family = AF_UNSPEC;
     hint.ai_flags = AI_ADDRCONFIG; // get IPV6 address if supported, otherwise IPV4
     hint.ai_flags |= AI_CANONNAME;
-    memset(&target_addr, 0, sizeof(target_addr));
 
     // convert domain name to IP address
     // Todo: check EAI_FAIL error when resolve host name
@@ -44,19 +43,16 @@ bool port_check_host_addr(const char *host_str, ip_addr_t *host_addr)
         return false;
     }
     if (addr_list->ai_family == AF_INET) {
-        struct in_addr addr4 = ((struct sockaddr_in *)(addr_list->ai_addr))->sin_addr;
-        inet_addr_to_ip4addr(ip_2_ip4(&target_addr), &addr4);
-        string_ptr = ip4addr_ntoa_r(ip_2_ip4(&target_addr), cstr, sizeof(cstr));
+        string_ptr = inet_ntoa_r(((struct sockaddr_in *)(addr_list->ai_addr))->sin_addr, cstr, sizeof(cstr));
     }
-#if CONFIG_LWIP_IPV6
+#if MB_TCP_IPV6_ENABLED
     else {
-        struct in6_addr addr6 = ((struct sockaddr_in6 *)(addr_list->ai_addr))->sin6_addr;
-        inet6_addr_to_ip6addr(ip_2_ip6(&target_addr), &addr6);
-        string_ptr = ip6addr_ntoa_r(ip_2_ip6(&target_addr), cstr, sizeof(cstr));
+        string_ptr = inet6_ntoa_r(((struct sockaddr_in6 *)(addr_list->ai_addr))->sin6_addr, cstr, sizeof(cstr));
     }
 #endif
     if (host_addr) {
-        *host_addr = target_addr;
+        memset(host_addr, 0, sizeof(struct sockaddr_storage));
+        memcpy(host_addr, addr_list->ai_addr, addr_list->ai_addrlen);
     }
     ESP_LOGD(TAG, "Check name[IP]: \"%s\"[%s]", addr_list->ai_canonname ? addr_list->ai_canonname : "UNK", string_ptr);
     freeaddrinfo(addr_list);
@@ -72,8 +68,18 @@ bool port_close_connection(mb_node_info_t *info_ptr)
         ESP_LOGD(TAG, "wrong socket info or disconnected socket: %d, skip.", info_ptr->index);
         return false;
     }
+    if (info_ptr->addr_info.proto == MB_UDP) {
+        // The datagram socket is shared by all nodes, just detach the node from it
+        queue_flush(info_ptr->rx_queue);
+        queue_flush(info_ptr->tx_queue);
+        MB_SET_NODE_STATE(info_ptr, MB_SOCK_STATE_OPENED);
+        info_ptr->sock_id = UNDEF_FD;
+        return true;
+    }
     uint8_t tmp_buff[MB_PDU_SIZE_MAX];
 
+    // The next connection starts from the new RTU frame
+    info_ptr->rtu_count = 0;
     // Empty tcp buffer before shutdown
     (void)recv(info_ptr->sock_id, &tmp_buff[0], MB_PDU_SIZE_MAX, MSG_DONTWAIT);
     queue_flush(info_ptr->rx_queue);
@@ -185,6 +191,107 @@ static int port_get_buf(mb_node_info_t *info_ptr, uint8_t *pdst_buf, uint16_t le
     return ret;
 }
 
+// Drop the rest of data in the socket to synchronize with the beginning of next frame
+static void port_drop_input(mb_node_info_t *info_ptr)
+{
+    uint8_t buf[MB_TCP_BUFF_MAX_SIZE];
+    while (recv(info_ptr->sock_id, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+        ;
+    }
+}
+
+// The master matches the response by TID of the last sent request, the slave echoes the TID
+static inline uint16_t port_get_rtu_frame_tid(mb_node_info_t *info_ptr)
+{
+    return info_ptr->is_master ? (uint16_t)(info_ptr->tid_counter - 1) : (uint16_t)(info_ptr->tid_counter + 1);
+}
+
+// Drop the accumulated part of RTU frame and the rest of data in the socket
+static int port_drop_rtu_frame(mb_node_info_t *info_ptr, int err)
+{
+    port_drop_input(info_ptr);
+    info_ptr->rtu_count = 0;
+    info_ptr->recv_err = err;
+    return err;
+}
+
+// Read raw RTU frame (address, PDU, CRC) and convert it into the MBAP frame for the rx queue.
+// The frame is accumulated in the buffer of the node over the select events, each read takes
+// only the bytes available in the socket and never goes beyond the end of the frame.
+static int port_read_rtu_packet(mb_node_info_t *info_ptr)
+{
+    uint8_t ptemp_buf[MB_TCP_BUFF_MAX_SIZE] = {0};
+    int frame_len = MB_RTU_FRAME_LEN_MORE;
+    int ret = 0;
+
+    if (!info_ptr->rtu_buf) {
+        info_ptr->rtu_buf = calloc(1, MB_RTU_FRAME_SIZE_MAX);
+        MB_RETURN_ON_FALSE(info_ptr->rtu_buf, ERR_MEM, TAG, "RTU frame buffer allocation fail.");
+        info_ptr->rtu_count = 0;
+    }
+    uint8_t *rtu_buf = info_ptr->rtu_buf;
+    // The part of frame which is not completed in time is dropped to synchronize with the next frame
+    if (info_ptr->rtu_count && ((esp_timer_get_time() - info_ptr->rtu_start_time) > (MB_READ_TICK * 1000))) {
+        ESP_LOGD(TAG, MB_NODE_FMT(", incomplete RTU frame of %u bytes is dropped."),
+                    info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, (unsigned)info_ptr->rtu_count);
+        info_ptr->rtu_count = 0;
+    }
+    // The stream does not keep the T3.5 gaps, so the frame boundary is inferred from the function code
+    while (true) {
+        uint16_t count = info_ptr->rtu_count;
+        if (count >= MB_RTU_FRAME_SIZE_MIN) {
+            frame_len = mb_rtu_frame_get_len(rtu_buf, count, !info_ptr->is_master);
+            if ((frame_len == MB_RTU_FRAME_LEN_UNKNOWN) || ((frame_len != MB_RTU_FRAME_LEN_MORE) && (frame_len < count))) {
+                ESP_LOGD(TAG, MB_NODE_FMT(", unsupported RTU frame, func: 0x%02x, drop input."),
+                            info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, rtu_buf[MB_SER_PDU_PDU_OFF]);
+                return port_drop_rtu_frame(info_ptr, ERR_BUF);
+            }
+            if (frame_len == count) {
+                break;
+            }
+        }
+        // The minimal frame, the next header byte or the rest of the frame of known length
+        uint16_t need = (count < MB_RTU_FRAME_SIZE_MIN) ? (MB_RTU_FRAME_SIZE_MIN - count)
+                            : ((frame_len == MB_RTU_FRAME_LEN_MORE) ? 1 : (frame_len - count));
+        ret = recv(info_ptr->sock_id, &rtu_buf[count], need, MSG_DONTWAIT);
+        if (ret == 0) {
+            ESP_LOGD(TAG, MB_NODE_FMT(", connection closed by peer."),
+                        info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str);
+            info_ptr->recv_err = ERR_CONN;
+            return ERR_CONN;
+        }
+        if (ret < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                // The rest of the frame is read on the next select event
+                return ERR_TIMEOUT;
+            }
+            ESP_LOGD(TAG, MB_NODE_FMT(", receive error, errno = %d(%s)."),
+                        info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, (int)errno, strerror(errno));
+            info_ptr->recv_err = ((errno == ENOTCONN) || (errno == ECONNRESET)) ? ERR_CONN : -1;
+            return info_ptr->recv_err;
+        }
+        if (!count) {
+            info_ptr->rtu_start_time = esp_timer_get_time();
+        }
+        info_ptr->rtu_count += ret;
+    }
+    info_ptr->rtu_count = 0;
+    ret = mb_rtu_frame_to_mbap(rtu_buf, frame_len, port_get_rtu_frame_tid(info_ptr), ptemp_buf, sizeof(ptemp_buf));
+    if ((ret < 0) || (ptemp_buf[MB_TCP_UID] > MB_ADDRESS_MAX)) {
+        ESP_LOGD(TAG, MB_NODE_FMT(", RTU frame CRC error, drop input."),
+                    info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str);
+        return port_drop_rtu_frame(info_ptr, ERR_BUF);
+    }
+    ret = port_enqueue_packet(info_ptr->rx_queue, ptemp_buf, ret);
+    if (ret < 0) {
+        info_ptr->recv_err = ret;
+        return ret;
+    }
+    info_ptr->recv_counter++;
+    info_ptr->recv_err = ERR_OK;
+    return ret;
+}
+
 int port_read_packet(mb_node_info_t *info_ptr)
 {
     uint16_t temp = 0;
@@ -194,6 +301,9 @@ int port_read_packet(mb_node_info_t *info_ptr)
     // Receive data from connected client
     if (info_ptr) {
         MB_RETURN_ON_FALSE((info_ptr->sock_id > 0), -1, TAG, "try to read incorrect socket = #%d", info_ptr->sock_id);
+        if (info_ptr->rtu_framing) {
+            return port_read_rtu_packet(info_ptr);
+        }
         // Read packet header
         ret = port_get_buf(info_ptr, ptemp_buf, MB_TCP_UID, MB_READ_TICK);
         if (ret < 0) {
@@ -254,6 +364,73 @@ int port_read_packet(mb_node_info_t *info_ptr)
     return -1;
 }
 
+// Read the whole datagram, a datagram keeps the boundary of the frame
+int port_recv_datagram(int sock_id, uint8_t *buf, uint16_t len, struct sockaddr_storage *src_addr, socklen_t *addr_len)
+{
+    MB_RETURN_ON_FALSE((buf && src_addr && addr_len && (sock_id > 0)), -1, TAG, "Try to read incorrect socket = #%d.", sock_id);
+    int ret = recvfrom(sock_id, buf, len, MSG_DONTWAIT, (struct sockaddr *)src_addr, addr_len);
+    if (ret < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        ESP_LOGD(TAG, "Socket(#%d) receive datagram error, ret = %d, errno = %d(%s)",
+                    sock_id, ret, (int)errno, strerror(errno));
+    }
+    return ret;
+}
+
+// Check the datagram of the node and put it into the rx queue
+int port_put_datagram(mb_node_info_t *info_ptr, uint8_t *buf, uint16_t len)
+{
+    uint8_t ptemp_buf[MB_TCP_BUFF_MAX_SIZE] = {0};
+    int ret = len;
+
+    MB_RETURN_ON_FALSE((info_ptr && buf), -1, TAG, "Incorrect datagram arguments.");
+    if (info_ptr->rtu_framing) {
+        ret = mb_rtu_frame_to_mbap(buf, len, port_get_rtu_frame_tid(info_ptr), ptemp_buf, sizeof(ptemp_buf));
+        buf = ptemp_buf;
+    } else if ((len <= MB_TCP_FUNC) || (MB_TCP_MBAP_GET_FIELD(buf, MB_TCP_PID) != 0)
+                || (MB_TCP_MBAP_GET_FIELD(buf, MB_TCP_LEN) != (len - MB_TCP_UID))) {
+        // The length field of MBAP header must match the datagram length exactly
+        ret = -1;
+    }
+    if ((ret <= MB_TCP_UID) || (buf[MB_TCP_UID] > MB_ADDRESS_MAX)) {
+        info_ptr->recv_err = ERR_BUF;
+        return ERR_BUF;
+    }
+    ret = port_enqueue_packet(info_ptr->rx_queue, buf, ret);
+    if (ret < 0) {
+        info_ptr->recv_err = ret;
+        return ret;
+    }
+    info_ptr->recv_counter++;
+    info_ptr->recv_err = ERR_OK;
+    return ret;
+}
+
+// Compare the peer addresses including the port number
+bool port_is_same_sock_addr(const struct sockaddr_storage *addr1, const struct sockaddr_storage *addr2)
+{
+    if (!addr1 || !addr2 || (addr1->ss_family != addr2->ss_family)) {
+        return false;
+    }
+    if (addr1->ss_family == PF_INET) {
+        const struct sockaddr_in *addr1_in = (const struct sockaddr_in *)addr1;
+        const struct sockaddr_in *addr2_in = (const struct sockaddr_in *)addr2;
+        return ((addr1_in->sin_port == addr2_in->sin_port)
+                    && (addr1_in->sin_addr.s_addr == addr2_in->sin_addr.s_addr));
+    }
+#if MB_TCP_IPV6_ENABLED
+    else if (addr1->ss_family == PF_INET6) {
+        const struct sockaddr_in6 *addr1_in6 = (const struct sockaddr_in6 *)addr1;
+        const struct sockaddr_in6 *addr2_in6 = (const struct sockaddr_in6 *)addr2;
+        return ((addr1_in6->sin6_port == addr2_in6->sin6_port)
+                    && !memcmp(&addr1_in6->sin6_addr, &addr2_in6->sin6_addr, sizeof(addr1_in6->sin6_addr)));
+    }
+#endif
+    return false;
+}
+
 err_t port_set_blocking(mb_node_info_t *info_ptr, bool is_blocking)
 {
     if (!info_ptr) {
@@ -366,7 +543,6 @@ err_t port_connect(void *ctx, mb_node_info_t *info_ptr)
     err_t err = ERR_OK;
     char str[HOST_STR_MAX_LEN];
     char *string_ptr = NULL;
-    ip_addr_t target_addr;
     struct addrinfo hint;
     struct addrinfo *addr_list;
     struct addrinfo *cur_addr;
@@ -377,7 +553,6 @@ err_t port_connect(void *ctx, mb_node_info_t *info_ptr)
     hint.ai_family = (info_ptr->addr_info.addr_type == MB_IPV4) ? AF_INET : AF_INET6;
     hint.ai_socktype = (info_ptr->addr_info.proto == MB_UDP) ? SOCK_DGRAM : SOCK_STREAM;
     hint.ai_protocol = (info_ptr->addr_info.proto == MB_UDP) ? IPPROTO_UDP : IPPROTO_TCP;
-    memset(&target_addr, 0, sizeof(target_addr));
 
     if (asprintf(&string_ptr, "%u", info_ptr->addr_info.port) == -1) {
         abort();
@@ -393,20 +568,36 @@ err_t port_connect(void *ctx, mb_node_info_t *info_ptr)
 
     for (cur_addr = addr_list; cur_addr != NULL; cur_addr = cur_addr->ai_next) {
         if (cur_addr->ai_family == AF_INET) {
-            struct in_addr addr4 = ((struct sockaddr_in *)(cur_addr->ai_addr))->sin_addr;
-            inet_addr_to_ip4addr(ip_2_ip4(&target_addr), &addr4);
-            string_ptr = ip4addr_ntoa_r(ip_2_ip4(&target_addr), str, sizeof(str));
+            string_ptr = inet_ntoa_r(((struct sockaddr_in *)(cur_addr->ai_addr))->sin_addr, str, sizeof(str));
         }
-#if CONFIG_LWIP_IPV6
+#if MB_TCP_IPV6_ENABLED
         else if (cur_addr->ai_family == AF_INET6) {
-            struct in6_addr addr6 = ((struct sockaddr_in6 *)(cur_addr->ai_addr))->sin6_addr;
-            inet6_addr_to_ip6addr(ip_2_ip6(&target_addr), &addr6);
-            string_ptr = ip6addr_ntoa_r(ip_2_ip6(&target_addr), str, sizeof(str));
-            // Set scope id to fix routing issues with local address
+            string_ptr = inet6_ntoa_r(((struct sockaddr_in6 *)(cur_addr->ai_addr))->sin6_addr, str, sizeof(str));
+#if !CONFIG_IDF_TARGET_LINUX
+            // Set scope id to fix routing issues with local address (the host resolver sets it already)
             ((struct sockaddr_in6 *)(cur_addr->ai_addr))->sin6_scope_id =
                 esp_netif_get_netif_impl_index(drv_obj->network_iface_ptr);
+#endif
         }
 #endif
+        if (info_ptr->addr_info.proto == MB_UDP) {
+            // The datagram socket is shared by all nodes, the node keeps just the peer address
+            if (drv_obj->listen_sock_fd <= 0) {
+                drv_obj->listen_sock_fd = socket(cur_addr->ai_family, cur_addr->ai_socktype, cur_addr->ai_protocol);
+                if (drv_obj->listen_sock_fd < 0) {
+                    ESP_LOGE(TAG, "Unable to create socket: #%d, errno %d", drv_obj->listen_sock_fd, (int)errno);
+                    err = ERR_IF;
+                    continue;
+                }
+            }
+            memcpy(&info_ptr->peer_addr, cur_addr->ai_addr, cur_addr->ai_addrlen);
+            info_ptr->peer_addr_len = cur_addr->ai_addrlen;
+            info_ptr->sock_id = drv_obj->listen_sock_fd;
+            ESP_LOGI(TAG, "%p, "MB_NODE_FMT(", datagram peer is set."),
+                        ctx, info_ptr->index, info_ptr->sock_id, str);
+            err = ERR_OK;
+            break;
+        }
         if (info_ptr->sock_id <= 0) {
             info_ptr->sock_id = socket(cur_addr->ai_family, cur_addr->ai_socktype, cur_addr->ai_protocol);
             if (info_ptr->sock_id < 0) {
@@ -431,7 +622,8 @@ err_t port_connect(void *ctx, mb_node_info_t *info_ptr)
 
             // Set keep alive flag in socket options
             (void)port_keep_alive_enable(info_ptr->sock_id, CONFIG_FMB_TCP_KEEP_ALIVE_TOUT_SEC);
-            err = port_check_alive(info_ptr, MB_TCP_CHECK_ALIVE_TOUT_MS);
+            // Do not wait here, the pending connections are polled together by the driver
+            err = port_check_alive(info_ptr, 0);
             continue;
         }
         if ((err < 0) && (errno == EISCONN)) {
@@ -465,7 +657,22 @@ int port_write_poll(mb_node_info_t *info_ptr, const uint8_t *frame, uint16_t fra
                     info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, res, (int)errno);
         return res;
     }
-    res = send(info_ptr->sock_id, frame, frame_len, TCP_NODELAY);
+    uint8_t rtu_buf[MB_RTU_FRAME_SIZE_MAX];
+    if (info_ptr->rtu_framing) {
+        // The UID of MBAP header is the address field of RTU frame
+        res = mb_rtu_frame_from_mbap(frame, frame_len, rtu_buf, sizeof(rtu_buf));
+        MB_RETURN_ON_FALSE((res > 0), ERR_VAL, TAG, MB_NODE_FMT(", incorrect frame length: %u."),
+                            info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, (unsigned)frame_len);
+        frame = rtu_buf;
+        frame_len = (uint16_t)res;
+    }
+    if (info_ptr->addr_info.proto == MB_UDP) {
+        // The socket is shared by all nodes, send the datagram to the peer of the node
+        res = sendto(info_ptr->sock_id, frame, frame_len, 0,
+                        (struct sockaddr *)&info_ptr->peer_addr, info_ptr->peer_addr_len);
+    } else {
+        res = send(info_ptr->sock_id, frame, frame_len, MB_TCP_SEND_FLAGS);
+    }
     if (res < 0) {
         ESP_LOGE(TAG, MB_NODE_FMT(", send data error: %d, errno %d"),
                     info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, res, (int)errno);
@@ -485,7 +692,7 @@ int port_scan_addr_string(char *buffer, mb_uid_info_t *info_ptr)
     MB_RETURN_ON_FALSE((buffer && (strlen(buffer) < (HOST_STR_MAX_LEN - 8)) && info_ptr), 
                             -1, TAG, "check input parameters fail.");
 
-#if CONFIG_LWIP_IPV6
+#if MB_TCP_IPV6_ENABLED
     // Configuration format: 
     // "12;2001:0db8:85a3:0000:0000:8a2e:0370:7334;502"
     // "12;2001:0db8:85a3:0000:0000:8a2e:0370:7334"
@@ -763,14 +970,104 @@ void port_stop_mdns_service(char **dns_name)
 //     return ESP_ERR_NOT_FOUND;
 // }
 
-int port_resolve_mdns_host(const char *host_name, char **addr_str)
+#if MB_MDNS_RESOLVE_CACHE_TTL_SEC
+
+// The cache of resolved node addresses shared between master instances
+typedef struct {
+    char host_name[HOST_STR_MAX_LEN];
+    char *addr_str;
+    int64_t expire_time;
+} port_resolve_entry_t;
+
+static port_resolve_entry_t resolve_cache[MB_TCP_PORT_MAX_CONN] = {0};
+static _lock_t resolve_cache_lock;
+
+static port_resolve_entry_t *port_resolve_cache_find(const char *host_name)
 {
-    ESP_LOGD(TAG, "Query A: %s.local", host_name);
+    for (int i = 0; i < MB_TCP_PORT_MAX_CONN; i++) {
+        if (resolve_cache[i].addr_str && !strncmp(resolve_cache[i].host_name, host_name, HOST_STR_MAX_LEN)) {
+            return &resolve_cache[i];
+        }
+    }
+    return NULL;
+}
+
+// Returns the copy of the cached address or NULL if it is not cached or expired
+static char *port_resolve_cache_get(const char *host_name)
+{
+    char *addr_str = NULL;
+    _lock_acquire(&resolve_cache_lock);
+    port_resolve_entry_t *entry = port_resolve_cache_find(host_name);
+    if (entry && (entry->expire_time > port_get_timestamp())) {
+        addr_str = strdup(entry->addr_str);
+    }
+    _lock_release(&resolve_cache_lock);
+    return addr_str;
+}
+
+static void port_resolve_cache_put(const char *host_name, const char *addr_str)
+{
+    _lock_acquire(&resolve_cache_lock);
+    port_resolve_entry_t *entry = port_resolve_cache_find(host_name);
+    // Otherwise replace the free entry or the entry which expires first
+    for (int i = 0; !entry && (i < MB_TCP_PORT_MAX_CONN); i++) {
+        if (!resolve_cache[i].addr_str) {
+            entry = &resolve_cache[i];
+        }
+    }
+    if (!entry) {
+        entry = &resolve_cache[0];
+        for (int i = 1; i < MB_TCP_PORT_MAX_CONN; i++) {
+            if (resolve_cache[i].expire_time < entry->expire_time) {
+                entry = &resolve_cache[i];
+            }
+        }
+    }
+    free(entry->addr_str);
+    entry->addr_str = strdup(addr_str);
+    strlcpy(entry->host_name, host_name, HOST_STR_MAX_LEN);
+    entry->expire_time = port_get_timestamp() + ((int64_t)MB_MDNS_RESOLVE_CACHE_TTL_SEC * 1000000);
+    _lock_release(&resolve_cache_lock);
+}
+
+#endif
+
+void port_resolve_cache_invalidate(const char *host_name)
+{
+#if MB_MDNS_RESOLVE_CACHE_TTL_SEC
+    if (!host_name) {
+        return;
+    }
+    _lock_acquire(&resolve_cache_lock);
+    port_resolve_entry_t *entry = port_resolve_cache_find(host_name);
+    if (entry) {
+        ESP_LOGD(TAG, "Node: %s, drop cached IP: %s", host_name, entry->addr_str);
+        free(entry->addr_str);
+        entry->addr_str = NULL;
+    }
+    _lock_release(&resolve_cache_lock);
+#endif
+}
 
+int port_resolve_mdns_host(const char *host_name, char **addr_str)
+{
     esp_ip_addr_t addr;
     char *string_ptr = NULL;
     bzero(&addr, sizeof(esp_ip_addr_t));
 
+#if MB_MDNS_RESOLVE_CACHE_TTL_SEC
+    string_ptr = port_resolve_cache_get(host_name);
+    if (string_ptr) {
+        ESP_LOGD(TAG, "Node: %s, use cached IP: %s", host_name, string_ptr);
+        if (addr_str) {
+            *addr_str = string_ptr;
+        }
+        return strlen(string_ptr);
+    }
+#endif
+
+    ESP_LOGD(TAG, "Query A: %s.local", host_name);
+
     // Try to send query to obtain the IPv4 address
     esp_err_t err = mdns_query_a(host_name, MB_MDNS_QUERY_TIME_MS, &addr.u_addr.ip4);
     if (err) {
@@ -794,6 +1091,9 @@ int port_resolve_mdns_host(const char *host_name, char **addr_str)
             abort();
         }
     }
+#if MB_MDNS_RESOLVE_CACHE_TTL_SEC
+    port_resolve_cache_put(host_name, string_ptr);
+#endif
     if (addr_str) {
         ESP_LOGD(TAG, "Node: %s, was resolved with IP: %s", host_name, string_ptr);
         *addr_str = string_ptr;
@@ -886,6 +1186,37 @@ int port_bind_addr(const char *pbind_ip, mb_addr_type_t addr_type, mb_comm_mode_
     return(listen_sock_fd);
 }
 
+// Get the peer ip address as string, the port and address type from the socket address
+int port_get_sock_addr_info(const struct sockaddr_storage *src_addr, mb_uid_info_t *info_ptr)
+{
+    MB_RETURN_ON_FALSE((src_addr && info_ptr), -1, TAG, "Wrong parameter pointer.");
+    char addr_str[128];
+    char *paddr = NULL;
+
+    if (src_addr->ss_family == PF_INET) {
+        inet_ntoa_r(((struct sockaddr_in *)src_addr)->sin_addr.s_addr, addr_str, sizeof(addr_str) - 1);
+        info_ptr->port =  ntohs(((struct sockaddr_in *)src_addr)->sin_port);
+        info_ptr->addr_type = MB_IPV4;
+    }
+#if MB_TCP_IPV6_ENABLED
+    else if (src_addr->ss_family == PF_INET6) {
+        inet6_ntoa_r(((struct sockaddr_in6 *)src_addr)->sin6_addr, addr_str, sizeof(addr_str) - 1);
+        info_ptr->port =  ntohs(((struct sockaddr_in6 *)src_addr)->sin6_port);
+        info_ptr->addr_type = MB_IPV6;
+    }
+#endif
+    else {
+        return -1;
+    }
+    paddr = strdup(addr_str);
+    if (paddr) {
+        info_ptr->ip_addr_str = paddr;
+        info_ptr->node_name_str = paddr;
+        info_ptr->uid = 0;
+    }
+    return 0;
+}
+
 int port_accept_connection(int listen_sock_id, mb_uid_info_t *info_ptr)
 {
     MB_RETURN_ON_FALSE((info_ptr), -1, TAG, "Wrong parameter pointer.");
@@ -893,9 +1224,7 @@ int port_accept_connection(int listen_sock_id, mb_uid_info_t *info_ptr)
 
     // Address structure large enough for both IPv4 or IPv6 address
     struct sockaddr_storage src_addr;
-    char addr_str[128];
     int sock_id = UNDEF_FD;
-    char *paddr = NULL;
     socklen_t addr_size = sizeof(struct sockaddr_storage);
     bzero(&src_addr, sizeof(struct sockaddr_storage));
 
@@ -905,31 +1234,17 @@ int port_accept_connection(int listen_sock_id, mb_uid_info_t *info_ptr)
         ESP_LOGE(TAG, "Unable to accept connection: errno=%u", (unsigned)errno);
         close(sock_id);
     } else {
+        info_ptr->ip_addr_str = NULL;
         // Get the sender's ip address as string
-        if (src_addr.ss_family == PF_INET) {
-            inet_ntoa_r(((struct sockaddr_in *)&src_addr)->sin_addr.s_addr, addr_str, sizeof(addr_str) - 1);
-            info_ptr->port =  ntohs(((struct sockaddr_in *)&src_addr)->sin_port);
-            info_ptr->addr_type = MB_IPV4;
-        }
-#if CONFIG_LWIP_IPV6
-        else if (src_addr.ss_family == PF_INET6) {
-            inet6_ntoa_r(((struct sockaddr_in6 *)&src_addr)->sin6_addr, addr_str, sizeof(addr_str) - 1);
-            info_ptr->port =  ntohs(((struct sockaddr_in6 *)&src_addr)->sin6_port);
-            info_ptr->addr_type = MB_IPV6;
-        }
-#endif
-        else {
+        if (port_get_sock_addr_info(&src_addr, info_ptr) < 0) {
             // Make sure ss_family is valid
             abort();
         }
-        ESP_LOGI(TAG, "Socket (#%d), accept client connection from address[port]: %s[%u]", (int)sock_id, addr_str, info_ptr->port);
-        paddr = strdup(addr_str);
-        if (paddr) {
+        ESP_LOGI(TAG, "Socket (#%d), accept client connection from address[port]: %s[%u]",
+                    (int)sock_id, info_ptr->ip_addr_str ? info_ptr->ip_addr_str : "", info_ptr->port);
+        if (info_ptr->ip_addr_str) {
             info_ptr->fd = sock_id;
-            info_ptr->ip_addr_str = paddr;
-            info_ptr->node_name_str = paddr;
             info_ptr->proto = MB_TCP;
-            info_ptr->uid = 0;
         }
     }
     return sock_id;
@@ -11,12 +11,21 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stdatomic.h>
+#include "sdkconfig.h"
 
+#if CONFIG_IDF_TARGET_LINUX
+#include "port_tcp_posix.h"
+#else
 #include "lwip/err.h"
 #include "lwip/sockets.h"
 #include "lwip/netdb.h"
 #include "net/if.h"     // for SOMAXCONN
 
+#define MB_TCP_IPV6_ENABLED         (CONFIG_LWIP_IPV6)
+#define MB_TCP_SO_LINGER_ENABLED    (LWIP_SO_LINGER)
+#define MB_TCP_SEND_FLAGS           (0)
+#endif
+
 #include "port_tcp_common.h"
 
 #if __has_include("esp_timer.h")
@@ -63,6 +72,11 @@ extern "C" {
 #define MB_MDNS_PORT (CONFIG_FMB_TCP_PORT_DEFAULT)
 #define MB_READ_TICK (500)
 #define MB_MDNS_QUERY_TIME_MS (2000)
+#ifdef CONFIG_FMB_MDNS_RESOLVE_CACHE_TTL_SEC
+#define MB_MDNS_RESOLVE_CACHE_TTL_SEC (CONFIG_FMB_MDNS_RESOLVE_CACHE_TTL_SEC)
+#else
+#define MB_MDNS_RESOLVE_CACHE_TTL_SEC (0)
+#endif
 
 #define MB_STR_LEN_HOST 1  // "mb_node_tcp_01"
 #define MB_STR_LEN_IDX_HOST 2  // "12;mb_node_tcp_01"
@@ -87,13 +101,16 @@ typedef struct frame_queue_entry_s frame_entry_t;
 typedef struct mb_node_info_s mb_node_info_t;
 typedef enum addr_type_enum mb_tcp_addr_type_t;
 
-bool port_check_host_addr(const char *host_str, ip_addr_t* host_addr);
+bool port_check_host_addr(const char *host_str, struct sockaddr_storage *host_addr);
 mb_node_info_t* port_get_current_info(void *ctx);
 void port_check_shutdown(void *ctx);
 int64_t port_get_resp_time_left(mb_node_info_t* info_ptr);
 int port_enqueue_packet(QueueHandle_t queue, uint8_t *buf, uint16_t len);
 int port_dequeue_packet(QueueHandle_t queue, frame_entry_t* frame_info);
 int port_read_packet(mb_node_info_t* info_ptr);
+int port_recv_datagram(int sock_id, uint8_t *buf, uint16_t len, struct sockaddr_storage *src_addr, socklen_t *addr_len);
+int port_put_datagram(mb_node_info_t* info_ptr, uint8_t *buf, uint16_t len);
+bool port_is_same_sock_addr(const struct sockaddr_storage *addr1, const struct sockaddr_storage *addr2);
 err_t port_set_blocking(mb_node_info_t* info_ptr, bool is_blocking);
 int port_keep_alive_enable(int sock, int timeout_sec);
 err_t port_check_alive(mb_node_info_t* info_ptr, uint32_t timeout_ms);
@@ -118,6 +135,7 @@ typedef struct mdns_result_s mdns_result_t;
 char *port_get_node_ip_str(mdns_ip_addr_t *address, mb_addr_type_t addr_type);
 esp_err_t port_resolve_slave(uint8_t short_addr, mdns_result_t *result, char **resolved_ip, mb_addr_type_t addr_type);
 int port_resolve_mdns_host(const char *host_name, char **addr_str);
+void port_resolve_cache_invalidate(const char *host_name);
 
 #endif
 
@@ -125,6 +143,7 @@ int port_resolve_mdns_host(const char *host_name, char **addr_str);
 
 int port_bind_addr(const char *pbind_ip, mb_addr_type_t addr_type, mb_comm_mode_t proto, uint16_t port);
 int port_accept_connection(int listen_sock_id, mb_uid_info_t *info_ptr);
+int port_get_sock_addr_info(const struct sockaddr_storage *src_addr, mb_uid_info_t *info_ptr);
 
 #ifdef __cplusplus
 }
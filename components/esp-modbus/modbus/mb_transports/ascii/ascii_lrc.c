@@ -5,66 +5,82 @@
  */
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include "ascii_lrc.h"
 
+/* ----------------------- Static variables ---------------------------------*/
+// The nibble value with the valid flag (0x10) for each hex character, zero for other characters
+#define MB_ASCII_HEX_VALID  (0x10)
+
+// The number of words added to the 16-bit lanes of the LRC sum before they are folded
+#define MB_LRC_FOLD_WORDS   (128)
+
+static const uint8_t ascii_hex_val_tab[256] = {
+    ['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14,
+    ['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17, ['8'] = 0x18, ['9'] = 0x19,
+    ['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F
+};
+
+static const uint8_t ascii_hex_char_tab[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
 /* ----------------------- functions ---------------------------------*/
 uint8_t mb_char2bin(uint8_t char_val)
 {
-    uint8_t symb = 0xFF;
-    if ((char_val >= '0') && (char_val <= '9')) {
-        symb = (uint8_t)(char_val - '0');
-    } else if ((char_val >= 'A') && (char_val <= 'F')) {
-        symb = (uint8_t)(char_val - 'A' + 0x0A);
-    }
-    return symb;
+    uint8_t symb = ascii_hex_val_tab[char_val];
+    return (symb & MB_ASCII_HEX_VALID) ? (uint8_t)(symb & 0x0F) : 0xFF;
 }
 
 uint8_t mb_bin2char(uint8_t byte_val)
 {
-    uint8_t symb = '0';
-    if (byte_val <= 0x09) {
-        symb = (uint8_t)('0' + byte_val);
-    } else if ((byte_val >= 0x0A) && (byte_val <= 0x0F)) {
-        symb = (uint8_t)(byte_val - 0x0A + 'A');
-    } else {
-        /* Programming error. */
-        assert(0);
-    }
-    return symb;
+    /* Programming error. */
+    assert(byte_val <= 0x0F);
+    return ascii_hex_char_tab[byte_val & 0x0F];
 }
 
-uint8_t __attribute__ ((unused)) mb_lrc(uint8_t *frame, uint16_t length)
+uint8_t mb_lrc(const uint8_t *frame, uint16_t length)
 {
-    uint8_t lrc = 0; /* LRC char initialized */
+    uint32_t sum = 0;
 
+    // Add four bytes at once, the even and odd bytes are kept in separate 16-bit lanes,
+    // each word adds up to 2 * 255 to a lane, so the lanes are folded before they can
+    // overflow (MB_LRC_FOLD_WORDS * 2 * 255 < 0x10000)
+    while (length >= sizeof(uint32_t)) {
+        uint32_t lanes = 0;
+        for (int cnt = 0; (cnt < MB_LRC_FOLD_WORDS) && (length >= sizeof(uint32_t)); cnt++) {
+            uint32_t word;
+            memcpy(&word, frame, sizeof(word));
+            lanes += (word & 0x00FF00FF) + ((word >> 8) & 0x00FF00FF);
+            frame += sizeof(uint32_t);
+            length -= sizeof(uint32_t);
+        }
+        sum += (lanes & 0xFFFF) + (lanes >> 16);
+    }
     while (length--) {
-        lrc += *frame++; /* Add buffer byte without carry */
+        sum += *frame++; /* Add buffer byte without carry */
     }
 
     /* Return twos complement */
-    lrc = (uint8_t)(-((char)lrc));
-    return lrc;
+    return (uint8_t)(-sum);
 }
 
 // The helper function to fill ASCII frame buffer
 int mb_ascii_set_buf(const uint8_t *data_ptr, uint8_t *buf, int bin_length)
 {
-    int bin_idx = 0;
-    int frm_idx = 0;
-    uint8_t lrc = 0;
+    int frm_idx = 1;
 
     assert(data_ptr && buf);
 
+    uint8_t lrc = mb_lrc(data_ptr, (uint16_t)bin_length);
     buf[0] = MB_ASCII_START;
-    for (frm_idx = 1; (bin_idx < bin_length); bin_idx++) {
-        buf[frm_idx++] = mb_bin2char((uint8_t)(data_ptr[bin_idx] >> 4));   // High nibble
-        buf[frm_idx++] = mb_bin2char((uint8_t)(data_ptr[bin_idx] & 0X0F)); // Low nibble
-        lrc += data_ptr[bin_idx];
+    for (int bin_idx = 0; bin_idx < bin_length; bin_idx++) {
+        buf[frm_idx++] = ascii_hex_char_tab[data_ptr[bin_idx] >> 4];    // High nibble
+        buf[frm_idx++] = ascii_hex_char_tab[data_ptr[bin_idx] & 0x0F];  // Low nibble
     }
-    lrc = (uint8_t)(-((char)lrc));
-    buf[frm_idx++] = mb_bin2char((uint8_t)(lrc >> 4));
-    buf[frm_idx++] = mb_bin2char((uint8_t)(lrc & 0X0F));
+    buf[frm_idx++] = ascii_hex_char_tab[lrc >> 4];
+    buf[frm_idx++] = ascii_hex_char_tab[lrc & 0x0F];
     buf[frm_idx++] = MB_ASCII_CR;
     buf[frm_idx++] = MB_ASCII_LF;
 
@@ -73,21 +89,22 @@ int mb_ascii_set_buf(const uint8_t *data_ptr, uint8_t *buf, int bin_length)
 
 int mb_ascii_get_binary_buf(uint8_t *data_ptr, int length)
 {
-    int bin_idx = 0;
-    uint8_t lrc = 0;
-
     assert(data_ptr);
 
-    if ((data_ptr[0] == ':') && (data_ptr[length - 1] == '\n') && (data_ptr[length - 2] == '\r')) {
-        for (int str_idx = 1; (str_idx < length) && (data_ptr[str_idx] > ' '); str_idx += 2) {
-            data_ptr[bin_idx] = (mb_char2bin(data_ptr[str_idx]) << 4); // High nibble
-            data_ptr[bin_idx] |= mb_char2bin(data_ptr[str_idx + 1]);   // Low nibble
-            lrc += data_ptr[bin_idx++];
-        }
+    // The whole frame between the delimiters is decoded: ':', pairs of hex characters, CR, LF
+    if ((length < 3) || !(length & 1) || (data_ptr[0] != MB_ASCII_START)
+            || (data_ptr[length - 1] != MB_ASCII_LF) || (data_ptr[length - 2] != MB_ASCII_CR)) {
+        return -1;
+    }
+    int bin_length = (length - 3) >> 1;
+    const uint8_t *str_ptr = &data_ptr[1];
+    uint8_t valid = MB_ASCII_HEX_VALID;
+    for (int bin_idx = 0; bin_idx < bin_length; bin_idx++, str_ptr += 2) {
+        uint8_t hi = ascii_hex_val_tab[str_ptr[0]];
+        uint8_t lo = ascii_hex_val_tab[str_ptr[1]];
+        valid &= (hi & lo);
+        data_ptr[bin_idx] = (uint8_t)((hi << 4) | (lo & 0x0F));
     }
-    
-    lrc = (uint8_t)(-((char)lrc));
-    bin_idx = ((lrc == 0) && (bin_idx == ((length - 3) >> 1))) ? bin_idx : -1;
-    return bin_idx;
-}
 
+    return (valid && (mb_lrc(data_ptr, (uint16_t)bin_length) == 0)) ? bin_length : -1;
+}
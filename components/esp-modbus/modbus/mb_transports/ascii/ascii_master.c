@@ -68,6 +68,9 @@ mb_err_enum_t mbm_ascii_transp_create(mb_serial_opts_t *ser_opts, void **in_out_
     if (ser_opts->response_tout_ms) {
         mb_port_timer_set_response_time(port_obj, ser_opts->response_tout_ms);
     }
+    // Measure the round trip time of slaves to adjust the respond timeout
+    ret = mb_port_timer_rtt_create(port_obj);
+    MB_GOTO_ON_FALSE((ret == MB_ENOERR), MB_EPORTERR, error, TAG, "timer rtt creation, err: %d", ret);
     ret = mb_port_event_create(port_obj);
     MB_GOTO_ON_FALSE((ret == MB_ENOERR), MB_EPORTERR, error, TAG, "event port creation, err: %d", ret);
     transp->base.port_obj = port_obj;
@@ -207,7 +210,7 @@ static mb_err_enum_t mbm_ascii_transp_send(mb_trans_base_t *inst, uint8_t slv_ad
             if (transp->frame_is_broadcast) {
                 mb_port_timer_convert_delay_enable(transp->base.port_obj);
             } else {
-                mb_port_timer_respond_timeout_enable(transp->base.port_obj);
+                mb_port_timer_slave_respond_timeout_enable(transp->base.port_obj, slv_addr);
             }
         } else {
             status = MB_EIO;
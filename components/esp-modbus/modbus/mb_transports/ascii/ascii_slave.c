@@ -163,6 +163,7 @@ static mb_err_enum_t mbs_ascii_transp_receive(mb_trans_base_t *inst, uint8_t *re
         /* Return the start of the Modbus PDU to the caller. */
         *frame_buf = &buf[MB_SER_PDU_PDU_OFF];
     } else {
+        MB_DIAG_INC(inst->port_obj, MB_DIAG_BUS_COMM_ERR_CNT);
         status = MB_EIO;
     }
     return status;
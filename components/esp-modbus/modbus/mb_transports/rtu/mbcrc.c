@@ -36,6 +36,7 @@
  */
 /* ----------------------- Platform includes --------------------------------*/
 #include "mb_common.h"
+#include "mbcrc.h"
 
 static const uint8_t crc_hi_tab[] = {
     0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
@@ -87,13 +88,64 @@ static const uint8_t crc_lo_tab[] = {
     0x41, 0x81, 0x80, 0x40
 };
 
+#if (MB_CRC16_SLICE_NUM > 1)
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// The slice tables: crc_slice_tab[k][i] is the CRC of byte i followed by k zero bytes
+static uint16_t crc_slice_tab[MB_CRC16_SLICE_NUM][256];
+static atomic_bool crc_slice_tab_ready = false;
+
+static void mb_crc16_slice_tab_init(void)
+{
+    // The tables are deterministic, so concurrent initialization writes the same values
+    for (int idx = 0; idx < 256; idx++) {
+        crc_slice_tab[0][idx] = (uint16_t)(crc_lo_tab[idx] << 8 | crc_hi_tab[idx]);
+    }
+    for (int idx = 0; idx < 256; idx++) {
+        uint16_t crc = crc_slice_tab[0][idx];
+        for (int slice = 1; slice < MB_CRC16_SLICE_NUM; slice++) {
+            crc = (crc >> 8) ^ crc_slice_tab[0][crc & 0xFF];
+            crc_slice_tab[slice][idx] = crc;
+        }
+    }
+    atomic_store_explicit(&crc_slice_tab_ready, true, memory_order_release);
+}
+
+#endif
+
 uint16_t
-mb_crc16(uint8_t *frame_ptr, uint16_t len_buf)
+mb_crc16_update(uint16_t crc, const uint8_t *frame_ptr, uint16_t len_buf)
 {
-    uint8_t crc_hi = 0xFF;
-    uint8_t crc_lo = 0xFF;
+    uint8_t crc_hi;
+    uint8_t crc_lo;
     int idx;
 
+#if (MB_CRC16_SLICE_NUM > 1)
+    if (!atomic_load_explicit(&crc_slice_tab_ready, memory_order_acquire)) {
+        mb_crc16_slice_tab_init();
+    }
+    // Only the first two bytes of each slice are mixed with the current CRC value
+    while (len_buf >= MB_CRC16_SLICE_NUM) {
+        crc ^= (uint16_t)(frame_ptr[0] | frame_ptr[1] << 8);
+#if (MB_CRC16_SLICE_NUM == 8)
+        crc = crc_slice_tab[7][crc & 0xFF] ^ crc_slice_tab[6][crc >> 8]
+                ^ crc_slice_tab[5][frame_ptr[2]] ^ crc_slice_tab[4][frame_ptr[3]]
+                ^ crc_slice_tab[3][frame_ptr[4]] ^ crc_slice_tab[2][frame_ptr[5]]
+                ^ crc_slice_tab[1][frame_ptr[6]] ^ crc_slice_tab[0][frame_ptr[7]];
+#else
+        crc = crc_slice_tab[3][crc & 0xFF] ^ crc_slice_tab[2][crc >> 8]
+                ^ crc_slice_tab[1][frame_ptr[2]] ^ crc_slice_tab[0][frame_ptr[3]];
+#endif
+        frame_ptr += MB_CRC16_SLICE_NUM;
+        len_buf -= MB_CRC16_SLICE_NUM;
+    }
+#endif
+    crc_hi = (uint8_t)(crc >> 8);
+    crc_lo = (uint8_t)crc;
+
+    // The tail of the frame (or the whole frame for the byte-wise method)
     while (len_buf--) {
         idx    = crc_lo ^ *(frame_ptr++);
         crc_lo = (uint8_t)(crc_hi ^ crc_hi_tab[idx]);
@@ -101,3 +153,9 @@ mb_crc16(uint8_t *frame_ptr, uint16_t len_buf)
     }
     return (uint16_t)(crc_hi << 8 | crc_lo);
 }
+
+uint16_t
+mb_crc16(uint8_t *frame_ptr, uint16_t len_buf)
+{
+    return mb_crc16_update(MB_CRC16_INIT, frame_ptr, len_buf);
+}
@@ -37,5 +37,14 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#define MB_CRC16_INIT   (0xFFFF)
+
 uint16_t mb_crc16(uint8_t *frame_ptr, uint16_t len_buf);
 
+/* Continue the CRC16 calculation of the frame received in chunks starting from MB_CRC16_INIT.
+ * The result for the whole frame is the same as the result of mb_crc16().
+ */
+uint16_t mb_crc16_update(uint16_t crc, const uint8_t *frame_ptr, uint16_t len_buf);
+
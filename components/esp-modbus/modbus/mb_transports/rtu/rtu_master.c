@@ -9,6 +9,8 @@
 
 #include "mb_config.h"
 
+#include "esp_timer.h"
+
 #if (CONFIG_FMB_COMM_MODE_RTU_EN)
 
 static const char *TAG = "mb_transp.rtu_master";
@@ -24,6 +26,9 @@ typedef struct
     uint16_t snd_buf_cnt;
     uint16_t rcv_buf_pos;
     bool frame_is_broadcast;
+#if MB_MASTER_BCAST_BATCH_ENABLED
+    uint64_t bcast_hold_until_us;
+#endif
     volatile mb_timer_mode_enum_t cur_timer_mode;
     mb_rtu_state_enum_t state;
 } mbm_rtu_transp_t;
@@ -73,6 +78,9 @@ mb_err_enum_t mbm_rtu_transp_create(mb_serial_opts_t *ser_opts, void **in_out_in
     if (ser_opts->response_tout_ms) {
         mb_port_timer_set_response_time(port_obj, ser_opts->response_tout_ms);
     }
+    // Measure the round trip time of slaves to adjust the respond timeout
+    ret = mb_port_timer_rtt_create(port_obj);
+    MB_GOTO_ON_FALSE((ret == MB_ENOERR), MB_EILLSTATE, error, TAG, "timer rtt creation, err: %d", ret);
     ret = mb_port_event_create(port_obj);
     MB_GOTO_ON_FALSE((ret == MB_ENOERR), MB_EILLSTATE, error, TAG, "event port creation, err: %d", ret);
     transp->base.port_obj = port_obj;
@@ -159,14 +167,25 @@ static mb_err_enum_t mbm_rtu_transp_receive(mb_trans_base_t *inst, uint8_t *rcv_
     assert(length < MB_RTU_SER_PDU_SIZE_MAX);
     assert(buf);
 
+    /* Use the CRC accumulated by the port while the frame was received, if available. */
+    uint16_t crc16 = 0;
+    if (!mb_port_ser_get_recv_crc(inst->port_obj, &crc16)) {
+        crc16 = mb_crc16(buf, length);
+    }
+
     /* Check length and CRC checksum */
     if ((length >= MB_RTU_SER_PDU_SIZE_MIN)
-        && (mb_crc16(buf, length) == 0)) {
+        && (crc16 == 0)) {
         /* Save the address field. All frames are passed to the upper layed
          * and the decision if a frame is used is done there.
          */
         *rcv_addr_buf = buf[MB_SER_PDU_ADDR_OFF];
 
+        /* Take the round trip time sample at the end of the frame on the bus,
+         * so the processing delay of the stack is not included.
+         */
+        mb_port_timer_rtt_stop_at(inst->port_obj, *rcv_addr_buf, mb_port_ser_get_recv_time_us(inst->port_obj));
+
         /* Total length of Modbus-PDU is Modbus-Serial-Line-PDU minus
          * size of address field and CRC checksum.
          */
@@ -181,6 +200,20 @@ static mb_err_enum_t mbm_rtu_transp_receive(mb_trans_base_t *inst, uint8_t *rcv_
     return status;
 }
 
+// Get the time to wait before the request, the bus keeps T3.5 after the last frame
+// and the unicast request waits for the end of conversion delay of the broadcasts.
+static uint64_t mbm_rtu_transp_get_send_delay_us(mbm_rtu_transp_t *transp, uint8_t slv_addr)
+{
+    int64_t delay_us = mb_port_ser_get_send_delay_us(transp->base.port_obj);
+#if MB_MASTER_BCAST_BATCH_ENABLED
+    if (slv_addr != MB_ADDRESS_BROADCAST) {
+        int64_t hold_us = (int64_t)transp->bcast_hold_until_us - esp_timer_get_time();
+        delay_us = (hold_us > delay_us) ? hold_us : delay_us;
+    }
+#endif
+    return (delay_us > 0) ? (uint64_t)delay_us : 0;
+}
+
 static mb_err_enum_t mbm_rtu_transp_send(mb_trans_base_t *inst, uint8_t slv_addr, const uint8_t *frame_ptr, uint16_t frame_len)
 {
     mbm_rtu_transp_t *transp = __containerof(inst, mbm_rtu_transp_t, base);
@@ -192,6 +225,12 @@ static mb_err_enum_t mbm_rtu_transp_send(mb_trans_base_t *inst, uint8_t slv_addr
     }
 
     if (frame_ptr && frame_len) {
+        // The FSM task is not blocked, the request is sent again on EV_FRAME_TRANSMIT
+        uint64_t delay_us = mbm_rtu_transp_get_send_delay_us(transp, slv_addr);
+        if (delay_us) {
+            mb_port_timer_send_delay_enable(transp->base.port_obj, delay_us);
+            return MB_EBUSY;
+        }
         /* First byte before the Modbus-PDU is the slave address. */
         transp->snd_buf_cur = (uint8_t *)frame_ptr - 1;
         transp->snd_buf_cnt = 1;
@@ -212,9 +251,14 @@ static mb_err_enum_t mbm_rtu_transp_send(mb_trans_base_t *inst, uint8_t slv_addr
         // If the frame is broadcast, master will enable timer of convert delay,
         // else master will enable timer of respond timeout. */
         if (transp->frame_is_broadcast) {
+#if MB_MASTER_BCAST_BATCH_ENABLED
+            transp->bcast_hold_until_us = esp_timer_get_time() + (MB_MASTER_DELAY_MS_CONVERT * 1000);
+            mb_port_timer_convert_delay_t35_enable(transp->base.port_obj);
+#else
             mb_port_timer_convert_delay_enable(transp->base.port_obj);
+#endif
         } else {
-            mb_port_timer_respond_timeout_enable(transp->base.port_obj);
+            mb_port_timer_slave_respond_timeout_enable(transp->base.port_obj, slv_addr);
         }
 
     } else {
@@ -262,7 +306,13 @@ static bool mbm_rtu_transp_timer_expired(void *inst)
             need_poll = mb_port_event_post(transp->base.port_obj, EVENT(EV_EXECUTE));
             ESP_EARLY_LOGD(TAG, "%p:MB_TMODE_CONVERT_DELAY", transp->base.descr.parent);
             break;
-            
+
+        case MB_TMODE_SEND_DELAY:
+            // The bus is free, the deferred request keeps its transaction
+            need_poll = mb_port_event_post(transp->base.port_obj, EVENT(EV_FRAME_TRANSMIT));
+            ESP_EARLY_LOGD(TAG, "%p:MB_TMODE_SEND_DELAY", transp->base.descr.parent);
+            break;
+
         default:
             need_poll = mb_port_event_post(transp->base.port_obj, EVENT(EV_READY));
             break;
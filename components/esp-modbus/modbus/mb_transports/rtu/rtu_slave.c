@@ -144,9 +144,15 @@ static mb_err_enum_t mbs_rtu_transp_receive(mb_trans_base_t *inst, uint8_t *recv
     assert(length < MB_RTU_SER_PDU_SIZE_MAX);
     assert(buf);
 
+    /* Use the CRC accumulated by the port while the frame was received, if available. */
+    uint16_t crc16 = 0;
+    if (!mb_port_ser_get_recv_crc(inst->port_obj, &crc16)) {
+        crc16 = mb_crc16(buf, length);
+    }
+
     /* Check length and CRC checksum */
     if ((length >= MB_RTU_SER_PDU_SIZE_MIN)
-        && (mb_crc16(buf, length) == 0)) {
+        && (crc16 == 0)) {
         /* Save the address field. All frames are passed to the upper layed
          * and the decision if a frame is used is done there.
          */
@@ -161,6 +167,7 @@ static mb_err_enum_t mbs_rtu_transp_receive(mb_trans_base_t *inst, uint8_t *recv
         /* Return the start of the Modbus PDU to the caller. */
         *frame_buf = &buf[MB_SER_PDU_PDU_OFF];
     } else {
+        MB_DIAG_INC(inst->port_obj, MB_DIAG_BUS_COMM_ERR_CNT);
         status = MB_EIO;
     }
     return status;
@@ -177,6 +184,12 @@ static mb_err_enum_t mbs_rtu_transp_send(mb_trans_base_t *inst, uint8_t slv_addr
     }
 
     if (frame_ptr && frame_len) {
+        // The response is deferred with the timer until T3.5 after the request is elapsed
+        uint32_t delay_us = mb_port_ser_get_send_delay_us(transp->port_obj);
+        if (delay_us) {
+            mb_port_timer_send_delay_enable(transp->port_obj, delay_us);
+            return MB_EBUSY;
+        }
         /* First byte before the Modbus-PDU is the slave address. */
         transp->snd_buf_cur = (uint8_t *)frame_ptr - 1;
         transp->snd_buf_cnt = 1;
@@ -215,10 +228,13 @@ static bool mbs_rtu_transp_timer_expired(void *inst)
 {
     mbs_rtu_transp_t *transp = __containerof(inst, mbs_rtu_transp_t, base);
     bool need_poll = false;
-    //mb_timer_mode_enum_t timer_mode = mb_port_get_cur_timer_mode(transp->base.port_obj);
+    mb_timer_mode_enum_t timer_mode = mb_port_get_cur_timer_mode(transp->port_obj);
 
-    mb_port_timer_disable(transp->base.port_obj);
-    
+    mb_port_timer_disable(transp->port_obj);
+    if (timer_mode == MB_TMODE_SEND_DELAY) {
+        need_poll = mb_port_event_post(transp->port_obj, EVENT(EV_FRAME_TRANSMIT));
+        ESP_EARLY_LOGD(TAG, "%p:MB_TMODE_SEND_DELAY", transp->base.descr.parent);
+    }
     return need_poll;
 }
 
@@ -21,22 +21,16 @@ extern "C" {
 
 #if (CONFIG_FMB_COMM_MODE_RTU_EN)
 
-/* If baudrate > 19200 then we should use the fixed timer values
- * t35 = 1750us. Otherwise t35 must be 3.5 times the character time.
- * The timer reload value for a character is given by:
- *
- * ChTimeValue = Ticks_per_1s / (Baudrate / 11)
- *             = 11 * Ticks_per_1s / Baudrate
- *             = 220000 / Baudrate
- * The reload for t3.5 is 1.5 times this value and similary
- * for t3.5.
+/* The T3.5 timer reload value in timer ticks (50us) for 11 bit character.
+ * If baudrate > 19200 the fixed value t35 = 1750us is used unless the fixed
+ * frame timing is disabled in the configuration (see MB_SER_GET_T35_US).
  */
-#define MB_RTU_GET_T35_VAL(baudrate) (__extension__(            \
-{                                                               \
-    uint16_t tmr_35_50us = (baudrate > 19200) ?                 \
-                    35 : ((7UL * 220000UL) / (2UL * baudrate)); \
-    tmr_35_50us;                                                \
-}                                                               \
+#define MB_RTU_GET_T35_VAL(baudrate) (__extension__(                                    \
+{                                                                                       \
+    uint16_t tmr_35_50us = (uint16_t)((MB_SER_GET_T35_US(22, (baudrate))               \
+                                + MB_TIMER_TICK_TIME_US - 1) / MB_TIMER_TICK_TIME_US);  \
+    tmr_35_50us;                                                                        \
+}                                                                                       \
 ))
 
 /* ----------------------- Defines ------------------------------------------*/
@@ -63,6 +63,9 @@ mb_err_enum_t mbm_tcp_transp_create(mb_tcp_opts_t *tcp_opts, void **in_out_inst)
     if (tcp_opts->response_tout_ms) {
         mb_port_timer_set_response_time(port_obj, tcp_opts->response_tout_ms);
     }
+    // Measure the round trip time of slaves to adjust the respond timeout
+    ret = mb_port_timer_rtt_create(port_obj);
+    MB_GOTO_ON_FALSE((ret == MB_ENOERR), MB_EPORTERR, error, TAG, "timer rtt creation, err: %d", ret);
     ret = mb_port_event_create(port_obj);
     MB_GOTO_ON_FALSE((ret == MB_ENOERR), MB_EPORTERR, error, TAG, "event port creation, err: %d", ret);
     // Set callback function pointer for the timer
@@ -181,7 +184,7 @@ static mb_err_enum_t mbm_tcp_transp_send(mb_trans_base_t *inst, uint8_t address,
     if (mbm_port_tcp_send_data(inst->port_obj, address, frame_ptr, tcp_len) == false) {
         status = MB_EIO;
     }
-    mb_port_timer_respond_timeout_enable(inst->port_obj);
+    mb_port_timer_slave_respond_timeout_enable(inst->port_obj, address);
     return status;
 }
 
@@ -0,0 +1,146 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "mb_frame.h"
+#include "mb_proto.h"
+#include "rtu/mbcrc.h"
+#include "tcp_rtu_framing.h"
+
+/* ----------------------- Defines ------------------------------------------*/
+// The total length of frame with the byte count field at the offset, or MB_RTU_FRAME_LEN_MORE
+#define MB_RTU_LEN_WITH_COUNT(frame, len, cnt_off, hdr_len) \
+    (((len) > (cnt_off)) ? ((hdr_len) + (frame)[cnt_off] + MB_SER_PDU_SIZE_CRC) : MB_RTU_FRAME_LEN_MORE)
+
+static int mb_rtu_request_get_len(const uint8_t *frame, uint16_t len)
+{
+    switch (frame[MB_SER_PDU_PDU_OFF]) {
+        case MB_FUNC_READ_COILS:
+        case MB_FUNC_READ_DISCRETE_INPUTS:
+        case MB_FUNC_READ_HOLDING_REGISTER:
+        case MB_FUNC_READ_INPUT_REGISTER:
+        case MB_FUNC_WRITE_SINGLE_COIL:
+        case MB_FUNC_WRITE_REGISTER:
+        case MB_FUNC_DIAG_DIAGNOSTIC:
+            return 8;
+        case MB_FUNC_DIAG_READ_EXCEPTION:
+        case MB_FUNC_DIAG_GET_COM_EVENT_CNT:
+        case MB_FUNC_DIAG_GET_COM_EVENT_LOG:
+        case MB_FUNC_OTHER_REPORT_SLAVEID:
+            return 4;
+        case MB_FUNC_READ_FIFO_QUEUE:
+            return 6;
+        case MB_FUNC_MASK_WRITE_REGISTER:
+            return 10;
+        case MB_FUNC_WRITE_MULTIPLE_COILS:
+        case MB_FUNC_WRITE_MULTIPLE_REGISTERS:
+            // address, function, start address, quantity, byte count, data
+            return MB_RTU_LEN_WITH_COUNT(frame, len, 6, 7);
+        case MB_FUNC_READWRITE_MULTIPLE_REGISTERS:
+            // address, function, read address, read quantity, write address, write quantity, byte count, data
+            return MB_RTU_LEN_WITH_COUNT(frame, len, 10, 11);
+        case MB_FUNC_READ_FILE_RECORD:
+        case MB_FUNC_WRITE_FILE_RECORD:
+            return MB_RTU_LEN_WITH_COUNT(frame, len, 2, 3);
+        default:
+            break;
+    }
+    return MB_RTU_FRAME_LEN_UNKNOWN;
+}
+
+static int mb_rtu_response_get_len(const uint8_t *frame, uint16_t len)
+{
+    uint8_t func_code = frame[MB_SER_PDU_PDU_OFF];
+
+    if (func_code & MB_FUNC_ERROR) {
+        // address, function, exception code
+        return 5;
+    }
+    switch (func_code) {
+        case MB_FUNC_WRITE_SINGLE_COIL:
+        case MB_FUNC_WRITE_REGISTER:
+        case MB_FUNC_WRITE_MULTIPLE_COILS:
+        case MB_FUNC_WRITE_MULTIPLE_REGISTERS:
+        case MB_FUNC_DIAG_DIAGNOSTIC:
+        case MB_FUNC_DIAG_GET_COM_EVENT_CNT:
+            return 8;
+        case MB_FUNC_DIAG_READ_EXCEPTION:
+            return 5;
+        case MB_FUNC_MASK_WRITE_REGISTER:
+            return 10;
+        case MB_FUNC_READ_COILS:
+        case MB_FUNC_READ_DISCRETE_INPUTS:
+        case MB_FUNC_READ_HOLDING_REGISTER:
+        case MB_FUNC_READ_INPUT_REGISTER:
+        case MB_FUNC_READWRITE_MULTIPLE_REGISTERS:
+        case MB_FUNC_DIAG_GET_COM_EVENT_LOG:
+        case MB_FUNC_OTHER_REPORT_SLAVEID:
+        case MB_FUNC_READ_FILE_RECORD:
+        case MB_FUNC_WRITE_FILE_RECORD:
+            // address, function, byte count, data
+            return MB_RTU_LEN_WITH_COUNT(frame, len, 2, 3);
+        case MB_FUNC_READ_FIFO_QUEUE:
+            // address, function, two bytes of byte count, data
+            if (len < 4) {
+                return MB_RTU_FRAME_LEN_MORE;
+            }
+            return 4 + ((frame[2] << 8) | frame[3]) + MB_SER_PDU_SIZE_CRC;
+        default:
+            break;
+    }
+    return MB_RTU_FRAME_LEN_UNKNOWN;
+}
+
+int mb_rtu_frame_get_len(const uint8_t *frame, uint16_t len, bool is_request)
+{
+    if (!frame || (len <= MB_SER_PDU_PDU_OFF)) {
+        return MB_RTU_FRAME_LEN_MORE;
+    }
+    int frame_len = is_request ? mb_rtu_request_get_len(frame, len) : mb_rtu_response_get_len(frame, len);
+    if (frame_len > MB_RTU_FRAME_SIZE_MAX) {
+        return MB_RTU_FRAME_LEN_UNKNOWN;
+    }
+    return frame_len;
+}
+
+int mb_rtu_frame_to_mbap(const uint8_t *rtu_frame, uint16_t rtu_len, uint16_t tid, uint8_t *mbap_buf, uint16_t buf_size)
+{
+    if (!rtu_frame || !mbap_buf || (rtu_len < MB_RTU_FRAME_SIZE_MIN) || (rtu_len > MB_RTU_FRAME_SIZE_MAX)) {
+        return -1;
+    }
+    // The CRC of the frame including the CRC field is zero
+    if (mb_crc16((uint8_t *)rtu_frame, rtu_len) != 0) {
+        return -1;
+    }
+    // The unit identifier and PDU follow the MBAP header
+    uint16_t data_len = rtu_len - MB_SER_PDU_SIZE_CRC;
+    if ((MB_TCP_UID + data_len) > buf_size) {
+        return -1;
+    }
+    mbap_buf[MB_TCP_TID] = (uint8_t)(tid >> 8);
+    mbap_buf[MB_TCP_TID + 1] = (uint8_t)(tid & 0xFF);
+    mbap_buf[MB_TCP_PID] = (uint8_t)(MB_TCP_PROTOCOL_ID >> 8);
+    mbap_buf[MB_TCP_PID + 1] = (uint8_t)(MB_TCP_PROTOCOL_ID & 0xFF);
+    mbap_buf[MB_TCP_LEN] = (uint8_t)(data_len >> 8);
+    mbap_buf[MB_TCP_LEN + 1] = (uint8_t)(data_len & 0xFF);
+    memmove(&mbap_buf[MB_TCP_UID], rtu_frame, data_len);
+    return (MB_TCP_UID + data_len);
+}
+
+int mb_rtu_frame_from_mbap(const uint8_t *mbap_frame, uint16_t mbap_len, uint8_t *rtu_buf, uint16_t buf_size)
+{
+    if (!mbap_frame || !rtu_buf || (mbap_len <= MB_TCP_FUNC)) {
+        return -1;
+    }
+    uint16_t data_len = mbap_len - MB_TCP_UID;
+    if (((data_len + MB_SER_PDU_SIZE_CRC) > buf_size) || ((data_len + MB_SER_PDU_SIZE_CRC) > MB_RTU_FRAME_SIZE_MAX)) {
+        return -1;
+    }
+    memmove(rtu_buf, &mbap_frame[MB_TCP_UID], data_len);
+    uint16_t crc16 = mb_crc16(rtu_buf, data_len);
+    rtu_buf[data_len++] = (uint8_t)(crc16 & 0xFF);
+    rtu_buf[data_len++] = (uint8_t)(crc16 >> 8);
+    return data_len;
+}
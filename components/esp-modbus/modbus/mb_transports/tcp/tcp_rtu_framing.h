@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------- Defines ------------------------------------------*/
+
+#define MB_RTU_FRAME_SIZE_MIN       (4)     /*!< Address, function code and CRC. */
+#define MB_RTU_FRAME_SIZE_MAX       (256)   /*!< Maximum size of RTU frame. */
+
+#define MB_RTU_FRAME_LEN_UNKNOWN    (-1)    /*!< The length of frame can not be inferred from function code. */
+#define MB_RTU_FRAME_LEN_MORE       (0)     /*!< More bytes of frame header are required to infer the length. */
+
+/**
+ * @brief Infer the length of RTU frame (address, PDU and CRC) from the function code.
+ *
+ * The stream sockets do not keep the T3.5 gaps between frames, so the frame
+ * boundary is calculated from the fixed size or byte count field of the function.
+ *
+ * @param frame pointer to the received part of the frame, starting from address field
+ * @param len number of bytes received
+ * @param is_request true if the frame is the request of master, false for the response of slave
+ *
+ * @return
+ *     - the total length of the frame in bytes
+ *     - MB_RTU_FRAME_LEN_MORE if more bytes are required to infer the length
+ *     - MB_RTU_FRAME_LEN_UNKNOWN if the function code is not supported or the length is incorrect
+ */
+int mb_rtu_frame_get_len(const uint8_t *frame, uint16_t len, bool is_request);
+
+/**
+ * @brief Convert the RTU frame received from socket into the MBAP frame used by the TCP port.
+ *
+ * @param rtu_frame pointer to the RTU frame (address, PDU and CRC)
+ * @param rtu_len length of RTU frame
+ * @param tid transaction identifier to set in the MBAP header
+ * @param mbap_buf the buffer for the MBAP frame
+ * @param buf_size size of the MBAP buffer
+ *
+ * @return the length of MBAP frame, or -1 if the CRC or the length is incorrect
+ */
+int mb_rtu_frame_to_mbap(const uint8_t *rtu_frame, uint16_t rtu_len, uint16_t tid, uint8_t *mbap_buf, uint16_t buf_size);
+
+/**
+ * @brief Convert the MBAP frame of the TCP port into the RTU frame to be sent over socket.
+ *
+ * The UID field of MBAP header is used as the address field of RTU frame.
+ *
+ * @param mbap_frame pointer to the MBAP frame
+ * @param mbap_len length of MBAP frame
+ * @param rtu_buf the buffer for the RTU frame
+ * @param buf_size size of the RTU buffer
+ *
+ * @return the length of RTU frame, or -1 if the length is incorrect
+ */
+int mb_rtu_frame_from_mbap(const uint8_t *mbap_frame, uint16_t mbap_len, uint8_t *rtu_buf, uint16_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "unity_fixture.h"
+
+#include "sdkconfig.h"
+
+static void run_all_tests(void)
+{
+#if (CONFIG_FMB_COMM_MODE_TCP_EN)
+    RUN_TEST_GROUP(modbus_bench_tcp);
+#endif
+}
+
+void app_main(void)
+{
+    UNITY_MAIN_FUNC(run_all_tests);
+}
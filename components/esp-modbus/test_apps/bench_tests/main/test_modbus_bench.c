@@ -0,0 +1,403 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include "unity_fixture.h"
+
+#include "test_utils.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_netif.h"
+#include "esp_event.h"
+
+#include "sdkconfig.h"
+#include "test_common.h"
+#include "mb_proto.h"
+
+#define TAG "MODBUS_BENCH"
+
+#define BENCH_TCP_PORT_NUM          (1502)
+#define BENCH_REQUESTS              (CONFIG_MB_BENCH_REQUESTS)
+#define BENCH_MAX_CONNS             (CONFIG_MB_BENCH_MAX_CONNECTIONS)
+#define BENCH_MAX_DEPTH             (4)
+#define BENCH_MAX_CLIENTS           (BENCH_MAX_CONNS * BENCH_MAX_DEPTH)
+#define BENCH_REG_AREA_SIZE         (128)
+#define BENCH_TASK_STACK_SIZE       (4096)
+#define BENCH_TASK_PRIO             (CONFIG_MB_TEST_MASTER_TASK_PRIO)
+#define BENCH_POINT_TOUT_MS         (300000)
+#define BENCH_STATUS_MAX_TASKS      (64)
+#define BENCH_PAR_INFO_TOUT         (10)
+#define BENCH_RESPOND_TOUT_MS       (CONFIG_FMB_MASTER_TIMEOUT_MS_RESPOND)
+#define BENCH_SLAVE_ADDR(idx)       ((uint8_t)((idx) + 1))
+#define BENCH_ADDR_STR_LEN          (32)
+
+// The prefix of the result lines parsed by the pytest script
+#define BENCH_RESULT_PREFIX         "MB_BENCH:"
+
+#if CONFIG_MB_PORT_ADAPTER_EN
+#define BENCH_TRANSPORT             "adapter"
+#else
+#define BENCH_TRANSPORT             "tcp"
+#endif
+
+// The workaround to statically link whole test library
+__attribute__((unused)) bool mb_test_include_bench_impl = true;
+
+#if (CONFIG_FMB_COMM_MODE_TCP_EN)
+
+typedef struct {
+    void *mbm_handle;
+    void *mbs_handle;
+    TaskHandle_t slave_task;
+    uint8_t uid;
+} bench_conn_t;
+
+typedef struct {
+    uint8_t func_code;
+    uint16_t reg_count;
+    uint8_t conns;
+    uint8_t depth;
+} bench_point_t;
+
+typedef struct {
+    const bench_point_t *point;
+    bench_conn_t *conn;
+    SemaphoreHandle_t done_sema;
+} bench_client_t;
+
+typedef struct {
+    uint64_t busy_us;               // CPU time of all tasks except the idle tasks
+    uint32_t allocs;                // Number of heap allocations
+} bench_usage_t;
+
+// The sweep of the benchmark, each combination is one result line
+static const uint8_t bench_func_codes[] = {
+    MB_FUNC_READ_HOLDING_REGISTER,
+    MB_FUNC_READ_INPUT_REGISTER,
+    MB_FUNC_WRITE_MULTIPLE_REGISTERS,
+    MB_FUNC_READ_COILS
+};
+static const uint16_t bench_reg_counts[] = {1, 32, 120};
+static const uint8_t bench_conn_counts[] = {1, 2, 4};
+static const uint8_t bench_depths[] = {1, BENCH_MAX_DEPTH};
+
+static uint16_t holding_registers[BENCH_REG_AREA_SIZE] = {0};
+static uint16_t input_registers[BENCH_REG_AREA_SIZE] = {0};
+static uint16_t coil_registers[BENCH_REG_AREA_SIZE] = {0};
+
+static bench_conn_t s_conns[BENCH_MAX_CONNS];
+static char s_addr_str[BENCH_MAX_CONNS][BENCH_ADDR_STR_LEN];
+static const char *s_addr_table[BENCH_MAX_CONNS][2];
+static mb_parameter_descriptor_t s_descr[BENCH_MAX_CONNS];
+
+static uint32_t s_latency_us[BENCH_REQUESTS];
+static _Atomic int s_next_request = 0;
+static _Atomic int s_errors = 0;
+static _Atomic bool s_slave_stop = false;
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+static TaskStatus_t s_task_status[BENCH_STATUS_MAX_TASKS];
+#endif
+
+#if CONFIG_HEAP_USE_HOOKS
+
+static _Atomic uint32_t s_alloc_count = 0;
+
+// The hooks are called by the heap component for each allocation and free
+IRAM_ATTR void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    atomic_fetch_add_explicit(&s_alloc_count, 1, memory_order_relaxed);
+}
+
+IRAM_ATTR void esp_heap_trace_free_hook(void *ptr)
+{
+}
+
+#endif
+
+static void bench_get_usage(bench_usage_t *usage)
+{
+    usage->busy_us = 0;
+    usage->allocs = 0;
+#if CONFIG_HEAP_USE_HOOKS
+    usage->allocs = atomic_load(&s_alloc_count);
+#endif
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    // The run time counters are in microseconds (esp_timer clock), the idle time is not counted
+    UBaseType_t count = uxTaskGetSystemState(s_task_status, BENCH_STATUS_MAX_TASKS, NULL);
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (strncmp(s_task_status[i].pcTaskName, "IDLE", 4)) {
+            usage->busy_us += s_task_status[i].ulRunTimeCounter;
+        }
+    }
+#endif
+}
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+// Nearest rank percentile of the sorted samples, permille is the rank in parts per thousand
+static uint32_t bench_percentile(const uint32_t *sorted, int count, int permille)
+{
+    int rank = (count * permille + 999) / 1000;
+    rank = (rank < 1) ? 1 : rank;
+    return sorted[rank - 1];
+}
+
+// The slave task reads the parameter access notifications, the full queue would delay the slave
+static void bench_slave_task(void *arg)
+{
+    void *mbs_handle = arg;
+    mb_param_info_t reg_info;
+    while (!atomic_load(&s_slave_stop)) {
+        (void)mbc_slave_get_param_info(mbs_handle, &reg_info, BENCH_PAR_INFO_TOUT);
+    }
+    vTaskSuspend(NULL);
+}
+
+static void bench_client_task(void *arg)
+{
+    bench_client_t *client = arg;
+    uint16_t data[BENCH_REG_AREA_SIZE] = {0};
+    mb_param_request_t request = {
+        .slave_addr = client->conn->uid,
+        .command = client->point->func_code,
+        .reg_start = 0,
+        .reg_size = client->point->reg_count
+    };
+    int index = 0;
+
+    // Wait the start of the measurement
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while ((index = atomic_fetch_add(&s_next_request, 1)) < BENCH_REQUESTS) {
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t err = mbc_master_send_request(client->conn->mbm_handle, &request, data);
+        s_latency_us[index] = (uint32_t)(esp_timer_get_time() - start_us);
+        if (err != ESP_OK) {
+            atomic_fetch_add(&s_errors, 1);
+        }
+    }
+    xSemaphoreGive(client->done_sema);
+    vTaskSuspend(NULL);
+}
+
+// The depth clients share one master, the master sends one request at a time,
+// so the depth above one measures the latency of the requests queued in the master
+static void bench_run_point(const bench_point_t *point)
+{
+    bench_client_t clients[BENCH_MAX_CLIENTS];
+    TaskHandle_t tasks[BENCH_MAX_CLIENTS] = {NULL};
+    int count = point->conns * point->depth;
+    SemaphoreHandle_t done_sema = xSemaphoreCreateCounting(count, 0);
+    TEST_ASSERT_NOT_NULL(done_sema);
+
+    atomic_store(&s_next_request, 0);
+    atomic_store(&s_errors, 0);
+    for (int i = 0; i < count; i++) {
+        clients[i].point = point;
+        clients[i].conn = &s_conns[i % point->conns];
+        clients[i].done_sema = done_sema;
+        TEST_ASSERT_TRUE(xTaskCreatePinnedToCore(bench_client_task, "bench_client",
+                                                    BENCH_TASK_STACK_SIZE, &clients[i],
+                                                    BENCH_TASK_PRIO, &tasks[i], CONFIG_FMB_PORT_TASK_AFFINITY));
+    }
+
+    // The clients are created before the measurement to exclude their allocations
+    bench_usage_t usage_start, usage_end;
+    bench_get_usage(&usage_start);
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        xTaskNotifyGive(tasks[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(xSemaphoreTake(done_sema, pdMS_TO_TICKS(BENCH_POINT_TOUT_MS)));
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    bench_get_usage(&usage_end);
+
+    for (int i = 0; i < count; i++) {
+        vTaskDelete(tasks[i]);
+    }
+    vSemaphoreDelete(done_sema);
+
+    qsort(s_latency_us, BENCH_REQUESTS, sizeof(s_latency_us[0]), bench_cmp_u32);
+    double rps = (elapsed_us > 0) ? ((double)BENCH_REQUESTS * 1000000.0 / elapsed_us) : 0.0;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    double cpu_us = (double)(usage_end.busy_us - usage_start.busy_us) / BENCH_REQUESTS;
+#else
+    double cpu_us = -1.0;
+#endif
+#if CONFIG_HEAP_USE_HOOKS
+    double allocs = (double)(usage_end.allocs - usage_start.allocs) / BENCH_REQUESTS;
+#else
+    double allocs = -1.0;
+#endif
+    // One JSON object per line to be collected by the test script and tracked over time
+    printf(BENCH_RESULT_PREFIX "{\"transport\":\"%s\",\"target\":\"%s\",\"fc\":%u,\"regs\":%u,\"conns\":%u,"
+            "\"depth\":%u,\"requests\":%d,\"errors\":%d,\"rps\":%.1f,\"p50_us\":%" PRIu32 ","
+            "\"p99_us\":%" PRIu32 ",\"p999_us\":%" PRIu32 ",\"cpu_us_per_req\":%.1f,\"allocs_per_req\":%.2f}\n",
+            BENCH_TRANSPORT, CONFIG_IDF_TARGET, (unsigned)point->func_code, (unsigned)point->reg_count,
+            (unsigned)point->conns, (unsigned)point->depth, BENCH_REQUESTS, atomic_load(&s_errors), rps,
+            bench_percentile(s_latency_us, BENCH_REQUESTS, 500),
+            bench_percentile(s_latency_us, BENCH_REQUESTS, 990),
+            bench_percentile(s_latency_us, BENCH_REQUESTS, 999),
+            cpu_us, allocs);
+    fflush(stdout);
+    TEST_ASSERT_EQUAL(0, atomic_load(&s_errors));
+}
+
+static void bench_slave_setup_start(void *mbs_handle)
+{
+    mb_register_area_descriptor_t reg_area = {0};
+
+    reg_area.type = MB_PARAM_HOLDING;
+    reg_area.address = (void *)holding_registers;
+    reg_area.size = sizeof(holding_registers);
+    TEST_ESP_OK(mbc_slave_set_descriptor(mbs_handle, reg_area));
+
+    reg_area.type = MB_PARAM_INPUT;
+    reg_area.address = (void *)input_registers;
+    reg_area.size = sizeof(input_registers);
+    TEST_ESP_OK(mbc_slave_set_descriptor(mbs_handle, reg_area));
+
+    reg_area.type = MB_PARAM_COIL;
+    reg_area.address = (void *)coil_registers;
+    reg_area.size = sizeof(coil_registers);
+    TEST_ESP_OK(mbc_slave_set_descriptor(mbs_handle, reg_area));
+    TEST_ESP_OK(mbc_slave_start(mbs_handle));
+}
+
+// Each connection is the master and slave pair with its own port and slave address
+static void bench_conn_create(int index)
+{
+    bench_conn_t *conn = &s_conns[index];
+    conn->uid = BENCH_SLAVE_ADDR(index);
+    uint16_t port = BENCH_TCP_PORT_NUM + index;
+
+    mb_communication_info_t slave_cfg = {
+        .tcp_opts.port = port,
+        .tcp_opts.mode = MB_TCP,
+        .tcp_opts.addr_type = MB_IPV4,
+        .tcp_opts.ip_addr_table = NULL,
+        .tcp_opts.uid = conn->uid,
+        .tcp_opts.start_disconnected = true,
+        .tcp_opts.response_tout_ms = BENCH_RESPOND_TOUT_MS
+    };
+    TEST_ESP_OK(mbc_slave_create_tcp(&slave_cfg, &conn->mbs_handle));
+    bench_slave_setup_start(conn->mbs_handle);
+    TEST_ASSERT_TRUE(xTaskCreatePinnedToCore(bench_slave_task, "bench_slave",
+                                                BENCH_TASK_STACK_SIZE, conn->mbs_handle,
+                                                CONFIG_MB_TEST_SLAVE_TASK_PRIO, &conn->slave_task,
+                                                CONFIG_FMB_PORT_TASK_AFFINITY));
+
+    snprintf(s_addr_str[index], BENCH_ADDR_STR_LEN, "%u;127.0.0.1;%u", (unsigned)conn->uid, (unsigned)port);
+    s_addr_table[index][0] = s_addr_str[index];
+    s_addr_table[index][1] = NULL;
+    mb_communication_info_t master_cfg = {
+        .tcp_opts.port = port,
+        .tcp_opts.mode = MB_TCP,
+        .tcp_opts.addr_type = MB_IPV4,
+        .tcp_opts.ip_addr_table = (void *)s_addr_table[index],
+        .tcp_opts.uid = 0,
+        .tcp_opts.start_disconnected = false,
+        .tcp_opts.response_tout_ms = BENCH_RESPOND_TOUT_MS
+    };
+    TEST_ESP_OK(mbc_master_create_tcp(&master_cfg, &conn->mbm_handle));
+    s_descr[index] = (mb_parameter_descriptor_t) {
+        .cid = 0,
+        .param_key = "bench_reg",
+        .param_units = "Data",
+        .mb_slave_addr = conn->uid,
+        .mb_param_type = MB_PARAM_HOLDING,
+        .mb_reg_start = 0,
+        .mb_size = 1,
+        .param_type = PARAM_TYPE_U16,
+        .param_size = 2,
+        .access = PAR_PERMS_READ_WRITE_TRIGGER
+    };
+    TEST_ESP_OK(mbc_master_set_descriptor(conn->mbm_handle, &s_descr[index], 1));
+    TEST_ESP_OK(mbc_master_start(conn->mbm_handle));
+}
+
+static void bench_conn_delete(int index)
+{
+    bench_conn_t *conn = &s_conns[index];
+    if (conn->mbm_handle) {
+        TEST_ESP_OK(mbc_master_delete(conn->mbm_handle));
+    }
+    if (conn->slave_task) {
+        vTaskDelete(conn->slave_task);
+    }
+    if (conn->mbs_handle) {
+        TEST_ESP_OK(mbc_slave_delete(conn->mbs_handle));
+    }
+    memset(conn, 0, sizeof(bench_conn_t));
+}
+
+TEST_GROUP(modbus_bench_tcp);
+
+TEST_SETUP(modbus_bench_tcp)
+{
+#if !CONFIG_MB_PORT_ADAPTER_EN
+    // The lwIP stack is started for the loopback interface, no network interface is required
+    esp_err_t err = esp_netif_init();
+    TEST_ASSERT_TRUE((err == ESP_OK) || (err == ESP_ERR_INVALID_STATE));
+    err = esp_event_loop_create_default();
+    TEST_ASSERT_TRUE((err == ESP_OK) || (err == ESP_ERR_INVALID_STATE));
+#endif
+    test_common_start();
+    atomic_store(&s_slave_stop, false);
+    for (int i = 0; i < BENCH_MAX_CONNS; i++) {
+        bench_conn_create(i);
+    }
+}
+
+TEST_TEAR_DOWN(modbus_bench_tcp)
+{
+    atomic_store(&s_slave_stop, true);
+    vTaskDelay(BENCH_PAR_INFO_TOUT + 1); // Let the slave tasks to leave the notification queue
+    for (int i = 0; i < BENCH_MAX_CONNS; i++) {
+        bench_conn_delete(i);
+    }
+    test_common_stop();
+    ESP_LOGI(TAG, "%s, done successfully.", __func__);
+}
+
+TEST(modbus_bench_tcp, test_modbus_bench_tcp_sweep)
+{
+    for (int fc = 0; fc < sizeof(bench_func_codes) / sizeof(bench_func_codes[0]); fc++) {
+        for (int reg = 0; reg < sizeof(bench_reg_counts) / sizeof(bench_reg_counts[0]); reg++) {
+            for (int conn = 0; conn < sizeof(bench_conn_counts) / sizeof(bench_conn_counts[0]); conn++) {
+                if (bench_conn_counts[conn] > BENCH_MAX_CONNS) {
+                    continue;
+                }
+                for (int depth = 0; depth < sizeof(bench_depths) / sizeof(bench_depths[0]); depth++) {
+                    bench_point_t point = {
+                        .func_code = bench_func_codes[fc],
+                        .reg_count = bench_reg_counts[reg],
+                        .conns = bench_conn_counts[conn],
+                        .depth = bench_depths[depth]
+                    };
+                    bench_run_point(&point);
+                }
+            }
+        }
+    }
+}
+
+TEST_GROUP_RUNNER(modbus_bench_tcp)
+{
+    RUN_TEST_CASE(modbus_bench_tcp, test_modbus_bench_tcp_sweep);
+}
+
+#endif
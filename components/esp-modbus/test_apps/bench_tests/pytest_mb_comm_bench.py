@@ -0,0 +1,30 @@
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+
+import json
+import os
+
+import pytest
+from pytest_embedded import Dut
+
+BENCH_RESULT_PATTERN = r'MB_BENCH:(\{[^\r\n]*\})'
+BENCH_DONE_PATTERN = r'\d+ Tests \d+ Failures \d+ Ignored'
+
+
+@pytest.mark.parametrize('target', ['esp32'], indirect=True)
+@pytest.mark.parametrize('config', ['adapter', 'tcp'], indirect=True)
+@pytest.mark.multi_dut_modbus_generic
+def test_modbus_comm_bench(dut: Dut, config: str) -> None:
+    results = []
+    while True:
+        match = dut.expect([BENCH_RESULT_PATTERN, BENCH_DONE_PATTERN], timeout=1200)
+        if not match.group(0).decode().startswith('MB_BENCH:'):
+            break
+        results.append(json.loads(match.group(1).decode()))
+    # The results are stored with the test logs, one JSON object per line
+    result_path = os.path.join(dut.logdir, f'mb_bench_{config}.jsonl')
+    with open(result_path, 'w') as result_file:
+        for result in results:
+            result_file.write(json.dumps(result) + '\n')
+    assert results, 'no benchmark results are received'
+    assert 'Failures 0' in match.group(0).decode(), 'the benchmark is failed'
@@ -17,6 +17,8 @@
 
 #include "protocol_examples_common.h"
 #include "esp_event.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
 
 #if __has_include("unity_test_utils.h")
 // unity test utils are used
@@ -33,6 +35,11 @@
 #define TEST_TCP_MASTER_SEND_TOUT_US    (500)
 
 #define TEST_MASTER_RESPOND_TOUT_MS     (CONFIG_FMB_MASTER_TIMEOUT_MS_RESPOND)
+#define TEST_LOOPBACK_READ_CNT          (100)
+#define TEST_UDP_RESPOND_TOUT_MS        (300)
+#define TEST_UDP_ATTEMPT_CNT            (CONFIG_FMB_UDP_RETRY_CNT + 1)
+#define TEST_MBAP_SIZE                  (7)
+#define TEST_MBAP_GET_TID(buf)          ((uint16_t)(((buf)[0] << 8U) | (buf)[1]))
 
 // The workaround to statically link the whole test library
 __attribute__((unused)) bool mb_test_include_phys_impl_tcp = true;
@@ -240,4 +247,146 @@ static void test_modbus_tcp_master(void)
 TEST_CASE_MULTIPLE_DEVICES("Modbus TCP multi device master - slave case.", "[modbus][test_env=multi_dut_modbus_tcp]",
                             test_modbus_tcp_slave, test_modbus_tcp_master);
 
+const char *slave_loopback_addr_table[] = {
+    "01;127.0.0.1;1502",            // Corresponds to characteristic MB_DEVICE_ADDR1
+    NULL                            // End of table condition (must be included)
+};
+
+// Get the average time of the parameter read from the slave on the loopback interface,
+// the master and slave exchange the MBAP frames or the raw RTU frames (rtu_framing)
+static uint32_t test_modbus_loopback_read_time_us(mb_comm_mode_t mode, bool rtu_framing)
+{
+    void *mbs_handle = NULL;
+    void *mbm_handle = NULL;
+    uint16_t value = 0;
+
+    mb_communication_info_t slave_cfg = {
+        .tcp_opts.port = TEST_TCP_PORT_NUM1,
+        .tcp_opts.mode = mode,
+        .tcp_opts.addr_type = MB_IPV4,
+        .tcp_opts.ip_addr_table = NULL,
+        .tcp_opts.uid = MB_DEVICE_ADDR1,
+        .tcp_opts.response_tout_ms = 1,
+        .tcp_opts.ip_netif_ptr = NULL,
+        .tcp_opts.rtu_framing = rtu_framing
+    };
+    TEST_ESP_OK(mbc_slave_create_tcp(&slave_cfg, &mbs_handle));
+    test_common_slave_setup_start(mbs_handle);
+
+    mb_communication_info_t master_cfg = {
+        .tcp_opts.port = TEST_TCP_PORT_NUM1,
+        .tcp_opts.mode = mode,
+        .tcp_opts.addr_type = MB_IPV4,
+        .tcp_opts.ip_addr_table = (void *)slave_loopback_addr_table,
+        .tcp_opts.uid = 0,
+        .tcp_opts.response_tout_ms = TEST_MASTER_RESPOND_TOUT_MS,
+        .tcp_opts.ip_netif_ptr = NULL,
+        .tcp_opts.rtu_framing = rtu_framing
+    };
+    TEST_ESP_OK(mbc_master_create_tcp(&master_cfg, &mbm_handle));
+    TEST_ESP_OK(mbc_master_set_descriptor(mbm_handle, &descriptors[0], 1));
+    TEST_ESP_OK(mbc_master_start(mbm_handle));
+
+    // The first request includes the connection phase, so it is not measured
+    TEST_ESP_OK(test_common_read_modbus_parameter(mbm_handle, CID_DEV_REG0, &value));
+    int64_t start_time = esp_timer_get_time();
+    for (int i = 0; i < TEST_LOOPBACK_READ_CNT; i++) {
+        TEST_ESP_OK(test_common_read_modbus_parameter(mbm_handle, CID_DEV_REG0, &value));
+    }
+    uint32_t read_time_us = (uint32_t)((esp_timer_get_time() - start_time) / TEST_LOOPBACK_READ_CNT);
+
+    TEST_ESP_OK(mbc_master_delete(mbm_handle));
+    TEST_ESP_OK(mbc_slave_delete(mbs_handle));
+    return read_time_us;
+}
+
+TEST_CASE("Modbus UDP and TCP latency on loopback interface.", "[modbus][test_env=loopback]")
+{
+    TEST_ESP_OK(esp_netif_init());
+    TEST_ESP_OK(esp_event_loop_create_default());
+
+    uint32_t tcp_time_us = test_modbus_loopback_read_time_us(MB_TCP, false);
+    uint32_t udp_time_us = test_modbus_loopback_read_time_us(MB_UDP, false);
+    ESP_LOGI(TAG, "Loopback read time, TCP: %" PRIu32 " us, UDP: %" PRIu32 " us.", tcp_time_us, udp_time_us);
+    // No datagram is lost on the loopback interface, so no request is completed by the retry
+    TEST_ASSERT_LESS_THAN_UINT32(TEST_MASTER_RESPOND_TOUT_MS * 1000, tcp_time_us);
+    TEST_ASSERT_LESS_THAN_UINT32(TEST_MASTER_RESPOND_TOUT_MS * 1000, udp_time_us);
+
+    TEST_ESP_OK(esp_event_loop_delete_default());
+}
+
+TEST_CASE("Modbus RTU over TCP and UDP master - slave on loopback interface.", "[modbus][test_env=loopback]")
+{
+    TEST_ESP_OK(esp_netif_init());
+    TEST_ESP_OK(esp_event_loop_create_default());
+
+    // The stream socket does not keep the frame boundary, the frame length is inferred from the function code
+    uint32_t tcp_time_us = test_modbus_loopback_read_time_us(MB_TCP, true);
+    uint32_t udp_time_us = test_modbus_loopback_read_time_us(MB_UDP, true);
+    ESP_LOGI(TAG, "Loopback RTU framing read time, TCP: %" PRIu32 " us, UDP: %" PRIu32 " us.", tcp_time_us, udp_time_us);
+    TEST_ASSERT_LESS_THAN_UINT32(TEST_MASTER_RESPOND_TOUT_MS * 1000, tcp_time_us);
+    TEST_ASSERT_LESS_THAN_UINT32(TEST_MASTER_RESPOND_TOUT_MS * 1000, udp_time_us);
+
+    TEST_ESP_OK(esp_event_loop_delete_default());
+}
+
+TEST_CASE("Modbus UDP master resends the request on response timeout.", "[modbus][test_env=loopback]")
+{
+    void *mbm_handle = NULL;
+    uint16_t value = 0;
+    uint8_t buf[260];
+
+    TEST_ESP_OK(esp_netif_init());
+    TEST_ESP_OK(esp_event_loop_create_default());
+
+    // The silent peer takes the request datagrams and never responds
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, sock);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_TCP_PORT_NUM1),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+    TEST_ASSERT_EQUAL(0, bind(sock, (struct sockaddr *)&addr, sizeof(addr)));
+
+    mb_communication_info_t master_cfg = {
+        .tcp_opts.port = TEST_TCP_PORT_NUM1,
+        .tcp_opts.mode = MB_UDP,
+        .tcp_opts.addr_type = MB_IPV4,
+        .tcp_opts.ip_addr_table = (void *)slave_loopback_addr_table,
+        .tcp_opts.uid = 0,
+        .tcp_opts.response_tout_ms = TEST_UDP_RESPOND_TOUT_MS,
+        .tcp_opts.ip_netif_ptr = NULL
+    };
+    TEST_ESP_OK(mbc_master_create_tcp(&master_cfg, &mbm_handle));
+    TEST_ESP_OK(mbc_master_set_descriptor(mbm_handle, &descriptors[0], 1));
+    TEST_ESP_OK(mbc_master_start(mbm_handle));
+
+    // The request is completed with timeout after the response timeout of each attempt
+    int64_t start_time = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, test_common_read_modbus_parameter(mbm_handle, CID_DEV_REG0, &value));
+    uint32_t read_time_ms = (uint32_t)((esp_timer_get_time() - start_time) / 1000);
+    ESP_LOGI(TAG, "UDP request failed after %" PRIu32 " ms.", read_time_ms);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(TEST_UDP_ATTEMPT_CNT * TEST_UDP_RESPOND_TOUT_MS, read_time_ms);
+    TEST_ASSERT_LESS_THAN_UINT32((TEST_UDP_ATTEMPT_CNT + 1) * TEST_UDP_RESPOND_TOUT_MS, read_time_ms);
+    TEST_ESP_OK(mbc_master_delete(mbm_handle));
+
+    // Each attempt sends the same datagram with the TID of the request
+    int count = 0;
+    int len = 0;
+    uint16_t tid = 0;
+    while ((len = recv(sock, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        TEST_ASSERT_GREATER_THAN(TEST_MBAP_SIZE, len);
+        if (!count) {
+            tid = TEST_MBAP_GET_TID(buf);
+        }
+        TEST_ASSERT_EQUAL_HEX16(tid, TEST_MBAP_GET_TID(buf));
+        count++;
+    }
+    TEST_ASSERT_EQUAL(TEST_UDP_ATTEMPT_CNT, count);
+    close(sock);
+
+    TEST_ESP_OK(esp_event_loop_delete_default());
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,351 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "sdkconfig.h"
+#include "esp_modbus_master.h"
+#include "esp_modbus_slave.h"
+#include "mb_common.h"
+#include "mb_proto.h"
+#include "port_serial_common.h"
+
+#define TAG "MB_PTY_TEST"
+
+#define PTY_PORT_NUM            (CONFIG_MB_PTY_TEST_PORT_NUM)
+#define PTY_REQUESTS            (CONFIG_MB_PTY_TEST_REQUESTS)
+#define PTY_SLAVE_ADDR          (1)
+#define PTY_REG_AREA_SIZE       (128)
+#define PTY_TASK_STACK_SIZE     (4096)
+#define PTY_TASK_PRIO           (5)
+#define PTY_PAR_INFO_TOUT       (10)
+#define PTY_RESPOND_TOUT_MS     (CONFIG_FMB_MASTER_TIMEOUT_MS_RESPOND)
+#define PTY_STATS_BAUDRATE      (115200)
+#define PTY_STATS_REQUESTS      (10)
+#define PTY_STATS_REG_COUNT     (10)
+#define PTY_BCAST_BAUDRATE      (115200)
+#define PTY_BCAST_CYCLES        (5)
+#define PTY_BCAST_BATCH         (4)
+
+// The line format of the test is 8N1: start, 8 data and stop bits
+#define PTY_CHAR_BITS           (10)
+
+// The prefix of the result lines parsed by the pytest script
+#define PTY_RESULT_PREFIX       "MB_PTY_BENCH:"
+
+#if CONFIG_FMB_SERIAL_FIXED_FRAME_TIMING_EN
+#define PTY_FRAME_TIMING        "fixed"
+#else
+#define PTY_FRAME_TIMING        "exact"
+#endif
+
+#ifdef CONFIG_FMB_MASTER_BCAST_BATCH_EN
+#define PTY_BCAST_BATCH_EN      (true)
+#else
+#define PTY_BCAST_BATCH_EN      (false)
+#endif
+
+// The workaround to statically link whole test library
+__attribute__((unused)) bool mb_test_include_pty_impl = true;
+
+typedef struct {
+    void *mbm_handle;
+    void *mbs_handle;
+    TaskHandle_t slave_task;
+} test_pty_pair_t;
+
+static const uint32_t test_baudrates[] = {19200, 115200, 921600};
+static const uint16_t test_reg_counts[] = {1, 32, 120};
+
+static uint16_t holding_registers[PTY_REG_AREA_SIZE] = {0};
+static uint32_t s_latency_us[PTY_REQUESTS];
+static _Atomic bool s_slave_stop = false;
+
+static int test_cmp_u32(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+// Nearest rank percentile of the sorted samples, permille is the rank in parts per thousand
+static uint32_t test_percentile(const uint32_t *sorted, int count, int permille)
+{
+    int rank = (count * permille + 999) / 1000;
+    rank = (rank < 1) ? 1 : rank;
+    return sorted[rank - 1];
+}
+
+// The number of characters on the line for the PDU of the given length
+static uint32_t test_get_line_chars(mb_comm_mode_t mode, uint32_t pdu_len)
+{
+    if (mode == MB_RTU) {
+        // Address, PDU and CRC16
+        return 1 + pdu_len + 2;
+    }
+    // The ':', address, PDU and LRC as two hex characters per byte, CR and LF
+    return 1 + 2 * (1 + pdu_len + 1) + 2;
+}
+
+// The slave task reads the parameter access notifications, the full queue would delay the slave
+static void test_slave_task(void *arg)
+{
+    void *mbs_handle = arg;
+    mb_param_info_t reg_info;
+    while (!atomic_load(&s_slave_stop)) {
+        (void)mbc_slave_get_param_info(mbs_handle, &reg_info, PTY_PAR_INFO_TOUT);
+    }
+    vTaskSuspend(NULL);
+}
+
+// The slave is created first to create the pty, the master opens its other end
+static void test_pair_create(test_pty_pair_t *pair, mb_comm_mode_t mode, uint32_t baudrate)
+{
+    mb_communication_info_t slave_cfg = {
+        .ser_opts.port = PTY_PORT_NUM,
+        .ser_opts.mode = mode,
+        .ser_opts.uid = PTY_SLAVE_ADDR,
+        .ser_opts.data_bits = UART_DATA_8_BITS,
+        .ser_opts.stop_bits = UART_STOP_BITS_1,
+        .ser_opts.baudrate = baudrate,
+        .ser_opts.parity = UART_PARITY_DISABLE,
+        .ser_opts.response_tout_ms = PTY_RESPOND_TOUT_MS
+    };
+    TEST_ESP_OK(mbc_slave_create_serial(&slave_cfg, &pair->mbs_handle));
+    mb_register_area_descriptor_t reg_area = {
+        .type = MB_PARAM_HOLDING,
+        .start_offset = 0,
+        .address = (void *)holding_registers,
+        .size = sizeof(holding_registers)
+    };
+    TEST_ESP_OK(mbc_slave_set_descriptor(pair->mbs_handle, reg_area));
+    TEST_ESP_OK(mbc_slave_start(pair->mbs_handle));
+    atomic_store(&s_slave_stop, false);
+    TEST_ASSERT_TRUE(xTaskCreate(test_slave_task, "pty_slave", PTY_TASK_STACK_SIZE,
+                                    pair->mbs_handle, PTY_TASK_PRIO, &pair->slave_task));
+
+    mb_communication_info_t master_cfg = {
+        .ser_opts.port = PTY_PORT_NUM,
+        .ser_opts.mode = mode,
+        .ser_opts.data_bits = UART_DATA_8_BITS,
+        .ser_opts.stop_bits = UART_STOP_BITS_1,
+        .ser_opts.baudrate = baudrate,
+        .ser_opts.parity = UART_PARITY_DISABLE,
+        .ser_opts.response_tout_ms = PTY_RESPOND_TOUT_MS
+    };
+    TEST_ESP_OK(mbc_master_create_serial(&master_cfg, &pair->mbm_handle));
+    static const mb_parameter_descriptor_t descr = {
+        .cid = 0,
+        .param_key = "pty_reg",
+        .param_units = "Data",
+        .mb_slave_addr = PTY_SLAVE_ADDR,
+        .mb_param_type = MB_PARAM_HOLDING,
+        .mb_reg_start = 0,
+        .mb_size = 1,
+        .param_type = PARAM_TYPE_U16,
+        .param_size = 2,
+        .access = PAR_PERMS_READ_WRITE_TRIGGER
+    };
+    TEST_ESP_OK(mbc_master_set_descriptor(pair->mbm_handle, &descr, 1));
+    TEST_ESP_OK(mbc_master_start(pair->mbm_handle));
+}
+
+static void test_pair_delete(test_pty_pair_t *pair)
+{
+    TEST_ESP_OK(mbc_master_delete(pair->mbm_handle));
+    atomic_store(&s_slave_stop, true);
+    vTaskDelay(PTY_PAR_INFO_TOUT + 1); // Let the slave task to leave the notification queue
+    vTaskDelete(pair->slave_task);
+    TEST_ESP_OK(mbc_slave_delete(pair->mbs_handle));
+    memset(pair, 0, sizeof(test_pty_pair_t));
+}
+
+// Read the registers and compare the time of the characters on the line with the elapsed time,
+// the rest is the frame gaps, the turnaround of the slave and the processing of the stack
+static void test_run_point(test_pty_pair_t *pair, mb_comm_mode_t mode, uint32_t baudrate, uint16_t reg_count)
+{
+    uint16_t data[PTY_REG_AREA_SIZE] = {0};
+    mb_param_request_t request = {
+        .slave_addr = PTY_SLAVE_ADDR,
+        .command = 0x03,
+        .reg_start = 0,
+        .reg_size = reg_count
+    };
+    int errors = 0;
+
+    for (int i = 0; i < PTY_REG_AREA_SIZE; i++) {
+        holding_registers[i] = (uint16_t)(0x1000 + (reg_count << 4) + i);
+    }
+    // The function code, address and count of the request, the function code, byte count and data of the response
+    uint32_t line_chars = test_get_line_chars(mode, 5) + test_get_line_chars(mode, 2 + 2 * reg_count);
+    double char_time_us = (double)PTY_CHAR_BITS * 1000000.0 / baudrate;
+
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < PTY_REQUESTS; i++) {
+        int64_t req_start_us = esp_timer_get_time();
+        esp_err_t err = mbc_master_send_request(pair->mbm_handle, &request, data);
+        s_latency_us[i] = (uint32_t)(esp_timer_get_time() - req_start_us);
+        if ((err != ESP_OK) || memcmp(data, holding_registers, reg_count * sizeof(uint16_t))) {
+            errors++;
+        }
+        memset(data, 0, sizeof(data));
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    qsort(s_latency_us, PTY_REQUESTS, sizeof(s_latency_us[0]), test_cmp_u32);
+    double rps = (elapsed_us > 0) ? ((double)PTY_REQUESTS * 1000000.0 / elapsed_us) : 0.0;
+    double line_us = line_chars * char_time_us;
+    double bus_util = (elapsed_us > 0) ? (line_us * PTY_REQUESTS / elapsed_us) : 0.0;
+    // One JSON object per line to be collected by the test script and tracked over time
+    printf(PTY_RESULT_PREFIX "{\"mode\":\"%s\",\"timing\":\"%s\",\"baud\":%" PRIu32 ",\"regs\":%u,"
+            "\"requests\":%d,\"errors\":%d,\"rps\":%.1f,\"p50_us\":%" PRIu32 ",\"p99_us\":%" PRIu32 ","
+            "\"line_us_per_req\":%.1f,\"bus_util\":%.3f}\n",
+            (mode == MB_RTU) ? "rtu" : "ascii", PTY_FRAME_TIMING, baudrate, (unsigned)reg_count,
+            PTY_REQUESTS, errors, rps,
+            test_percentile(s_latency_us, PTY_REQUESTS, 500),
+            test_percentile(s_latency_us, PTY_REQUESTS, 990),
+            line_us, bus_util);
+    fflush(stdout);
+    TEST_ASSERT_EQUAL(0, errors);
+}
+
+static void test_run_mode(mb_comm_mode_t mode)
+{
+    test_pty_pair_t pair = {0};
+    for (int baud = 0; baud < sizeof(test_baudrates) / sizeof(test_baudrates[0]); baud++) {
+        test_pair_create(&pair, mode, test_baudrates[baud]);
+        for (int reg = 0; reg < sizeof(test_reg_counts) / sizeof(test_reg_counts[0]); reg++) {
+            test_run_point(&pair, mode, test_baudrates[baud], test_reg_counts[reg]);
+        }
+        test_pair_delete(&pair);
+    }
+}
+
+static void test_get_ser_stats(void *handle, mb_port_ser_stats_t *stats)
+{
+    mb_base_t *mb_obj = ((mb_controller_common_t *)handle)->mb_base;
+    TEST_ASSERT_TRUE(mb_port_ser_get_stats(mb_obj->port_obj, stats));
+}
+
+// Every frame is copied once from the driver by the port task and its buffer is lent to the transport
+static void test_check_recv_counters(mb_comm_mode_t mode)
+{
+    test_pty_pair_t pair = {0};
+    uint16_t data[PTY_STATS_REG_COUNT] = {0};
+    mb_param_request_t request = {
+        .slave_addr = PTY_SLAVE_ADDR,
+        .command = 0x03,
+        .reg_start = 0,
+        .reg_size = PTY_STATS_REG_COUNT
+    };
+    mb_port_ser_stats_t mbm_before, mbm_after, mbs_before, mbs_after;
+
+    test_pair_create(&pair, mode, PTY_STATS_BAUDRATE);
+    test_get_ser_stats(pair.mbm_handle, &mbm_before);
+    test_get_ser_stats(pair.mbs_handle, &mbs_before);
+    for (int i = 0; i < PTY_STATS_REQUESTS; i++) {
+        TEST_ESP_OK(mbc_master_send_request(pair.mbm_handle, &request, data));
+    }
+    test_get_ser_stats(pair.mbm_handle, &mbm_after);
+    test_get_ser_stats(pair.mbs_handle, &mbs_after);
+    test_pair_delete(&pair);
+
+    uint32_t resp_chars = test_get_line_chars(mode, 2 + 2 * PTY_STATS_REG_COUNT);
+    uint32_t req_chars = test_get_line_chars(mode, 5);
+    TEST_ASSERT_EQUAL_UINT32(PTY_STATS_REQUESTS, mbm_after.buf_lend_count - mbm_before.buf_lend_count);
+    TEST_ASSERT_EQUAL_UINT32(0, mbm_after.copy_count - mbm_before.copy_count);
+    TEST_ASSERT_EQUAL_UINT32(resp_chars, mbm_after.frame_copy_bytes);
+    TEST_ASSERT_EQUAL_UINT32(PTY_STATS_REQUESTS * resp_chars, mbm_after.copy_bytes - mbm_before.copy_bytes);
+    TEST_ASSERT_EQUAL_UINT32(PTY_STATS_REQUESTS, mbs_after.buf_lend_count - mbs_before.buf_lend_count);
+    TEST_ASSERT_EQUAL_UINT32(0, mbs_after.copy_count - mbs_before.copy_count);
+    TEST_ASSERT_EQUAL_UINT32(req_chars, mbs_after.frame_copy_bytes);
+    TEST_ASSERT_EQUAL_UINT32(PTY_STATS_REQUESTS * req_chars, mbs_after.copy_bytes - mbs_before.copy_bytes);
+}
+
+// The batch of broadcast writes is followed by the unicast read of the written registers,
+// the conversion delay is applied after each broadcast or once before the read (CONFIG_FMB_MASTER_BCAST_BATCH_EN)
+static void test_run_bcast_point(void)
+{
+    test_pty_pair_t pair = {0};
+    uint16_t data[PTY_BCAST_BATCH] = {0};
+    mb_param_request_t write_req = {
+        .slave_addr = MB_ADDRESS_BROADCAST,
+        .command = 0x06,
+        .reg_size = 1
+    };
+    mb_param_request_t read_req = {
+        .slave_addr = PTY_SLAVE_ADDR,
+        .command = 0x03,
+        .reg_start = 0,
+        .reg_size = PTY_BCAST_BATCH
+    };
+    int errors = 0;
+
+    test_pair_create(&pair, MB_RTU, PTY_BCAST_BAUDRATE);
+    int64_t start_us = esp_timer_get_time();
+    for (int cycle = 0; cycle < PTY_BCAST_CYCLES; cycle++) {
+        for (int i = 0; i < PTY_BCAST_BATCH; i++) {
+            uint16_t value = (uint16_t)((cycle << 8) + i);
+            write_req.reg_start = i;
+            errors += (mbc_master_send_request(pair.mbm_handle, &write_req, &value) != ESP_OK);
+        }
+        errors += (mbc_master_send_request(pair.mbm_handle, &read_req, data) != ESP_OK);
+        for (int i = 0; i < PTY_BCAST_BATCH; i++) {
+            errors += (data[i] != (uint16_t)((cycle << 8) + i));
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    test_pair_delete(&pair);
+
+    int transactions = PTY_BCAST_CYCLES * (PTY_BCAST_BATCH + 1);
+    double tps = (elapsed_us > 0) ? ((double)transactions * 1000000.0 / elapsed_us) : 0.0;
+    printf(PTY_RESULT_PREFIX "{\"mode\":\"rtu\",\"timing\":\"%s\",\"baud\":%u,\"bcast\":%d,"
+            "\"bcast_batch\":%s,\"convert_ms\":%d,\"transactions\":%d,\"errors\":%d,\"tps\":%.1f}\n",
+            PTY_FRAME_TIMING, (unsigned)PTY_BCAST_BAUDRATE, PTY_BCAST_BATCH,
+            PTY_BCAST_BATCH_EN ? "true" : "false", MB_MASTER_DELAY_MS_CONVERT,
+            transactions, errors, tps);
+    fflush(stdout);
+    TEST_ASSERT_EQUAL(0, errors);
+}
+
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+
+TEST_CASE("Test RTU master and slave pair over the pty.", "[MB_PTY]")
+{
+    test_run_mode(MB_RTU);
+}
+
+TEST_CASE("Test RTU frames are copied once and lent to the transport.", "[MB_PTY]")
+{
+    test_check_recv_counters(MB_RTU);
+}
+
+TEST_CASE("Test RTU broadcast requests batched between unicast polls.", "[MB_PTY]")
+{
+    test_run_bcast_point();
+}
+
+#endif
+
+#if (CONFIG_FMB_COMM_MODE_ASCII_EN)
+
+TEST_CASE("Test ASCII master and slave pair over the pty.", "[MB_PTY]")
+{
+    test_run_mode(MB_ASCII);
+}
+
+TEST_CASE("Test ASCII frames are copied once and lent to the transport.", "[MB_PTY]")
+{
+    test_check_recv_counters(MB_ASCII);
+}
+
+#endif
@@ -0,0 +1,30 @@
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+
+import json
+import os
+
+import pytest
+from pytest_embedded import Dut
+
+PTY_RESULT_PATTERN = r'MB_PTY_BENCH:(\{[^\r\n]*\})'
+PTY_DONE_PATTERN = r'\d+ Tests \d+ Failures \d+ Ignored'
+
+
+@pytest.mark.parametrize('target', ['linux'], indirect=True)
+@pytest.mark.parametrize('config', ['fixed', 'exact', 'bcast'], indirect=True)
+@pytest.mark.host_test
+def test_modbus_pty(dut: Dut, config: str) -> None:
+    results = []
+    while True:
+        match = dut.expect([PTY_RESULT_PATTERN, PTY_DONE_PATTERN], timeout=1200)
+        if not match.group(0).decode().startswith('MB_PTY_BENCH:'):
+            break
+        results.append(json.loads(match.group(1).decode()))
+    # The results are stored with the test logs, one JSON object per line
+    result_path = os.path.join(dut.logdir, f'mb_pty_{config}.jsonl')
+    with open(result_path, 'w') as result_file:
+        for result in results:
+            result_file.write(json.dumps(result) + '\n')
+    assert {result['mode'] for result in results} == {'rtu', 'ascii'}, 'the results of both modes are expected'
+    assert 'Failures 0' in match.group(0).decode(), 'the test is failed'
@@ -54,6 +54,24 @@ bool __wrap_mb_port_ser_recv_data(mb_port_base_t *inst, uint8_t **frame, uint16_
     return mb_port_adapter_recv_data(inst, frame, length);
 }
 
+bool __wrap_mb_port_ser_get_recv_crc(mb_port_base_t *inst, uint16_t *crc)
+{
+    // The adapter does not accumulate the CRC, let the transport calculate it
+    return false;
+}
+
+uint32_t __wrap_mb_port_ser_get_send_delay_us(mb_port_base_t *inst)
+{
+    // The adapter has no bus timing, the frame is sent immediately
+    return 0;
+}
+
+int64_t __wrap_mb_port_ser_get_recv_time_us(mb_port_base_t *inst)
+{
+    // The frame is taken from the adapter queue when it is read
+    return esp_timer_get_time();
+}
+
 bool __wrap_mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *frame, uint16_t length)
 {
     return mb_port_adapter_send_data(inst, 0, frame, length);
@@ -31,6 +31,9 @@ void __wrap_mb_port_ser_enable(mb_port_base_t *inst);
 void __wrap_mb_port_ser_disable(mb_port_base_t *inst);
 bool __wrap_mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *p_ser_frame, uint16_t ser_length);
 bool __wrap_mb_port_ser_recv_data(mb_port_base_t *inst, uint8_t **ser_frame, uint16_t *p_ser_length);
+bool __wrap_mb_port_ser_get_recv_crc(mb_port_base_t *inst, uint16_t *crc);
+uint32_t __wrap_mb_port_ser_get_send_delay_us(mb_port_base_t *inst);
+int64_t __wrap_mb_port_ser_get_recv_time_us(mb_port_base_t *inst);
 void __wrap_mb_port_ser_delete(mb_port_base_t *inst);
 
 #endif
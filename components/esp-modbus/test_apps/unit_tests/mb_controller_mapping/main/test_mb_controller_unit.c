@@ -434,6 +434,192 @@ static esp_err_t test_master_check_callback(int par_index, mb_err_enum_t mb_err)
     return err;
 }
 
+// The table with sparse and unordered cids
+static const mb_parameter_descriptor_t sparse_descriptors[] = {
+    {1000, STR("MB_sparse_hold-1000"), STR("Data"), MB_DEVICE_ADDR1, MB_PARAM_HOLDING, 0, 2,
+        0, PARAM_TYPE_U32, 4, OPTS(0, 0, 0), PAR_PERMS_READ_WRITE_TRIGGER},
+    {7, STR("MB_sparse_input-7"), STR("Data"), MB_DEVICE_ADDR1, MB_PARAM_INPUT, 2, 1,
+        0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ},
+    {0, STR("MB_sparse_coil-0"), STR("Bit"), MB_DEVICE_ADDR1, MB_PARAM_COIL, 3, TEST_COIL_AREA0_REG_SZ,
+        0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ_WRITE_TRIGGER},
+    {65535, STR("MB_sparse_hold-65535"), STR("Data"), MB_DEVICE_ADDR1, MB_PARAM_HOLDING, 4, 2,
+        0, PARAM_TYPE_FLOAT_CDAB, 4, OPTS(0, 0, 0), PAR_PERMS_READ_WRITE_TRIGGER},
+    {1, STR("MB_sparse_hold-1"), STR("Data"), MB_DEVICE_ADDR1, MB_PARAM_HOLDING, 6, 1,
+        0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ_WRITE_TRIGGER},
+};
+
+static void test_master_check_index(void)
+{
+    mb_communication_info_t master_config = {
+        .ser_opts.port = TEST_SER_PORT_NUM,
+        .ser_opts.mode = MB_RTU,
+        .ser_opts.uid = MB_DEVICE_ADDR1,
+        .ser_opts.data_bits = UART_DATA_8_BITS,
+        .ser_opts.stop_bits = UART_STOP_BITS_2,
+        .ser_opts.baudrate = 115200,
+        .ser_opts.parity = UART_PARITY_DISABLE,
+        .ser_opts.response_tout_ms = 1,
+        .ser_opts.test_tout_us = TEST_SLAVE_SEND_TOUT_US};
+    mb_base_t *mb_base = NULL; // fake mb_base handle
+    void *mbm_handle = NULL;
+    const uint16_t sparse_num = (sizeof(sparse_descriptors) / sizeof(sparse_descriptors[0]));
+
+    TEST_ESP_ERR(MB_ENOERR, mb_stub_serial_create(&master_config.ser_opts, (void *)&mb_base));
+    mb_base->port_obj = (mb_port_base_t *)0x44556677;
+    mbm_rtu_create_ExpectAnyArgsAndReturn(MB_ENOERR);
+    mbm_rtu_create_ReturnThruPtr_in_out_obj((void **)&mb_base);
+    TEST_ESP_OK(mbc_master_create_serial(&master_config, &mbm_handle));
+
+    // The table with duplicated cid is rejected
+    mb_parameter_descriptor_t dup_descriptors[2] = {sparse_descriptors[0], sparse_descriptors[1]};
+    dup_descriptors[1].cid = sparse_descriptors[0].cid;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, mbc_master_set_descriptor(mbm_handle, &dup_descriptors[0], 2));
+
+    TEST_ESP_OK(mbc_master_set_descriptor(mbm_handle, &sparse_descriptors[0], sparse_num));
+    mb_port_event_post_ExpectAndReturn(mb_base->port_obj, EVENT(EV_FRAME_TRANSMIT | EV_TRANS_START), true);
+    TEST_ESP_OK(mbc_master_start(mbm_handle));
+
+    const mb_parameter_descriptor_t *param_descriptor = NULL;
+    for (int i = 0; i < sparse_num; i++) {
+        TEST_ESP_OK(mbc_master_get_cid_info(mbm_handle, sparse_descriptors[i].cid, &param_descriptor));
+        TEST_ASSERT_EQUAL_HEX32(&sparse_descriptors[i], param_descriptor);
+        param_descriptor = NULL;
+        TEST_ESP_OK(mbc_master_get_cid_info_by_key(mbm_handle, sparse_descriptors[i].param_key, &param_descriptor));
+        TEST_ASSERT_EQUAL_HEX32(&sparse_descriptors[i], param_descriptor);
+    }
+    TEST_ESP_ERR(ESP_ERR_NOT_FOUND, mbc_master_get_cid_info(mbm_handle, 2, &param_descriptor));
+    TEST_ESP_ERR(ESP_ERR_NOT_FOUND, mbc_master_get_cid_info(mbm_handle, 999, &param_descriptor));
+    TEST_ESP_ERR(ESP_ERR_NOT_FOUND, mbc_master_get_cid_info_by_key(mbm_handle, "MB_sparse_hold", &param_descriptor));
+
+    TEST_ESP_OK(mbc_master_stop(mbm_handle));
+    TEST_ESP_OK(mbc_master_delete(mbm_handle));
+    TEST_ASSERT_EQUAL_HEX(mb_port_get_inst_counter(), 0);
+    ESP_LOGI(TAG, "Test passed successfully.");
+}
+
+#if CONFIG_FMB_MASTER_SLAVE_HEALTH_EN
+
+#define TEST_HEALTH_SLAVES_NUM 8
+#define TEST_HEALTH_OFFLINE_TOUT_MS 20
+#define TEST_HEALTH_FAIL_SCANS CONFIG_FMB_MASTER_SLAVE_FAIL_THRESHOLD
+
+// One holding register of each slave, the slaves 3, 5, 6 are offline (k = 3 of n = 8)
+static const mb_parameter_descriptor_t health_descriptors[TEST_HEALTH_SLAVES_NUM] = {
+    {0, STR("MB_slave1_hold"), STR("Data"), 1, MB_PARAM_HOLDING, 0, 1, 0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ},
+    {1, STR("MB_slave2_hold"), STR("Data"), 2, MB_PARAM_HOLDING, 0, 1, 0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ},
+    {2, STR("MB_slave3_hold"), STR("Data"), 3, MB_PARAM_HOLDING, 0, 1, 0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ},
+    {3, STR("MB_slave4_hold"), STR("Data"), 4, MB_PARAM_HOLDING, 0, 1, 0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ},
+    {4, STR("MB_slave5_hold"), STR("Data"), 5, MB_PARAM_HOLDING, 0, 1, 0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ},
+    {5, STR("MB_slave6_hold"), STR("Data"), 6, MB_PARAM_HOLDING, 0, 1, 0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ},
+    {6, STR("MB_slave7_hold"), STR("Data"), 7, MB_PARAM_HOLDING, 0, 1, 0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ},
+    {7, STR("MB_slave8_hold"), STR("Data"), 8, MB_PARAM_HOLDING, 0, 1, 0, PARAM_TYPE_U16, 2, OPTS(0, 0, 0), PAR_PERMS_READ},
+};
+
+static bool health_offline[MB_ADDRESS_MAX + 1] = {0};
+static mb_base_t *health_mb_base = NULL;
+static int health_sent_count = 0;
+
+// Emulates the response of online slaves and the respond timeout of offline slaves
+static mb_err_enum_t test_health_wait_req_finish(mb_port_base_t *inst, int cmock_num_calls)
+{
+    uint8_t slave_addr = health_mb_base->get_dest_addr(health_mb_base);
+    health_sent_count++;
+    if (health_offline[slave_addr]) {
+        vTaskDelay(pdMS_TO_TICKS(TEST_HEALTH_OFFLINE_TOUT_MS));
+        return MB_ETIMEDOUT;
+    }
+    return MB_ENOERR;
+}
+
+// Reads all slaves once and returns the scan time in ticks
+static TickType_t test_health_scan(void *mbm_handle)
+{
+    uint8_t data[4] = {0};
+    uint8_t type = 0;
+    TickType_t start = xTaskGetTickCount();
+    health_sent_count = 0;
+    for (int i = 0; i < TEST_HEALTH_SLAVES_NUM; i++) {
+        esp_err_t err = mbc_master_get_parameter(mbm_handle, health_descriptors[i].cid, data, &type);
+        TEST_ESP_ERR((health_offline[health_descriptors[i].mb_slave_addr] ? ESP_ERR_TIMEOUT : ESP_OK), err);
+    }
+    return (xTaskGetTickCount() - start);
+}
+
+static void test_master_check_health(void)
+{
+    mb_communication_info_t master_config = {
+        .ser_opts.port = TEST_SER_PORT_NUM,
+        .ser_opts.mode = MB_RTU,
+        .ser_opts.uid = MB_DEVICE_ADDR1,
+        .ser_opts.data_bits = UART_DATA_8_BITS,
+        .ser_opts.stop_bits = UART_STOP_BITS_2,
+        .ser_opts.baudrate = 115200,
+        .ser_opts.parity = UART_PARITY_DISABLE,
+        .ser_opts.response_tout_ms = 1,
+        .ser_opts.test_tout_us = TEST_SLAVE_SEND_TOUT_US};
+    void *mbm_handle = NULL;
+    mb_slave_health_state_t state = MB_SLAVE_HEALTH_UP;
+    const int offline_num = 3;
+
+    TEST_ESP_ERR(MB_ENOERR, mb_stub_serial_create(&master_config.ser_opts, (void *)&health_mb_base));
+    health_mb_base->port_obj = (mb_port_base_t *)0x44556677;
+    mbm_rtu_create_ExpectAnyArgsAndReturn(MB_ENOERR);
+    mbm_rtu_create_ReturnThruPtr_in_out_obj((void **)&health_mb_base);
+    TEST_ESP_OK(mbc_master_create_serial(&master_config, &mbm_handle));
+    TEST_ESP_OK(mbc_master_set_descriptor(mbm_handle, &health_descriptors[0], TEST_HEALTH_SLAVES_NUM));
+    mb_port_event_post_IgnoreAndReturn(true);
+    mb_port_event_res_take_IgnoreAndReturn(true);
+    mb_port_event_res_release_Ignore();
+    mb_port_event_wait_req_finish_StubWithCallback(test_health_wait_req_finish);
+    TEST_ESP_OK(mbc_master_start(mbm_handle));
+
+    memset(health_offline, 0, sizeof(health_offline));
+    health_offline[3] = health_offline[5] = health_offline[6] = true;
+
+    // Each scan waits for the respond timeout of offline slaves until they are down
+    TickType_t fail_scan_ticks = 0;
+    for (int scan = 0; scan < TEST_HEALTH_FAIL_SCANS; scan++) {
+        fail_scan_ticks = test_health_scan(mbm_handle);
+        TEST_ASSERT_EQUAL_INT(TEST_HEALTH_SLAVES_NUM, health_sent_count);
+        TEST_ESP_OK(mbc_master_get_slave_health(mbm_handle, 3, &state));
+        TEST_ASSERT_EQUAL_INT(((scan + 1) < TEST_HEALTH_FAIL_SCANS) ? MB_SLAVE_HEALTH_SUSPECT : MB_SLAVE_HEALTH_DOWN, state);
+    }
+    TEST_ESP_OK(mbc_master_get_slave_health(mbm_handle, 1, &state));
+    TEST_ASSERT_EQUAL_INT(MB_SLAVE_HEALTH_UP, state);
+
+    // The requests to the down slaves fail immediately
+    TickType_t down_scan_ticks = test_health_scan(mbm_handle);
+    TEST_ASSERT_EQUAL_INT((TEST_HEALTH_SLAVES_NUM - offline_num), health_sent_count);
+    TEST_ASSERT_LESS_THAN(fail_scan_ticks, down_scan_ticks);
+    ESP_LOGI(TAG, "Scan of %d slaves with %d offline: %" PRIu32 " ms before, %" PRIu32 " ms after circuit break.",
+                TEST_HEALTH_SLAVES_NUM, offline_num, (uint32_t)pdTICKS_TO_MS(fail_scan_ticks),
+                (uint32_t)pdTICKS_TO_MS(down_scan_ticks));
+
+    // The probe is sent after the probe interval, the slave 5 is recovered
+    health_offline[5] = false;
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_FMB_MASTER_SLAVE_PROBE_MS) + 2);
+    test_health_scan(mbm_handle);
+    TEST_ASSERT_EQUAL_INT(TEST_HEALTH_SLAVES_NUM, health_sent_count);
+    TEST_ESP_OK(mbc_master_get_slave_health(mbm_handle, 5, &state));
+    TEST_ASSERT_EQUAL_INT(MB_SLAVE_HEALTH_UP, state);
+    TEST_ESP_OK(mbc_master_get_slave_health(mbm_handle, 6, &state));
+    TEST_ASSERT_EQUAL_INT(MB_SLAVE_HEALTH_DOWN, state);
+
+    // The failed probe doubles the probe interval
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_FMB_MASTER_SLAVE_PROBE_MS) + 2);
+    test_health_scan(mbm_handle);
+    TEST_ASSERT_EQUAL_INT((TEST_HEALTH_SLAVES_NUM - offline_num + 1), health_sent_count);
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, mbc_master_get_slave_health(mbm_handle, 0, &state));
+
+    mb_port_event_wait_req_finish_StubWithCallback(NULL);
+    TEST_ESP_OK(mbc_master_stop(mbm_handle));
+    TEST_ESP_OK(mbc_master_delete(mbm_handle));
+    TEST_ASSERT_EQUAL_HEX(mb_port_get_inst_counter(), 0);
+    ESP_LOGI(TAG, "Test passed successfully.");
+}
+
+#endif
+
 // Check if modbus controller object forms correct modbus request from data dictionary
 // and is able to transfer data using mb_object. Check possible errors returned back from
 // mb_object and make sure the modbus controller handles them correctly.
@@ -478,10 +664,30 @@ TEST(unit_test_controller, test_master_register_callbacks)
     TEST_ESP_ERR(ESP_OK, test_master_check_callback(CID_DEV_REG0_DISCRITE, MB_ENOERR));
 }
 
+TEST(unit_test_controller, test_master_check_param_index)
+{
+    ESP_LOGI(TAG, "TEST: Check the modbus master controller finds the sparse cids and keys of data dictionary.");
+    test_master_check_index();
+}
+
+#if CONFIG_FMB_MASTER_SLAVE_HEALTH_EN
+
+TEST(unit_test_controller, test_master_check_slave_health)
+{
+    ESP_LOGI(TAG, "TEST: Check the modbus master controller fails fast the requests to down slaves and probes them.");
+    test_master_check_health();
+}
+
+#endif
+
 TEST_GROUP_RUNNER(unit_test_controller)
 {
     RUN_TEST_CASE(unit_test_controller, test_master_send_read_request);
     RUN_TEST_CASE(unit_test_controller, test_master_send_write_request);
     RUN_TEST_CASE(unit_test_controller, test_master_register_callbacks);
+    RUN_TEST_CASE(unit_test_controller, test_master_check_param_index);
     RUN_TEST_CASE(unit_test_controller, test_slave_check_area_descriptor);
+#if CONFIG_FMB_MASTER_SLAVE_HEALTH_EN
+    RUN_TEST_CASE(unit_test_controller, test_master_check_slave_health);
+#endif
 }
@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+
+#include "sdkconfig.h"
+#include "ascii/ascii_lrc.h"
+
+#define TEST_BIN_MAX_SIZE 256
+#define TEST_ASCII_MAX_SIZE ((TEST_BIN_MAX_SIZE * 2) + 5)
+#define TEST_LRC_MAX_SIZE 4096
+
+// The character by character conversion used as the reference
+static uint8_t test_char2bin_reference(uint8_t char_val)
+{
+    if ((char_val >= '0') && (char_val <= '9')) {
+        return (uint8_t)(char_val - '0');
+    } else if ((char_val >= 'A') && (char_val <= 'F')) {
+        return (uint8_t)(char_val - 'A' + 0x0A);
+    }
+    return 0xFF;
+}
+
+static uint8_t test_bin2char_reference(uint8_t byte_val)
+{
+    return (byte_val <= 0x09) ? (uint8_t)('0' + byte_val) : (uint8_t)(byte_val - 0x0A + 'A');
+}
+
+static int test_ascii_set_buf_reference(const uint8_t *data_ptr, uint8_t *buf, int bin_length)
+{
+    int frm_idx = 1;
+    uint8_t lrc = 0;
+    buf[0] = MB_ASCII_START;
+    for (int bin_idx = 0; bin_idx < bin_length; bin_idx++) {
+        buf[frm_idx++] = test_bin2char_reference((uint8_t)(data_ptr[bin_idx] >> 4));
+        buf[frm_idx++] = test_bin2char_reference((uint8_t)(data_ptr[bin_idx] & 0x0F));
+        lrc += data_ptr[bin_idx];
+    }
+    lrc = (uint8_t)(-((char)lrc));
+    buf[frm_idx++] = test_bin2char_reference((uint8_t)(lrc >> 4));
+    buf[frm_idx++] = test_bin2char_reference((uint8_t)(lrc & 0x0F));
+    buf[frm_idx++] = MB_ASCII_CR;
+    buf[frm_idx++] = MB_ASCII_LF;
+    return frm_idx;
+}
+
+TEST_CASE("Test ASCII frame encoding, decoding and LRC.", "[MB_ASCII]")
+{
+    uint8_t *data = calloc(1, TEST_BIN_MAX_SIZE);
+    uint8_t *frame = calloc(1, TEST_ASCII_MAX_SIZE);
+    uint8_t *ref_frame = calloc(1, TEST_ASCII_MAX_SIZE);
+    TEST_ASSERT(data && frame && ref_frame);
+
+    for (int i = 0; i < 256; i++) {
+        TEST_ASSERT_EQUAL_HEX8(test_char2bin_reference(i), mb_char2bin(i));
+    }
+    for (int i = 0; i < TEST_BIN_MAX_SIZE; i++) {
+        data[i] = (uint8_t)rand();
+    }
+
+    for (int len = 0; len < TEST_BIN_MAX_SIZE; len++) {
+        uint8_t lrc = 0;
+        for (int i = 0; i < len; i++) {
+            lrc += data[i];
+        }
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)(-lrc), mb_lrc(data, len));
+        int frame_len = mb_ascii_set_buf(data, frame, len);
+        TEST_ASSERT_EQUAL_INT(test_ascii_set_buf_reference(data, ref_frame, len), frame_len);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(ref_frame, frame, frame_len);
+        // The decoded frame includes the LRC byte
+        TEST_ASSERT_EQUAL_INT(len + 1, mb_ascii_get_binary_buf(frame, frame_len));
+        if (len) {
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(data, frame, len);
+        }
+    }
+
+    // The frames with incorrect LRC, non hex character or missing delimiter are rejected
+    int frame_len = mb_ascii_set_buf(data, frame, 8);
+    frame[frame_len - 3] = (frame[frame_len - 3] == '0') ? '1' : '0';
+    TEST_ASSERT_EQUAL_INT(-1, mb_ascii_get_binary_buf(frame, frame_len));
+    frame_len = mb_ascii_set_buf(data, frame, 8);
+    frame[3] = 'a';
+    TEST_ASSERT_EQUAL_INT(-1, mb_ascii_get_binary_buf(frame, frame_len));
+    frame_len = mb_ascii_set_buf(data, frame, 8);
+    frame[frame_len - 1] = '\r';
+    TEST_ASSERT_EQUAL_INT(-1, mb_ascii_get_binary_buf(frame, frame_len));
+
+    free(ref_frame);
+    free(frame);
+    free(data);
+}
+
+TEST_CASE("Test ASCII LRC of long buffers.", "[MB_ASCII]")
+{
+    // The lengths around the fold of the word lanes and the maximum sum of each lane
+    const int lengths[] = {511, 512, 513, 516, 517, 1020, 1024, 2047, TEST_LRC_MAX_SIZE};
+    uint8_t *data = malloc(TEST_LRC_MAX_SIZE);
+    TEST_ASSERT(data);
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < TEST_LRC_MAX_SIZE; i++) {
+            data[i] = pass ? (uint8_t)rand() : 0xFF;
+        }
+        for (int i = 0; i < (sizeof(lengths) / sizeof(lengths[0])); i++) {
+            uint8_t lrc = 0;
+            for (int cnt = 0; cnt < lengths[i]; cnt++) {
+                lrc += data[cnt];
+            }
+            TEST_ASSERT_EQUAL_HEX8((uint8_t)(-lrc), mb_lrc(data, lengths[i]));
+            // The unaligned start of the buffer
+            lrc -= data[0];
+            TEST_ASSERT_EQUAL_HEX8((uint8_t)(-lrc), mb_lrc(&data[1], lengths[i] - 1));
+        }
+    }
+    free(data);
+}
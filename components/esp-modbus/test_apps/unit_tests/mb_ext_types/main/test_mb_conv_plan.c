@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+#include "esp_log.h"
+
+#include "sdkconfig.h"
+#include "esp_modbus_master.h"
+
+#define TAG "MB_CONV_PLAN_TEST"
+
+#define TEST_CONV_DATA_SIZE 16
+#define TEST_CONV_GUARD 0xEE
+
+// The register buffer as it is received from slave, the bytes with high bit set catch the sign extension
+static const uint8_t test_conv_src[TEST_CONV_DATA_SIZE] = {
+    0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90
+};
+
+#define TEST_CONV_EXPECT(type, ...) { .param_type = PARAM_TYPE_##type, .name = #type, .expected = { __VA_ARGS__ } }
+
+// The expected parameter buffers, the patterns are produced by the mb_set_xxx() functions of the type
+static const struct {
+    mb_descr_type_t param_type;
+    const char *name;
+    uint8_t expected[TEST_CONV_DATA_SIZE];
+} test_conv_expect[] = {
+    TEST_CONV_EXPECT(U8, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(U16, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(U32, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(FLOAT, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(ASCII, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(BIN, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+#if CONFIG_FMB_EXT_TYPE_SUPPORT
+    TEST_CONV_EXPECT(I8_A, 0x81, 0x00, 0x83, 0x00, 0x85, 0x00, 0x87, 0x00, 0x89, 0x00, 0x8B, 0x00, 0x8D, 0x00, 0x8F, 0x00),
+    TEST_CONV_EXPECT(I8_B, 0x00, 0x82, 0x00, 0x84, 0x00, 0x86, 0x00, 0x88, 0x00, 0x8A, 0x00, 0x8C, 0x00, 0x8E, 0x00, 0x90),
+    TEST_CONV_EXPECT(U8_A, 0x81, 0x00, 0x83, 0x00, 0x85, 0x00, 0x87, 0x00, 0x89, 0x00, 0x8B, 0x00, 0x8D, 0x00, 0x8F, 0x00),
+    TEST_CONV_EXPECT(U8_B, 0x00, 0x82, 0x00, 0x84, 0x00, 0x86, 0x00, 0x88, 0x00, 0x8A, 0x00, 0x8C, 0x00, 0x8E, 0x00, 0x90),
+    TEST_CONV_EXPECT(I16_AB, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(I16_BA, 0x82, 0x81, 0x84, 0x83, 0x86, 0x85, 0x88, 0x87, 0x8A, 0x89, 0x8C, 0x8B, 0x8E, 0x8D, 0x90, 0x8F),
+    TEST_CONV_EXPECT(U16_AB, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(U16_BA, 0x82, 0x81, 0x84, 0x83, 0x86, 0x85, 0x88, 0x87, 0x8A, 0x89, 0x8C, 0x8B, 0x8E, 0x8D, 0x90, 0x8F),
+    TEST_CONV_EXPECT(I32_ABCD, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(I32_CDAB, 0x83, 0x84, 0x81, 0x82, 0x87, 0x88, 0x85, 0x86, 0x8B, 0x8C, 0x89, 0x8A, 0x8F, 0x90, 0x8D, 0x8E),
+    TEST_CONV_EXPECT(I32_BADC, 0x82, 0x81, 0x84, 0x83, 0x86, 0x85, 0x88, 0x87, 0x8A, 0x89, 0x8C, 0x8B, 0x8E, 0x8D, 0x90, 0x8F),
+    TEST_CONV_EXPECT(I32_DCBA, 0x84, 0x83, 0x82, 0x81, 0x88, 0x87, 0x86, 0x85, 0x8C, 0x8B, 0x8A, 0x89, 0x90, 0x8F, 0x8E, 0x8D),
+    TEST_CONV_EXPECT(U32_ABCD, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(U32_CDAB, 0x83, 0x84, 0x81, 0x82, 0x87, 0x88, 0x85, 0x86, 0x8B, 0x8C, 0x89, 0x8A, 0x8F, 0x90, 0x8D, 0x8E),
+    TEST_CONV_EXPECT(U32_BADC, 0x82, 0x81, 0x84, 0x83, 0x86, 0x85, 0x88, 0x87, 0x8A, 0x89, 0x8C, 0x8B, 0x8E, 0x8D, 0x90, 0x8F),
+    TEST_CONV_EXPECT(U32_DCBA, 0x84, 0x83, 0x82, 0x81, 0x88, 0x87, 0x86, 0x85, 0x8C, 0x8B, 0x8A, 0x89, 0x90, 0x8F, 0x8E, 0x8D),
+    TEST_CONV_EXPECT(FLOAT_ABCD, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(FLOAT_CDAB, 0x83, 0x84, 0x81, 0x82, 0x87, 0x88, 0x85, 0x86, 0x8B, 0x8C, 0x89, 0x8A, 0x8F, 0x90, 0x8D, 0x8E),
+    TEST_CONV_EXPECT(FLOAT_BADC, 0x82, 0x81, 0x84, 0x83, 0x86, 0x85, 0x88, 0x87, 0x8A, 0x89, 0x8C, 0x8B, 0x8E, 0x8D, 0x90, 0x8F),
+    TEST_CONV_EXPECT(FLOAT_DCBA, 0x84, 0x83, 0x82, 0x81, 0x88, 0x87, 0x86, 0x85, 0x8C, 0x8B, 0x8A, 0x89, 0x90, 0x8F, 0x8E, 0x8D),
+    TEST_CONV_EXPECT(I64_ABCDEFGH, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(I64_HGFEDCBA, 0x88, 0x87, 0x86, 0x85, 0x84, 0x83, 0x82, 0x81, 0x90, 0x8F, 0x8E, 0x8D, 0x8C, 0x8B, 0x8A, 0x89),
+    TEST_CONV_EXPECT(I64_GHEFCDAB, 0x87, 0x88, 0x85, 0x86, 0x83, 0x84, 0x81, 0x82, 0x8F, 0x90, 0x8D, 0x8E, 0x8B, 0x8C, 0x89, 0x8A),
+    TEST_CONV_EXPECT(I64_BADCFEHG, 0x82, 0x81, 0x84, 0x83, 0x86, 0x85, 0x88, 0x87, 0x8A, 0x89, 0x8C, 0x8B, 0x8E, 0x8D, 0x90, 0x8F),
+    TEST_CONV_EXPECT(U64_ABCDEFGH, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(U64_HGFEDCBA, 0x88, 0x87, 0x86, 0x85, 0x84, 0x83, 0x82, 0x81, 0x90, 0x8F, 0x8E, 0x8D, 0x8C, 0x8B, 0x8A, 0x89),
+    TEST_CONV_EXPECT(U64_GHEFCDAB, 0x87, 0x88, 0x85, 0x86, 0x83, 0x84, 0x81, 0x82, 0x8F, 0x90, 0x8D, 0x8E, 0x8B, 0x8C, 0x89, 0x8A),
+    TEST_CONV_EXPECT(U64_BADCFEHG, 0x82, 0x81, 0x84, 0x83, 0x86, 0x85, 0x88, 0x87, 0x8A, 0x89, 0x8C, 0x8B, 0x8E, 0x8D, 0x90, 0x8F),
+    TEST_CONV_EXPECT(DOUBLE_ABCDEFGH, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90),
+    TEST_CONV_EXPECT(DOUBLE_HGFEDCBA, 0x88, 0x87, 0x86, 0x85, 0x84, 0x83, 0x82, 0x81, 0x90, 0x8F, 0x8E, 0x8D, 0x8C, 0x8B, 0x8A, 0x89),
+    TEST_CONV_EXPECT(DOUBLE_GHEFCDAB, 0x87, 0x88, 0x85, 0x86, 0x83, 0x84, 0x81, 0x82, 0x8F, 0x90, 0x8D, 0x8E, 0x8B, 0x8C, 0x89, 0x8A),
+    TEST_CONV_EXPECT(DOUBLE_BADCFEHG, 0x82, 0x81, 0x84, 0x83, 0x86, 0x85, 0x88, 0x87, 0x8A, 0x89, 0x8C, 0x8B, 0x8E, 0x8D, 0x90, 0x8F),
+#endif
+};
+
+#define TEST_CONV_EXPECT_CNT (sizeof(test_conv_expect) / sizeof(test_conv_expect[0]))
+
+TEST_CASE("Test conversion of each parameter type to expected byte order.", "[MB_CONV_PLAN]")
+{
+    uint8_t dest[TEST_CONV_DATA_SIZE + 1];
+    mb_param_conv_plan_t plan;
+
+    for (int idx = 0; idx < TEST_CONV_EXPECT_CNT; idx++) {
+        ESP_LOGI(TAG, "Check type %s.", test_conv_expect[idx].name);
+        // Conversion by type resolved on each call
+        memset(dest, TEST_CONV_GUARD, sizeof(dest));
+        TEST_ESP_OK(mbc_master_set_param_data(dest, (void *)test_conv_src,
+                                                test_conv_expect[idx].param_type, TEST_CONV_DATA_SIZE));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(test_conv_expect[idx].expected, dest, TEST_CONV_DATA_SIZE);
+        TEST_ASSERT_EQUAL_HEX8(TEST_CONV_GUARD, dest[TEST_CONV_DATA_SIZE]);
+
+        // Conversion by precompiled plan
+        memset(dest, TEST_CONV_GUARD, sizeof(dest));
+        TEST_ESP_OK(mbc_master_get_conv_plan(&plan, test_conv_expect[idx].param_type, TEST_CONV_DATA_SIZE));
+        TEST_ESP_OK(mbc_master_apply_conv_plan(&plan, dest, test_conv_src));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(test_conv_expect[idx].expected, dest, TEST_CONV_DATA_SIZE);
+        TEST_ASSERT_EQUAL_HEX8(TEST_CONV_GUARD, dest[TEST_CONV_DATA_SIZE]);
+    }
+}
+
+TEST_CASE("Test conversion plan skips the incomplete element.", "[MB_CONV_PLAN]")
+{
+    uint8_t dest[TEST_CONV_DATA_SIZE];
+    mb_param_conv_plan_t plan;
+
+    // The remainder of the parameter which is less than element size is not transferred
+    memset(dest, TEST_CONV_GUARD, sizeof(dest));
+    TEST_ESP_OK(mbc_master_get_conv_plan(&plan, PARAM_TYPE_U32, 6));
+    TEST_ESP_OK(mbc_master_apply_conv_plan(&plan, dest, test_conv_src));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(test_conv_src, dest, 4);
+    TEST_ASSERT_EQUAL_HEX8(TEST_CONV_GUARD, dest[4]);
+    TEST_ASSERT_EQUAL_HEX8(TEST_CONV_GUARD, dest[5]);
+
+    // The unsupported type gives empty plan which is rejected on apply
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, mbc_master_get_conv_plan(&plan, (mb_descr_type_t)0x05, PARAM_SIZE_U16));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, mbc_master_apply_conv_plan(&plan, dest, test_conv_src));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, mbc_master_set_param_data(dest, (void *)test_conv_src,
+                                                                        (mb_descr_type_t)0x05, PARAM_SIZE_U16));
+}
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+#include "esp_log.h"
+
+#include "sdkconfig.h"
+#include "rtu/mbcrc.h"
+
+#define TAG "MB_CRC16_TEST"
+
+#define TEST_FRAME_MAX_SIZE 256
+
+// The bit-wise CRC16 calculation as defined in the Modbus over serial line specification
+static uint16_t test_crc16_reference(const uint8_t *frame_ptr, uint16_t len_buf)
+{
+    uint16_t crc = 0xFFFF;
+    while (len_buf--) {
+        crc ^= *(frame_ptr++);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x0001) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+TEST_CASE("Test CRC16 is bit exact for all frame lengths and alignments.", "[MB_CRC16]")
+{
+    uint8_t *frame = calloc(1, TEST_FRAME_MAX_SIZE + 8);
+    TEST_ASSERT(frame);
+
+    for (int i = 0; i < (TEST_FRAME_MAX_SIZE + 8); i++) {
+        frame[i] = (uint8_t)rand();
+    }
+
+    // The check value of CRC-16/MODBUS
+    TEST_ASSERT_EQUAL_HEX16(0x4B37, mb_crc16((uint8_t *)"123456789", 9));
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, mb_crc16(frame, 0));
+
+    for (int offset = 0; offset < 8; offset++) {
+        for (int len = 0; len <= TEST_FRAME_MAX_SIZE; len++) {
+            TEST_ASSERT_EQUAL_HEX16(test_crc16_reference(&frame[offset], len), mb_crc16(&frame[offset], len));
+        }
+    }
+
+    // The CRC of the frame with the CRC appended (low byte first) is zero as checked by receiver
+    uint16_t crc = mb_crc16(frame, TEST_FRAME_MAX_SIZE - 2);
+    frame[TEST_FRAME_MAX_SIZE - 2] = (uint8_t)(crc & 0xFF);
+    frame[TEST_FRAME_MAX_SIZE - 1] = (uint8_t)(crc >> 8);
+    TEST_ASSERT_EQUAL_HEX16(0, mb_crc16(frame, TEST_FRAME_MAX_SIZE));
+
+    free(frame);
+}
+
+TEST_CASE("Test CRC16 accumulated over received chunks.", "[MB_CRC16]")
+{
+    uint8_t *frame = calloc(1, TEST_FRAME_MAX_SIZE);
+    TEST_ASSERT(frame);
+
+    for (int i = 0; i < TEST_FRAME_MAX_SIZE; i++) {
+        frame[i] = (uint8_t)rand();
+    }
+
+    // The chunk sizes as the bytes are pulled from the UART ring buffer
+    const uint16_t chunks[] = {1, 3, 7, 8, 120};
+    for (int i = 0; i < (sizeof(chunks) / sizeof(chunks[0])); i++) {
+        uint16_t crc = MB_CRC16_INIT;
+        for (int pos = 0; pos < TEST_FRAME_MAX_SIZE; pos += chunks[i]) {
+            uint16_t len = ((TEST_FRAME_MAX_SIZE - pos) < chunks[i]) ? (TEST_FRAME_MAX_SIZE - pos) : chunks[i];
+            crc = mb_crc16_update(crc, &frame[pos], len);
+        }
+        TEST_ASSERT_EQUAL_HEX16(mb_crc16(frame, TEST_FRAME_MAX_SIZE), crc);
+    }
+
+    free(frame);
+}
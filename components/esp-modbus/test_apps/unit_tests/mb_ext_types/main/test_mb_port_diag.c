@@ -0,0 +1,59 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+
+#include "sdkconfig.h"
+#include "port_common.h"
+
+#if CONFIG_FMB_CONTROLLER_SLAVE_DIAG_SUPPORT
+
+#define TEST_REQUEST_CNT (MB_DIAG_EVENT_LOG_SIZE + 10)
+
+static mb_port_base_t test_port = {
+    .descr = {.parent_name = "test_diag", .obj_name = "test_diag"}
+};
+
+TEST_CASE("Test port diagnostic counters and event log.", "[MB_PORT_DIAG]")
+{
+    uint8_t events[MB_DIAG_EVENT_LOG_SIZE] = {0};
+    mb_port_diag_restart(&test_port, true);
+    for (int i = 0; i < TEST_REQUEST_CNT; i++) {
+        MB_DIAG_INC(&test_port, MB_DIAG_BUS_MSG_CNT);
+        MB_DIAG_INC(&test_port, MB_DIAG_SLAVE_MSG_CNT);
+        mb_port_diag_rcv_event(&test_port, false, false);
+        mb_port_diag_send_event(&test_port, (i & 1) ? MB_EX_ILLEGAL_DATA_ADDRESS : MB_EX_NONE);
+    }
+    TEST_ASSERT_EQUAL_UINT16(TEST_REQUEST_CNT, mb_port_diag_get_counter(&test_port, MB_DIAG_BUS_MSG_CNT));
+    TEST_ASSERT_EQUAL_UINT16(TEST_REQUEST_CNT, mb_port_diag_get_counter(&test_port, MB_DIAG_SLAVE_MSG_CNT));
+    TEST_ASSERT_EQUAL_UINT16(0, mb_port_diag_get_counter(&test_port, MB_DIAG_BUS_COMM_ERR_CNT));
+
+    // The log keeps the most recent events, the overrun is reported with the next received request
+    mb_port_diag_set_overrun(&test_port);
+    mb_port_diag_rcv_event(&test_port, true, true);
+    TEST_ASSERT_EQUAL_UINT8(MB_DIAG_EVENT_LOG_SIZE, mb_port_diag_get_log(&test_port, events, sizeof(events)));
+    TEST_ASSERT_EQUAL_HEX8((MB_DIAG_EV_RCV | MB_DIAG_EV_RCV_OVERRUN | MB_DIAG_EV_RCV_BROADCAST | MB_DIAG_EV_RCV_COMM_ERR), events[0]);
+    TEST_ASSERT_EQUAL_HEX8((MB_DIAG_EV_SEND | MB_DIAG_EV_SEND_READ_EX), events[1]);
+    TEST_ASSERT_EQUAL_HEX8(MB_DIAG_EV_RCV, events[2]);
+    TEST_ASSERT_EQUAL_HEX8(MB_DIAG_EV_SEND, events[3]);
+    TEST_ASSERT_EQUAL_UINT16(1, mb_port_diag_get_counter(&test_port, MB_DIAG_BUS_CHAR_OVERRUN_CNT));
+
+    // The listen only mode is left on restart which also clears the counters
+    mb_port_diag_set_listen_only(&test_port);
+    TEST_ASSERT_TRUE(mb_port_diag_is_listen_only(&test_port));
+    mb_port_diag_restart(&test_port, false);
+    TEST_ASSERT_FALSE(mb_port_diag_is_listen_only(&test_port));
+    TEST_ASSERT_EQUAL_UINT16(0, mb_port_diag_get_counter(&test_port, MB_DIAG_BUS_MSG_CNT));
+    TEST_ASSERT_EQUAL_UINT8(2, mb_port_diag_get_log(&test_port, events, 2));
+    TEST_ASSERT_EQUAL_HEX8(MB_DIAG_EV_RESTART, events[0]);
+    TEST_ASSERT_EQUAL_HEX8(MB_DIAG_EV_LISTEN_ONLY, events[1]);
+    mb_port_diag_restart(&test_port, true);
+    TEST_ASSERT_EQUAL_UINT8(1, mb_port_diag_get_log(&test_port, events, sizeof(events)));
+}
+
+#endif
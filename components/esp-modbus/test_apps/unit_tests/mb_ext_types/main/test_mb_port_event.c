@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "sdkconfig.h"
+#include "port_common.h"
+
+#define TEST_EVENT_ROUNDS 1000
+#define TEST_PRODUCER_STACK_SIZE 4096
+
+static mb_port_base_t test_port = {
+    .descr = {.parent_name = "test_event", .obj_name = "test_event"}
+};
+
+static volatile int test_post_failures = 0;
+
+static void test_event_producer_task(void *arg)
+{
+    mb_port_base_t *inst = (mb_port_base_t *)arg;
+    for (int i = 0; i < TEST_EVENT_ROUNDS; i++) {
+        // The producer has higher priority and fills the ring, the post waits for the free cell
+        if (!mb_port_event_post(inst, EVENT(EV_FRAME_RECEIVED, (uint16_t)i, NULL))) {
+            test_post_failures++;
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Test port event delivery order.", "[MB_PORT_EVENT]")
+{
+    mb_event_t event = {0};
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_event_create(&test_port));
+
+    // The event posted before the first get is kept in the ring
+    TEST_ASSERT_TRUE(mb_port_event_post(&test_port, EVENT(EV_READY)));
+    TEST_ASSERT_TRUE(mb_port_event_get(&test_port, &event));
+    TEST_ASSERT_EQUAL(EV_READY, event.event);
+
+    // The FSM steps posted by the polling task itself are chained
+    for (int i = 0; i < TEST_EVENT_ROUNDS; i++) {
+        TEST_ASSERT_TRUE(mb_port_event_post(&test_port, EVENT(EV_EXECUTE | EV_TRANS_START, (uint16_t)i)));
+        TEST_ASSERT_TRUE(mb_port_event_get(&test_port, &event));
+        TEST_ASSERT_EQUAL(EV_EXECUTE, event.event);
+        TEST_ASSERT_EQUAL_UINT16(i, event.length);
+        TEST_ASSERT_EQUAL_UINT64(mb_port_get_trans_id(&test_port), event.trans_id);
+    }
+
+    // The events posted by other task are delivered in order through the ring
+    TEST_ASSERT_EQUAL(pdTRUE, xTaskCreatePinnedToCore(test_event_producer_task, "producer", TEST_PRODUCER_STACK_SIZE,
+                                                        &test_port, (uxTaskPriorityGet(NULL) + 1), NULL, xPortGetCoreID()));
+    for (int i = 0; i < TEST_EVENT_ROUNDS; i++) {
+        TEST_ASSERT_TRUE(mb_port_event_get(&test_port, &event));
+        TEST_ASSERT_EQUAL(EV_FRAME_RECEIVED, event.event);
+        TEST_ASSERT_EQUAL_UINT16(i, event.length);
+    }
+    TEST_ASSERT_EQUAL(0, test_post_failures);
+    mb_port_event_delete(&test_port);
+}
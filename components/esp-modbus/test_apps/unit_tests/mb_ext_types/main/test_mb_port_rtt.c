@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "sdkconfig.h"
+#include "mb_config.h"
+#include "port_common.h"
+
+#if CONFIG_FMB_MASTER_ADAPTIVE_TIMEOUT_EN
+
+#define TEST_T35_TICKS 35
+#define TEST_RESPONSE_TIME_MS 1000
+#define TEST_SAMPLES 64
+#define TEST_SLAVE_ADDR 1
+#define TEST_FAST_SLAVE_ADDR 2
+#define TEST_SLOW_SLAVE_ADDR 3
+
+static mb_port_base_t test_port = {
+    .descr = {.parent_name = "test_rtt", .obj_name = "test_rtt"}
+};
+
+static uint32_t test_rtt_feed(uint8_t slave_addr, uint64_t rtt_us, int count)
+{
+    mb_port_rtt_stats_t stats = {0};
+    for (int i = 0; i < count; i++) {
+        mb_port_timer_slave_respond_timeout_enable(&test_port, slave_addr);
+        mb_port_timer_rtt_sample(&test_port, slave_addr, rtt_us);
+        mb_port_timer_disable(&test_port);
+    }
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_timer_get_rtt_stats(&test_port, slave_addr, &stats));
+    return stats.rto_ms;
+}
+
+TEST_CASE("Test master respond timeout converges to round trip time of slave and is clamped.", "[MB_PORT_RTT]")
+{
+    mb_port_rtt_stats_t stats = {0};
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_timer_create(&test_port, TEST_T35_TICKS));
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_timer_rtt_create(&test_port));
+    mb_port_timer_set_response_time(&test_port, TEST_RESPONSE_TIME_MS);
+
+    // The configured respond timeout is used until the slave responds
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_timer_get_rtt_stats(&test_port, TEST_SLAVE_ADDR, &stats));
+    TEST_ASSERT_EQUAL_UINT32(TEST_RESPONSE_TIME_MS, stats.rto_ms);
+
+    // The variance of the steady round trip time fades out, RTO = SRTT + granularity
+    uint32_t rto_ms = test_rtt_feed(TEST_SLAVE_ADDR, 200000, TEST_SAMPLES);
+    TEST_ASSERT_UINT32_WITHIN(1, 201, rto_ms);
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_timer_get_rtt_stats(&test_port, TEST_SLAVE_ADDR, &stats));
+    TEST_ASSERT_EQUAL_UINT32(200000, stats.srtt_us);
+    TEST_ASSERT_EQUAL_UINT32(TEST_SAMPLES, stats.samples);
+
+    // The sample which is not related to the active request is ignored
+    mb_port_timer_slave_respond_timeout_enable(&test_port, TEST_SLAVE_ADDR);
+    mb_port_timer_rtt_sample(&test_port, TEST_FAST_SLAVE_ADDR, 1000);
+    mb_port_timer_disable(&test_port);
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_timer_get_rtt_stats(&test_port, TEST_FAST_SLAVE_ADDR, &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.samples);
+
+    // The timeout doubles the respond timeout, the next response resets the backoff
+    mb_port_timer_slave_respond_timeout_enable(&test_port, TEST_SLAVE_ADDR);
+    vTaskDelay(pdMS_TO_TICKS(rto_ms * 2));
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_timer_get_rtt_stats(&test_port, TEST_SLAVE_ADDR, &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.timeouts);
+    TEST_ASSERT_UINT32_WITHIN(1, (rto_ms * 2), stats.rto_ms);
+    TEST_ASSERT_UINT32_WITHIN(1, 201, test_rtt_feed(TEST_SLAVE_ADDR, 200000, 1));
+
+    // The respond timeout is limited by the minimal and the configured one
+    TEST_ASSERT_EQUAL_UINT32(MB_MASTER_MIN_TIMEOUT_MS_RESPOND, test_rtt_feed(TEST_FAST_SLAVE_ADDR, 1000, TEST_SAMPLES));
+    TEST_ASSERT_EQUAL_UINT32(TEST_RESPONSE_TIME_MS, test_rtt_feed(TEST_SLOW_SLAVE_ADDR, 2000000, TEST_SAMPLES));
+
+    mb_port_timer_delete(&test_port);
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+
+#include "sdkconfig.h"
+#include "port_common.h"
+
+#if CONFIG_FMB_STATS_EN
+
+static mb_port_base_t test_port = {
+    .descr = {.parent_name = "test_stats", .obj_name = "test_stats"}
+};
+
+TEST_CASE("Test port stats counters and percentiles.", "[MB_PORT_STATS]")
+{
+    mb_stats_t stats = {0};
+    // The statistics are created with the event object of the instance
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_event_create(&test_port));
+    for (uint32_t i = 1; i <= 100; i++) {
+        MB_STATS_FRAME(&test_port, false, 5);
+        MB_STATS_FRAME(&test_port, true, 7);
+        mb_port_stats_handler(&test_port, 0x03, i);
+        mb_port_stats_request(&test_port, 0x03, i * 100, (i % 10) ? EV_ERROR_OK : EV_ERROR_RESPOND_TIMEOUT);
+    }
+    mb_port_stats_request(&test_port, 0x10, 1000, EV_ERROR_EXECUTE_FUNCTION);
+    // The requests failed before parsing are counted by the error type only
+    mb_port_stats_request(&test_port, 0, 0, EV_ERROR_RECEIVE_DATA);
+    MB_STATS_DROP(&test_port, 3);
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_stats_get(&test_port, &stats));
+    TEST_ASSERT_EQUAL_UINT64(500, stats.rx_bytes);
+    TEST_ASSERT_EQUAL_UINT64(700, stats.tx_bytes);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.rx_frames);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.tx_frames);
+    TEST_ASSERT_EQUAL_UINT32(10, stats.err_timeout);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.err_receive);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.err_execute);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.drops);
+    TEST_ASSERT_EQUAL_UINT8(0x03, stats.funcs[0].func);
+    TEST_ASSERT_EQUAL_UINT32(10, stats.funcs[0].errors);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.funcs[0].latency.count);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.funcs[0].latency.min_us);
+    TEST_ASSERT_EQUAL_UINT32(10000, stats.funcs[0].latency.max_us);
+    TEST_ASSERT_EQUAL_UINT64(505000, stats.funcs[0].latency.sum_us);
+    // The percentile is the upper bound of the bucket with four significant bits
+    TEST_ASSERT_UINT32_WITHIN(320, 5000, stats.funcs[0].latency.p50_us);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(9000, stats.funcs[0].latency.p90_us);
+    TEST_ASSERT_EQUAL_UINT32(10000, stats.funcs[0].latency.p99_us);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.funcs[0].handler.count);
+    TEST_ASSERT_UINT32_WITHIN(4, 50, stats.funcs[0].handler.p50_us);
+    TEST_ASSERT_EQUAL_UINT8(0x10, stats.funcs[1].func);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.funcs[1].errors);
+    // The invalid function code 0 does not take the tracked slot
+    mb_port_stats_handler(&test_port, 0, 10);
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_stats_get(&test_port, &stats));
+    TEST_ASSERT_EQUAL_UINT8(0, stats.funcs[2].func);
+
+    // The connection attempts of TCP master
+    mb_port_stats_connect(&test_port, 1500, true);
+    mb_port_stats_connect(&test_port, 0, false);
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_stats_get(&test_port, &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.err_connect);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.connect.count);
+    TEST_ASSERT_EQUAL_UINT32(1500, stats.connect.max_us);
+
+    // The function codes above the limit are not tracked separately
+    for (uint8_t func = 0x20; func < (0x20 + MB_STATS_FUNC_MAX); func++) {
+        mb_port_stats_request(&test_port, func, 10, EV_ERROR_OK);
+    }
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_stats_get(&test_port, &stats));
+    TEST_ASSERT_EQUAL_UINT32(2, stats.untracked);
+    mb_port_event_delete(&test_port);
+}
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+#include "esp_log.h"
+
+#include "sdkconfig.h"
+#include "port_common.h"
+
+#define TAG "MB_PORT_TRACE_TEST"
+
+#if CONFIG_FMB_STAGE_TRACE_EN
+
+#define TEST_RING_SIZE CONFIG_FMB_STAGE_TRACE_RING_SIZE
+#define TEST_OVERRUN_CNT (TEST_RING_SIZE * 3)
+
+static mb_port_base_t test_port = {
+    .descr = {.parent_name = "test_trace", .obj_name = "test_trace"}
+};
+
+TEST_CASE("Test port trace ring order and overrun.", "[MB_PORT_TRACE]")
+{
+    mb_trace_record_t records[TEST_RING_SIZE] = {0};
+    uint16_t count = TEST_RING_SIZE;
+    uint32_t lost = 0;
+    // The trace ring is created with the event object of the instance
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_event_create(&test_port));
+    for (int i = 0; i < MB_TRACE_STAGE_COUNT; i++) {
+        MB_STAGE_TRACE(&test_port, i, 0x03, i, i * 10);
+    }
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_trace_read(&test_port, records, &count, &lost));
+    TEST_ASSERT_EQUAL_UINT16(MB_TRACE_STAGE_COUNT, count);
+    TEST_ASSERT_EQUAL_UINT32(0, lost);
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT8(i, records[i].stage);
+        TEST_ASSERT_EQUAL_UINT8(0x03, records[i].func);
+        TEST_ASSERT_EQUAL_UINT32(i * 10, records[i].value);
+        if (i) {
+            TEST_ASSERT_EQUAL_UINT32(records[i - 1].seq + 1, records[i].seq);
+            TEST_ASSERT_GREATER_OR_EQUAL_UINT32(records[i - 1].time_us, records[i].time_us);
+        }
+    }
+
+    // The oldest records are dropped when the ring is not read in time
+    for (int i = 0; i < TEST_OVERRUN_CNT; i++) {
+        MB_STAGE_TRACE(&test_port, MB_TRACE_STAGE_REG_CB, 0, i, 0);
+    }
+    count = TEST_RING_SIZE;
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_trace_read(&test_port, records, &count, &lost));
+    ESP_LOGI(TAG, "read: %u, lost: %" PRIu32, (unsigned)count, lost);
+    TEST_ASSERT_EQUAL_UINT32(TEST_OVERRUN_CNT - count, lost);
+    TEST_ASSERT_EQUAL_UINT16(TEST_OVERRUN_CNT - 1, records[count - 1].arg);
+    count = TEST_RING_SIZE;
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_trace_read(&test_port, records, &count, &lost));
+    TEST_ASSERT_EQUAL_UINT16(0, count);
+    mb_port_event_delete(&test_port);
+}
+
+#endif
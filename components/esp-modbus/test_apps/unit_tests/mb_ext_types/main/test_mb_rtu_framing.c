@@ -0,0 +1,96 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+
+#include "sdkconfig.h"
+#include "rtu/mbcrc.h"
+#include "tcp/tcp_rtu_framing.h"
+
+#define TEST_MBAP_HDR_SIZE 6
+
+typedef struct {
+    bool is_request;
+    uint16_t len;
+    uint8_t frame[32];
+} test_rtu_frame_t;
+
+// The frames without CRC, the CRC is appended by the test
+static const test_rtu_frame_t test_frames[] = {
+    {true, 6, {0x01, 0x03, 0x00, 0x10, 0x00, 0x02}},
+    {true, 6, {0x01, 0x05, 0x00, 0x01, 0xFF, 0x00}},
+    {true, 11, {0x02, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04, 0x00, 0x0A, 0x01, 0x02}},
+    {true, 9, {0x03, 0x0F, 0x00, 0x13, 0x00, 0x0A, 0x02, 0xCD, 0x01}},
+    {true, 15, {0x04, 0x17, 0x00, 0x03, 0x00, 0x06, 0x00, 0x0E, 0x00, 0x02, 0x04, 0x00, 0xFF, 0x00, 0xFF}},
+    {true, 2, {0x05, 0x11}},
+    {false, 7, {0x01, 0x03, 0x04, 0x00, 0x0A, 0x00, 0x0B}},
+    {false, 6, {0x02, 0x10, 0x00, 0x01, 0x00, 0x02}},
+    {false, 3, {0x03, 0x83, 0x02}},
+    {false, 4, {0x04, 0x01, 0x01, 0x05}},
+    {false, 8, {0x05, 0x18, 0x00, 0x04, 0x00, 0x01, 0x12, 0x34}},
+};
+
+static uint16_t test_append_crc(const test_rtu_frame_t *test, uint8_t *buf)
+{
+    memcpy(buf, test->frame, test->len);
+    uint16_t crc = mb_crc16(buf, test->len);
+    buf[test->len] = (uint8_t)(crc & 0xFF);
+    buf[test->len + 1] = (uint8_t)(crc >> 8);
+    return (test->len + 2);
+}
+
+TEST_CASE("Test RTU frame length is inferred from the function code.", "[MB_RTU_FRAMING]")
+{
+    uint8_t buf[MB_RTU_FRAME_SIZE_MAX] = {0};
+
+    for (int i = 0; i < (sizeof(test_frames) / sizeof(test_frames[0])); i++) {
+        uint16_t frame_len = test_append_crc(&test_frames[i], buf);
+        // Feed the bytes one by one as they come from the stream
+        int len = MB_RTU_FRAME_LEN_MORE;
+        uint16_t count = 0;
+        while ((len == MB_RTU_FRAME_LEN_MORE) && (count < frame_len)) {
+            len = mb_rtu_frame_get_len(buf, ++count, test_frames[i].is_request);
+        }
+        TEST_ASSERT_EQUAL_INT(frame_len, len);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT16(frame_len, count);
+    }
+
+    // The function code which length is not known
+    buf[1] = 0x2B;
+    TEST_ASSERT_EQUAL_INT(MB_RTU_FRAME_LEN_UNKNOWN, mb_rtu_frame_get_len(buf, 4, true));
+    TEST_ASSERT_EQUAL_INT(MB_RTU_FRAME_LEN_MORE, mb_rtu_frame_get_len(buf, 1, false));
+}
+
+TEST_CASE("Test RTU frame conversion to MBAP frame and back.", "[MB_RTU_FRAMING]")
+{
+    uint8_t rtu_buf[MB_RTU_FRAME_SIZE_MAX] = {0};
+    uint8_t mbap_buf[MB_RTU_FRAME_SIZE_MAX + TEST_MBAP_HDR_SIZE] = {0};
+    uint8_t out_buf[MB_RTU_FRAME_SIZE_MAX] = {0};
+
+    for (int i = 0; i < (sizeof(test_frames) / sizeof(test_frames[0])); i++) {
+        uint16_t frame_len = test_append_crc(&test_frames[i], rtu_buf);
+        int mbap_len = mb_rtu_frame_to_mbap(rtu_buf, frame_len, 0x1234, mbap_buf, sizeof(mbap_buf));
+        TEST_ASSERT_EQUAL_INT(frame_len - 2 + TEST_MBAP_HDR_SIZE, mbap_len);
+        // TID, protocol ID, length of UID and PDU
+        TEST_ASSERT_EQUAL_HEX8(0x12, mbap_buf[0]);
+        TEST_ASSERT_EQUAL_HEX8(0x34, mbap_buf[1]);
+        TEST_ASSERT_EQUAL_HEX8(0x00, mbap_buf[2]);
+        TEST_ASSERT_EQUAL_HEX8(0x00, mbap_buf[3]);
+        TEST_ASSERT_EQUAL_UINT16(test_frames[i].len, (mbap_buf[4] << 8) | mbap_buf[5]);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(test_frames[i].frame, &mbap_buf[TEST_MBAP_HDR_SIZE], test_frames[i].len);
+
+        int rtu_len = mb_rtu_frame_from_mbap(mbap_buf, mbap_len, out_buf, sizeof(out_buf));
+        TEST_ASSERT_EQUAL_INT(frame_len, rtu_len);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(rtu_buf, out_buf, frame_len);
+    }
+
+    // The frame with incorrect CRC is rejected
+    uint16_t frame_len = test_append_crc(&test_frames[0], rtu_buf);
+    rtu_buf[frame_len - 1] ^= 0x01;
+    TEST_ASSERT_EQUAL_INT(-1, mb_rtu_frame_to_mbap(rtu_buf, frame_len, 0, mbap_buf, sizeof(mbap_buf)));
+}
@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+
+#include "sdkconfig.h"
+#include "port_serial_common.h"
+
+#if (CONFIG_FMB_COMM_MODE_ASCII_EN || CONFIG_FMB_COMM_MODE_RTU_EN)
+
+#define TEST_SLAVE_UID 0x11
+
+typedef struct {
+    mb_mode_type_t mode;
+    const char *frame;
+    uint16_t len;
+    bool is_foreign;
+} test_addr_frame_t;
+
+static const test_addr_frame_t test_frames[] = {
+    // RTU: own, foreign, broadcast, pseudo address and no address yet
+    {MB_RTU, "\x11\x03\x00\x10\x00\x02", 6, false},
+    {MB_RTU, "\x12\x03\x00\x10\x00\x02", 6, true},
+    {MB_RTU, "\x00\x06\x00\x01\x00\x03", 6, false},
+    {MB_RTU, "\xFF\x03\x00\x10\x00\x02", 6, false},
+    {MB_RTU, "\x12", 1, true},
+    {MB_RTU, "", 0, false},
+    // ASCII: own, foreign, broadcast, short header, no start and invalid characters
+    {MB_ASCII, ":1103001000025A\r\n", 17, false},
+    {MB_ASCII, ":1203001000025A\r\n", 17, true},
+    {MB_ASCII, ":000600010003F6\r\n", 17, false},
+    {MB_ASCII, ":1A03", 5, true},
+    {MB_ASCII, ":12", 3, true},
+    {MB_ASCII, ":1", 2, false},
+    {MB_ASCII, "1203001000025A", 14, false},
+    {MB_ASCII, ":G203", 5, false},
+};
+
+TEST_CASE("Test serial early address filter frames", "[MB_SER_ADDR_FILTER]")
+{
+    for (int idx = 0; idx < (int)(sizeof(test_frames) / sizeof(test_frames[0])); idx++) {
+        const test_addr_frame_t *test = &test_frames[idx];
+        const uint8_t *frame = (const uint8_t *)test->frame;
+        char msg[32];
+        snprintf(msg, sizeof(msg), "frame #%d", idx);
+        TEST_ASSERT_EQUAL_MESSAGE(test->is_foreign,
+                                    mb_port_ser_is_foreign_frame(test->mode, TEST_SLAVE_UID, frame, 0, test->len),
+                                    msg);
+    }
+}
+
+TEST_CASE("Test serial early address filter chunks", "[MB_SER_ADDR_FILTER]")
+{
+    const uint8_t *rtu_frame = (const uint8_t *)"\x12\x03\x00\x10\x00\x02";
+    const uint8_t *ascii_frame = (const uint8_t *)":1203001000025A\r\n";
+    // The address is checked only by the call which receives it
+    TEST_ASSERT_TRUE(mb_port_ser_is_foreign_frame(MB_RTU, TEST_SLAVE_UID, rtu_frame, 0, 1));
+    TEST_ASSERT_FALSE(mb_port_ser_is_foreign_frame(MB_RTU, TEST_SLAVE_UID, rtu_frame, 1, 6));
+    // The ASCII header received in parts
+    TEST_ASSERT_FALSE(mb_port_ser_is_foreign_frame(MB_ASCII, TEST_SLAVE_UID, ascii_frame, 0, 1));
+    TEST_ASSERT_FALSE(mb_port_ser_is_foreign_frame(MB_ASCII, TEST_SLAVE_UID, ascii_frame, 1, 2));
+    TEST_ASSERT_TRUE(mb_port_ser_is_foreign_frame(MB_ASCII, TEST_SLAVE_UID, ascii_frame, 2, 3));
+    TEST_ASSERT_FALSE(mb_port_ser_is_foreign_frame(MB_ASCII, TEST_SLAVE_UID, ascii_frame, 3, 17));
+}
+
+#endif
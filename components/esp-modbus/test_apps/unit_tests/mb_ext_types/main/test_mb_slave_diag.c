@@ -0,0 +1,282 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+
+#include "sdkconfig.h"
+#include "mb_common.h"
+#include "mb_proto.h"
+#include "mb_func.h"
+#include "transport_common.h"
+
+#if CONFIG_FMB_CONTROLLER_SLAVE_DIAG_SUPPORT
+
+#define TEST_SLAVE_UID          (1)
+#define TEST_SLAVE_UART_PORT    (UART_NUM_1)
+#define TEST_FRAME_SIZE         (MB_PDU_DATA_OFF + 7 + MB_DIAG_EVENT_LOG_SIZE)
+
+static mb_port_base_t test_port = {
+    .descr = {.parent_name = "test_slave_diag", .obj_name = "test_slave_diag"}
+};
+
+static mb_base_t test_base = {
+    .port_obj = &test_port
+};
+
+// The request is placed into the frame and the handler result is checked by the caller
+static mb_exception_t test_diag_request(uint8_t *frame, uint16_t *len, uint16_t sub_func, uint16_t data)
+{
+    frame[MB_PDU_FUNC_OFF] = MB_FUNC_DIAG_DIAGNOSTIC;
+    frame[MB_PDU_DATA_OFF] = (uint8_t)(sub_func >> 8);
+    frame[MB_PDU_DATA_OFF + 1] = (uint8_t)(sub_func & 0xFF);
+    frame[MB_PDU_DATA_OFF + 2] = (uint8_t)(data >> 8);
+    frame[MB_PDU_DATA_OFF + 3] = (uint8_t)(data & 0xFF);
+    *len = 5;
+    return mbs_fn_diag_diagnostic(&test_base, frame, len);
+}
+
+TEST_CASE("Test slave diagnostics function handler.", "[MB_SLAVE_DIAG]")
+{
+    uint8_t frame[TEST_FRAME_SIZE] = {0};
+    uint16_t len = 0;
+    mb_port_diag_restart(&test_port, true);
+
+    // The query data is echoed with any length
+    const uint8_t echo_req[] = {MB_FUNC_DIAG_DIAGNOSTIC, 0x00, 0x00, 0x12, 0x34, 0x56};
+    memcpy(frame, echo_req, sizeof(echo_req));
+    len = sizeof(echo_req);
+    TEST_ASSERT_EQUAL(MB_EX_NONE, mbs_fn_diag_diagnostic(&test_base, frame, &len));
+    TEST_ASSERT_EQUAL_UINT16(sizeof(echo_req), len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(echo_req, frame, sizeof(echo_req));
+
+    // The counters are returned in the data field of the response
+    for (int i = 0; i < 3; i++) {
+        MB_DIAG_INC(&test_port, MB_DIAG_BUS_MSG_CNT);
+    }
+    TEST_ASSERT_EQUAL(MB_EX_NONE, test_diag_request(frame, &len, MB_DIAG_SUB_BUS_MSG_CNT, 0));
+    TEST_ASSERT_EQUAL_UINT16(5, len);
+    TEST_ASSERT_EQUAL_HEX8(MB_FUNC_DIAG_DIAGNOSTIC, frame[MB_PDU_FUNC_OFF]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, frame[MB_PDU_DATA_OFF]);
+    TEST_ASSERT_EQUAL_HEX8(MB_DIAG_SUB_BUS_MSG_CNT, frame[MB_PDU_DATA_OFF + 1]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, frame[MB_PDU_DATA_OFF + 2]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, frame[MB_PDU_DATA_OFF + 3]);
+    TEST_ASSERT_EQUAL(MB_EX_NONE, test_diag_request(frame, &len, MB_DIAG_SUB_RETURN_DIAG_REG, 0));
+    TEST_ASSERT_EQUAL_HEX8(0x00, frame[MB_PDU_DATA_OFF + 3]);
+    TEST_ASSERT_EQUAL(MB_EX_NONE, test_diag_request(frame, &len, MB_DIAG_SUB_CLEAR_COUNTERS, 0));
+    TEST_ASSERT_EQUAL_UINT16(0, mb_port_diag_get_counter(&test_port, MB_DIAG_BUS_MSG_CNT));
+
+    // The unsupported sub-functions are rejected
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_FUNCTION, test_diag_request(frame, &len, 0x03, 0));
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_FUNCTION, test_diag_request(frame, &len, 0x13, 0));
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_FUNCTION, test_diag_request(frame, &len, 0x15, 0));
+
+    // The data field must be zero, the restart also accepts the clear log value
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_DATA_VALUE, test_diag_request(frame, &len, MB_DIAG_SUB_BUS_MSG_CNT, 0x0001));
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_DATA_VALUE, test_diag_request(frame, &len, MB_DIAG_SUB_FORCE_LISTEN_ONLY, 0xFF00));
+    TEST_ASSERT_FALSE(mb_port_diag_is_listen_only(&test_port));
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_DATA_VALUE, test_diag_request(frame, &len, MB_DIAG_SUB_RESTART_COMM, 0x1234));
+    TEST_ASSERT_EQUAL(MB_EX_NONE, test_diag_request(frame, &len, MB_DIAG_SUB_RESTART_COMM, 0xFF00));
+    TEST_ASSERT_EQUAL(MB_EX_NONE, test_diag_request(frame, &len, MB_DIAG_SUB_RESTART_COMM, 0x0000));
+
+    // The length is checked for all sub-functions except the echo
+    (void)test_diag_request(frame, &len, MB_DIAG_SUB_BUS_MSG_CNT, 0);
+    len = 4;
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_DATA_VALUE, mbs_fn_diag_diagnostic(&test_base, frame, &len));
+    len = 2;
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_DATA_VALUE, mbs_fn_diag_diagnostic(&test_base, frame, &len));
+
+    mb_base_t no_port_base = {.port_obj = NULL};
+    len = 5;
+    TEST_ASSERT_EQUAL(MB_EX_SLAVE_DEVICE_FAILURE, mbs_fn_diag_diagnostic(&no_port_base, frame, &len));
+}
+
+TEST_CASE("Test slave comm event counter and log handlers.", "[MB_SLAVE_DIAG]")
+{
+    uint8_t frame[TEST_FRAME_SIZE] = {0};
+    uint16_t len = 0;
+    mb_port_diag_restart(&test_port, true);
+    MB_DIAG_INC(&test_port, MB_DIAG_COMM_EVENT_CNT);
+    MB_DIAG_INC(&test_port, MB_DIAG_COMM_EVENT_CNT);
+    MB_DIAG_INC(&test_port, MB_DIAG_BUS_MSG_CNT);
+    mb_port_diag_rcv_event(&test_port, false, false);
+    mb_port_diag_send_event(&test_port, MB_EX_ILLEGAL_DATA_ADDRESS);
+
+    // Status word (ready) and the event counter
+    frame[MB_PDU_FUNC_OFF] = MB_FUNC_DIAG_GET_COM_EVENT_CNT;
+    len = 1;
+    TEST_ASSERT_EQUAL(MB_EX_NONE, mbs_fn_diag_get_comm_event_cnt(&test_base, frame, &len));
+    TEST_ASSERT_EQUAL_UINT16(5, len);
+    const uint8_t cnt_resp[] = {MB_FUNC_DIAG_GET_COM_EVENT_CNT, 0x00, 0x00, 0x00, 0x02};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(cnt_resp, frame, sizeof(cnt_resp));
+    len = 2;
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_DATA_VALUE, mbs_fn_diag_get_comm_event_cnt(&test_base, frame, &len));
+
+    // Byte count, status, event counter, message counter and the events, the most recent first
+    frame[MB_PDU_FUNC_OFF] = MB_FUNC_DIAG_GET_COM_EVENT_LOG;
+    len = 1;
+    TEST_ASSERT_EQUAL(MB_EX_NONE, mbs_fn_diag_get_comm_event_log(&test_base, frame, &len));
+    TEST_ASSERT_EQUAL_UINT16(MB_PDU_DATA_OFF + 7 + 3, len);
+    const uint8_t log_resp[] = {MB_FUNC_DIAG_GET_COM_EVENT_LOG, 6 + 3, 0x00, 0x00, 0x00, 0x02, 0x00, 0x01,
+                                (MB_DIAG_EV_SEND | MB_DIAG_EV_SEND_READ_EX), MB_DIAG_EV_RCV, MB_DIAG_EV_RESTART};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(log_resp, frame, sizeof(log_resp));
+    len = 3;
+    TEST_ASSERT_EQUAL(MB_EX_ILLEGAL_DATA_VALUE, mbs_fn_diag_get_comm_event_log(&test_base, frame, &len));
+
+    // The log is limited by its size
+    for (int i = 0; i < MB_DIAG_EVENT_LOG_SIZE; i++) {
+        mb_port_diag_rcv_event(&test_port, false, false);
+    }
+    len = 1;
+    TEST_ASSERT_EQUAL(MB_EX_NONE, mbs_fn_diag_get_comm_event_log(&test_base, frame, &len));
+    TEST_ASSERT_EQUAL_UINT16(MB_PDU_DATA_OFF + 7 + MB_DIAG_EVENT_LOG_SIZE, len);
+    TEST_ASSERT_EQUAL_UINT8(6 + MB_DIAG_EVENT_LOG_SIZE, frame[MB_PDU_DATA_OFF]);
+}
+
+// The transport methods of the slave object are replaced to feed the requests to mbs_poll()
+static uint8_t test_req_frame[TEST_FRAME_SIZE];
+static uint16_t test_req_len;
+static uint16_t test_resp_len;
+static uint8_t test_resp_frame[TEST_FRAME_SIZE];
+static int test_send_cnt;
+
+static void test_transp_start_stop(mb_trans_base_t *transport)
+{
+    (void)transport;
+}
+
+static mb_err_enum_t test_transp_rcv(mb_trans_base_t *transport, uint8_t *rcv_addr_buf, uint8_t **frame_buf, uint16_t *len_buf)
+{
+    *rcv_addr_buf = TEST_SLAVE_UID;
+    *frame_buf = test_req_frame;
+    *len_buf = test_req_len;
+    return MB_ENOERR;
+}
+
+static mb_err_enum_t test_transp_send(mb_trans_base_t *transport, uint8_t slv_addr, const uint8_t *frame_ptr, uint16_t len)
+{
+    memcpy(test_resp_frame, frame_ptr, len);
+    test_resp_len = len;
+    test_send_cnt++;
+    return MB_ENOERR;
+}
+
+static mb_base_t *test_slave_start(mb_base_t *inst)
+{
+    TEST_ASSERT_NOT_NULL(inst);
+    inst->transp_obj->frm_start = test_transp_start_stop;
+    inst->transp_obj->frm_stop = test_transp_start_stop;
+    inst->transp_obj->frm_rcv = test_transp_rcv;
+    inst->transp_obj->frm_send = test_transp_send;
+    TEST_ASSERT_EQUAL(MB_ENOERR, inst->enable(inst));
+    mb_port_diag_restart(inst->port_obj, true);
+    return inst;
+}
+
+static void test_slave_stop(mb_base_t *inst)
+{
+    TEST_ASSERT_EQUAL(MB_ENOERR, inst->disable(inst));
+    TEST_ASSERT_EQUAL(MB_ENOERR, inst->delete(inst));
+}
+
+// Returns true if the request is responded, the events of the sent response are processed as well
+static bool test_slave_request(mb_base_t *inst, const uint8_t *req, uint16_t len)
+{
+    memcpy(test_req_frame, req, len);
+    test_req_len = len;
+    test_resp_len = 0;
+    int send_cnt = test_send_cnt;
+    TEST_ASSERT_TRUE(mb_port_event_post(inst->port_obj, EVENT(EV_FRAME_RECEIVED, len)));
+    TEST_ASSERT_EQUAL(MB_ENOERR, inst->poll(inst));
+    TEST_ASSERT_EQUAL(MB_ENOERR, inst->poll(inst));
+    if (test_send_cnt == send_cnt) {
+        return false;
+    }
+    // EV_FRAME_SENT and EV_ERROR_PROCESS
+    TEST_ASSERT_EQUAL(MB_ENOERR, inst->poll(inst));
+    TEST_ASSERT_EQUAL(MB_ENOERR, inst->poll(inst));
+    return true;
+}
+
+#if CONFIG_FMB_COMM_MODE_RTU_EN
+
+TEST_CASE("Test slave listen only mode.", "[MB_SLAVE_DIAG]")
+{
+    mb_serial_opts_t ser_opts = {
+        .mode = MB_RTU,
+        .port = TEST_SLAVE_UART_PORT,
+        .uid = TEST_SLAVE_UID,
+        .response_tout_ms = 1000,
+        .baudrate = 115200,
+        .data_bits = UART_DATA_8_BITS,
+        .stop_bits = UART_STOP_BITS_1,
+        .parity = UART_PARITY_DISABLE
+    };
+    void *inst = &ser_opts;
+    TEST_ASSERT_EQUAL(MB_ENOERR, mbs_rtu_create(&ser_opts, &inst));
+    mb_base_t *slave = test_slave_start((mb_base_t *)inst);
+
+    const uint8_t echo_req[] = {MB_FUNC_DIAG_DIAGNOSTIC, 0x00, MB_DIAG_SUB_RETURN_QUERY_DATA, 0xAB, 0xCD};
+    const uint8_t listen_req[] = {MB_FUNC_DIAG_DIAGNOSTIC, 0x00, MB_DIAG_SUB_FORCE_LISTEN_ONLY, 0x00, 0x00};
+    const uint8_t restart_req[] = {MB_FUNC_DIAG_DIAGNOSTIC, 0x00, MB_DIAG_SUB_RESTART_COMM, 0x00, 0x00};
+    TEST_ASSERT_TRUE(test_slave_request(slave, echo_req, sizeof(echo_req)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(echo_req, test_resp_frame, sizeof(echo_req));
+
+    // The force listen only request itself is not responded
+    TEST_ASSERT_FALSE(test_slave_request(slave, listen_req, sizeof(listen_req)));
+    TEST_ASSERT_TRUE(mb_port_diag_is_listen_only(slave->port_obj));
+
+    // The requests are monitored but not executed and not responded
+    TEST_ASSERT_FALSE(test_slave_request(slave, echo_req, sizeof(echo_req)));
+    TEST_ASSERT_FALSE(test_slave_request(slave, echo_req, sizeof(echo_req)));
+    TEST_ASSERT_TRUE(mb_port_diag_is_listen_only(slave->port_obj));
+    TEST_ASSERT_EQUAL_UINT16(3, mb_port_diag_get_counter(slave->port_obj, MB_DIAG_SLAVE_NO_RESP_CNT));
+    TEST_ASSERT_EQUAL_UINT16(4, mb_port_diag_get_counter(slave->port_obj, MB_DIAG_SLAVE_MSG_CNT));
+
+    // The restart leaves the listen only mode, the restart request is not responded
+    TEST_ASSERT_FALSE(test_slave_request(slave, restart_req, sizeof(restart_req)));
+    TEST_ASSERT_FALSE(mb_port_diag_is_listen_only(slave->port_obj));
+    TEST_ASSERT_TRUE(test_slave_request(slave, echo_req, sizeof(echo_req)));
+    TEST_ASSERT_EQUAL_UINT16(sizeof(echo_req), test_resp_len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(echo_req, test_resp_frame, sizeof(echo_req));
+
+    test_slave_stop(slave);
+}
+
+#endif
+
+#if CONFIG_FMB_COMM_MODE_TCP_EN
+
+TEST_CASE("Test slave rejects listen only mode over TCP.", "[MB_SLAVE_DIAG]")
+{
+    mb_tcp_opts_t tcp_opts = {
+        .mode = MB_TCP,
+        .port = MB_TCP_DEFAULT_PORT,
+        .uid = TEST_SLAVE_UID,
+        .response_tout_ms = 1000,
+        .addr_type = MB_IPV4,
+        .ip_addr_table = NULL,
+        .ip_netif_ptr = NULL
+    };
+    void *inst = &tcp_opts;
+    TEST_ASSERT_EQUAL(MB_ENOERR, mbs_tcp_create(&tcp_opts, &inst));
+    mb_base_t *slave = test_slave_start((mb_base_t *)inst);
+
+    const uint8_t listen_req[] = {MB_FUNC_DIAG_DIAGNOSTIC, 0x00, MB_DIAG_SUB_FORCE_LISTEN_ONLY, 0x00, 0x00};
+    const uint8_t exception_resp[] = {(MB_FUNC_DIAG_DIAGNOSTIC | MB_FUNC_ERROR), MB_EX_ILLEGAL_FUNCTION};
+    TEST_ASSERT_TRUE(test_slave_request(slave, listen_req, sizeof(listen_req)));
+    TEST_ASSERT_EQUAL_UINT16(sizeof(exception_resp), test_resp_len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(exception_resp, test_resp_frame, sizeof(exception_resp));
+    TEST_ASSERT_FALSE(mb_port_diag_is_listen_only(slave->port_obj));
+    TEST_ASSERT_EQUAL_UINT16(1, mb_port_diag_get_counter(slave->port_obj, MB_DIAG_BUS_EXCEPTION_CNT));
+
+    test_slave_stop(slave);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_private/esp_timer_private.h"
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "sdkconfig.h"
+#include "port_timer_wheel.h"
+
+#define TAG "MB_TIMER_WHEEL_TEST"
+
+#define TEST_TIMER_CNT 10
+#define TEST_TICK_US 50
+// The timer is not expected earlier than the timeout, the latency of the timer service is allowed
+#define TEST_LATENCY_MAX_US 2000
+// The span of the four wheel levels in ticks, the longer timers are kept in the overflow list
+#define TEST_WHEEL_SPAN_TICKS (1ULL << 24)
+
+typedef struct {
+    mb_timer_wheel_entry_t entry;
+    uint64_t start_us;
+    uint64_t timeout_us;
+    int64_t expired_us;
+    int order;
+} test_timer_t;
+
+static test_timer_t test_timers[TEST_TIMER_CNT];
+static volatile int test_expired_cnt = 0;
+
+static void test_timer_cb(void *arg)
+{
+    test_timer_t *timer = (test_timer_t *)arg;
+    timer->expired_us = esp_timer_get_time();
+    timer->order = test_expired_cnt++;
+}
+
+static void test_timers_attach(void)
+{
+    memset(test_timers, 0, sizeof(test_timers));
+    test_expired_cnt = 0;
+    for (int i = 0; i < TEST_TIMER_CNT; i++) {
+        TEST_ASSERT_EQUAL(MB_ENOERR, mb_timer_wheel_attach(&test_timers[i].entry, test_timer_cb, &test_timers[i]));
+    }
+}
+
+static void test_timers_detach(void)
+{
+    for (int i = 0; i < TEST_TIMER_CNT; i++) {
+        mb_timer_wheel_detach(&test_timers[i].entry);
+    }
+}
+
+TEST_CASE("Test shared timer wheel expiration order and cancel.", "[MB_TIMER_WHEEL]")
+{
+    test_timers_attach();
+    // The timeouts cover the all levels of the wheel, the timers are started in reverse order
+    static const uint64_t timeouts_us[TEST_TIMER_CNT] = {
+        50, 750, 1750, 3500, 20000, 100000, 250000, 400000, 600000, 1000000
+    };
+    for (int i = (TEST_TIMER_CNT - 1); i >= 0; i--) {
+        test_timers[i].timeout_us = timeouts_us[i];
+        test_timers[i].start_us = esp_timer_get_time();
+        test_timers[i].expired_us = -1;
+        mb_timer_wheel_arm(&test_timers[i].entry, timeouts_us[i]);
+        TEST_ASSERT_TRUE(mb_timer_wheel_is_armed(&test_timers[i].entry));
+    }
+    // Cancel one timer and restart the other one with the longer timeout
+    mb_timer_wheel_cancel(&test_timers[5].entry);
+    TEST_ASSERT_FALSE(mb_timer_wheel_is_armed(&test_timers[5].entry));
+    test_timers[3].start_us = esp_timer_get_time();
+    test_timers[3].timeout_us = 500000;
+    mb_timer_wheel_arm(&test_timers[3].entry, test_timers[3].timeout_us);
+
+    vTaskDelay(pdMS_TO_TICKS(1200));
+    TEST_ASSERT_EQUAL_INT(TEST_TIMER_CNT - 1, test_expired_cnt);
+    TEST_ASSERT_EQUAL_INT64(-1, test_timers[5].expired_us);
+    int prev_order = -1;
+    static const int expire_order[] = {0, 1, 2, 4, 6, 7, 3, 8, 9};
+    for (int i = 0; i < (sizeof(expire_order) / sizeof(expire_order[0])); i++) {
+        test_timer_t *timer = &test_timers[expire_order[i]];
+        TEST_ASSERT_FALSE(mb_timer_wheel_is_armed(&timer->entry));
+        TEST_ASSERT_GREATER_THAN_INT(prev_order, timer->order);
+        prev_order = timer->order;
+        uint64_t elapsed_us = (uint64_t)(timer->expired_us - timer->start_us);
+        ESP_LOGI(TAG, "timer #%d, timeout: %" PRIu64 " us, expired: %" PRIu64 " us.",
+                    expire_order[i], timer->timeout_us, elapsed_us);
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT64(timer->timeout_us, elapsed_us);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64(timer->timeout_us + TEST_TICK_US + TEST_LATENCY_MAX_US, elapsed_us);
+    }
+    test_timers_detach();
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+
+TEST_CASE("Test shared timer wheel overflow list.", "[MB_TIMER_WHEEL]")
+{
+    mb_timer_wheel_stats_t start_stats = {0};
+    mb_timer_wheel_stats_t stats = {0};
+    test_timers_attach();
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_timer_wheel_get_stats(&start_stats));
+    // The timer stays in the overflow list when the wheel passes the span boundary
+    test_timers[0].expired_us = -1;
+    mb_timer_wheel_arm(&test_timers[0].entry, 2 * TEST_WHEEL_SPAN_TICKS * TEST_TICK_US + 1000000);
+    // Move the time close to the next span boundary, the short timer crosses it
+    uint64_t now_tick = (uint64_t)esp_timer_get_time() / TEST_TICK_US;
+    uint64_t boundary_us = (((now_tick / TEST_WHEEL_SPAN_TICKS) + 1) * TEST_WHEEL_SPAN_TICKS) * TEST_TICK_US;
+    esp_timer_private_advance((int64_t)(boundary_us - 10000) - esp_timer_get_time());
+    test_timers[1].start_us = esp_timer_get_time();
+    test_timers[1].timeout_us = 50000;
+    test_timers[1].expired_us = -1;
+    mb_timer_wheel_arm(&test_timers[1].entry, test_timers[1].timeout_us);
+
+    vTaskDelay(pdMS_TO_TICKS(200));
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_timer_wheel_get_stats(&stats));
+    TEST_ASSERT_EQUAL_INT(1, test_expired_cnt);
+    TEST_ASSERT_FALSE(mb_timer_wheel_is_armed(&test_timers[1].entry));
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT64(test_timers[1].timeout_us,
+                                        (uint64_t)(test_timers[1].expired_us - test_timers[1].start_us));
+    TEST_ASSERT_TRUE(mb_timer_wheel_is_armed(&test_timers[0].entry));
+    TEST_ASSERT_EQUAL_INT64(-1, test_timers[0].expired_us);
+    // Both timers are moved out of the overflow list at the boundary
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(2, stats.cascade_count - start_stats.cascade_count);
+    test_timers_detach();
+}
+
+#endif
+
+TEST_CASE("Test shared timer wheel overhead.", "[MB_TIMER_WHEEL]")
+{
+    mb_timer_wheel_stats_t start_stats = {0};
+    mb_timer_wheel_stats_t stats = {0};
+    test_timers_attach();
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_timer_wheel_get_stats(&start_stats));
+    // The timers are restarted as the T3.5 and response timers of busy instances
+    uint64_t start_us = esp_timer_get_time();
+    int expired_cnt = 0;
+    while ((esp_timer_get_time() - start_us) < 1000000) {
+        for (int i = 0; i < TEST_TIMER_CNT; i++) {
+            if (!mb_timer_wheel_is_armed(&test_timers[i].entry)) {
+                mb_timer_wheel_arm(&test_timers[i].entry, 1750 + (i * 1000));
+                expired_cnt++;
+            }
+        }
+        vTaskDelay(1);
+    }
+    // The statistic is reset when the service is stopped with the last timer
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_timer_wheel_get_stats(&stats));
+    test_timers_detach();
+    uint32_t wakeups = stats.wakeup_count - start_stats.wakeup_count;
+    uint64_t busy_us = stats.busy_time_us - start_stats.busy_time_us;
+    uint64_t run_us = stats.run_time_us - start_stats.run_time_us;
+    TEST_ASSERT_GREATER_THAN_UINT32(0, wakeups);
+    ESP_LOGI(TAG, "timers: %d, restarts: %d, expired: %" PRIu32 ", cascaded: %" PRIu32,
+                TEST_TIMER_CNT, expired_cnt, stats.expired_count - start_stats.expired_count,
+                stats.cascade_count - start_stats.cascade_count);
+    ESP_LOGI(TAG, "wakeups: %" PRIu32 " (%" PRIu64 " per second), busy time: %" PRIu64 " us, %" PRIu64 " us per wakeup, max: %" PRIu32 " us.",
+                wakeups, run_us ? (((uint64_t)wakeups * 1000000) / run_us) : 0,
+                busy_us, (busy_us / wakeups), stats.busy_time_max_us);
+}
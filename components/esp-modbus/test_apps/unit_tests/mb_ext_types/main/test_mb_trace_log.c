@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_utils.h"
+#include "esp_log.h"
+
+#include "sdkconfig.h"
+#include "port_common.h"
+
+#define TAG "MB_TRACE_LOG_TEST"
+
+// The cost of the messages is measured by the trace_log group of the mb_microbench application
+
+TEST_CASE("Test hot path log arguments are not evaluated above the compiled level.", "[MB_TRACE_LOG]")
+{
+    int evaluated = 0;
+    MB_TRACE(CONFIG_FMB_TRACE_LEVEL + 1, TAG, "skipped message %d.", ++evaluated);
+    TEST_ASSERT_EQUAL(0, evaluated);
+#if CONFIG_FMB_TRACE_DEFERRED_EN
+    (void)mb_trace_log_flush(0);
+#endif
+    MB_TRACE(ESP_LOG_ERROR, TAG, "logged message %d.", ++evaluated);
+    TEST_ASSERT_EQUAL(1, evaluated);
+#if CONFIG_FMB_TRACE_DEFERRED_EN
+    TEST_ASSERT_EQUAL(1, mb_trace_log_flush(0));
+#endif
+}
+
+#if CONFIG_FMB_TRACE_DEFERRED_EN
+
+static char test_output[512];
+static size_t test_output_len;
+
+static int test_log_capture(const char *format, va_list args)
+{
+    if (test_output_len < sizeof(test_output)) {
+        int len = vsnprintf(&test_output[test_output_len], sizeof(test_output) - test_output_len, format, args);
+        test_output_len += (len > 0) ? len : 0;
+    }
+    return 0;
+}
+
+TEST_CASE("Test deferred log keeps the string arguments until flush.", "[MB_TRACE_LOG]")
+{
+    static const uint8_t frame[] = {0x03, 0x00, 0x00, 0x00, 0x0A};
+    char *name = strdup("mbs_tcp#0");
+    TEST_ASSERT_NOT_NULL(name);
+
+    (void)mb_trace_log_flush(0);
+    MB_TRACE(ESP_LOG_ERROR, TAG, "node #%d [%s], receive data ready.", 1, name);
+    MB_TRACE(ESP_LOG_ERROR, TAG, "%s:%s", name, (const char *)NULL);
+    MB_TRACE_BUF(TAG, name, frame, sizeof(frame), ESP_LOG_ERROR);
+    // The string is changed and released before the messages are printed
+    memset(name, 'x', strlen(name));
+    free(name);
+
+    memset(test_output, 0, sizeof(test_output));
+    test_output_len = 0;
+    vprintf_like_t prev_vprintf = esp_log_set_vprintf(test_log_capture);
+    int count = mb_trace_log_flush(0);
+    (void)esp_log_set_vprintf(prev_vprintf);
+
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_NOT_NULL(strstr(test_output, "node #1 [mbs_tcp#0], receive data ready."));
+    TEST_ASSERT_NOT_NULL(strstr(test_output, "mbs_tcp#0:(null)"));
+    TEST_ASSERT_NOT_NULL(strstr(test_output, "(5 bytes) 03 00 00 00 0a"));
+    TEST_ASSERT_NULL(strstr(test_output, "xxx"));
+    TEST_ASSERT_EQUAL(0, mb_trace_log_flush(0));
+}
+
+#endif
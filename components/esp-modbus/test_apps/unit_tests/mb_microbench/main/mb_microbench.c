@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "sdkconfig.h"
+#include "mb_microbench.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
+
+#define UBENCH_WARMUP_ROUNDS    (CONFIG_MB_UBENCH_WARMUP_ROUNDS)
+#define UBENCH_SAMPLES          (CONFIG_MB_UBENCH_SAMPLES)
+#define UBENCH_BATCH            (CONFIG_MB_UBENCH_BATCH)
+
+static uint32_t s_samples[UBENCH_SAMPLES];
+
+// The overhead of one sample (counter reads and the calls of empty kernel), calibrated on first run
+static uint32_t s_overhead = UINT32_MAX;
+
+// The counter is truncated to 32 bits, the difference is valid while one sample is shorter than the wrap period
+static inline uint32_t ubench_get_counter(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#else
+    return (uint32_t)esp_cpu_get_cycle_count();
+#endif
+}
+
+// The kernel is called through the pointer to keep the compiler from inlining or hoisting it
+static void ubench_collect(mb_ubench_fn_t fn, void *arg)
+{
+    for (int round = 0; round < UBENCH_WARMUP_ROUNDS; round++) {
+        for (int call = 0; call < UBENCH_BATCH; call++) {
+            fn(arg);
+        }
+    }
+    for (int idx = 0; idx < UBENCH_SAMPLES; idx++) {
+        uint32_t start = ubench_get_counter();
+        for (int call = 0; call < UBENCH_BATCH; call++) {
+            fn(arg);
+        }
+        s_samples[idx] = ubench_get_counter() - start;
+    }
+}
+
+static int ubench_cmp_u32(const void *a, const void *b)
+{
+    uint32_t val_a = *(const uint32_t *)a;
+    uint32_t val_b = *(const uint32_t *)b;
+    return (val_a > val_b) - (val_a < val_b);
+}
+
+// Nearest rank percentile of the sorted samples, permille is the rank in parts per thousand
+static uint32_t ubench_percentile(const uint32_t *sorted, int count, int permille)
+{
+    int rank = (count * permille + 999) / 1000;
+    return sorted[(rank > 0) ? (rank - 1) : 0];
+}
+
+static void ubench_empty(void *arg)
+{
+    (void)arg;
+}
+
+static void ubench_calibrate(void)
+{
+    ubench_collect(ubench_empty, NULL);
+    qsort(s_samples, UBENCH_SAMPLES, sizeof(s_samples[0]), ubench_cmp_u32);
+    s_overhead = ubench_percentile(s_samples, UBENCH_SAMPLES, 500);
+}
+
+void mb_ubench_run(const char *group, const char *name, mb_ubench_fn_t fn, void *arg, mb_ubench_stats_t *stats)
+{
+    if (s_overhead == UINT32_MAX) {
+        ubench_calibrate();
+    }
+    ubench_collect(fn, arg);
+
+    double sum = 0;
+    for (int idx = 0; idx < UBENCH_SAMPLES; idx++) {
+        s_samples[idx] = (s_samples[idx] > s_overhead) ? (s_samples[idx] - s_overhead) : 0;
+        sum += s_samples[idx];
+    }
+    double mean = sum / UBENCH_SAMPLES;
+    double sq_sum = 0;
+    for (int idx = 0; idx < UBENCH_SAMPLES; idx++) {
+        sq_sum += (s_samples[idx] - mean) * (s_samples[idx] - mean);
+    }
+    qsort(s_samples, UBENCH_SAMPLES, sizeof(s_samples[0]), ubench_cmp_u32);
+
+    mb_ubench_stats_t result = {
+        .samples = UBENCH_SAMPLES,
+        .min = (float)s_samples[0] / UBENCH_BATCH,
+        .median = (float)ubench_percentile(s_samples, UBENCH_SAMPLES, 500) / UBENCH_BATCH,
+        .mean = (float)(mean / UBENCH_BATCH),
+        .stddev = (float)(sqrt(sq_sum / UBENCH_SAMPLES) / UBENCH_BATCH),
+        .p99 = (float)ubench_percentile(s_samples, UBENCH_SAMPLES, 990) / UBENCH_BATCH,
+        .max = (float)s_samples[UBENCH_SAMPLES - 1] / UBENCH_BATCH
+    };
+
+    printf(MB_UBENCH_RESULT_PREFIX "{\"target\":\"%s\",\"group\":\"%s\",\"name\":\"%s\",\"unit\":\"%s\","
+            "\"samples\":%" PRIu32 ",\"batch\":%d,\"min\":%.1f,\"median\":%.1f,\"mean\":%.1f,"
+            "\"stddev\":%.1f,\"p99\":%.1f,\"max\":%.1f}\n",
+            CONFIG_IDF_TARGET, group, name, MB_UBENCH_UNIT, result.samples, UBENCH_BATCH,
+            result.min, result.median, result.mean, result.stddev, result.p99, result.max);
+
+    if (stats) {
+        *stats = result;
+    }
+}
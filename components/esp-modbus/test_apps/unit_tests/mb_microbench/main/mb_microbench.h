@@ -0,0 +1,60 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_IDF_TARGET_LINUX
+#define MB_UBENCH_UNIT          "ns"
+#else
+#define MB_UBENCH_UNIT          "cycles"
+#endif
+
+// The prefix of the result lines parsed by the pytest script
+#define MB_UBENCH_RESULT_PREFIX "MB_UBENCH:"
+
+/**
+ * @brief The kernel under measurement, called CONFIG_MB_UBENCH_BATCH times per sample
+ */
+typedef void (*mb_ubench_fn_t)(void *arg);
+
+/**
+ * @brief The statistics of one kernel, the values are per call in MB_UBENCH_UNIT
+ */
+typedef struct {
+    uint32_t samples;           /*!< Number of the measured samples */
+    float min;                  /*!< Minimum */
+    float median;               /*!< Median (nearest rank) */
+    float mean;                 /*!< Arithmetic mean */
+    float stddev;               /*!< Standard deviation */
+    float p99;                  /*!< 99th percentile (nearest rank) */
+    float max;                  /*!< Maximum */
+} mb_ubench_stats_t;
+
+/**
+ * @brief Measure the kernel and print the result line
+ *
+ * The kernel is executed for CONFIG_MB_UBENCH_WARMUP_ROUNDS batches first, then
+ * CONFIG_MB_UBENCH_SAMPLES batches are timed. The overhead of the counter reads and
+ * the call of an empty kernel is subtracted from each sample.
+ *
+ * @param group the group name of the kernel (crc, ascii, bits, endianness, param_data, events, stats, trace_log, handlers)
+ * @param name the name of the kernel inside of the group
+ * @param fn the kernel function
+ * @param arg the argument passed to the kernel
+ * @param stats the calculated statistics, can be NULL
+ */
+void mb_ubench_run(const char *group, const char *name, mb_ubench_fn_t fn, void *arg, mb_ubench_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
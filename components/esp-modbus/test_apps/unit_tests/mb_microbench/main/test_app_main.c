@@ -0,0 +1,23 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include "unity.h"
+#include "unity_test_runner.h"
+
+#include "sdkconfig.h"
+
+void app_main(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    // The host build runs all cases once and returns the number of failures
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    exit(UNITY_END());
+#else
+    unity_run_menu();
+#endif
+}
@@ -0,0 +1,820 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#include "sdkconfig.h"
+#include "esp_modbus_master.h"
+#include "mb_endianness_utils.h"
+#include "rtu/mbcrc.h"
+#include "ascii/ascii_lrc.h"
+#include "mb_common.h"
+#include "mb_func.h"
+#include "mb_utils.h"
+
+#include "mb_microbench.h"
+
+#define TAG "MB_UBENCH_TEST"
+
+#define TEST_FRAME_MAX_SIZE     (256)
+#define TEST_REG_NUM            (256)
+#define TEST_COIL_BYTES         (256)
+#define TEST_PARAM_MAX_SIZE     (32)
+
+// The workaround to statically link whole test library
+__attribute__((unused)) bool mb_test_include_ubench_impl = true;
+
+// The results of kernels are stored here to keep the compiler from removing the calls
+static volatile union {
+    int8_t i8;
+    uint8_t u8;
+    int16_t i16;
+    uint16_t u16;
+    int32_t i32;
+    uint32_t u32;
+    int64_t i64;
+    uint64_t u64;
+    float f;
+    double d;
+    int status;
+} test_sink;
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* CRC16 */
+
+typedef struct {
+    uint8_t *buf;
+    uint16_t len;
+} test_crc_arg_t;
+
+static void test_ubench_crc16(void *arg)
+{
+    test_crc_arg_t *crc_arg = (test_crc_arg_t *)arg;
+    test_sink.u16 = mb_crc16(crc_arg->buf, crc_arg->len);
+}
+
+// The bit-wise CRC16 calculation as defined in the Modbus over serial line specification, the baseline
+static void test_ubench_crc16_bitwise(void *arg)
+{
+    test_crc_arg_t *crc_arg = (test_crc_arg_t *)arg;
+    const uint8_t *frame_ptr = crc_arg->buf;
+    uint16_t crc = 0xFFFF;
+    for (uint16_t len = crc_arg->len; len; len--) {
+        crc ^= *(frame_ptr++);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x0001) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+        }
+    }
+    test_sink.u16 = crc;
+}
+
+TEST_CASE("Microbenchmark of CRC16 calculation.", "[MB_UBENCH]")
+{
+    static const uint16_t test_lengths[] = {8, 64, 256};
+    uint8_t *frame = calloc(1, TEST_FRAME_MAX_SIZE);
+    TEST_ASSERT(frame);
+    for (int i = 0; i < TEST_FRAME_MAX_SIZE; i++) {
+        frame[i] = (uint8_t)rand();
+    }
+
+    // The check value of CRC-16/MODBUS
+    TEST_ASSERT_EQUAL_HEX16(0x4B37, mb_crc16((uint8_t *)"123456789", 9));
+
+    for (int i = 0; i < (sizeof(test_lengths) / sizeof(test_lengths[0])); i++) {
+        char name[32];
+        test_crc_arg_t crc_arg = {.buf = frame, .len = test_lengths[i]};
+        snprintf(name, sizeof(name), "mb_crc16/%u", (unsigned)test_lengths[i]);
+        mb_ubench_run("crc", name, test_ubench_crc16, &crc_arg, NULL);
+        snprintf(name, sizeof(name), "crc16_bitwise/%u", (unsigned)test_lengths[i]);
+        mb_ubench_run("crc", name, test_ubench_crc16_bitwise, &crc_arg, NULL);
+    }
+    free(frame);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* ASCII framing */
+
+#define TEST_ASCII_FRAME_MAX_SIZE   ((TEST_FRAME_MAX_SIZE * 2) + 5)
+
+typedef struct {
+    uint8_t *buf;
+    uint8_t *work;
+    uint16_t len;
+} test_ascii_arg_t;
+
+static void test_ubench_lrc(void *arg)
+{
+    test_ascii_arg_t *ascii_arg = (test_ascii_arg_t *)arg;
+    test_sink.u8 = mb_lrc(ascii_arg->buf, ascii_arg->len);
+}
+
+// The byte-wise LRC calculation as defined in the Modbus over serial line specification, the baseline
+static void test_ubench_lrc_bytewise(void *arg)
+{
+    test_ascii_arg_t *ascii_arg = (test_ascii_arg_t *)arg;
+    uint8_t lrc = 0;
+    for (uint16_t idx = 0; idx < ascii_arg->len; idx++) {
+        lrc += ascii_arg->buf[idx];
+    }
+    test_sink.u8 = (uint8_t)(-lrc);
+}
+
+// The frame is decoded in place, so each call encodes it first
+static void test_ubench_ascii_encode_decode(void *arg)
+{
+    test_ascii_arg_t *ascii_arg = (test_ascii_arg_t *)arg;
+    int frame_len = mb_ascii_set_buf(ascii_arg->buf, ascii_arg->work, ascii_arg->len);
+    test_sink.i32 = mb_ascii_get_binary_buf(ascii_arg->work, frame_len);
+}
+
+static uint8_t test_char2bin_reference(uint8_t char_val)
+{
+    if ((char_val >= '0') && (char_val <= '9')) {
+        return (uint8_t)(char_val - '0');
+    } else if ((char_val >= 'A') && (char_val <= 'F')) {
+        return (uint8_t)(char_val - 'A' + 0x0A);
+    }
+    return 0xFF;
+}
+
+static uint8_t test_bin2char_reference(uint8_t byte_val)
+{
+    return (byte_val <= 0x09) ? (uint8_t)('0' + byte_val) : (uint8_t)(byte_val - 0x0A + 'A');
+}
+
+// The character by character conversion with the branches, the baseline
+static void test_ubench_ascii_encode_decode_bytewise(void *arg)
+{
+    test_ascii_arg_t *ascii_arg = (test_ascii_arg_t *)arg;
+    uint8_t *frame = ascii_arg->work;
+    int frm_idx = 1;
+    uint8_t lrc = 0;
+    frame[0] = MB_ASCII_START;
+    for (int bin_idx = 0; bin_idx < ascii_arg->len; bin_idx++) {
+        frame[frm_idx++] = test_bin2char_reference((uint8_t)(ascii_arg->buf[bin_idx] >> 4));
+        frame[frm_idx++] = test_bin2char_reference((uint8_t)(ascii_arg->buf[bin_idx] & 0x0F));
+        lrc += ascii_arg->buf[bin_idx];
+    }
+    lrc = (uint8_t)(-lrc);
+    frame[frm_idx++] = test_bin2char_reference((uint8_t)(lrc >> 4));
+    frame[frm_idx++] = test_bin2char_reference((uint8_t)(lrc & 0x0F));
+    frame[frm_idx++] = MB_ASCII_CR;
+    frame[frm_idx++] = MB_ASCII_LF;
+    int bin_idx = 0;
+    lrc = 0;
+    for (int str_idx = 1; (str_idx < frm_idx) && (frame[str_idx] > ' '); str_idx += 2) {
+        frame[bin_idx] = (uint8_t)(test_char2bin_reference(frame[str_idx]) << 4);
+        frame[bin_idx] |= test_char2bin_reference(frame[str_idx + 1]);
+        lrc += frame[bin_idx++];
+    }
+    test_sink.i32 = (lrc == 0) ? bin_idx : -1;
+}
+
+TEST_CASE("Microbenchmark of ASCII framing.", "[MB_UBENCH]")
+{
+    // The binary sizes from the shortest frame to the maximum of 513 characters
+    static const uint16_t test_lengths[] = {2, 30, 126, 254};
+    uint8_t *data = calloc(1, TEST_FRAME_MAX_SIZE);
+    uint8_t *work = calloc(1, TEST_ASCII_FRAME_MAX_SIZE);
+    TEST_ASSERT(data && work);
+    for (int i = 0; i < TEST_FRAME_MAX_SIZE; i++) {
+        data[i] = (uint8_t)rand();
+    }
+
+    for (int i = 0; i < (sizeof(test_lengths) / sizeof(test_lengths[0])); i++) {
+        char name[40];
+        test_ascii_arg_t ascii_arg = {.buf = data, .work = work, .len = test_lengths[i]};
+        // The decoded frame includes the LRC byte
+        test_ubench_ascii_encode_decode(&ascii_arg);
+        TEST_ASSERT_EQUAL_INT(test_lengths[i] + 1, test_sink.i32);
+        snprintf(name, sizeof(name), "mb_lrc/%u", (unsigned)test_lengths[i]);
+        mb_ubench_run("ascii", name, test_ubench_lrc, &ascii_arg, NULL);
+        snprintf(name, sizeof(name), "lrc_bytewise/%u", (unsigned)test_lengths[i]);
+        mb_ubench_run("ascii", name, test_ubench_lrc_bytewise, &ascii_arg, NULL);
+        snprintf(name, sizeof(name), "encode_decode/%u", (unsigned)test_lengths[i]);
+        mb_ubench_run("ascii", name, test_ubench_ascii_encode_decode, &ascii_arg, NULL);
+        snprintf(name, sizeof(name), "encode_decode_bytewise/%u", (unsigned)test_lengths[i]);
+        mb_ubench_run("ascii", name, test_ubench_ascii_encode_decode_bytewise, &ascii_arg, NULL);
+    }
+    free(work);
+    free(data);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* Bit utilities */
+
+typedef struct {
+    uint8_t buf[4];
+    uint16_t offset;
+    uint8_t num;
+    uint8_t value;
+} test_bits_arg_t;
+
+static void test_ubench_get_bits(void *arg)
+{
+    test_bits_arg_t *bits_arg = (test_bits_arg_t *)arg;
+    test_sink.u8 = mb_util_get_bits(bits_arg->buf, bits_arg->offset, bits_arg->num);
+}
+
+static void test_ubench_set_bits(void *arg)
+{
+    test_bits_arg_t *bits_arg = (test_bits_arg_t *)arg;
+    mb_util_set_bits(bits_arg->buf, bits_arg->offset, bits_arg->num, bits_arg->value);
+}
+
+TEST_CASE("Microbenchmark of bit utilities.", "[MB_UBENCH]")
+{
+    // The byte aligned access and the access crossing the byte boundary
+    test_bits_arg_t aligned = {.buf = {0}, .offset = 8, .num = 8, .value = 0xA5};
+    test_bits_arg_t unaligned = {.buf = {0}, .offset = 5, .num = 8, .value = 0xA5};
+
+    mb_util_set_bits(unaligned.buf, unaligned.offset, unaligned.num, unaligned.value);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, mb_util_get_bits(unaligned.buf, unaligned.offset, unaligned.num));
+
+    mb_ubench_run("bits", "mb_util_get_bits/aligned", test_ubench_get_bits, &aligned, NULL);
+    mb_ubench_run("bits", "mb_util_get_bits/unaligned", test_ubench_get_bits, &unaligned, NULL);
+    mb_ubench_run("bits", "mb_util_set_bits/aligned", test_ubench_set_bits, &aligned, NULL);
+    mb_ubench_run("bits", "mb_util_set_bits/unaligned", test_ubench_set_bits, &unaligned, NULL);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* Endianness conversions */
+
+#if CONFIG_FMB_EXT_TYPE_SUPPORT
+
+// Defines the get and set kernels for one conversion, the set result is the register value
+#define TEST_UBENCH_CONV(type, order, arr_type, val_type, member, val)            \
+static void test_ubench_get_##type##_##order(void *arg)                          \
+{                                                                                 \
+    test_sink.member = mb_get_##type##_##order((arr_type *)arg);                  \
+}                                                                                 \
+static void test_ubench_set_##type##_##order(void *arg)                          \
+{                                                                                 \
+    test_sink.u64 = mb_set_##type##_##order((arr_type *)arg, (val_type)(val));    \
+}
+
+#define TEST_UBENCH_CONV_ENTRY(type, order)                                       \
+    {"mb_get_" #type "_" #order, test_ubench_get_##type##_##order},               \
+    {"mb_set_" #type "_" #order, test_ubench_set_##type##_##order}
+
+TEST_UBENCH_CONV(int8, a, val_16_arr, int8_t, i8, -0x5A)
+TEST_UBENCH_CONV(int8, b, val_16_arr, int8_t, i8, -0x5A)
+TEST_UBENCH_CONV(uint8, a, val_16_arr, uint8_t, u8, 0xA5)
+TEST_UBENCH_CONV(uint8, b, val_16_arr, uint8_t, u8, 0xA5)
+TEST_UBENCH_CONV(int16, ab, val_16_arr, int16_t, i16, -0x1234)
+TEST_UBENCH_CONV(int16, ba, val_16_arr, int16_t, i16, -0x1234)
+TEST_UBENCH_CONV(uint16, ab, val_16_arr, uint16_t, u16, 0x1234)
+TEST_UBENCH_CONV(uint16, ba, val_16_arr, uint16_t, u16, 0x1234)
+TEST_UBENCH_CONV(int32, abcd, val_32_arr, int32_t, i32, -0x12345678)
+TEST_UBENCH_CONV(int32, badc, val_32_arr, int32_t, i32, -0x12345678)
+TEST_UBENCH_CONV(int32, cdab, val_32_arr, int32_t, i32, -0x12345678)
+TEST_UBENCH_CONV(int32, dcba, val_32_arr, int32_t, i32, -0x12345678)
+TEST_UBENCH_CONV(uint32, abcd, val_32_arr, uint32_t, u32, 0x12345678)
+TEST_UBENCH_CONV(uint32, badc, val_32_arr, uint32_t, u32, 0x12345678)
+TEST_UBENCH_CONV(uint32, cdab, val_32_arr, uint32_t, u32, 0x12345678)
+TEST_UBENCH_CONV(uint32, dcba, val_32_arr, uint32_t, u32, 0x12345678)
+TEST_UBENCH_CONV(float, abcd, val_32_arr, float, f, 12.34)
+TEST_UBENCH_CONV(float, badc, val_32_arr, float, f, 12.34)
+TEST_UBENCH_CONV(float, cdab, val_32_arr, float, f, 12.34)
+TEST_UBENCH_CONV(float, dcba, val_32_arr, float, f, 12.34)
+TEST_UBENCH_CONV(double, abcdefgh, val_64_arr, double, d, 12345.6789)
+TEST_UBENCH_CONV(double, hgfedcba, val_64_arr, double, d, 12345.6789)
+TEST_UBENCH_CONV(double, ghefcdab, val_64_arr, double, d, 12345.6789)
+TEST_UBENCH_CONV(double, badcfehg, val_64_arr, double, d, 12345.6789)
+TEST_UBENCH_CONV(int64, abcdefgh, val_64_arr, int64_t, i64, -0x123456789ABCDEFLL)
+TEST_UBENCH_CONV(int64, hgfedcba, val_64_arr, int64_t, i64, -0x123456789ABCDEFLL)
+TEST_UBENCH_CONV(int64, ghefcdab, val_64_arr, int64_t, i64, -0x123456789ABCDEFLL)
+TEST_UBENCH_CONV(int64, badcfehg, val_64_arr, int64_t, i64, -0x123456789ABCDEFLL)
+TEST_UBENCH_CONV(uint64, abcdefgh, val_64_arr, uint64_t, u64, 0x123456789ABCDEFULL)
+TEST_UBENCH_CONV(uint64, hgfedcba, val_64_arr, uint64_t, u64, 0x123456789ABCDEFULL)
+TEST_UBENCH_CONV(uint64, ghefcdab, val_64_arr, uint64_t, u64, 0x123456789ABCDEFULL)
+TEST_UBENCH_CONV(uint64, badcfehg, val_64_arr, uint64_t, u64, 0x123456789ABCDEFULL)
+
+static const struct {
+    const char *name;
+    mb_ubench_fn_t fn;
+} test_conv_kernels[] = {
+    TEST_UBENCH_CONV_ENTRY(int8, a),
+    TEST_UBENCH_CONV_ENTRY(int8, b),
+    TEST_UBENCH_CONV_ENTRY(uint8, a),
+    TEST_UBENCH_CONV_ENTRY(uint8, b),
+    TEST_UBENCH_CONV_ENTRY(int16, ab),
+    TEST_UBENCH_CONV_ENTRY(int16, ba),
+    TEST_UBENCH_CONV_ENTRY(uint16, ab),
+    TEST_UBENCH_CONV_ENTRY(uint16, ba),
+    TEST_UBENCH_CONV_ENTRY(int32, abcd),
+    TEST_UBENCH_CONV_ENTRY(int32, badc),
+    TEST_UBENCH_CONV_ENTRY(int32, cdab),
+    TEST_UBENCH_CONV_ENTRY(int32, dcba),
+    TEST_UBENCH_CONV_ENTRY(uint32, abcd),
+    TEST_UBENCH_CONV_ENTRY(uint32, badc),
+    TEST_UBENCH_CONV_ENTRY(uint32, cdab),
+    TEST_UBENCH_CONV_ENTRY(uint32, dcba),
+    TEST_UBENCH_CONV_ENTRY(float, abcd),
+    TEST_UBENCH_CONV_ENTRY(float, badc),
+    TEST_UBENCH_CONV_ENTRY(float, cdab),
+    TEST_UBENCH_CONV_ENTRY(float, dcba),
+    TEST_UBENCH_CONV_ENTRY(double, abcdefgh),
+    TEST_UBENCH_CONV_ENTRY(double, hgfedcba),
+    TEST_UBENCH_CONV_ENTRY(double, ghefcdab),
+    TEST_UBENCH_CONV_ENTRY(double, badcfehg),
+    TEST_UBENCH_CONV_ENTRY(int64, abcdefgh),
+    TEST_UBENCH_CONV_ENTRY(int64, hgfedcba),
+    TEST_UBENCH_CONV_ENTRY(int64, ghefcdab),
+    TEST_UBENCH_CONV_ENTRY(int64, badcfehg),
+    TEST_UBENCH_CONV_ENTRY(uint64, abcdefgh),
+    TEST_UBENCH_CONV_ENTRY(uint64, hgfedcba),
+    TEST_UBENCH_CONV_ENTRY(uint64, ghefcdab),
+    TEST_UBENCH_CONV_ENTRY(uint64, badcfehg),
+};
+
+TEST_CASE("Microbenchmark of endianness conversions.", "[MB_UBENCH]")
+{
+    // The register buffer is large enough for any conversion and aligned as the registers of the frame
+    uint64_t reg_buf = 0;
+
+    val_32_arr val32 = {0};
+    mb_set_float_cdab(&val32, 12.34f);
+    TEST_ASSERT_EQUAL_FLOAT(12.34f, mb_get_float_cdab(&val32));
+
+    for (int i = 0; i < (sizeof(test_conv_kernels) / sizeof(test_conv_kernels[0])); i++) {
+        mb_ubench_run("endianness", test_conv_kernels[i].name, test_conv_kernels[i].fn, &reg_buf, NULL);
+    }
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* Parameter data conversion of the master controller */
+
+#define TEST_PARAM_ENTRY(type, size) {#type, type, size}
+
+static const struct {
+    const char *name;
+    mb_descr_type_t type;
+    size_t size;
+} test_param_types[] = {
+    TEST_PARAM_ENTRY(PARAM_TYPE_U8, PARAM_SIZE_U8),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U16, PARAM_SIZE_U16),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U32, PARAM_SIZE_U32),
+    TEST_PARAM_ENTRY(PARAM_TYPE_FLOAT, PARAM_SIZE_FLOAT),
+    TEST_PARAM_ENTRY(PARAM_TYPE_ASCII, PARAM_SIZE_ASCII24),
+    TEST_PARAM_ENTRY(PARAM_TYPE_BIN, PARAM_SIZE_ASCII),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I8_A, PARAM_SIZE_I8_REG),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I8_B, PARAM_SIZE_I8_REG),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U8_A, PARAM_SIZE_U8_REG),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U8_B, PARAM_SIZE_U8_REG),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I16_AB, PARAM_SIZE_I16),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I16_BA, PARAM_SIZE_I16),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U16_AB, PARAM_SIZE_U16),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U16_BA, PARAM_SIZE_U16),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I32_ABCD, PARAM_SIZE_I32),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I32_CDAB, PARAM_SIZE_I32),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I32_BADC, PARAM_SIZE_I32),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I32_DCBA, PARAM_SIZE_I32),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U32_ABCD, PARAM_SIZE_U32),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U32_CDAB, PARAM_SIZE_U32),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U32_BADC, PARAM_SIZE_U32),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U32_DCBA, PARAM_SIZE_U32),
+    TEST_PARAM_ENTRY(PARAM_TYPE_FLOAT_ABCD, PARAM_SIZE_FLOAT),
+    TEST_PARAM_ENTRY(PARAM_TYPE_FLOAT_CDAB, PARAM_SIZE_FLOAT),
+    TEST_PARAM_ENTRY(PARAM_TYPE_FLOAT_BADC, PARAM_SIZE_FLOAT),
+    TEST_PARAM_ENTRY(PARAM_TYPE_FLOAT_DCBA, PARAM_SIZE_FLOAT),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I64_ABCDEFGH, PARAM_SIZE_I64),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I64_HGFEDCBA, PARAM_SIZE_I64),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I64_GHEFCDAB, PARAM_SIZE_I64),
+    TEST_PARAM_ENTRY(PARAM_TYPE_I64_BADCFEHG, PARAM_SIZE_I64),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U64_ABCDEFGH, PARAM_SIZE_U64),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U64_HGFEDCBA, PARAM_SIZE_U64),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U64_GHEFCDAB, PARAM_SIZE_U64),
+    TEST_PARAM_ENTRY(PARAM_TYPE_U64_BADCFEHG, PARAM_SIZE_U64),
+    TEST_PARAM_ENTRY(PARAM_TYPE_DOUBLE_ABCDEFGH, PARAM_SIZE_DOUBLE),
+    TEST_PARAM_ENTRY(PARAM_TYPE_DOUBLE_HGFEDCBA, PARAM_SIZE_DOUBLE),
+    TEST_PARAM_ENTRY(PARAM_TYPE_DOUBLE_GHEFCDAB, PARAM_SIZE_DOUBLE),
+    TEST_PARAM_ENTRY(PARAM_TYPE_DOUBLE_BADCFEHG, PARAM_SIZE_DOUBLE),
+};
+
+typedef struct {
+    mb_descr_type_t type;
+    size_t size;
+    uint8_t *dest;
+    uint8_t *src;
+} test_param_arg_t;
+
+static void test_ubench_set_param_data(void *arg)
+{
+    test_param_arg_t *param_arg = (test_param_arg_t *)arg;
+    test_sink.status = mbc_master_set_param_data(param_arg->dest, param_arg->src, param_arg->type, param_arg->size);
+}
+
+TEST_CASE("Microbenchmark of master parameter data conversion.", "[MB_UBENCH]")
+{
+    uint8_t src[TEST_PARAM_MAX_SIZE];
+    uint8_t dest[TEST_PARAM_MAX_SIZE];
+    for (int i = 0; i < TEST_PARAM_MAX_SIZE; i++) {
+        src[i] = (uint8_t)rand();
+    }
+
+    for (int i = 0; i < (sizeof(test_param_types) / sizeof(test_param_types[0])); i++) {
+        mb_param_conv_plan_t plan;
+        // The extended types are not supported when CONFIG_FMB_EXT_TYPE_SUPPORT is disabled
+        if (mbc_master_get_conv_plan(&plan, test_param_types[i].type, test_param_types[i].size) != ESP_OK) {
+            ESP_LOGW(TAG, "%s is not supported, skip.", test_param_types[i].name);
+            continue;
+        }
+        test_param_arg_t param_arg = {
+            .type = test_param_types[i].type,
+            .size = test_param_types[i].size,
+            .dest = dest,
+            .src = src
+        };
+        TEST_ESP_OK(mbc_master_set_param_data(dest, src, param_arg.type, param_arg.size));
+        mb_ubench_run("param_data", test_param_types[i].name, test_ubench_set_param_data, &param_arg, NULL);
+    }
+}
+
+#define TEST_CID_TABLE_SIZE     (1000)
+
+// The data dictionary of mixed type parameters, the register data of each cid follows the previous one
+typedef struct {
+    uint16_t count;
+    mb_descr_type_t types[TEST_CID_TABLE_SIZE];
+    size_t sizes[TEST_CID_TABLE_SIZE];
+    mb_param_conv_plan_t plans[TEST_CID_TABLE_SIZE];
+    uint8_t *src;
+    uint8_t *dest;
+} test_cid_table_arg_t;
+
+// The plans are compiled once, when the description table is set
+static void test_ubench_cid_table_plans(void *arg)
+{
+    test_cid_table_arg_t *table = (test_cid_table_arg_t *)arg;
+    size_t offset = 0;
+    for (uint16_t i = 0; i < table->count; i++) {
+        test_sink.status = mbc_master_apply_conv_plan(&table->plans[i], &table->dest[offset], &table->src[offset]);
+        offset += table->sizes[i];
+    }
+}
+
+// The type is resolved on each call of mbc_master_set_param_data()
+static void test_ubench_cid_table_set_param_data(void *arg)
+{
+    test_cid_table_arg_t *table = (test_cid_table_arg_t *)arg;
+    size_t offset = 0;
+    for (uint16_t i = 0; i < table->count; i++) {
+        test_sink.status = mbc_master_set_param_data(&table->dest[offset], &table->src[offset],
+                                                        table->types[i], table->sizes[i]);
+        offset += table->sizes[i];
+    }
+}
+
+TEST_CASE("Microbenchmark of master data conversion of mixed type cids.", "[MB_UBENCH]")
+{
+    test_cid_table_arg_t *table = calloc(1, sizeof(test_cid_table_arg_t));
+    TEST_ASSERT_NOT_NULL(table);
+    size_t total_size = 0;
+    for (int i = 0; table->count < TEST_CID_TABLE_SIZE; i = (i + 1) % (sizeof(test_param_types) / sizeof(test_param_types[0]))) {
+        // The extended types are not in the table when CONFIG_FMB_EXT_TYPE_SUPPORT is disabled
+        if (mbc_master_get_conv_plan(&table->plans[table->count], test_param_types[i].type, test_param_types[i].size) != ESP_OK) {
+            continue;
+        }
+        table->types[table->count] = test_param_types[i].type;
+        table->sizes[table->count] = test_param_types[i].size;
+        total_size += test_param_types[i].size;
+        table->count++;
+    }
+    table->src = malloc(total_size);
+    table->dest = malloc(total_size);
+    TEST_ASSERT_TRUE(table->src && table->dest);
+    for (size_t i = 0; i < total_size; i++) {
+        table->src[i] = (uint8_t)rand();
+    }
+
+    test_ubench_cid_table_plans(table);
+    TEST_ESP_OK(test_sink.status);
+    mb_ubench_run("param_data", "cid_table_1000/plans", test_ubench_cid_table_plans, table, NULL);
+    mb_ubench_run("param_data", "cid_table_1000/set_param_data", test_ubench_cid_table_set_param_data, table, NULL);
+    free(table->src);
+    free(table->dest);
+    free(table);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* Slave command handlers */
+
+// The register areas are kept in the frame byte order, the callbacks only copy the data
+// so the results show the cost of the request parsing and the response building
+static uint8_t test_reg_area[TEST_REG_NUM * 2];
+static uint8_t test_coil_area[TEST_COIL_BYTES];
+
+static mb_err_enum_t test_reg_input_cb(mb_base_t *inst, uint8_t *reg_buff, uint16_t reg_addr, uint16_t reg_num)
+{
+    if ((reg_addr < 1) || ((reg_addr - 1 + reg_num) > TEST_REG_NUM)) {
+        return MB_ENOREG;
+    }
+    memcpy(reg_buff, &test_reg_area[(reg_addr - 1) * 2], reg_num * 2);
+    return MB_ENOERR;
+}
+
+static mb_err_enum_t test_reg_holding_cb(mb_base_t *inst, uint8_t *reg_buff, uint16_t reg_addr, uint16_t reg_num,
+                                            mb_reg_mode_enum_t mode)
+{
+    if ((reg_addr < 1) || ((reg_addr - 1 + reg_num) > TEST_REG_NUM)) {
+        return MB_ENOREG;
+    }
+    if (mode == MB_REG_READ) {
+        memcpy(reg_buff, &test_reg_area[(reg_addr - 1) * 2], reg_num * 2);
+    } else {
+        memcpy(&test_reg_area[(reg_addr - 1) * 2], reg_buff, reg_num * 2);
+    }
+    return MB_ENOERR;
+}
+
+// The canned requests address the coils from the byte boundary
+static mb_err_enum_t test_reg_coils_cb(mb_base_t *inst, uint8_t *reg_buff, uint16_t reg_addr, uint16_t coil_num,
+                                        mb_reg_mode_enum_t mode)
+{
+    uint16_t byte_offset = (reg_addr - 1) >> 3;
+    uint16_t byte_num = (coil_num + 7) >> 3;
+    if ((reg_addr < 1) || ((byte_offset + byte_num) > TEST_COIL_BYTES)) {
+        return MB_ENOREG;
+    }
+    if (mode == MB_REG_READ) {
+        memcpy(reg_buff, &test_coil_area[byte_offset], byte_num);
+    } else {
+        memcpy(&test_coil_area[byte_offset], reg_buff, byte_num);
+    }
+    return MB_ENOERR;
+}
+
+static mb_err_enum_t test_reg_discrete_cb(mb_base_t *inst, uint8_t *reg_buff, uint16_t reg_addr, uint16_t disc_num)
+{
+    return test_reg_coils_cb(inst, reg_buff, reg_addr, disc_num, MB_REG_READ);
+}
+
+typedef mb_exception_t (*test_handler_fp)(mb_base_t *inst, uint8_t *frame_ptr, uint16_t *len_buf);
+
+typedef struct {
+    const char *name;
+    test_handler_fp handler;
+    const uint8_t *request;
+    uint16_t len;
+} test_handler_case_t;
+
+#define TEST_HANDLER_CASE(name, handler, ...) \
+    {name, handler, (const uint8_t[]){__VA_ARGS__}, sizeof((const uint8_t[]){__VA_ARGS__})}
+
+// Write multiple registers and coils requests carry the data of the maximum size used below
+#define TEST_DATA_16    0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA
+#define TEST_DATA_64    TEST_DATA_16, TEST_DATA_16, TEST_DATA_16, TEST_DATA_16
+#define TEST_DATA_240   TEST_DATA_64, TEST_DATA_64, TEST_DATA_64, TEST_DATA_16, TEST_DATA_16, TEST_DATA_16
+
+static const test_handler_case_t test_handler_cases[] = {
+    TEST_HANDLER_CASE("mbs_fn_read_input_reg/1", mbs_fn_read_input_reg, 0x04, 0x00, 0x00, 0x00, 0x01),
+    TEST_HANDLER_CASE("mbs_fn_read_input_reg/125", mbs_fn_read_input_reg, 0x04, 0x00, 0x00, 0x00, 0x7D),
+    TEST_HANDLER_CASE("mbs_fn_read_holding_reg/1", mbs_fn_read_holding_reg, 0x03, 0x00, 0x00, 0x00, 0x01),
+    TEST_HANDLER_CASE("mbs_fn_read_holding_reg/125", mbs_fn_read_holding_reg, 0x03, 0x00, 0x00, 0x00, 0x7D),
+    TEST_HANDLER_CASE("mbs_fn_write_holding_reg", mbs_fn_write_holding_reg, 0x06, 0x00, 0x10, 0x12, 0x34),
+    TEST_HANDLER_CASE("mbs_fn_write_multi_holding_reg/8", mbs_fn_write_multi_holding_reg,
+                        0x10, 0x00, 0x00, 0x00, 0x08, 0x10, TEST_DATA_16),
+    TEST_HANDLER_CASE("mbs_fn_write_multi_holding_reg/120", mbs_fn_write_multi_holding_reg,
+                        0x10, 0x00, 0x00, 0x00, 0x78, 0xF0, TEST_DATA_240),
+    TEST_HANDLER_CASE("mbs_fn_rw_multi_holding_reg/32", mbs_fn_rw_multi_holding_reg,
+                        0x17, 0x00, 0x00, 0x00, 0x20, 0x00, 0x40, 0x00, 0x20, 0x40, TEST_DATA_64),
+    TEST_HANDLER_CASE("mbs_fn_read_coils/16", mbs_fn_read_coils, 0x01, 0x00, 0x00, 0x00, 0x10),
+    TEST_HANDLER_CASE("mbs_fn_read_coils/1000", mbs_fn_read_coils, 0x01, 0x00, 0x00, 0x03, 0xE8),
+    TEST_HANDLER_CASE("mbs_fn_write_coil", mbs_fn_write_coil, 0x05, 0x00, 0x08, 0xFF, 0x00),
+    TEST_HANDLER_CASE("mbs_fn_write_multi_coils/16", mbs_fn_write_multi_coils,
+                        0x0F, 0x00, 0x00, 0x00, 0x10, 0x02, 0x55, 0xAA),
+    TEST_HANDLER_CASE("mbs_fn_write_multi_coils/512", mbs_fn_write_multi_coils,
+                        0x0F, 0x00, 0x00, 0x02, 0x00, 0x40, TEST_DATA_64),
+    TEST_HANDLER_CASE("mbs_fn_read_discrete_inp/16", mbs_fn_read_discrete_inp, 0x02, 0x00, 0x00, 0x00, 0x10),
+    TEST_HANDLER_CASE("mbs_fn_read_discrete_inp/1000", mbs_fn_read_discrete_inp, 0x02, 0x00, 0x00, 0x03, 0xE8),
+#if MB_FUNC_OTHER_REP_SLAVEID_ENABLED
+    TEST_HANDLER_CASE("mbs_fn_report_slave_id", mbs_fn_report_slave_id, 0x11),
+#endif
+};
+
+typedef struct {
+    mb_base_t *inst;
+    const test_handler_case_t *test_case;
+    uint8_t *frame;
+} test_handler_arg_t;
+
+// The handler builds the response in place of the request, so the request is restored on each call
+static void test_ubench_handler(void *arg)
+{
+    test_handler_arg_t *handler_arg = (test_handler_arg_t *)arg;
+    uint16_t len = handler_arg->test_case->len;
+    memcpy(handler_arg->frame, handler_arg->test_case->request, len);
+    test_sink.status = handler_arg->test_case->handler(handler_arg->inst, handler_arg->frame, &len);
+}
+
+static void test_ubench_frame_copy(void *arg)
+{
+    test_handler_arg_t *handler_arg = (test_handler_arg_t *)arg;
+    memcpy(handler_arg->frame, handler_arg->test_case->request, handler_arg->test_case->len);
+}
+
+TEST_CASE("Microbenchmark of slave command handlers on canned frames.", "[MB_UBENCH]")
+{
+    // Only the fields used by the handlers are initialized
+    static mb_base_t test_inst;
+    memset(&test_inst, 0, sizeof(test_inst));
+    CRITICAL_SECTION_INIT(test_inst.lock);
+    test_inst.rw_cbs.reg_input_cb = test_reg_input_cb;
+    test_inst.rw_cbs.reg_holding_cb = test_reg_holding_cb;
+    test_inst.rw_cbs.reg_coils_cb = test_reg_coils_cb;
+    test_inst.rw_cbs.reg_discrete_cb = test_reg_discrete_cb;
+#if MB_FUNC_OTHER_REP_SLAVEID_ENABLED
+    static uint8_t test_obj_id[] = {0x01, 0xFF, 'E', 'S', 'P', '-', 'M', 'B'};
+    test_inst.obj_id = test_obj_id;
+    test_inst.obj_id_len = sizeof(test_obj_id);
+#endif
+
+    uint8_t *frame = calloc(1, MB_BUFFER_SIZE);
+    TEST_ASSERT(frame);
+    for (int i = 0; i < sizeof(test_reg_area); i++) {
+        test_reg_area[i] = (uint8_t)rand();
+    }
+
+    test_handler_arg_t handler_arg = {.inst = &test_inst, .test_case = &test_handler_cases[0], .frame = frame};
+    // The cost of the request restore is included in the results of handlers
+    mb_ubench_run("handlers", "frame_copy", test_ubench_frame_copy, &handler_arg, NULL);
+
+    for (int i = 0; i < (sizeof(test_handler_cases) / sizeof(test_handler_cases[0])); i++) {
+        handler_arg.test_case = &test_handler_cases[i];
+        uint16_t len = test_handler_cases[i].len;
+        memcpy(frame, test_handler_cases[i].request, len);
+        TEST_ASSERT_EQUAL_MESSAGE(MB_EX_NONE, test_handler_cases[i].handler(&test_inst, frame, &len),
+                                    test_handler_cases[i].name);
+        mb_ubench_run("handlers", test_handler_cases[i].name, test_ubench_handler, &handler_arg, NULL);
+    }
+
+    CRITICAL_SECTION_CLOSE(test_inst.lock);
+    free(frame);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* Port events */
+
+// The FSM step posted by the polling task itself, it is returned by the next get without the ring
+static void test_ubench_event_chain(void *arg)
+{
+    mb_port_base_t *inst = (mb_port_base_t *)arg;
+    mb_event_t event;
+    (void)mb_port_event_post(inst, EVENT(EV_EXECUTE));
+    test_sink.status = mb_port_event_get(inst, &event);
+}
+
+// The event is passed through the ring when the chained one is not taken yet
+static void test_ubench_event_ring(void *arg)
+{
+    mb_port_base_t *inst = (mb_port_base_t *)arg;
+    mb_event_t event;
+    (void)mb_port_event_post(inst, EVENT(EV_EXECUTE));
+    (void)mb_port_event_post(inst, EVENT(EV_FRAME_SENT));
+    (void)mb_port_event_get(inst, &event);
+    test_sink.status = mb_port_event_get(inst, &event);
+}
+
+// The FreeRTOS queue round trip of the event structure, the baseline
+static void test_ubench_event_queue(void *arg)
+{
+    QueueHandle_t queue_hdl = (QueueHandle_t)arg;
+    mb_event_t event = {.event = EV_EXECUTE};
+    (void)xQueueSend(queue_hdl, &event, 0);
+    test_sink.status = xQueueReceive(queue_hdl, &event, 0);
+}
+
+TEST_CASE("Microbenchmark of port events.", "[MB_UBENCH]")
+{
+    static mb_port_base_t test_port = {
+        .descr = {.parent_name = "ubench_event", .obj_name = "ubench_event"}
+    };
+    mb_event_t event = {0};
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_event_create(&test_port));
+    TEST_ASSERT_TRUE(mb_port_event_post(&test_port, EVENT(EV_READY)));
+    TEST_ASSERT_TRUE(mb_port_event_get(&test_port, &event));
+    TEST_ASSERT_EQUAL(EV_READY, event.event);
+    mb_ubench_run("events", "chain", test_ubench_event_chain, &test_port, NULL);
+    mb_ubench_run("events", "ring", test_ubench_event_ring, &test_port, NULL);
+    mb_port_event_delete(&test_port);
+
+    QueueHandle_t queue_hdl = xQueueCreate(CONFIG_FMB_QUEUE_LENGTH, sizeof(mb_event_t));
+    TEST_ASSERT_NOT_NULL(queue_hdl);
+    mb_ubench_run("events", "queue_reference", test_ubench_event_queue, queue_hdl, NULL);
+    vQueueDelete(queue_hdl);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* Statistics */
+
+#if CONFIG_FMB_STATS_EN
+
+// The statistics recorded by the slave FSM for one request: received and sent frames, handler time and latency
+static void test_ubench_stats_request(void *arg)
+{
+    static uint32_t seq = 0;
+    mb_port_base_t *inst = (mb_port_base_t *)arg;
+    seq++;
+    MB_STATS_FRAME(inst, false, 12);
+    mb_port_stats_handler(inst, 0x03, seq & 0xFF);
+    MB_STATS_FRAME(inst, true, 25);
+    mb_port_stats_request(inst, 0x03, seq * 7, EV_ERROR_OK);
+}
+
+TEST_CASE("Microbenchmark of statistics recording.", "[MB_UBENCH]")
+{
+    static mb_port_base_t test_port = {
+        .descr = {.parent_name = "ubench_stats", .obj_name = "ubench_stats"}
+    };
+    mb_stats_t stats = {0};
+    // The statistics are created with the event object of the instance
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_event_create(&test_port));
+    test_ubench_stats_request(&test_port);
+    TEST_ASSERT_EQUAL(MB_ENOERR, mb_port_stats_get(&test_port, &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.rx_frames);
+    TEST_ASSERT_EQUAL_UINT8(0x03, stats.funcs[0].func);
+    mb_ubench_run("stats", "request", test_ubench_stats_request, &test_port, NULL);
+    mb_port_event_delete(&test_port);
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* Hot path log */
+
+static const char *test_log_parent = "mbs_tcp#0";
+static uint8_t test_log_frame[] = {0x03, 0x00, 0x00, 0x00, 0x0A};
+
+// The messages of one TCP slave request with the debug level compiled in and disabled at runtime,
+// ESP_LOG_LEVEL() is used to bypass the LOG_LOCAL_LEVEL of the application
+static void test_ubench_log_esp_log(void *arg)
+{
+    (void)arg;
+    ESP_LOG_LEVEL(ESP_LOG_DEBUG, TAG, "%p, node #%d, socket(#%d) [%s], receive data ready.", test_log_parent, 1, 54, test_log_parent);
+    ESP_LOG_LEVEL(ESP_LOG_DEBUG, TAG, "%p:EV_FRAME_RECEIVED", test_log_parent);
+    esp_log_buffer_hex_internal(TAG, test_log_frame, sizeof(test_log_frame), ESP_LOG_DEBUG);
+    ESP_LOG_LEVEL(ESP_LOG_DEBUG, TAG, "%p:EV_EXECUTE", test_log_parent);
+    ESP_LOG_LEVEL(ESP_LOG_DEBUG, TAG, "%p: function (0x%x), invoke handler %p.", test_log_parent, (int)test_log_frame[0], test_log_frame);
+    ESP_LOG_LEVEL(ESP_LOG_DEBUG, TAG, "%p, read packet, TID: 0x%04x, %p.", test_log_parent, 1, test_log_frame);
+    ESP_LOG_LEVEL(ESP_LOG_DEBUG, TAG, "%p:EV_MASTER_FRAME_SENT", test_log_parent);
+    ESP_LOG_LEVEL(ESP_LOG_DEBUG, TAG, "%p, transaction processing time(us) = %d", test_log_parent, 1);
+}
+
+// The same messages removed by the compiler when CONFIG_FMB_TRACE_LEVEL is below the debug level
+static void test_ubench_log_trace(void *arg)
+{
+    (void)arg;
+    MB_TRACED(TAG, "%p, node #%d, socket(#%d) [%s], receive data ready.", test_log_parent, 1, 54, test_log_parent);
+    MB_TRACED(TAG, "%p:EV_FRAME_RECEIVED", test_log_parent);
+    MB_TRACE_BUF(TAG, "", test_log_frame, sizeof(test_log_frame), ESP_LOG_DEBUG);
+    MB_TRACED(TAG, "%p:EV_EXECUTE", test_log_parent);
+    MB_TRACED(TAG, "%p: function (0x%x), invoke handler %p.", test_log_parent, (int)test_log_frame[0], test_log_frame);
+    MB_TRACED(TAG, "%p, read packet, TID: 0x%04x, %p.", test_log_parent, 1, test_log_frame);
+    MB_TRACED(TAG, "%p:EV_MASTER_FRAME_SENT", test_log_parent);
+    MB_TRACED(TAG, "%p, transaction processing time(us) = %d", test_log_parent, 1);
+}
+
+#if CONFIG_FMB_TRACE_DEFERRED_EN
+
+// The same messages at the error level stored into the deferred log ring
+static void test_ubench_log_deferred(void *arg)
+{
+    (void)arg;
+    MB_TRACEE(TAG, "%p, node #%d, socket(#%d) [%s], receive data ready.", test_log_parent, 1, 54, test_log_parent);
+    MB_TRACEE(TAG, "%p:EV_FRAME_RECEIVED", test_log_parent);
+    MB_TRACE_BUF(TAG, "", test_log_frame, sizeof(test_log_frame), ESP_LOG_ERROR);
+    MB_TRACEE(TAG, "%p:EV_EXECUTE", test_log_parent);
+    MB_TRACEE(TAG, "%p: function (0x%x), invoke handler %p.", test_log_parent, (int)test_log_frame[0], test_log_frame);
+    MB_TRACEE(TAG, "%p, read packet, TID: 0x%04x, %p.", test_log_parent, 1, test_log_frame);
+    MB_TRACEE(TAG, "%p:EV_MASTER_FRAME_SENT", test_log_parent);
+    MB_TRACEE(TAG, "%p, transaction processing time(us) = %d", test_log_parent, 1);
+}
+
+#endif
+
+TEST_CASE("Microbenchmark of hot path log messages.", "[MB_UBENCH]")
+{
+    // The messages of the tag are disabled at runtime, the flushed deferred messages are dropped by the filter
+    esp_log_level_set(TAG, ESP_LOG_NONE);
+    mb_ubench_run("trace_log", "esp_log_debug_disabled", test_ubench_log_esp_log, NULL, NULL);
+    mb_ubench_run("trace_log", "mb_trace_debug", test_ubench_log_trace, NULL, NULL);
+#if CONFIG_FMB_TRACE_DEFERRED_EN
+    (void)mb_trace_log_flush(0);
+    test_ubench_log_deferred(NULL);
+    TEST_ASSERT_EQUAL(8, mb_trace_log_flush(0));
+    mb_ubench_run("trace_log", "mb_trace_deferred", test_ubench_log_deferred, NULL, NULL);
+    (void)mb_trace_log_flush(0);
+#endif
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+}
@@ -0,0 +1,41 @@
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+
+import json
+import os
+
+import pytest
+from pytest_embedded import Dut
+
+UBENCH_RESULT_PATTERN = r'MB_UBENCH:(\{[^\r\n]*\})'
+UBENCH_DONE_PATTERN = r'\d+ Tests \d+ Failures \d+ Ignored'
+
+
+def collect_ubench_results(dut: Dut, result_name: str) -> None:
+    results = []
+    while True:
+        match = dut.expect([UBENCH_RESULT_PATTERN, UBENCH_DONE_PATTERN], timeout=600)
+        if not match.group(0).decode().startswith('MB_UBENCH:'):
+            break
+        results.append(json.loads(match.group(1).decode()))
+    # The results are stored with the test logs, one JSON object per line
+    result_path = os.path.join(dut.logdir, result_name)
+    with open(result_path, 'w') as result_file:
+        for result in results:
+            result_file.write(json.dumps(result) + '\n')
+    assert results, 'no benchmark results are received'
+    assert 'Failures 0' in match.group(0).decode(), 'the benchmark is failed'
+
+
+@pytest.mark.parametrize('target', ['esp32'], indirect=True)
+@pytest.mark.multi_dut_modbus_generic
+def test_mb_microbench(dut: Dut) -> None:
+    dut.expect_exact('Press ENTER to see the list of tests')
+    dut.write('[MB_UBENCH]')
+    collect_ubench_results(dut, 'mb_ubench_esp32.jsonl')
+
+
+@pytest.mark.parametrize('target', ['linux'], indirect=True)
+@pytest.mark.host_test
+def test_mb_microbench_host(dut: Dut) -> None:
+    collect_ubench_results(dut, 'mb_ubench_linux.jsonl')
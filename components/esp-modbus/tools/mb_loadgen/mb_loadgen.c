@@ -0,0 +1,889 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// The Modbus TCP load generator for the host (linux).
+// It opens N connections to the slave, keeps up to `depth` requests with distinct
+// transaction identifiers in flight on each connection and sends the configured mix
+// of requests at the target rate (open loop) or as fast as the slave responds (closed loop).
+// The results are reported per connection: throughput, latency percentiles,
+// timeouts, exceptions and protocol errors.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <signal.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define LG_MBAP_HEADER_SIZE     (7)
+#define LG_MBAP_LEN_OFF         (4)
+#define LG_PDU_SIZE_MAX         (253)
+#define LG_FRAME_SIZE_MAX       (LG_MBAP_HEADER_SIZE + LG_PDU_SIZE_MAX)
+#define LG_MIX_MAX              (16)
+#define LG_CONN_MAX             (4096)
+#define LG_DEPTH_MAX            (64)
+#define LG_EXC_CODE_MAX         (16)
+#define LG_EPOLL_EVENTS_MAX     (64)
+#define LG_RECONNECT_MS         (200)
+#define LG_WAIT_MAX_MS          (100)
+#define LG_UID_MAX              (255)
+
+#define LG_NS_PER_US            (1000ULL)
+#define LG_NS_PER_MS            (1000000ULL)
+#define LG_NS_PER_SEC           (1000000000ULL)
+
+#define LG_DEFAULT_PORT         "502"
+#define LG_DEFAULT_MIX          "3:0:1"
+#define LG_DEFAULT_TIMEOUT_MS   (1000)
+#define LG_DEFAULT_DURATION_S   (10)
+
+// The limits of the quantity field of the requests as per Modbus application protocol specification
+#define LG_READ_COILS_MAX       (2000)
+#define LG_READ_REGS_MAX        (125)
+#define LG_WRITE_COILS_MAX      (1968)
+#define LG_WRITE_REGS_MAX       (123)
+
+typedef struct {
+    uint8_t fc;                 // function code
+    uint16_t addr;              // start address
+    uint16_t count;             // number of registers or coils
+    uint32_t weight;            // relative frequency of the request in the mix
+} lg_request_t;
+
+typedef struct {
+    const char *host;
+    const char *port;
+    int conns;
+    int depth;
+    uint8_t uid;
+    double rate;                // total requests per second, 0 - closed loop
+    double duration_s;
+    uint64_t requests;          // total number of requests, 0 - limited by the duration only
+    uint32_t timeout_ms;
+    lg_request_t mix[LG_MIX_MAX];
+    int mix_cnt;
+    uint32_t mix_weight;
+    bool json;
+} lg_config_t;
+
+typedef struct {
+    uint64_t sent;
+    uint64_t ok;
+    uint64_t exceptions;
+    uint64_t exc_codes[LG_EXC_CODE_MAX];
+    uint64_t timeouts;
+    uint64_t errors;            // malformed or mismatched responses and requests lost on disconnection
+    uint64_t late;              // responses received after the timeout of the request
+    uint64_t disconnects;
+    uint64_t conn_fails;        // failed connection attempts
+    uint32_t *lat_us;           // latency of the successful requests
+    size_t lat_cnt;
+    size_t lat_cap;
+} lg_stats_t;
+
+typedef struct {
+    bool busy;
+    uint16_t tid;
+    uint8_t mix_idx;
+    uint64_t start_ns;          // the scheduled time in open loop, the send time in closed loop
+    uint64_t deadline_ns;
+} lg_slot_t;
+
+typedef enum {
+    LG_CONN_CLOSED = 0,
+    LG_CONN_CONNECTING,
+    LG_CONN_CONNECTED
+} lg_conn_state_t;
+
+typedef struct {
+    int index;
+    int fd;
+    lg_conn_state_t state;
+    uint64_t reconnect_ns;
+    uint64_t connect_deadline_ns;   // the connection attempt is abandoned after the response timeout
+    uint64_t next_send_ns;
+    uint64_t period_ns;
+    uint16_t next_tid;
+    int in_flight;
+    bool wants_out;
+    lg_slot_t slots[LG_DEPTH_MAX];
+    uint8_t tx_buf[LG_FRAME_SIZE_MAX * LG_DEPTH_MAX];
+    size_t tx_len;
+    uint8_t rx_buf[LG_FRAME_SIZE_MAX * 2];
+    size_t rx_len;
+    lg_stats_t stats;
+} lg_conn_t;
+
+static lg_config_t s_cfg;
+static struct sockaddr_storage s_addr;
+static socklen_t s_addr_len;
+static int s_epoll_fd = -1;
+static int s_timer_fd = -1;
+static uint64_t s_timer_ns;
+static uint64_t s_issued;
+static uint32_t s_rand_state = 0x2545F491;
+static volatile sig_atomic_t s_stop;
+
+static uint64_t lg_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * LG_NS_PER_SEC) + (uint64_t)ts.tv_nsec;
+}
+
+// The xorshift generator to select the request of the mix
+static uint32_t lg_rand(void)
+{
+    s_rand_state ^= s_rand_state << 13;
+    s_rand_state ^= s_rand_state >> 17;
+    s_rand_state ^= s_rand_state << 5;
+    return s_rand_state;
+}
+
+static void lg_on_signal(int sig)
+{
+    // The second signal stops the wait for the requests in flight
+    (void)sig;
+    s_stop++;
+}
+
+static void lg_usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] host\n"
+            "  -p port      TCP port of the slave (default " LG_DEFAULT_PORT ")\n"
+            "  -c conns     number of connections (default 1)\n"
+            "  -d depth     requests in flight per connection, pipelined with distinct TIDs (default 1)\n"
+            "  -u uid       unit identifier 0..255 (default 1)\n"
+            "  -r rate      total target rate in requests per second, 0 - closed loop (default 0)\n"
+            "  -t seconds   test duration (default %d)\n"
+            "  -n requests  total number of requests, the test stops when they are completed\n"
+            "  -o ms        response and connection timeout (default %d)\n"
+            "  -m mix       request mix: fc:addr:count[@weight][,...] (default " LG_DEFAULT_MIX ")\n"
+            "               supported function codes: 1, 2, 3, 4, 5, 6, 15, 16\n"
+            "  -j           print the results as JSON lines\n",
+            prog, LG_DEFAULT_DURATION_S, LG_DEFAULT_TIMEOUT_MS);
+}
+
+// Parses the whole string as the decimal number in the range
+static bool lg_parse_long(const char *str, long min, long max, long *value)
+{
+    char *end = NULL;
+    errno = 0;
+    long ret = strtol(str, &end, 10);
+    if ((end == str) || *end || errno || (ret < min) || (ret > max)) {
+        return false;
+    }
+    *value = ret;
+    return true;
+}
+
+static bool lg_check_request(const lg_request_t *req)
+{
+    switch (req->fc) {
+    case 0x01:
+    case 0x02:
+        return (req->count >= 1) && (req->count <= LG_READ_COILS_MAX);
+    case 0x03:
+    case 0x04:
+        return (req->count >= 1) && (req->count <= LG_READ_REGS_MAX);
+    case 0x05:
+    case 0x06:
+        return true;
+    case 0x0F:
+        return (req->count >= 1) && (req->count <= LG_WRITE_COILS_MAX);
+    case 0x10:
+        return (req->count >= 1) && (req->count <= LG_WRITE_REGS_MAX);
+    default:
+        return false;
+    }
+}
+
+static bool lg_parse_mix(const char *str, lg_config_t *cfg)
+{
+    char *copy = strdup(str);
+    char *save = NULL;
+    bool ret = (copy != NULL);
+    cfg->mix_cnt = 0;
+    cfg->mix_weight = 0;
+    for (char *tok = strtok_r(copy, ",", &save); ret && tok; tok = strtok_r(NULL, ",", &save)) {
+        unsigned fc = 0, addr = 0, count = 1, weight = 1;
+        int fields = sscanf(tok, "%u:%u:%u@%u", &fc, &addr, &count, &weight);
+        if ((fields < 2) || (cfg->mix_cnt >= LG_MIX_MAX) || (fc > 0xFF) || (addr > 0xFFFF)
+                || (count > 0xFFFF) || !weight || ((addr + count) > 0x10000)) {
+            ret = false;
+            break;
+        }
+        lg_request_t *req = &cfg->mix[cfg->mix_cnt];
+        req->fc = (uint8_t)fc;
+        req->addr = (uint16_t)addr;
+        req->count = ((fc == 0x05) || (fc == 0x06)) ? 1 : (uint16_t)count;
+        req->weight = weight;
+        if (!lg_check_request(req)) {
+            ret = false;
+            break;
+        }
+        cfg->mix_weight += weight;
+        cfg->mix_cnt++;
+    }
+    free(copy);
+    return ret && cfg->mix_cnt;
+}
+
+static uint8_t lg_select_request(void)
+{
+    if (s_cfg.mix_cnt == 1) {
+        return 0;
+    }
+    uint32_t pick = lg_rand() % s_cfg.mix_weight;
+    for (uint8_t idx = 0; idx < s_cfg.mix_cnt; idx++) {
+        if (pick < s_cfg.mix[idx].weight) {
+            return idx;
+        }
+        pick -= s_cfg.mix[idx].weight;
+    }
+    return 0;
+}
+
+// Builds the MBAP frame of the request, returns the frame length
+static size_t lg_build_request(uint8_t *frame, uint16_t tid, const lg_request_t *req)
+{
+    uint8_t *pdu = &frame[LG_MBAP_HEADER_SIZE];
+    size_t pdu_len = 5;
+    pdu[0] = req->fc;
+    pdu[1] = (uint8_t)(req->addr >> 8);
+    pdu[2] = (uint8_t)(req->addr & 0xFF);
+    switch (req->fc) {
+    case 0x05:
+        pdu[3] = 0xFF;
+        pdu[4] = 0x00;
+        break;
+    case 0x06:
+        pdu[3] = (uint8_t)(tid >> 8);
+        pdu[4] = (uint8_t)(tid & 0xFF);
+        break;
+    case 0x0F:
+    case 0x10: {
+        uint8_t byte_cnt = (req->fc == 0x0F) ? (uint8_t)((req->count + 7) >> 3) : (uint8_t)(req->count << 1);
+        pdu[3] = (uint8_t)(req->count >> 8);
+        pdu[4] = (uint8_t)(req->count & 0xFF);
+        pdu[5] = byte_cnt;
+        for (int idx = 0; idx < byte_cnt; idx++) {
+            pdu[6 + idx] = (uint8_t)(tid + idx);
+        }
+        pdu_len = 6 + byte_cnt;
+        break;
+    }
+    default:
+        pdu[3] = (uint8_t)(req->count >> 8);
+        pdu[4] = (uint8_t)(req->count & 0xFF);
+        break;
+    }
+    frame[0] = (uint8_t)(tid >> 8);
+    frame[1] = (uint8_t)(tid & 0xFF);
+    frame[2] = 0;
+    frame[3] = 0;
+    frame[4] = (uint8_t)((pdu_len + 1) >> 8);
+    frame[5] = (uint8_t)((pdu_len + 1) & 0xFF);
+    frame[6] = s_cfg.uid;
+    return LG_MBAP_HEADER_SIZE + pdu_len;
+}
+
+// Checks the normal response PDU against the request
+static bool lg_check_response(const lg_request_t *req, const uint8_t *pdu, size_t pdu_len)
+{
+    switch (req->fc) {
+    case 0x01:
+    case 0x02:
+        return (pdu_len >= 2) && (pdu[1] == ((req->count + 7) >> 3)) && (pdu_len == (size_t)(2 + pdu[1]));
+    case 0x03:
+    case 0x04:
+        return (pdu_len >= 2) && (pdu[1] == (req->count << 1)) && (pdu_len == (size_t)(2 + pdu[1]));
+    default:
+        return (pdu_len == 5) && (((pdu[1] << 8) | pdu[2]) == req->addr);
+    }
+}
+
+static void lg_stats_add_latency(lg_stats_t *stats, uint64_t lat_ns)
+{
+    if (stats->lat_cnt == stats->lat_cap) {
+        size_t cap = stats->lat_cap ? (stats->lat_cap << 1) : 4096;
+        uint32_t *lat_us = realloc(stats->lat_us, cap * sizeof(uint32_t));
+        if (!lat_us) {
+            return;
+        }
+        stats->lat_us = lat_us;
+        stats->lat_cap = cap;
+    }
+    uint64_t lat_us = lat_ns / LG_NS_PER_US;
+    stats->lat_us[stats->lat_cnt++] = (lat_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)lat_us;
+}
+
+static void lg_epoll_update(lg_conn_t *conn, bool wants_out)
+{
+    struct epoll_event ev = {
+        .events = EPOLLIN | (wants_out ? EPOLLOUT : 0),
+        .data.ptr = conn
+    };
+    if (conn->wants_out != wants_out) {
+        epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+        conn->wants_out = wants_out;
+    }
+}
+
+// Sets the absolute expiration time of the timer, the timer is not reprogrammed for the same time
+static void lg_timer_arm(uint64_t time_ns)
+{
+    if (time_ns == s_timer_ns) {
+        return;
+    }
+    struct itimerspec its = {
+        .it_value.tv_sec = (time_t)(time_ns / LG_NS_PER_SEC),
+        .it_value.tv_nsec = (long)(time_ns % LG_NS_PER_SEC)
+    };
+    if (!timerfd_settime(s_timer_fd, TFD_TIMER_ABSTIME, &its, NULL)) {
+        s_timer_ns = time_ns;
+    }
+}
+
+// Reads the expiration count to clear the readiness of the timer
+static void lg_timer_ack(void)
+{
+    uint64_t expirations = 0;
+    (void)read(s_timer_fd, &expirations, sizeof(expirations));
+    s_timer_ns = 0;
+}
+
+static void lg_conn_close(lg_conn_t *conn, uint64_t now)
+{
+    if (conn->fd >= 0) {
+        epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+        close(conn->fd);
+        conn->fd = -1;
+    }
+    if (conn->state == LG_CONN_CONNECTED) {
+        conn->stats.disconnects++;
+    } else if (conn->state == LG_CONN_CONNECTING) {
+        conn->stats.conn_fails++;
+    }
+    // The requests in flight are lost with the connection
+    for (int idx = 0; idx < s_cfg.depth; idx++) {
+        if (conn->slots[idx].busy) {
+            conn->slots[idx].busy = false;
+            conn->stats.errors++;
+        }
+    }
+    conn->in_flight = 0;
+    conn->tx_len = 0;
+    conn->rx_len = 0;
+    conn->state = LG_CONN_CLOSED;
+    conn->reconnect_ns = now + (LG_RECONNECT_MS * LG_NS_PER_MS);
+}
+
+static void lg_conn_open(lg_conn_t *conn, uint64_t now)
+{
+    int fd = socket(s_addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd < 0) {
+        conn->stats.conn_fails++;
+        conn->reconnect_ns = now + (LG_RECONNECT_MS * LG_NS_PER_MS);
+        return;
+    }
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    if ((connect(fd, (struct sockaddr *)&s_addr, s_addr_len) < 0) && (errno != EINPROGRESS)) {
+        close(fd);
+        conn->stats.conn_fails++;
+        conn->reconnect_ns = now + (LG_RECONNECT_MS * LG_NS_PER_MS);
+        return;
+    }
+    struct epoll_event ev = {
+        .events = EPOLLIN | EPOLLOUT,
+        .data.ptr = conn
+    };
+    if (epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        close(fd);
+        conn->stats.conn_fails++;
+        conn->reconnect_ns = now + (LG_RECONNECT_MS * LG_NS_PER_MS);
+        return;
+    }
+    conn->fd = fd;
+    conn->wants_out = true;
+    conn->state = LG_CONN_CONNECTING;
+    conn->connect_deadline_ns = now + ((uint64_t)s_cfg.timeout_ms * LG_NS_PER_MS);
+}
+
+static void lg_conn_flush(lg_conn_t *conn, uint64_t now)
+{
+    while (conn->tx_len) {
+        ssize_t ret = send(conn->fd, conn->tx_buf, conn->tx_len, MSG_NOSIGNAL);
+        if (ret < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            lg_conn_close(conn, now);
+            return;
+        }
+        memmove(conn->tx_buf, &conn->tx_buf[ret], conn->tx_len - (size_t)ret);
+        conn->tx_len -= (size_t)ret;
+    }
+    lg_epoll_update(conn, conn->tx_len != 0);
+}
+
+static void lg_conn_issue(lg_conn_t *conn, uint64_t start_ns, uint64_t now)
+{
+    int slot_idx = 0;
+    while (conn->slots[slot_idx].busy) {
+        slot_idx++;
+    }
+    lg_slot_t *slot = &conn->slots[slot_idx];
+    slot->busy = true;
+    slot->tid = conn->next_tid++;
+    slot->mix_idx = lg_select_request();
+    slot->start_ns = start_ns;
+    slot->deadline_ns = now + ((uint64_t)s_cfg.timeout_ms * LG_NS_PER_MS);
+    conn->tx_len += lg_build_request(&conn->tx_buf[conn->tx_len], slot->tid, &s_cfg.mix[slot->mix_idx]);
+    conn->in_flight++;
+    conn->stats.sent++;
+    s_issued++;
+}
+
+// Expires the timed out requests and issues the new ones, returns the time of the next event
+static uint64_t lg_conn_service(lg_conn_t *conn, uint64_t now, bool issue)
+{
+    uint64_t next_ns = UINT64_MAX;
+    if (conn->state == LG_CONN_CLOSED) {
+        if (issue && (now >= conn->reconnect_ns)) {
+            lg_conn_open(conn, now);
+        }
+        return (issue && (conn->state == LG_CONN_CLOSED)) ? conn->reconnect_ns : UINT64_MAX;
+    }
+    if (conn->state == LG_CONN_CONNECTING) {
+        // The slave that does not accept the connection in time is counted as the failed attempt
+        if (now >= conn->connect_deadline_ns) {
+            lg_conn_close(conn, now);
+            return issue ? conn->reconnect_ns : UINT64_MAX;
+        }
+        next_ns = conn->connect_deadline_ns;
+    }
+    for (int idx = 0; idx < s_cfg.depth; idx++) {
+        lg_slot_t *slot = &conn->slots[idx];
+        if (slot->busy && (now >= slot->deadline_ns)) {
+            slot->busy = false;
+            conn->in_flight--;
+            conn->stats.timeouts++;
+        } else if (slot->busy && (slot->deadline_ns < next_ns)) {
+            next_ns = slot->deadline_ns;
+        }
+    }
+    if (conn->state != LG_CONN_CONNECTED) {
+        return next_ns;
+    }
+    bool queued = false;
+    while (issue && (conn->in_flight < s_cfg.depth) && (!s_cfg.requests || (s_issued < s_cfg.requests))
+            && ((conn->tx_len + LG_FRAME_SIZE_MAX) <= sizeof(conn->tx_buf))) {
+        if (conn->period_ns) {
+            // The open loop: the latency is counted from the scheduled time of the request,
+            // so the delay of the requests waiting for the free slot is not hidden
+            if (now < conn->next_send_ns) {
+                break;
+            }
+            lg_conn_issue(conn, conn->next_send_ns, now);
+            conn->next_send_ns += conn->period_ns;
+        } else {
+            lg_conn_issue(conn, now, now);
+        }
+        queued = true;
+    }
+    if (issue && conn->period_ns && (conn->in_flight < s_cfg.depth) && (conn->next_send_ns < next_ns)) {
+        next_ns = conn->next_send_ns;
+    }
+    if (queued) {
+        lg_conn_flush(conn, now);
+    }
+    return next_ns;
+}
+
+static void lg_conn_process(lg_conn_t *conn, const uint8_t *frame, size_t frame_len, uint64_t now)
+{
+    uint16_t tid = (uint16_t)((frame[0] << 8) | frame[1]);
+    const uint8_t *pdu = &frame[LG_MBAP_HEADER_SIZE];
+    size_t pdu_len = frame_len - LG_MBAP_HEADER_SIZE;
+    lg_slot_t *slot = NULL;
+    for (int idx = 0; idx < s_cfg.depth; idx++) {
+        if (conn->slots[idx].busy && (conn->slots[idx].tid == tid)) {
+            slot = &conn->slots[idx];
+            break;
+        }
+    }
+    if (!slot) {
+        conn->stats.late++;
+        return;
+    }
+    slot->busy = false;
+    conn->in_flight--;
+    const lg_request_t *req = &s_cfg.mix[slot->mix_idx];
+    if ((frame[2] != 0) || (frame[3] != 0) || (frame[6] != s_cfg.uid) || !pdu_len) {
+        conn->stats.errors++;
+    } else if (pdu[0] == (req->fc | 0x80)) {
+        conn->stats.exceptions++;
+        if ((pdu_len == 2) && (pdu[1] < LG_EXC_CODE_MAX)) {
+            conn->stats.exc_codes[pdu[1]]++;
+        }
+    } else if ((pdu[0] == req->fc) && lg_check_response(req, pdu, pdu_len)) {
+        conn->stats.ok++;
+        lg_stats_add_latency(&conn->stats, now - slot->start_ns);
+    } else {
+        conn->stats.errors++;
+    }
+}
+
+static void lg_conn_read(lg_conn_t *conn, uint64_t now)
+{
+    while (conn->state == LG_CONN_CONNECTED) {
+        ssize_t ret = recv(conn->fd, &conn->rx_buf[conn->rx_len], sizeof(conn->rx_buf) - conn->rx_len, 0);
+        if (ret == 0) {
+            lg_conn_close(conn, now);
+            return;
+        }
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                lg_conn_close(conn, now);
+            }
+            return;
+        }
+        conn->rx_len += (size_t)ret;
+        size_t offset = 0;
+        while ((conn->rx_len - offset) >= LG_MBAP_HEADER_SIZE) {
+            uint8_t *frame = &conn->rx_buf[offset];
+            size_t len = (size_t)((frame[LG_MBAP_LEN_OFF] << 8) | frame[LG_MBAP_LEN_OFF + 1]);
+            // The length field counts the unit identifier and the PDU
+            if ((len < 2) || ((len + LG_MBAP_HEADER_SIZE - 1) > LG_FRAME_SIZE_MAX)) {
+                conn->stats.errors++;
+                lg_conn_close(conn, now);
+                return;
+            }
+            size_t frame_len = len + LG_MBAP_HEADER_SIZE - 1;
+            if ((conn->rx_len - offset) < frame_len) {
+                break;
+            }
+            lg_conn_process(conn, frame, frame_len, now);
+            offset += frame_len;
+        }
+        memmove(conn->rx_buf, &conn->rx_buf[offset], conn->rx_len - offset);
+        conn->rx_len -= offset;
+    }
+}
+
+static void lg_conn_event(lg_conn_t *conn, uint32_t events, uint64_t now)
+{
+    if (conn->state == LG_CONN_CONNECTING) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if ((events & (EPOLLERR | EPOLLHUP))
+                || getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &len) || err) {
+            lg_conn_close(conn, now);
+            return;
+        }
+        if (events & EPOLLOUT) {
+            conn->state = LG_CONN_CONNECTED;
+            lg_epoll_update(conn, false);
+            // The requests scheduled while the connection was down are skipped
+            if (conn->period_ns && (conn->next_send_ns < now)) {
+                conn->next_send_ns = now;
+            }
+        }
+        return;
+    }
+    if (events & EPOLLIN) {
+        lg_conn_read(conn, now);
+    }
+    if ((conn->state == LG_CONN_CONNECTED) && (events & (EPOLLERR | EPOLLHUP))) {
+        lg_conn_close(conn, now);
+    }
+    if ((conn->state == LG_CONN_CONNECTED) && (events & EPOLLOUT)) {
+        lg_conn_flush(conn, now);
+    }
+}
+
+static int lg_cmp_u32(const void *a, const void *b)
+{
+    uint32_t val_a = *(const uint32_t *)a;
+    uint32_t val_b = *(const uint32_t *)b;
+    return (val_a > val_b) - (val_a < val_b);
+}
+
+// Nearest rank percentile of the sorted samples, permille is the rank in parts per thousand
+static uint32_t lg_percentile(const uint32_t *sorted, size_t count, int permille)
+{
+    if (!count) {
+        return 0;
+    }
+    size_t rank = ((count * (size_t)permille) + 999) / 1000;
+    return sorted[(rank > 0) ? (rank - 1) : 0];
+}
+
+static void lg_print_stats(const char *name, lg_stats_t *stats, double elapsed_s)
+{
+    qsort(stats->lat_us, stats->lat_cnt, sizeof(uint32_t), lg_cmp_u32);
+    double rps = (elapsed_s > 0) ? ((double)stats->ok / elapsed_s) : 0;
+    uint32_t max_us = stats->lat_cnt ? stats->lat_us[stats->lat_cnt - 1] : 0;
+    if (s_cfg.json) {
+        printf("{\"conn\":\"%s\",\"sent\":%" PRIu64 ",\"ok\":%" PRIu64 ",\"exceptions\":%" PRIu64
+                ",\"timeouts\":%" PRIu64 ",\"errors\":%" PRIu64 ",\"late\":%" PRIu64 ",\"disconnects\":%" PRIu64
+                ",\"conn_fails\":%" PRIu64 ",\"rps\":%.1f,\"p50_us\":%" PRIu32 ",\"p99_us\":%" PRIu32
+                ",\"p999_us\":%" PRIu32 ",\"max_us\":%" PRIu32 ",\"exc_codes\":{",
+                name, stats->sent, stats->ok, stats->exceptions, stats->timeouts, stats->errors, stats->late,
+                stats->disconnects, stats->conn_fails, rps, lg_percentile(stats->lat_us, stats->lat_cnt, 500),
+                lg_percentile(stats->lat_us, stats->lat_cnt, 990),
+                lg_percentile(stats->lat_us, stats->lat_cnt, 999), max_us);
+        const char *sep = "";
+        for (int code = 0; code < LG_EXC_CODE_MAX; code++) {
+            if (stats->exc_codes[code]) {
+                printf("%s\"%d\":%" PRIu64, sep, code, stats->exc_codes[code]);
+                sep = ",";
+            }
+        }
+        printf("}}\n");
+    } else {
+        printf("%-6s %10" PRIu64 " %10" PRIu64 " %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %6" PRIu64
+                " %6" PRIu64 " %6" PRIu64 " %10.1f %9" PRIu32 " %9" PRIu32 " %9" PRIu32 " %9" PRIu32 "\n",
+                name, stats->sent, stats->ok, stats->exceptions, stats->timeouts, stats->errors, stats->late,
+                stats->disconnects, stats->conn_fails, rps, lg_percentile(stats->lat_us, stats->lat_cnt, 500),
+                lg_percentile(stats->lat_us, stats->lat_cnt, 990),
+                lg_percentile(stats->lat_us, stats->lat_cnt, 999), max_us);
+    }
+}
+
+static void lg_report(lg_conn_t *conns, double elapsed_s)
+{
+    lg_stats_t total = {0};
+    for (int idx = 0; idx < s_cfg.conns; idx++) {
+        total.lat_cap += conns[idx].stats.lat_cnt;
+    }
+    total.lat_us = malloc((total.lat_cap ? total.lat_cap : 1) * sizeof(uint32_t));
+    if (!s_cfg.json) {
+        printf("%-6s %10s %10s %8s %8s %8s %6s %6s %6s %10s %9s %9s %9s %9s\n", "conn", "sent", "ok", "exc",
+                "timeout", "error", "late", "disc", "cfail", "rps", "p50_us", "p99_us", "p999_us", "max_us");
+    }
+    for (int idx = 0; idx < s_cfg.conns; idx++) {
+        lg_stats_t *stats = &conns[idx].stats;
+        char name[16];
+        snprintf(name, sizeof(name), "%d", idx);
+        lg_print_stats(name, stats, elapsed_s);
+        total.sent += stats->sent;
+        total.ok += stats->ok;
+        total.exceptions += stats->exceptions;
+        total.timeouts += stats->timeouts;
+        total.errors += stats->errors;
+        total.late += stats->late;
+        total.disconnects += stats->disconnects;
+        total.conn_fails += stats->conn_fails;
+        for (int code = 0; code < LG_EXC_CODE_MAX; code++) {
+            total.exc_codes[code] += stats->exc_codes[code];
+        }
+        if (total.lat_us) {
+            memcpy(&total.lat_us[total.lat_cnt], stats->lat_us, stats->lat_cnt * sizeof(uint32_t));
+            total.lat_cnt += stats->lat_cnt;
+        }
+    }
+    lg_print_stats("total", &total, elapsed_s);
+    if (!s_cfg.json) {
+        for (int code = 0; code < LG_EXC_CODE_MAX; code++) {
+            if (total.exc_codes[code]) {
+                printf("exception %d: %" PRIu64 "\n", code, total.exc_codes[code]);
+            }
+        }
+    }
+    free(total.lat_us);
+}
+
+static bool lg_resolve(const char *host, const char *port)
+{
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+        .ai_protocol = IPPROTO_TCP
+    };
+    struct addrinfo *res = NULL;
+    int ret = getaddrinfo(host, port, &hints, &res);
+    if (ret || !res) {
+        fprintf(stderr, "Can not resolve %s:%s, %s.\n", host, port, gai_strerror(ret));
+        return false;
+    }
+    memcpy(&s_addr, res->ai_addr, res->ai_addrlen);
+    s_addr_len = res->ai_addrlen;
+    freeaddrinfo(res);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *mix_str = LG_DEFAULT_MIX;
+    s_cfg.port = LG_DEFAULT_PORT;
+    s_cfg.conns = 1;
+    s_cfg.depth = 1;
+    s_cfg.uid = 1;
+    s_cfg.duration_s = LG_DEFAULT_DURATION_S;
+    s_cfg.timeout_ms = LG_DEFAULT_TIMEOUT_MS;
+
+    int opt;
+    long value = 0;
+    bool duration_set = false;
+    while ((opt = getopt(argc, argv, "p:c:d:u:r:t:n:o:m:jh")) != -1) {
+        switch (opt) {
+        case 'p': s_cfg.port = optarg; break;
+        case 'c': s_cfg.conns = atoi(optarg); break;
+        case 'd': s_cfg.depth = atoi(optarg); break;
+        case 'u':
+            if (!lg_parse_long(optarg, 0, LG_UID_MAX, &value)) {
+                fprintf(stderr, "Incorrect unit identifier \"%s\", 0..%d.\n", optarg, LG_UID_MAX);
+                return EXIT_FAILURE;
+            }
+            s_cfg.uid = (uint8_t)value;
+            break;
+        case 'r': s_cfg.rate = atof(optarg); break;
+        case 't': s_cfg.duration_s = atof(optarg); duration_set = true; break;
+        case 'n': s_cfg.requests = strtoull(optarg, NULL, 10); break;
+        case 'o': s_cfg.timeout_ms = (uint32_t)atoi(optarg); break;
+        case 'm': mix_str = optarg; break;
+        case 'j': s_cfg.json = true; break;
+        default:
+            lg_usage(argv[0]);
+            return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (optind != (argc - 1)) {
+        lg_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    s_cfg.host = argv[optind];
+    if ((s_cfg.conns < 1) || (s_cfg.conns > LG_CONN_MAX) || (s_cfg.depth < 1) || (s_cfg.depth > LG_DEPTH_MAX)
+            || (s_cfg.rate < 0) || (s_cfg.duration_s <= 0) || !s_cfg.timeout_ms) {
+        fprintf(stderr, "Incorrect options, connections: 1..%d, depth: 1..%d.\n", LG_CONN_MAX, LG_DEPTH_MAX);
+        return EXIT_FAILURE;
+    }
+    if (!lg_parse_mix(mix_str, &s_cfg)) {
+        fprintf(stderr, "Incorrect request mix \"%s\".\n", mix_str);
+        return EXIT_FAILURE;
+    }
+    if (!lg_resolve(s_cfg.host, s_cfg.port)) {
+        return EXIT_FAILURE;
+    }
+    // The request count limits the test alone if the duration is not set explicitly
+    if (s_cfg.requests && !duration_set) {
+        s_cfg.duration_s = 1e9;
+    }
+
+    s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    s_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    lg_conn_t *conns = calloc((size_t)s_cfg.conns, sizeof(lg_conn_t));
+    // The timer wakes up the wait at the send time of the open loop with the sub-millisecond resolution
+    struct epoll_event timer_ev = {
+        .events = EPOLLIN,
+        .data.ptr = NULL
+    };
+    if ((s_epoll_fd < 0) || (s_timer_fd < 0) || !conns
+            || (epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, s_timer_fd, &timer_ev) < 0)) {
+        fprintf(stderr, "Initialization fail, %s.\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    signal(SIGINT, lg_on_signal);
+    signal(SIGTERM, lg_on_signal);
+    s_rand_state ^= (uint32_t)lg_now_ns();
+
+    uint64_t start_ns = lg_now_ns();
+    for (int idx = 0; idx < s_cfg.conns; idx++) {
+        lg_conn_t *conn = &conns[idx];
+        conn->index = idx;
+        conn->fd = -1;
+        conn->next_tid = (uint16_t)lg_rand();
+        if (s_cfg.rate > 0) {
+            // The rate is divided between the connections, the first requests are spread over the period
+            conn->period_ns = (uint64_t)((double)s_cfg.conns * LG_NS_PER_SEC / s_cfg.rate);
+            conn->next_send_ns = start_ns + ((conn->period_ns * (uint64_t)idx) / (uint64_t)s_cfg.conns);
+        }
+        lg_conn_open(conn, start_ns);
+    }
+
+    uint64_t end_ns = start_ns + (uint64_t)(s_cfg.duration_s * LG_NS_PER_SEC);
+    uint64_t drain_end_ns = 0;
+    struct epoll_event events[LG_EPOLL_EVENTS_MAX];
+    for (;;) {
+        uint64_t now = lg_now_ns();
+        bool issue = !s_stop && (now < end_ns) && (!s_cfg.requests || (s_issued < s_cfg.requests));
+        if (!issue && !drain_end_ns) {
+            // Waits for the responses of the requests in flight up to the response timeout
+            drain_end_ns = now + ((uint64_t)s_cfg.timeout_ms * LG_NS_PER_MS);
+        }
+        uint64_t next_ns = issue ? end_ns : drain_end_ns;
+        int in_flight = 0;
+        for (int idx = 0; idx < s_cfg.conns; idx++) {
+            uint64_t conn_next_ns = lg_conn_service(&conns[idx], now, issue);
+            next_ns = (conn_next_ns < next_ns) ? conn_next_ns : next_ns;
+            in_flight += conns[idx].in_flight;
+        }
+        if (!issue && (!in_flight || (now >= drain_end_ns) || (s_stop > 1))) {
+            break;
+        }
+        int wait_ms = 0;
+        if (next_ns > now) {
+            // The wait is limited to check the stop request, the timer expires at the exact time of the event
+            uint64_t wait_max_ns = now + (LG_WAIT_MAX_MS * LG_NS_PER_MS);
+            lg_timer_arm((next_ns < wait_max_ns) ? next_ns : wait_max_ns);
+            wait_ms = LG_WAIT_MAX_MS;
+        }
+        int ev_num = epoll_wait(s_epoll_fd, events, LG_EPOLL_EVENTS_MAX, wait_ms);
+        if ((ev_num < 0) && (errno != EINTR)) {
+            fprintf(stderr, "Wait for events fail, %s.\n", strerror(errno));
+            break;
+        }
+        now = lg_now_ns();
+        for (int idx = 0; idx < ev_num; idx++) {
+            if (!events[idx].data.ptr) {
+                lg_timer_ack();
+                continue;
+            }
+            lg_conn_event((lg_conn_t *)events[idx].data.ptr, events[idx].events, now);
+        }
+    }
+    double elapsed_s = (double)(lg_now_ns() - start_ns) / LG_NS_PER_SEC;
+    // The elapsed time of the report does not include the wait for the last responses
+    if (drain_end_ns && (end_ns < lg_now_ns())) {
+        elapsed_s = (double)(end_ns - start_ns) / LG_NS_PER_SEC;
+    }
+
+    lg_report(conns, elapsed_s);
+    for (int idx = 0; idx < s_cfg.conns; idx++) {
+        if (conns[idx].fd >= 0) {
+            close(conns[idx].fd);
+        }
+        free(conns[idx].stats.lat_us);
+    }
+    free(conns);
+    close(s_timer_fd);
+    close(s_epoll_fd);
+    return EXIT_SUCCESS;
+}
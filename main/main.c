@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_system.h"
@@ -29,6 +30,10 @@
 #define MQTT_PASSWORD ""
 #define FILTER_PRESSURE_DIFF "homeassistant/sensor/pressure"
 #define FILTER_AREA_AIR_TEMPERATURE "homeassistant/sensor/filter_area_temperature"
+#define MODBUS_STATS_TOPIC "modbus/slave/metrics"
+#define MODBUS_STATS_PERIOD_MS 10000
+// The counters take about 2 KB of text, each tracked function code about 1 KB (errors, latency and handler time)
+#define MODBUS_STATS_TEXT_SIZE (2048 + MB_STATS_FUNC_MAX * 1024)
 
 // Defining I2C parameters for SDP810-500
 #define I2C_MASTER_SCL_IO           22
@@ -216,6 +221,34 @@ void modbus_task(void *arg)
     }
 }
 
+#if CONFIG_FMB_STATS_EN
+// Publishes the Modbus slave statistics in the Prometheus text format,
+// the broker side bridge (for example, mqtt2prometheus or telegraf) exposes them for scraping
+void modbus_stats_task(void *arg)
+{
+    static mb_stats_t stats;
+    char *stats_text = malloc(MODBUS_STATS_TEXT_SIZE);
+    if (!stats_text) {
+        ESP_LOGE(TAG, "No memory for the Modbus statistics text.");
+        vTaskDelete(NULL);
+        return;
+    }
+    while(1) {
+        vTaskDelay(pdMS_TO_TICKS(MODBUS_STATS_PERIOD_MS));
+        size_t length = MODBUS_STATS_TEXT_SIZE;
+        esp_err_t err = mbc_get_stats(arg, &stats);
+        if (err == ESP_OK) {
+            err = mbc_stats_to_prometheus(&stats, "slave", stats_text, &length);
+        }
+        if (err == ESP_OK) {
+            esp_mqtt_client_publish(client, MODBUS_STATS_TOPIC, stats_text, length, 0, 0);
+        } else {
+            ESP_LOGW(TAG, "Modbus statistics export error: %s", esp_err_to_name(err));
+        }
+    }
+}
+#endif
+
 void app_main(void)
 {
     ESP_ERROR_CHECK(nvs_flash_init());
@@ -272,4 +305,7 @@ void app_main(void)
     //Create tasks with different priorities
     xTaskCreatePinnedToCore(sensor_mqtt_task, "sensor_mqtt_task", 4096, NULL, 4, NULL, 0); // Pin to core 0
     xTaskCreatePinnedToCore(modbus_task, "modbus_task", 4096, NULL, 6, NULL, 1);  // Higher priority for Modbus and pin to core 1
+#if CONFIG_FMB_STATS_EN
+    xTaskCreatePinnedToCore(modbus_stats_task, "modbus_stats_task", 4096, slave_interface, 2, NULL, 0);
+#endif
 }
\ No newline at end of file